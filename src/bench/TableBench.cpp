@@ -0,0 +1,367 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    分析表构建性能测试。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+/*
+
+    用法：
+        TableBench [options] [tcey file]...
+
+    选项：
+        -repeat:N           每个文法构建 N 次，报告总耗时最短的一次。默认为 1。
+        -workers:N          构建时使用的线程数量。默认为 0，即自动选择。
+        -synthetic:N,N,...  额外测试生成的表达式文法，N 为优先级层数。
+
+    未指定文法文件时，测试 resources 下的 ansi-c.tcey.yacc 与 ansi-c-mod.tcey.yacc。
+
+    对每个文法依次执行 YaccTcey 读取、Lr1Grammar 构建与 buildParserTable，
+    结果以 JSON 输出到标准输出。用于比较修改文法或构建算法前后的差异。
+
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <cstdio>
+
+#include <core/YaccTcey.h>
+#include <core/Lr1Grammar.h>
+#include <core/LrParserTable.h>
+
+using namespace std;
+using namespace tc;
+
+/**
+ * 一个待测文法。
+ */
+struct BenchGrammar {
+    string name;
+
+    /** 文法文件路径。为空时使用 text。 */
+    string path;
+    string text;
+};
+
+/**
+ * 一次构建的结果。
+ */
+struct BenchResult {
+    double yaccSeconds = 0;
+    double lr1Seconds = 0;
+    double tableSeconds = 0;
+
+    lr1grammar::Lr1BuildStats stats;
+
+    int symbolCount = 0;
+    int terminalCount = 0;
+    int expressionCount = 0;
+    int stateCount = 0;
+    long long itemCount = 0;
+
+    long long actionCells = 0;
+    long long gotoCells = 0;
+
+    double totalSeconds() const { return yaccSeconds + lr1Seconds + tableSeconds; }
+};
+
+static double __tcSecondsSince(chrono::steady_clock::time_point begin) {
+    return chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+}
+
+/**
+ * 生成表达式文法。共 levels 层二元运算，每层一个运算符，
+ * 形如 expN : expN OPN expN+1 | expN+1。
+ */
+static string __tcMakeSyntheticGrammar(int levels) {
+
+    stringstream out;
+
+    out << "/*_tcey_\n\n";
+    for (int level = 0; level < levels; level++) {
+        out << "token-key OP" << level << " +\n";
+    }
+
+    out << "token-key LP (\n";
+    out << "token-key RP )\n";
+    out << "token-key SEMI ;\n";
+    out << "token-key IDENTIFIER --_identifier_\n\n";
+    out << "*/\n\n";
+
+    out << "%token IDENTIFIER LP RP SEMI\n";
+    for (int level = 0; level < levels; level++) {
+        out << "%token OP" << level << "\n";
+    }
+
+    out << "%start statement_list\n";
+    out << "%%\n\n";
+
+    out << "statement_list\n\t: statement\n\t| statement_list statement\n\t;\n\n";
+    out << "statement\n\t: exp0 SEMI\n\t;\n\n";
+
+    for (int level = 0; level < levels; level++) {
+        string next = level + 1 < levels ? "exp" + to_string(level + 1) : "primary";
+
+        out << "exp" << level << "\n";
+        out << "\t: " << next << "\n";
+        out << "\t| exp" << level << " OP" << level << " " << next << "\n";
+        out << "\t;\n\n";
+    }
+
+    out << "primary\n\t: IDENTIFIER\n\t| LP exp0 RP\n\t;\n\n";
+    out << "%%\n";
+
+    return out.str();
+}
+
+/**
+ * 构建一次。
+ *
+ * @return 读取文法失败时，返回错误信息。否则返回空串。
+ */
+static string __tcRunOnce(const BenchGrammar& grammar, int workerCount, BenchResult& result) {
+
+    auto yaccBegin = chrono::steady_clock::now();
+
+    unique_ptr< YaccTcey > yacc;
+    if (grammar.path.empty()) {
+        stringstream in(grammar.text);
+        yacc = make_unique< YaccTcey >(in);
+    } else {
+        yacc = make_unique< YaccTcey >(grammar.path);
+    }
+
+    result.yaccSeconds = __tcSecondsSince(yaccBegin);
+
+    if (yacc->errcode != YaccTceyError::TCEY_OK) {
+        return yacc->errmsg.empty() ? "failed to load grammar" : yacc->errmsg;
+    }
+
+    auto lr1Begin = chrono::steady_clock::now();
+    lr1grammar::Lr1Grammar lr1(yacc->grammar, workerCount);
+    result.lr1Seconds = __tcSecondsSince(lr1Begin);
+
+    LrParserTable table;
+
+    auto tableBegin = chrono::steady_clock::now();
+    lr1.buildParserTable(table);
+    result.tableSeconds = __tcSecondsSince(tableBegin);
+
+    result.stats = lr1.getStats();
+
+    auto& states = lr1.getStates();
+    result.stateCount = states.size();
+    result.itemCount = 0;
+    for (auto& state : states) {
+        result.itemCount += state.expressions.size();
+    }
+
+    result.symbolCount = table.symbolList.size();
+    result.terminalCount = 0;
+    for (auto& symbol : table.symbolList) {
+        if (symbol.type == grammar::SymbolType::TERMINAL) {
+            result.terminalCount++;
+        }
+    }
+
+    result.expressionCount = table.flatExpressions.size();
+
+    result.actionCells = 0;
+    result.gotoCells = 0;
+    for (auto& rowPair : table.table) {
+        for (auto& cellPair : rowPair.second) {
+            if (table.symbolList[cellPair.first].type == grammar::SymbolType::TERMINAL) {
+                result.actionCells++;
+            } else {
+                result.gotoCells++;
+            }
+        }
+    }
+
+    return "";
+}
+
+static string __tcJsonQuote(const string& s) {
+    string res = "\"";
+    for (char ch : s) {
+        if (ch == '"' || ch == '\\') {
+            res += '\\';
+            res += ch;
+        } else if ((unsigned char) ch < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", ch);
+            res += buf;
+        } else {
+            res += ch;
+        }
+    }
+
+    res += '"';
+    return res;
+}
+
+static double __tcRatio(double a, double b) {
+    return b == 0 ? 0 : a / b;
+}
+
+static void __tcPrintResult(ostream& out, const BenchGrammar& grammar, const BenchResult& r) {
+
+    auto& s = r.stats;
+    int nonTerminalCount = r.symbolCount - r.terminalCount;
+
+    out << "    {\n";
+    out << "      \"grammar\": " << __tcJsonQuote(grammar.name) << ",\n";
+    out << "      \"symbols\": " << r.symbolCount << ",\n";
+    out << "      \"terminals\": " << r.terminalCount << ",\n";
+    out << "      \"expressions\": " << r.expressionCount << ",\n";
+
+    out << "      \"seconds\": {\n";
+    out << "        \"yacc\": " << r.yaccSeconds << ",\n";
+    out << "        \"flatten\": " << s.flattenSeconds << ",\n";
+    out << "        \"first\": " << s.firstSeconds << ",\n";
+    out << "        \"closure\": " << s.closureSeconds << ",\n";
+    out << "        \"intern\": " << s.internSeconds << ",\n";
+    out << "        \"fill\": " << s.fillSeconds << ",\n";
+    out << "        \"total\": " << r.totalSeconds() << "\n";
+    out << "      },\n";
+
+    out << "      \"states\": " << r.stateCount << ",\n";
+    out << "      \"items\": " << r.itemCount << ",\n";
+    out << "      \"kernelItems\": " << s.kernelItemCount << ",\n";
+    out << "      \"closures\": " << s.closureCount << ",\n";
+    out << "      \"transitions\": " << s.transitionCount << ",\n";
+
+    out << "      \"table\": {\n";
+    out << "        \"actionCells\": " << r.actionCells << ",\n";
+    out << "        \"gotoCells\": " << r.gotoCells << ",\n";
+    out << "        \"actionDensity\": "
+        << __tcRatio(r.actionCells, double(r.stateCount) * r.terminalCount) << ",\n";
+    out << "        \"gotoDensity\": "
+        << __tcRatio(r.gotoCells, double(r.stateCount) * nonTerminalCount) << ",\n";
+    out << "        \"density\": "
+        << __tcRatio(r.actionCells + r.gotoCells, double(r.stateCount) * r.symbolCount) << "\n";
+    out << "      },\n";
+
+    out << "      \"conflicts\": {\n";
+    out << "        \"shiftReduceResolved\": " << s.shiftReduceResolved << ",\n";
+    out << "        \"shiftReduceUnresolved\": " << s.shiftReduceUnresolved << ",\n";
+    out << "        \"nonassocErrors\": " << s.nonassocErrors << ",\n";
+    out << "        \"reduceReduce\": " << s.reduceReduce << "\n";
+    out << "      }\n";
+    out << "    }";
+}
+
+static bool __tcParseIntOption(const string& arg, const string& prefix, int& value) {
+    if (arg.rfind(prefix, 0) != 0) {
+        return false;
+    }
+
+    value = atoi(arg.c_str() + prefix.size());
+    return true;
+}
+
+int main(int argc, const char** argv) {
+
+    int repeat = 1;
+    int workerCount = 0;
+    vector< int > syntheticLevels;
+    vector< BenchGrammar > grammars;
+
+    for (int argIdx = 1; argIdx < argc; argIdx++) {
+        string arg = argv[argIdx];
+
+        if (__tcParseIntOption(arg, "-repeat:", repeat)
+            || __tcParseIntOption(arg, "-workers:", workerCount)
+        ) {
+            continue;
+        }
+
+        if (arg.rfind("-synthetic:", 0) == 0) {
+            stringstream ss(arg.substr(11));
+            string level;
+            while (getline(ss, level, ',')) {
+                if (atoi(level.c_str()) > 0) {
+                    syntheticLevels.push_back(atoi(level.c_str()));
+                }
+            }
+
+            continue;
+        }
+
+        if (arg[0] == '-') {
+            cerr << "usage: " << argv[0]
+                << " [-repeat:N] [-workers:N] [-synthetic:N,N,...] [tcey file]..." << endl;
+            return -1;
+        }
+
+        grammars.push_back({ arg, arg, "" });
+    }
+
+    if (grammars.empty()) {
+        grammars.push_back({ "ansi-c", "./resources/ansi-c.tcey.yacc", "" });
+        grammars.push_back({ "ansi-c-mod", "./resources/ansi-c-mod.tcey.yacc", "" });
+    }
+
+    for (int levels : syntheticLevels) {
+        grammars.push_back({
+            "synthetic-" + to_string(levels), "", __tcMakeSyntheticGrammar(levels)
+        });
+    }
+
+    if (repeat < 1) {
+        repeat = 1;
+    }
+
+    cout << "{\n";
+    cout << "  \"repeat\": " << repeat << ",\n";
+    cout << "  \"workers\": " << workerCount << ",\n";
+    cout << "  \"results\": [\n";
+
+    int exitCode = 0;
+
+    for (size_t grammarIdx = 0; grammarIdx < grammars.size(); grammarIdx++) {
+        auto& grammar = grammars[grammarIdx];
+
+        BenchResult best;
+        string errmsg;
+
+        for (int round = 0; round < repeat; round++) {
+            BenchResult result;
+            errmsg = __tcRunOnce(grammar, workerCount, result);
+            if (!errmsg.empty()) {
+                break;
+            }
+
+            if (round == 0 || result.totalSeconds() < best.totalSeconds()) {
+                best = result;
+            }
+        }
+
+        if (!errmsg.empty()) {
+            cout << "    {\n";
+            cout << "      \"grammar\": " << __tcJsonQuote(grammar.name) << ",\n";
+            cout << "      \"error\": " << __tcJsonQuote(errmsg) << "\n";
+            cout << "    }";
+            exitCode = -2;
+        } else {
+            __tcPrintResult(cout, grammar, best);
+        }
+
+        cout << (grammarIdx + 1 < grammars.size() ? ",\n" : "\n");
+    }
+
+    cout << "  ]\n";
+    cout << "}\n";
+
+    return exitCode;
+}
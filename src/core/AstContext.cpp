@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    Abstract Syntax Tree Context
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+#include <core/AstContext.h>
+
+#include <algorithm>
+#include <new>
+#include <type_traits>
+
+using namespace std;
+using namespace tc;
+
+AstContext::~AstContext() {
+    this->clear();
+}
+
+AstNode* AstContext::newNode(AstNodeAllocator& allocator, int symbolId, int tokenIdx) {
+    void* mem = allocator.nodeArena.allocate(sizeof(AstNode), alignof(AstNode));
+    AstNode* node = new (mem) AstNode;
+    node->context = this;
+    node->symbolId = symbolId;
+    node->tokenIdx = tokenIdx;
+
+    if constexpr (!is_trivially_destructible_v<AstNode>) {
+        allocator.nodesToDestroy.push_back(node);
+    }
+
+    allocator.nodeCount++;
+
+    return node;
+}
+
+AstNodeChildren AstContext::newChildren(AstNodeAllocator& allocator, int count) {
+    AstNodeChildren children;
+    children.count = count;
+
+    if (count > 0) {
+        children.data = allocator.childArena.allocateArray<AstNode*>(count);
+    }
+
+    return children;
+}
+
+AstNodeAllocator& AstContext::newAllocator() {
+    extraAllocators.push_back(make_unique<AstNodeAllocator>());
+    return *extraAllocators.back();
+}
+
+size_t AstContext::getNodeCount() {
+    size_t count = mainAllocator.nodeCount;
+    for (auto& allocator : extraAllocators) {
+        count += allocator->nodeCount;
+    }
+
+    return count;
+}
+
+size_t AstContext::getUsedBytes() {
+    size_t bytes = mainAllocator.nodeArena.getUsedBytes() + mainAllocator.childArena.getUsedBytes();
+    for (auto& allocator : extraAllocators) {
+        bytes += allocator->nodeArena.getUsedBytes() + allocator->childArena.getUsedBytes();
+    }
+
+    return bytes;
+}
+
+void AstContext::releaseAllocator(AstNodeAllocator& allocator) {
+
+    // 节点可平凡析构时，不需要逐个处理，直接归还内存即可。
+    if constexpr (!is_trivially_destructible_v<AstNode>) {
+        for (auto node : allocator.nodesToDestroy) {
+            node->~AstNode();
+        }
+
+        allocator.nodesToDestroy.clear();
+    }
+
+    allocator.nodeArena.release();
+    allocator.childArena.release();
+    allocator.nodeCount = 0;
+}
+
+void AstContext::clear() {
+    
+    releaseAllocator(mainAllocator);
+    
+    for (auto& allocator : extraAllocators) {
+        releaseAllocator(*allocator);
+    }
+
+    extraAllocators.clear();
+
+    symbolList.reset();
+    tokens = nullptr;
+
+    tokenPieces.clear();
+    tokenPiecesByVirtual.clear();
+    virtualTokenCount = 0;
+}
+
+int AstContext::lookupRealTokenIdx(int tokenIdx) const {
+    
+    // 最后一个 virtualBegin <= tokenIdx 的段。
+    auto it = upper_bound(
+        tokenPiecesByVirtual.begin(), tokenPiecesByVirtual.end(), tokenIdx,
+        [] (int idx, const AstTokenPiece& piece) { return idx < piece.virtualBegin; }
+    );
+
+    if (it == tokenPiecesByVirtual.begin()) {
+        return -1;
+    }
+
+    --it;
+    int offset = tokenIdx - it->virtualBegin;
+    return offset < it->length ? it->realBegin + offset : -1;
+}
+
+int AstContext::lookupVirtualTokenIdx(int realIdx) const {
+
+    auto it = upper_bound(
+        tokenPieces.begin(), tokenPieces.end(), realIdx,
+        [] (int idx, const AstTokenPiece& piece) { return idx < piece.realBegin; }
+    );
+
+    if (it == tokenPieces.begin()) {
+        return -1;
+    }
+
+    --it;
+    int offset = realIdx - it->realBegin;
+    return offset < it->length ? it->virtualBegin + offset : -1;
+}
+
+void AstContext::applyTokenEdit(
+    const vector< Token >* newTokens, 
+    int oldTokenCount, 
+    const TokenEdit& edit
+) {
+
+    if (tokenPieces.empty()) {
+        // 此前没有编辑过。映射为恒等。
+        tokenPieces.push_back({ 0, 0, oldTokenCount });
+        virtualTokenCount = oldTokenCount;
+    }
+
+    int delta = edit.newEnd - edit.oldEnd;
+
+    vector< AstTokenPiece > pieces;
+    pieces.reserve(tokenPieces.size() + 2);
+
+    auto addPiece = [&pieces] (int virtualBegin, int realBegin, int length) {
+        if (length <= 0) {
+            return;
+        }
+
+        // 与前一段首尾相接时合并。
+        if (!pieces.empty()) {
+            auto& last = pieces.back();
+            if (last.virtualBegin + last.length == virtualBegin 
+                && last.realBegin + last.length == realBegin
+            ) {
+                last.length += length;
+                return;
+            }
+        }
+
+        pieces.push_back({ virtualBegin, realBegin, length });
+    };
+
+    bool newPieceAdded = false;
+
+    for (auto& piece : tokenPieces) {
+        int realEnd = piece.realBegin + piece.length;
+
+        // 编辑之前的部分，位置不变。
+        if (piece.realBegin < edit.begin) {
+            int length = min(realEnd, edit.begin) - piece.realBegin;
+            addPiece(piece.virtualBegin, piece.realBegin, length);
+        }
+
+        // 新插入的 token。
+        if (!newPieceAdded && realEnd >= edit.begin) {
+            addPiece(virtualTokenCount, edit.begin, edit.newEnd - edit.begin);
+            newPieceAdded = true;
+        }
+
+        // 编辑之后的部分，整体平移。
+        if (realEnd > edit.oldEnd) {
+            int realBegin = max(piece.realBegin, edit.oldEnd);
+            int offset = realBegin - piece.realBegin;
+            addPiece(piece.virtualBegin + offset, realBegin + delta, realEnd - realBegin);
+        }
+    }
+
+    if (!newPieceAdded) {
+        addPiece(virtualTokenCount, edit.begin, edit.newEnd - edit.begin);
+    }
+
+    virtualTokenCount += max(edit.newEnd - edit.begin, 0);
+
+    tokenPieces = move(pieces);
+    tokenPiecesByVirtual = tokenPieces;
+    sort(
+        tokenPiecesByVirtual.begin(), tokenPiecesByVirtual.end(), 
+        [] (const AstTokenPiece& a, const AstTokenPiece& b) {
+            return a.virtualBegin < b.virtualBegin;
+        }
+    );
+
+    this->tokens = newTokens;
+}
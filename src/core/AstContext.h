@@ -0,0 +1,282 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    Abstract Syntax Tree Context
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+#pragma once
+
+#include <core/AstNode.h>
+#include <utils/MemoryArena.h>
+#include <utils/AppendOnlyList.h>
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace tc {
+
+    /**
+     * token 列表的一次编辑。
+     * 旧列表的 [begin, oldEnd) 被替换为新列表的 [begin, newEnd)，其余 token 不变。
+     */
+    struct TokenEdit {
+        int begin;
+        int oldEnd;
+        int newEnd;
+    };
+
+    /**
+     * token 下标映射中的一段。
+     * 节点内的 token 下标 [virtualBegin, virtualBegin + length) 
+     * 对应 token 列表内的 [realBegin, realBegin + length)。
+     */
+    struct AstTokenPiece {
+        int32_t virtualBegin;
+        int32_t realBegin;
+        int32_t length;
+    };
+
+    /**
+     * 节点分配器。持有节点和孩子数组所在的内存。
+     * 
+     * 多个线程同时为同一个上下文创建节点时，每个线程使用各自的分配器，互不加锁。
+     */
+    struct AstNodeAllocator {
+
+        /**
+         * 节点所在的内存。
+         */
+        MemoryArena nodeArena;
+
+        /**
+         * 孩子数组所在的内存。
+         */
+        MemoryArena childArena;
+
+        /**
+         * 需要析构的节点。仅当节点不可平凡析构时使用。
+         */
+        std::vector< AstNode* > nodesToDestroy;
+
+        size_t nodeCount = 0;
+    };
+
+    /**
+     * 语法树上下文。持有一棵语法树的所有节点。
+     * 
+     * 节点和孩子数组都从大块内存中切出，不单独释放。
+     * 整棵树通过 clear 一次性释放，不需要递归遍历。
+     */
+    class AstContext {
+    public:
+
+        AstContext() {}
+        ~AstContext();
+
+        /**
+         * 绑定节点共享的符号表和 token 列表。
+         * 上下文会共同持有符号表，但不持有 token 列表。
+         * 调用者需保证 token 列表的生命周期覆盖语法树。
+         * 
+         * @param symbolList 符号表。符号 id 和其在表内下标保持一致。
+         * @param tokens 词法分析得到的 token 列表。
+         */
+        void bind(
+            std::shared_ptr< const std::vector< grammar::Symbol > > symbolList, 
+            const std::vector< Token >* tokens
+        ) {
+            this->symbolList = std::move(symbolList);
+            this->tokens = tokens;
+            this->streamTokens = nullptr;
+        }
+
+        /**
+         * 改为从只追加列表读取 token。
+         * token 列表还在增长时，其他线程可以通过它安全地读取语法树内的 token。
+         * 列表内容需与 bind 绑定的列表一致。
+         * 
+         * @param streamTokens 只追加列表。传入空指针表示改回从 bind 绑定的列表读取。
+         */
+        void bindStreamTokens(const AppendOnlyList< Token >* streamTokens) {
+            this->streamTokens = streamTokens;
+        }
+
+        /**
+         * 创建一个新节点。
+         * 
+         * @param symbolId 符号 id。
+         * @param tokenIdx token 下标。非终结符可以稍后设置为子树内第一个 token 的下标。
+         */
+        AstNode* newNode(int symbolId, int tokenIdx = -1) {
+            return newNode(mainAllocator, symbolId, tokenIdx);
+        }
+
+        /**
+         * 使用指定的分配器创建一个新节点。
+         * 
+         * @param allocator 由 newAllocator 得到的分配器。
+         */
+        AstNode* newNode(AstNodeAllocator& allocator, int symbolId, int tokenIdx = -1);
+
+        /**
+         * 创建一个额外的分配器。其中的节点同样属于本上下文，随 clear 一起释放。
+         * 
+         * 本方法不是线程安全的。需要在工作线程开始前，为每个线程各创建一个。
+         */
+        AstNodeAllocator& newAllocator();
+
+        /**
+         * 默认的分配器。不指定分配器的 newNode 与 newChildren 使用它。
+         */
+        AstNodeAllocator& getMainAllocator() { return mainAllocator; }
+
+        const grammar::Symbol& getSymbol(int symbolId) const {
+            return (*symbolList)[symbolId];
+        }
+
+        /**
+         * 获取 token。
+         * 
+         * @param tokenIdx 节点内记录的 token 下标。
+         */
+        const Token& getToken(int tokenIdx) const {
+            int realIdx = toRealTokenIdx(tokenIdx);
+            return streamTokens != nullptr ? (*streamTokens)[realIdx] : (*tokens)[realIdx];
+        }
+
+        /**
+         * 绑定的符号表。
+         */
+        const std::vector< grammar::Symbol >& getSymbolList() const { return *symbolList; }
+
+        /**
+         * 绑定的 token 列表。不受 bindStreamTokens 影响。
+         */
+        const std::vector< Token >& getTokens() const { return *tokens; }
+
+        /**
+         * 节点内记录的 token 下标 -> token 列表内的下标。
+         * 
+         * 完整分析得到的树内，两者相同。增量分析复用的节点保留原来的下标，
+         * 由上下文映射到新的 token 列表。
+         * 
+         * @return token 列表内的下标。token 已被编辑删除时，返回 -1。
+         */
+        int toRealTokenIdx(int tokenIdx) const {
+            return tokenPiecesByVirtual.empty() ? tokenIdx : lookupRealTokenIdx(tokenIdx);
+        }
+
+        /**
+         * token 列表内的下标 -> 新节点应记录的 token 下标。
+         */
+        int toVirtualTokenIdx(int realIdx) const {
+            return tokenPieces.empty() ? realIdx : lookupVirtualTokenIdx(realIdx);
+        }
+
+        /**
+         * 节点可能记录的 token 下标的上界（不含）。
+         * 
+         * @param tokenCount token 列表长度。仅当没有发生过编辑时使用。
+         */
+        int getVirtualTokenCount(int tokenCount) const {
+            return tokenPieces.empty() ? tokenCount : virtualTokenCount;
+        }
+
+        /**
+         * 应用 token 列表的编辑，并绑定到新的 token 列表。
+         * 
+         * 未被删除的 token 的下标映射到新列表内的位置。
+         * 新插入的 token 分到一段全新的下标，与已有节点不冲突。
+         * 
+         * @param newTokens 编辑后的 token 列表。
+         * @param oldTokenCount 编辑前的 token 列表长度。
+         * @param edit 编辑范围。
+         */
+        void applyTokenEdit(
+            const std::vector< Token >* newTokens, 
+            int oldTokenCount, 
+            const TokenEdit& edit
+        );
+
+        /**
+         * 创建一个孩子数组。数组内容未初始化。
+         * 
+         * @param count 孩子数量。
+         */
+        AstNodeChildren newChildren(int count) {
+            return newChildren(mainAllocator, count);
+        }
+
+        /**
+         * 使用指定的分配器创建一个孩子数组。
+         */
+        AstNodeChildren newChildren(AstNodeAllocator& allocator, int count);
+
+        /**
+         * 释放所有节点。之前分配的节点和孩子数组全部失效。
+         */
+        void clear();
+
+        /**
+         * 已创建的节点数量。
+         */
+        size_t getNodeCount();
+
+        /**
+         * 节点和孩子数组占用的字节数。
+         */
+        size_t getUsedBytes();
+
+    protected:
+
+        /**
+         * 默认的分配器。
+         */
+        AstNodeAllocator mainAllocator;
+
+        /**
+         * 由 newAllocator 创建的分配器。
+         */
+        std::vector< std::unique_ptr< AstNodeAllocator > > extraAllocators;
+
+        std::shared_ptr< const std::vector< grammar::Symbol > > symbolList;
+        const std::vector< Token >* tokens = nullptr;
+
+        /**
+         * 不为空时，getToken 从这里读取，而不是 tokens。
+         */
+        const AppendOnlyList< Token >* streamTokens = nullptr;
+
+        /**
+         * token 下标映射。按 realBegin 排序，覆盖整个 token 列表。
+         * 为空表示节点内的下标就是列表内的下标。
+         */
+        std::vector< AstTokenPiece > tokenPieces;
+
+        /**
+         * 与 tokenPieces 内容相同，按 virtualBegin 排序。
+         */
+        std::vector< AstTokenPiece > tokenPiecesByVirtual;
+
+        /**
+         * 下一段新 token 使用的起始下标。
+         */
+        int virtualTokenCount = 0;
+
+        int lookupRealTokenIdx(int tokenIdx) const;
+        int lookupVirtualTokenIdx(int realIdx) const;
+
+        static void releaseAllocator(AstNodeAllocator& allocator);
+
+    private:
+        AstContext(const AstContext&) = delete;
+        AstContext& operator = (const AstContext&) = delete;
+    };
+
+}
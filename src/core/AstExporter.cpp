@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    语法树导出。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+#include <core/AstExporter.h>
+#include <core/AstContext.h>
+#include <utils/BufferedWriter.h>
+
+#include <magic_enum/magic_enum.hpp>
+
+#include <vector>
+
+using namespace std;
+using namespace tc;
+
+static constexpr char AST_EXPORT_MAGIC[4] = { 'T', 'C', 'A', 'X' };
+static constexpr uint32_t AST_EXPORT_VERSION = 1;
+
+/**
+ * 写入 JSON 字符串字面量。非 ASCII 字节原样输出。
+ */
+static void __tcWriteJsonString(BufferedWriter& writer, string_view str) {
+    
+    static const char* hexDigits = "0123456789abcdef";
+
+    writer.put('"');
+
+    for (char ch : str) {
+        switch (ch) {
+            case '"': writer.write("\\\""); break;
+            case '\\': writer.write("\\\\"); break;
+            case '\n': writer.write("\\n"); break;
+            case '\r': writer.write("\\r"); break;
+            case '\t': writer.write("\\t"); break;
+            default:
+                if ((unsigned char) ch < 0x20) {
+                    writer.write("\\u00");
+                    writer.put(hexDigits[ch >> 4]);
+                    writer.put(hexDigits[ch & 0xf]);
+                } else {
+                    writer.put(ch);
+                }
+        }
+    }
+
+    writer.put('"');
+}
+
+/**
+ * 先序遍历。visit(node, parentId) 按先序依次收到每个节点及其上级的先序编号。
+ */
+template <typename Visitor>
+static void __tcWalkPreOrder(const AstNode* root, Visitor&& visit) {
+
+    // 栈内记录节点与其上级的编号。
+    vector< pair< const AstNode*, int > > stack = { { root, -1 } };
+    int nextId = 0;
+
+    while (!stack.empty()) {
+        auto [node, parentId] = stack.back();
+        stack.pop_back();
+
+        int id = nextId++;
+        visit(node, parentId);
+
+        for (int childIdx = node->children.size() - 1; childIdx >= 0; childIdx--) {
+            stack.emplace_back(node->children[childIdx], id);
+        }
+    }
+}
+
+static int __tcRealTokenIdx(const AstNode* node) {
+    return node->tokenIdx < 0 ? -1 : node->context->toRealTokenIdx(node->tokenIdx);
+}
+
+static void __tcExportBinary(BufferedWriter& writer, const AstNode* root) {
+
+    auto& symbolList = root->context->getSymbolList();
+    auto& tokens = root->context->getTokens();
+
+    writer.write(AST_EXPORT_MAGIC, sizeof(AST_EXPORT_MAGIC));
+    writer.writeBinary(AST_EXPORT_VERSION);
+    writer.writeBinary(uint32_t(symbolList.size()));
+    writer.writeBinary(uint32_t(tokens.size()));
+
+    for (auto& symbol : symbolList) {
+        writer.writeBinary(int32_t(symbol.type == grammar::SymbolType::TERMINAL));
+        writer.writeBinary(uint32_t(symbol.name.size()));
+        writer.write(symbol.name);
+    }
+
+    for (auto& token : tokens) {
+        writer.writeBinary(int32_t(token.kind));
+        writer.writeBinary(int32_t(token.row));
+        writer.writeBinary(int32_t(token.col));
+        writer.writeBinary(uint32_t(token.content.size()));
+        writer.write(token.content);
+    }
+
+    __tcWalkPreOrder(root, [&writer] (const AstNode* node, int) {
+        writer.writeBinary(int32_t(node->symbolId));
+        writer.writeBinary(int32_t(__tcRealTokenIdx(node)));
+        writer.writeBinary(int32_t(node->children.size()));
+    });
+}
+
+static void __tcExportJsonLines(BufferedWriter& writer, const AstNode* root) {
+
+    auto& symbolList = root->context->getSymbolList();
+    auto& tokens = root->context->getTokens();
+
+    writer.write("{\"type\":\"header\",\"format\":\"tcast\",\"version\":");
+    writer.writeDecimal(AST_EXPORT_VERSION);
+    writer.write(",\"symbols\":");
+    writer.writeDecimal(symbolList.size());
+    writer.write(",\"tokens\":");
+    writer.writeDecimal(tokens.size());
+    writer.write("}\n");
+
+    for (size_t symbolId = 0; symbolId < symbolList.size(); symbolId++) {
+        auto& symbol = symbolList[symbolId];
+
+        writer.write("{\"type\":\"symbol\",\"id\":");
+        writer.writeDecimal(symbolId);
+        writer.write(",\"name\":");
+        __tcWriteJsonString(writer, symbol.name);
+        writer.write(symbol.type == grammar::SymbolType::TERMINAL 
+            ? ",\"terminal\":true}\n" : ",\"terminal\":false}\n");
+    }
+
+    for (size_t tokenIdx = 0; tokenIdx < tokens.size(); tokenIdx++) {
+        auto& token = tokens[tokenIdx];
+
+        writer.write("{\"type\":\"token\",\"id\":");
+        writer.writeDecimal(tokenIdx);
+        writer.write(",\"kind\":");
+        __tcWriteJsonString(writer, magic_enum::enum_name(token.kind));
+        writer.write(",\"row\":");
+        writer.writeDecimal(token.row);
+        writer.write(",\"col\":");
+        writer.writeDecimal(token.col);
+        writer.write(",\"content\":");
+        __tcWriteJsonString(writer, token.content);
+        writer.write("}\n");
+    }
+
+    int nodeId = 0;
+    __tcWalkPreOrder(root, [&writer, &nodeId] (const AstNode* node, int parentId) {
+        writer.write("{\"type\":\"node\",\"id\":");
+        writer.writeDecimal(nodeId++);
+        writer.write(",\"parent\":");
+        writer.writeDecimal(parentId);
+        writer.write(",\"symbol\":");
+        writer.writeDecimal(node->symbolId);
+        writer.write(",\"token\":");
+        writer.writeDecimal(__tcRealTokenIdx(node));
+        writer.write(",\"children\":");
+        writer.writeDecimal(node->children.size());
+        writer.write("}\n");
+    });
+}
+
+int tc::exportAst(ostream& out, const AstNode* root, AstExportFormat format) {
+
+    if (root == nullptr) {
+        return 1;
+    }
+
+    {
+        BufferedWriter writer(out);
+
+        if (format == AstExportFormat::binary) {
+            __tcExportBinary(writer, root);
+        } else {
+            __tcExportJsonLines(writer, root);
+        }
+    }
+
+    out.flush();
+    return out.good() ? 0 : 2;
+}
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    语法树导出。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+/*
+
+  用途
+
+    把语法树交给外部工具（编辑器插件、可视化前端等）。与 dot 格式不同，
+    输出只描述结构，节点之间用编号关联，体积与节点数量成正比。
+
+    两种格式都在一次先序遍历内边走边写，使用显式栈，不会因为
+    长的左递归链导致栈溢出。输出经过缓冲，不逐行刷新。
+
+  二进制格式（本机字节序）
+
+    头部      char[4] "TCAX"，uint32 版本，uint32 符号数，uint32 token 数
+    符号      每个 { int32 终结符为 1，uint32 名称长度，名称 }
+    token     每个 { int32 kind，int32 row，int32 col，uint32 内容长度，内容 }
+    节点      先序排列，每个 { int32 符号 id，int32 token 下标，int32 孩子数 }
+
+    节点部分没有数量字段：读到的孩子数全部消化完时，树即结束。
+    token 下标为 -1 表示没有 token（空子树）。
+
+  JSON lines 格式
+
+    每行一个 JSON 对象，以 type 区分：
+      {"type":"header","format":"tcast","version":1,"symbols":N,"tokens":N}
+      {"type":"symbol","id":0,"name":"...","terminal":true}
+      {"type":"token","id":0,"kind":"identifier","row":1,"col":1,"content":"..."}
+      {"type":"node","id":0,"parent":-1,"symbol":0,"token":0,"children":2}
+
+    node 按先序排列，id 为先序编号，parent 为上级节点的 id（根为 -1）。
+    前端可以逐行读取并立即建立节点，不需要等待整个文件解析完毕。
+
+*/
+
+#pragma once
+
+#include <core/AstNode.h>
+
+#include <iostream>
+
+namespace tc {
+
+    enum class AstExportFormat {
+        binary,
+        jsonLines
+    };
+
+    /**
+     * 导出语法树。符号表与 token 列表取自节点所属的上下文。
+     * 
+     * @param out 输出流。二进制格式需要以二进制模式打开。
+     * @param root 根节点。
+     * @param format 格式。
+     * @return 0 表示成功。根节点为空时返回 1，写入失败时返回 2。
+     */
+    int exportAst(std::ostream& out, const AstNode* root, AstExportFormat format);
+
+}
@@ -10,18 +10,21 @@
 */
 
 #include <core/AstNode.h>
+#include <core/AstContext.h>
 
 using namespace std;
 using namespace tc;
 
-AstNode::~AstNode() {
-    this->freeChildren();
+const grammar::Symbol& AstNode::symbol() const {
+    return context->getSymbol(symbolId);
 }
 
-void AstNode::freeChildren() {
-    for (auto& child : children) {
-        delete child;
+const Token& AstNode::token() const {
+    static const Token emptyToken {};
+
+    if (tokenIdx < 0 || symbolType() != grammar::SymbolType::TERMINAL) {
+        return emptyToken;
     }
 
-    children.clear();
+    return context->getToken(tokenIdx);
 }
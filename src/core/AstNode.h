@@ -16,15 +16,49 @@
 #include "core/SymbolKinds.h"
 #include "core/Grammar.h"
 
-#include <vector>
+#include <cstddef>
+#include <cstdint>
 
 namespace tc {
 
+    struct AstNode;
+
+    /**
+     * 语法树节点的孩子列表。
+     * 指向由 AstContext 分配的数组，不负责释放。
+     */
+    struct AstNodeChildren {
+
+        AstNode** data = nullptr;
+        
+        int count = 0;
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+
+        AstNode*& operator [] (size_t idx) const { return data[idx]; }
+        AstNode*& back() const { return data[count - 1]; }
+
+        AstNode** begin() const { return data; }
+        AstNode** end() const { return data + count; }
+    };
+
+    class AstContext;
+
     /**
      * 语法树节点。
+     * 
+     * 节点及其孩子列表由 AstContext 统一分配和释放。
+     * 节点本身只记录符号 id 和 token 下标，符号和 token 的内容
+     * 保存在 AstContext 共享的符号表和 token 列表内，通过访问函数获取。
      */
     struct AstNode {
 
+        /**
+         * 节点所属的上下文。
+         */
+        AstContext* context = nullptr;
+
         /**
          * 上级节点。
          */
@@ -33,35 +67,39 @@ namespace tc {
         /**
          * 子节点。
          */
-        std::vector< AstNode* > children;
+        AstNodeChildren children;
 
         /**
-         * 符号。
+         * 符号 id。对应上下文符号表的下标。
          */
-        grammar::Symbol symbol;
+        int32_t symbolId = -1;
 
         /**
-         * 符号类型。
+         * 终结符在 token 列表内的下标。
+         * 非终结符记录子树内第一个 token 的下标，子树为空时为 -1。
+         * 
+         * 增量分析后，下标需经 AstContext::toRealTokenIdx 映射。
          */
-        grammar::SymbolType& symbolType = symbol.type;
+        int32_t tokenIdx = -1;
 
-        TokenKind& tokenKind = symbol.tokenKind;
-        SymbolKind& symbolKind = symbol.symbolKind;
+        /**
+         * 符号。
+         */
+        const grammar::Symbol& symbol() const;
 
         /**
-         * 终结符。仅当符号为终结符时可用。
+         * 符号类型。
          */
-        Token token;
+        grammar::SymbolType symbolType() const { return symbol().type; }
+
+        TokenKind tokenKind() const { return symbol().tokenKind; }
+        SymbolKind symbolKind() const { return symbol().symbolKind; }
 
-        
-        ~AstNode();
-        
         /**
-         * 释放所有孩子结点的内存。递归释放。
+         * 终结符。仅当符号为终结符时有意义。非终结符会得到一个空 token。
          */
-        void freeChildren();
+        const Token& token() const;
         
     };
 
 }
-
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    编译后的文法。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+#include <core/CompiledGrammar.h>
+
+using namespace std;
+using namespace tc;
+using namespace tc::grammar;
+
+CompiledGrammar::CompiledGrammar(
+    const vector< Symbol >& symbols,
+    const vector< FlatExpression >& flatExpressions
+) {
+
+    /* 符号。 */
+
+    int symbolCount = symbols.size();
+
+    terminalFlags.resize(symbolCount);
+    nameOffsets.reserve(symbolCount + 1);
+
+    size_t nameBytes = 0;
+    for (auto& symbol : symbols) {
+        nameBytes += symbol.name.size();
+    }
+
+    names.reserve(nameBytes);
+
+    for (int symbolId = 0; symbolId < symbolCount; symbolId++) {
+        auto& symbol = symbols[symbolId];
+        terminalFlags[symbolId] = symbol.type == SymbolType::TERMINAL;
+
+        nameOffsets.push_back(names.size());
+        names += symbol.name;
+    }
+
+    nameOffsets.push_back(names.size());
+
+    /* 产生式。 */
+
+    int expressionCount = flatExpressions.size();
+
+    size_t rhsSize = 0;
+    for (auto& expression : flatExpressions) {
+        rhsSize += expression.rule.size();
+    }
+
+    expressions.reserve(expressionCount);
+    rhsSymbols.reserve(rhsSize);
+    lhsOffsets.assign(symbolCount + 1, 0);
+
+    for (auto& expression : flatExpressions) {
+        auto& entry = expressions.emplace_back();
+        entry.lhs = expression.targetSymbolId;
+        entry.rhsBegin = rhsSymbols.size();
+        entry.rhsLength = expression.rule.size();
+        entry.precedence = expression.precedence;
+
+        rhsSymbols.insert(rhsSymbols.end(), expression.rule.begin(), expression.rule.end());
+
+        lhsOffsets[entry.lhs + 1]++;
+    }
+
+    /* 按左部分组。计数排序，组内保持 id 升序。 */
+
+    for (int symbolId = 0; symbolId < symbolCount; symbolId++) {
+        lhsOffsets[symbolId + 1] += lhsOffsets[symbolId];
+    }
+
+    lhsExpressionIds.resize(expressionCount);
+    vector< int > fillPos(lhsOffsets.begin(), lhsOffsets.end() - 1);
+
+    for (int expressionId = 0; expressionId < expressionCount; expressionId++) {
+        lhsExpressionIds[fillPos[expressions[expressionId].lhs]++] = expressionId;
+    }
+
+}
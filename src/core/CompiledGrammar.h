@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    编译后的文法。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+/*
+
+  存储方式
+
+    grammar::Grammar 与 FlatExpression 便于构造和修改，但每条产生式的右部
+    都是单独分配的 vector，符号名称也各自持有字符串。构建分析表求闭包、
+    分析器归约时，需要在这些分散的内存之间跳转。
+
+    CompiledGrammar 把同样的内容整理成只读的紧凑数组（CSR 形式）：
+
+      expressions    每条产生式一项：左部 id、右部起点、右部长度、优先级。
+      rhsSymbols     所有产生式的右部依次首尾相接。
+      lhsExpressions 按左部分组的产生式 id，第 i 个符号的产生式为
+                     lhsExpressionIds[lhsOffsets[i], lhsOffsets[i + 1])。
+      names          所有符号名称存放在同一块缓冲区内。
+
+    符号 id 与产生式 id 保持原样（均为从 0 开始的连续编号）。
+
+    构建一次后以 shared_ptr<const CompiledGrammar> 共享：
+    Lr1Grammar 构建分析表时使用，并随分析表交给 Parser。
+    对象构建后不再修改，可以被多个线程同时读取。
+
+*/
+
+#pragma once
+
+#include <core/Grammar.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tc::grammar {
+
+    class CompiledGrammar {
+    public:
+
+        /**
+         * @param symbols 符号表。符号 id 需要与其下标相同。
+         * @param expressions 产生式列表。产生式 id 即为其下标。
+         */
+        CompiledGrammar(
+            const std::vector< Symbol >& symbols,
+            const std::vector< FlatExpression >& expressions
+        );
+
+        /**
+         * 产生式的紧凑描述。
+         */
+        struct ExpressionEntry {
+
+            /** 左部符号 id。 */
+            int lhs;
+
+            /** 右部在 rhsSymbols 内的起始下标。 */
+            int rhsBegin;
+
+            /** 右部长度。 */
+            int rhsLength;
+
+            /** 产生式优先级。0 表示未声明。 */
+            int precedence;
+        };
+
+    public: // 符号。
+
+        int getSymbolCount() const { return int(terminalFlags.size()); }
+
+        bool isTerminal(int symbolId) const { return terminalFlags[symbolId]; }
+
+        std::string_view getSymbolName(int symbolId) const {
+            return std::string_view(
+                names.data() + nameOffsets[symbolId],
+                nameOffsets[symbolId + 1] - nameOffsets[symbolId]
+            );
+        }
+
+    public: // 产生式。
+
+        int getExpressionCount() const { return int(expressions.size()); }
+
+        const ExpressionEntry& getExpression(int expressionId) const {
+            return expressions[expressionId];
+        }
+
+        int getLhs(int expressionId) const { return expressions[expressionId].lhs; }
+
+        int getRhsLength(int expressionId) const { return expressions[expressionId].rhsLength; }
+
+        /**
+         * 产生式右部。长度见 getRhsLength。
+         */
+        const int* getRhs(int expressionId) const {
+            return rhsSymbols.data() + expressions[expressionId].rhsBegin;
+        }
+
+        int getPrecedence(int expressionId) const { return expressions[expressionId].precedence; }
+
+        /**
+         * 左部为指定符号的产生式 id，按 id 升序排列。数量见 getExpressionCountOf。
+         */
+        const int* getExpressionsOf(int symbolId) const {
+            return lhsExpressionIds.data() + lhsOffsets[symbolId];
+        }
+
+        int getExpressionCountOf(int symbolId) const {
+            return lhsOffsets[symbolId + 1] - lhsOffsets[symbolId];
+        }
+
+    protected:
+
+        std::vector< ExpressionEntry > expressions;
+        std::vector< int > rhsSymbols;
+
+        std::vector< int > lhsOffsets;
+        std::vector< int > lhsExpressionIds;
+
+        /** 以符号 id 为下标。终结符为 1。 */
+        std::vector< char > terminalFlags;
+
+        std::string names;
+        std::vector< int > nameOffsets;
+
+    };
+
+}
@@ -7,6 +7,8 @@
 
 #include "core/Dfa.h"
 
+#include <iomanip>
+
 using namespace std;
 
 /* ------------ 公开方法。 ------------ */
@@ -151,9 +153,36 @@ void Dfa::clear() {
 
 
 const DfaStateNode* Dfa::recognize(istream& inStream) {
+    return profile ? this->recognizeImpl<true>(inStream) : this->recognizeImpl<false>(inStream);
+}
+
+/**
+ * 登记进入的状态。
+ */
+static void __tcProfileVisit(DfaProfile& profile, const DfaStateNode* node) {
+    int id = node->stateInfo.id;
+    profile.stateVisits.add(id);
+
+    if (id >= int(profile.finalStates.size())) {
+        profile.finalStates.resize(id + 1, false);
+    }
+
+    profile.finalStates[id] = node->stateInfo.isFinal;
+}
+
+template <bool profiled>
+const DfaStateNode* Dfa::recognizeImpl(istream& inStream) {
 
     DfaStateNode* currentNode = this->dfaEntry;
 
+    if constexpr (profiled) {
+        profile->recognizeCount++;
+
+        if (currentNode) {
+            __tcProfileVisit(*profile, currentNode);
+        }
+    }
+
     while (currentNode && inStream.good() && !inStream.fail()) {
 
         // 由于流的 unget 和 putback 都很不好用，此处非必要不 get。
@@ -176,6 +205,18 @@ const DfaStateNode* Dfa::recognize(istream& inStream) {
         DfaStateNode* nextNode = currentNode->nextState(ch);
 
         if (nextNode) {
+
+            if constexpr (profiled) {
+                int key = currentNode->stateInfo.id * 128 + ch;
+                profile->transitions.add(key);
+
+                if (key >= int(profile->transitionTargets.size())) {
+                    profile->transitionTargets.resize(key + 1, -1);
+                }
+
+                profile->transitionTargets[key] = nextNode->stateInfo.id;
+                __tcProfileVisit(*profile, nextNode);
+            }
             
             currentNode = nextNode; // 切换到下一状态。
 
@@ -201,4 +242,51 @@ const DfaStateNode* Dfa::recognize(istream& inStream) {
     return currentNode;
 }
 
+/* ------------ 热点统计。 ------------ */
+
+void DfaProfile::clear() {
+    recognizeCount = 0;
+    stateVisits.clear();
+    transitions.clear();
+    transitionTargets.clear();
+    finalStates.clear();
+}
+
+/**
+ * 可打印字符原样输出，其他字符输出编码。
+ */
+static string __tcDescribeChar(int ch) {
+    if (ch > ' ' && ch < 127) {
+        return string("'") + char(ch) + "'";
+    }
+
+    return "#" + to_string(ch);
+}
+
+void DfaProfile::report(ostream& out, int topN) const {
+
+    vector< pair< int, uint64_t > > hot;
+
+    out << "--- lexer dfa profile ---" << endl;
+    out << "recognize calls: " << recognizeCount << endl;
+
+    out << "state visits: " << stateVisits.getTotal() << endl;
+    stateVisits.top(topN, hot);
+    for (auto& it : hot) {
+        bool isFinal = it.first < int(finalStates.size()) && finalStates[it.first];
+        out << "  state " << setw(4) << it.first << (isFinal ? " (final)" : "        ")
+            << " : " << it.second << " (" << tc::HotCounter::formatPercent(it.second, stateVisits.getTotal()) << ")" << endl;
+    }
+
+    out << "transitions: " << transitions.getTotal() << endl;
+    transitions.top(topN, hot);
+    for (auto& it : hot) {
+        out << "  " << setw(4) << it.first / 128 << " --" << setw(4) << __tcDescribeChar(it.first % 128)
+            << " --> " << setw(4) << transitionTargets[it.first]
+            << " : " << it.second << " (" << tc::HotCounter::formatPercent(it.second, transitions.getTotal()) << ")" << endl;
+    }
+
+    out << "--- end of lexer dfa profile ---" << endl;
+}
+
 /* ------------ 私有方法。 ------------ */
@@ -12,6 +12,9 @@
 #include <vector>
 #include <set>
 #include <iostream>
+#include <cstdint>
+
+#include <core/HotCounter.h>
 
 /**
  * DFA 节点信息。
@@ -66,6 +69,37 @@ enum class DfaError {
     WARNING
 };
 
+/**
+ * DFA 热点统计。见 Dfa::setProfile。
+ * 用于找出识别过程中最常经过的状态与转移，以决定优先特化哪些路径。
+ */
+struct DfaProfile {
+
+    /** 调用 recognize 的次数。 */
+    uint64_t recognizeCount = 0;
+
+    /** 各状态被进入的次数（含初态）。键为状态 id。 */
+    tc::HotCounter stateVisits;
+
+    /** 各转移被走过的次数。键为 起点状态 id * 128 + 字符。 */
+    tc::HotCounter transitions;
+
+    /** 转移的目标状态 id。键与 transitions 相同。 */
+    std::vector<int> transitionTargets;
+
+    /** 状态是否为终态。以状态 id 为下标。 */
+    std::vector<char> finalStates;
+
+    void clear();
+
+    /**
+     * 输出最热的状态与转移。
+     * 
+     * @param topN 每一类最多输出的项数。
+     */
+    void report(std::ostream& out, int topN) const;
+};
+
 /**
  * DFA。
  * 使用 tcdf 格式命令构建。
@@ -112,10 +146,25 @@ public:
      */
     const DfaStateNode* recognize(std::istream& inStream);
 
+    /**
+     * 设置热点统计。设置后，recognize 会把经过的状态与转移计入其中。
+     * 未设置时，recognize 使用不含计数代码的版本。
+     * DFA 不会接管统计对象，调用者需保证其生命周期覆盖识别过程。
+     * 
+     * @param profile 统计对象。传入空指针表示停止统计。
+     */
+    void setProfile(DfaProfile* profile) { this->profile = profile; }
+
 protected:
 
     /* ------------ 私有方法。 ------------ */
 
+    /**
+     * 识别语言。profiled 为 true 时计入热点统计。
+     */
+    template <bool profiled>
+    const DfaStateNode* recognizeImpl(std::istream& inStream);
+
 protected:
 
     /* ------------ 私有成员。 ------------ */
@@ -129,6 +178,9 @@ protected:
     /** 自动机进入节点。 */
     DfaStateNode* dfaEntry = nullptr;
 
+    /** 热点统计。可以为空。 */
+    DfaProfile* profile = nullptr;
+
 public:
 
     /* ------------ 对外开放的成员。 ------------ */
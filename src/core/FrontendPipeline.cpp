@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    Frontend Pipeline
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+#include <core/FrontendPipeline.h>
+#include <utils/SpscQueue.h>
+#include <utils/AppendOnlyList.h>
+
+#include <thread>
+
+using namespace std;
+using namespace tc;
+
+int FrontendPipeline::run(
+    istream& in,
+    vector< Token >& tokens,
+    vector< LexerAnalyzeError >& lexerErrors,
+    vector< ParserParseError >& parserErrors
+) {
+
+    /** 词法 -> 语法。空批次表示结束。 */
+    SpscQueue< vector< Token > > tokenQueue(queueCapacity);
+
+    /** 语法 -> IR。空指针表示结束。 */
+    SpscQueue< AstNode* > declarationQueue(queueCapacity);
+
+    /**
+     * IR 线程读取的 token。只追加，已有的 token 不会移动。
+     * 语法线程在提交节点前发布节点用到的 token，IR 线程只读取已发布的部分。
+     */
+    AppendOnlyList< Token > streamTokens;
+
+    irGenerator.clear();
+
+    // 词法线程。
+    thread lexerThread([&] () {
+        lexer.analyze(in, [&tokenQueue] (vector< Token >& batch) {
+            tokenQueue.push(move(batch));
+        }, lexerErrors, tokenBatchSize);
+
+        tokenQueue.push(vector< Token >());
+    });
+
+    // IR 线程。
+    thread irThread([&] () {
+        while (true) {
+            AstNode* node = declarationQueue.pop();
+            if (node == nullptr) {
+                break;
+            }
+
+            irGenerator.processExternalDeclarationIncrementally(node);
+        }
+    });
+
+    // 语法分析在当前线程进行。
+    bool lexerFinished = false;
+
+    const auto fetchTokens = [&] (vector< Token >& tokenList) {
+        if (lexerFinished) {
+            return false;
+        }
+
+        vector< Token > batch = tokenQueue.pop();
+        if (batch.empty()) {
+            lexerFinished = true;
+            return false;
+        }
+
+        // tokenList 只由语法线程使用。IR 线程从 streamTokens 读取同样的内容。
+        streamTokens.append(batch.cbegin(), batch.cend());
+
+        tokenList.insert(
+            tokenList.end(), 
+            make_move_iterator(batch.begin()), make_move_iterator(batch.end())
+        );
+
+        return true;
+    };
+
+    parser.setReduceListener([&] (AstNode* node) {
+        if (node->symbolKind() == SymbolKind::external_declaration) {
+            declarationQueue.push(node);
+        }
+    });
+
+    streamTokens.append(tokens.cbegin(), tokens.cend());
+    parser.setStreamTokens(&streamTokens);
+
+    int errorCount = parser.parse(tokens, fetchTokens, parserErrors);
+
+    parser.setReduceListener(nullptr);
+
+    // 语法分析可能提前结束。取走剩余的 token，让词法线程能够结束。
+    while (!lexerFinished) {
+        if (tokenQueue.pop().empty()) {
+            lexerFinished = true;
+        }
+    }
+
+    declarationQueue.push(nullptr);
+
+    lexerThread.join();
+    irThread.join();
+
+    // streamTokens 即将释放。语法树改回从 tokens 读取。
+    parser.setStreamTokens(nullptr);
+
+    return errorCount;
+}
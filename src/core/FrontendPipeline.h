@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    Frontend Pipeline
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+/*
+
+  前端流水线
+
+    默认情况下，词法分析、语法分析、IR 生成依次执行：
+    前一阶段完全结束后，后一阶段才开始。
+
+    流水线模式下，三个阶段分别运行在三个线程上，通过有界无锁队列
+    （utils/SpscQueue.h）连接：
+
+      词法线程 --(token 批次)--> 语法线程 --(external_declaration)--> IR 线程
+
+    词法分析器每识别出一批 token 就交给语法分析器。
+    语法分析器每归约出一个 external_declaration（函数定义或全局声明），
+    就将其交给 IR 生成器，自己继续分析后续内容。
+
+    语法树节点通过下标引用 token 列表。语法线程向 token 列表追加时，列表可能扩容，
+    IR 线程不能同时读取它。因此 token 会另外追加到一个只追加列表
+    （utils/AppendOnlyList.h），IR 线程通过它读取。该列表分块存储，
+    已有元素不会移动；新 token 写好后才发布长度，IR 线程只读取已发布的部分。
+
+*/
+
+#pragma once
+
+#include <core/Lexer.h>
+#include <core/Parser.h>
+#include <core/tcir/IrGenerator.h>
+
+#include <iostream>
+#include <vector>
+
+namespace tc {
+
+    /**
+     * 前端流水线。并行执行词法分析、语法分析和 IR 生成。
+     */
+    class FrontendPipeline {
+    public:
+
+        /**
+         * @param lexer 词法分析器。需要已经准备好 dfa。
+         * @param parser 语法分析器。需要已经加载分析表。
+         * @param irGenerator IR 生成器。
+         */
+        FrontendPipeline(
+            Lexer& lexer, 
+            Parser& parser, 
+            tcir::IrGenerator& irGenerator
+        ) : lexer(lexer), parser(parser), irGenerator(irGenerator) {}
+
+        /**
+         * 运行流水线。
+         * 
+         * 存在词法错误或语法错误时，IR 生成器内的结果不完整，不应使用。
+         * 
+         * @param in 源码输入流。
+         * @param tokens 存储词法分析结果。语法树引用其中的 token。
+         * @param lexerErrors 词法错误列表。
+         * @param parserErrors 语法错误列表。
+         * @return 语法错误数量。
+         */
+        int run(
+            std::istream& in,
+            std::vector< Token >& tokens,
+            std::vector< LexerAnalyzeError >& lexerErrors,
+            std::vector< ParserParseError >& parserErrors
+        );
+
+        /**
+         * 每批 token 的数量。
+         */
+        size_t tokenBatchSize = 1024;
+
+        /**
+         * 队列容量。
+         */
+        size_t queueCapacity = 64;
+
+    protected:
+        Lexer& lexer;
+        Parser& parser;
+        tcir::IrGenerator& irGenerator;
+
+    private:
+        FrontendPipeline(const FrontendPipeline&) = delete;
+    };
+
+}
@@ -29,6 +29,20 @@ namespace tc::grammar {
 
     };
 
+    /**
+     * 终结符的结合性。由 %left, %right, %nonassoc 声明。
+     */
+    enum class Associativity {
+        
+        /** 未声明。 */
+        UNDEFINED,
+
+        LEFT,
+        RIGHT,
+        NONASSOC,
+
+    };
+
     /**
      * 文法符号。
      */
@@ -53,6 +67,15 @@ namespace tc::grammar {
         /** 符号类型。仅对 非终结符 有效。 */
         SymbolKind symbolKind;
 
+        /** 
+         * 优先级。仅对 终结符 有效。数值越大，结合越紧密。
+         * 0 表示未声明。
+         */
+        int precedence = 0;
+
+        /** 结合性。仅对 终结符 有效。 */
+        Associativity associativity = Associativity::UNDEFINED;
+
         bool operator == (const Symbol& symbol) const {
             if (id >= 0 && id == symbol.id) {
                 return true;
@@ -95,6 +118,13 @@ namespace tc::grammar {
          */
         std::vector< std::vector<int> > rules;
 
+        /**
+         * 各产生式由 %prec 指定的优先级。与 rules 一一对应。
+         * 0 表示未指定，此时取产生式内最后一个终结符的优先级。
+         * 可以为空，表示全部未指定。
+         */
+        std::vector<int> rulePrecedences;
+
         /**
          * 
          * todo: 本实现不严谨。
@@ -124,6 +154,12 @@ namespace tc::grammar {
 
         std::vector< int > rule;
 
+        /**
+         * 产生式优先级。用于解决移进-归约冲突。0 表示未声明。
+         * 仅在构建分析表时使用，不保存到 tcpt 文件。
+         */
+        int precedence = 0;
+
         bool operator == (const FlatExpression& flatExpression) const;
         bool operator != (const FlatExpression& flatExpression) const;
         bool isSameWith(const FlatExpression& flatExpression) const;
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    热点计数器。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+#include <core/HotCounter.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+using namespace tc;
+
+void HotCounter::top(int n, vector< pair< int, uint64_t > >& result) const {
+
+    result.clear();
+
+    for (int key = 0; key < int(counts.size()); key++) {
+        if (counts[key] != 0) {
+            result.emplace_back(key, counts[key]);
+        }
+    }
+
+    auto hotter = [] (const pair< int, uint64_t >& a, const pair< int, uint64_t >& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    };
+
+    if (n >= 0 && size_t(n) < result.size()) {
+        partial_sort(result.begin(), result.begin() + n, result.end(), hotter);
+        result.resize(n);
+    } else {
+        sort(result.begin(), result.end(), hotter);
+    }
+}
+
+string HotCounter::formatPercent(uint64_t count, uint64_t total) {
+    stringstream ss;
+    ss << fixed << setprecision(2) << (total ? 100.0 * count / total : 0.0) << "%";
+    return ss.str();
+}
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    热点计数器。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+/*
+
+  用途
+
+    词法分析与语法分析的热点统计（见 Dfa::setProfile 与 Parser::setProfile）
+    使用它记录各状态、各产生式被访问的次数，并在分析结束后取出最热的若干项。
+
+    键是较小的非负整数（状态 id、产生式 id 等），计数直接存放在以键为下标的
+    数组内，计数一次只是一次加法。
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tc {
+
+    /**
+     * 热点计数器。按非负整数键计数。
+     */
+    class HotCounter {
+    public:
+
+        void add(int key) {
+            if (key >= int(counts.size())) {
+                counts.resize(key + 1, 0);
+            }
+
+            counts[key]++;
+            total++;
+        }
+
+        uint64_t getCount(int key) const {
+            return key >= 0 && key < int(counts.size()) ? counts[key] : 0;
+        }
+
+        uint64_t getTotal() const { return total; }
+
+        /**
+         * 取出计数最多的若干项。按计数降序排列，计数相同时键小的在前。
+         * 
+         * @param n 最多取出的项数。
+         * @param result 存放结果：键与计数。原有内容会被替换。
+         */
+        void top(int n, std::vector< std::pair< int, uint64_t > >& result) const;
+
+        void clear() {
+            counts.clear();
+            total = 0;
+        }
+
+        /**
+         * 格式化占比，保留两位小数，如 "12.50%"。用于统计报告。
+         * 
+         * @param count 计数。
+         * @param total 总数。为 0 时得到 "0.00%"。
+         */
+        static std::string formatPercent(uint64_t count, uint64_t total);
+
+    protected:
+
+        std::vector< uint64_t > counts;
+        uint64_t total = 0;
+
+    };
+
+}
@@ -11,103 +11,55 @@
 
 #include <core/Intel386AssemblyGenerator.h>
 #include <core/tcir/IrContainer.h>
+#include <core/tcir/IrTextReader.h>
+#include <core/tcir/IrSsa.h>
 
 #include <utils/ConsoleColorPad.h>
 
-#include <functional>
+#include <iterator>
 #include <cstdint>
 
 using namespace std;
 using namespace tc;
 
+using tcir::IrInstruction;
+using tcir::IrOpcode;
+using tcir::IrOperand;
+using tcir::IrOperandKind;
+
 namespace tc::i386 {
 
 /**
- * 处理 tcir 的 extlink 区段。
- * extlink 与后续代码生成过程都是分离的。不需要返回解析的结果。
- * 
- * @param in 输入流。
- * @param out 汇编代码输出流。
- * @param err 错误信息输出流。
+ * 输出一个 4 字节的全局整数变量。
  */
-static void __processExtLink(
-    istream& in,
-    ostream& out,
-    ostream& err
-) {
-    string token;
-    
-    while (true) {
-        in >> token;
-        if (token == "@") {
-            in >> token >> token >> token;
-            break;
-        } else if (token == "export") {
-            // export ${symbol} ${"fun" | "var"}
+static void __writeStaticInt(ostream& out, const string& valName, uint64_t iValue) {
 
-            string type;
-            in >> token >> type;
+    out << "align 4" << endl;
+    out << valName << ":" << endl;
 
-            out << "global " << token << endl;
+    int iLen = 32 / 8; // 硬编码。强制 4 字节。
 
-        } else if (token == "import") {
-            // import ${symbol}
-            in >> token;
-            out << "extern " << token << endl;
+    out << "  db ";
+    while (iLen--) {
+        out << (iValue % 0xFF);
+        if (iLen) {
+            out << ", ";
         }
+        iValue >>= 8;
     }
+    out << endl;
 }
 
-static bool __extractInstructionCodeFromStream(
-    istream& in,
-    tcir::IrInstructionCode& container
-) {
-
-    const auto isNewLine = [] (int ch) {
-        return ch == '\r' || ch == '\n';
-    };
-
-    const auto isSpaceOrTab = [] (int ch) {
-        return ch == ' ' || ch == '\t';
-    };
-
-    const auto isBlank = [&isNewLine, &isSpaceOrTab] (int ch) {
-        return isSpaceOrTab(ch) || isNewLine(ch);
-    };
-
-    // 过滤前置空白字符（含换行）。
-    while (isBlank(in.peek())) {
-        in.get();
-    }
-
-    while (true) {
-
-        // 过滤前置空白字符。
-        while (isSpaceOrTab(in.peek())) {
-            in.get();
-        }
-
-        if (in.peek() == '@') {
-            return false; // 到 instruction 的结尾了。
-        } else if (isNewLine(in.peek())) {
-            // 要换行了。
-            break;
-        }
-
-        string token;
-        while (!isBlank(in.peek())) {
-            token.push_back(in.get());
-        }
-        container.push_back(token);
-    }
-
-    return true;
+static void __writeFileHeader(ostream& out) {
+    out << "; generated by ToyCompile" << endl;
+    out << "; for intel 386 protected mode environment" << endl;
+    out << endl;
+    out << "[bits 32]" << endl;
+    out << "section .text" << endl << endl;
 }
 
-
-
 static void __optimizeInstructions(
-    vector<tcir::IrInstructionCode>& instructions
+    vector<IrInstruction>& instructions
 ) {
     for (size_t idx = 0; idx < instructions.size(); idx++) {
         auto& curr = instructions[idx];
@@ -165,7 +117,7 @@ static void __optimizeInstructions(
                     && nextNext.isPopVreg1() 
                     && next.isMovToVreg0()
                 ) {
-                    curr = "mov vreg 1 vreg 0";
+                    curr = IrInstruction(IrOpcode::mov, IrOperand::vreg(1), IrOperand::vreg(0));
                     instructions.erase(instructions.begin() + idx + 2);
                     idx --;
                     continue;
@@ -176,416 +128,528 @@ static void __optimizeInstructions(
     }
 }
 
-static void __extractInstructionsFromStream(
-    istream& in,
-    vector<tcir::IrInstructionCode>& container
+void Intel386AssemblyGenerator::buildAssemblyFile(
+    vector<IrInstruction>& instructions,
+    ostream& out,
+    ostream& err
 ) {
 
-    tcir::IrInstructionCode code;
-    while (__extractInstructionCodeFromStream(in, code)) {
-        container.push_back(code);
-        code.clear();
-    }
+    vector<IrInstruction> function;
+    size_t functionBegin = 0;
 
-    // 删去 instruction 区段的结尾符号。
-    string token;
-    in >> token >> token >> token >> token;
+    for (size_t idx = 0; idx < instructions.size(); idx++) {
+        auto& code = instructions[idx];
 
-}
+        // 进入函数时，为整个函数分配寄存器。
+        if (code.isFunLabel()) {
+            size_t end = idx + 1;
+            while (end < instructions.size() && !instructions[end].isFunLabel()) {
+                end++;
+            }
 
-void Intel386AssemblyGenerator::processInstructionsSection(
-    istream& in,
-    ostream& out,
-    ostream& err
-) {
-    string token;
+            function.assign(instructions.begin() + idx, instructions.begin() + end);
+            allocator.allocate(function, registerAllocationEnabled);
+            functionBegin = idx;
+        }
 
-    vector<tcir::IrInstructionCode> instructions;
-    __extractInstructionsFromStream(in, instructions);
-    __optimizeInstructions(instructions);
+        this->currentPosition = int(idx - functionBegin);
+        if (allocator.isDeadInstruction(currentPosition)) {
+            continue;
+        }
 
-    buildAssemblyFile(instructions, out, err);
+        parseCode(code, out, err);
+    }
 
 }
 
-void Intel386AssemblyGenerator::processStaticData(istream& in, ostream& out) {
+void Intel386AssemblyGenerator::parseVariable(
+    const IrOperand& operand, ostream& out
+) {
 
-    string token;
-    while (true) {
-        in >> token;
-        if (token == "@") {
-            in >> token >> token >> token;
+    switch (operand.kind) {
+
+        case IrOperandKind::imm: { // 立即数
+            out << operand.value;
             break;
         }
 
-        if (token == "int") {
-            string access, valName, len, value;
-            in >> access >> valName >> len >> value;
-            out << "align 4" << endl;
-            out << valName << ":" << endl;
-
-            int iLen = 32 / 8; // 硬编码。强制 4 字节。
-            uint64_t iValue = stoull(value);
+        case IrOperandKind::global: { // 全局变量
+            out << "[" << names->getName(operand.value) << "]";
+            break;
+        }
 
-            out << "  db ";
-            while (iLen--) {
-                out << (iValue % 0xFF);
-                if (iLen) {
-                    out << ", ";
-                }
-                iValue >>= 8;
+        case IrOperandKind::local: // 局部变量
+        case IrOperandKind::param: // 函数参数
+        case IrOperandKind::vreg: { // 虚拟寄存器
+
+            // 位置由寄存器分配决定。栈上的值相对 ebp 寻址，不受函数内压栈的影响。
+            auto location = allocator.getLocation(operand);
+            if (location.isRegister()) {
+                out << Intel386RegisterAllocator::getName(location.reg);
+            } else if (location.offset < 0) {
+                out << "[ebp - " << -location.offset << "]";
+            } else {
+                out << "[ebp + " << location.offset << "]";
             }
-            out << endl;
 
+            break;
+        }
+
+        default: {
+            break;
         }
     }
 
 }
 
-void Intel386AssemblyGenerator::buildAssemblyFile(
-    vector<tcir::IrInstructionCode>& instructions,
-    ostream& out,
-    ostream& err
-) {
-
-    for (auto& code : instructions) {
-        parseCode(code, out, err);
+void Intel386AssemblyGenerator::parseLabel(const IrOperand& operand, ostream& out) {
+    if (operand.labelKind == tcir::IrLabelKind::named) {
+        out << names->getName(operand.value);
+    } else {
+        out << tcir::IrCodeUtils::getLabelPrefix(operand.labelKind) << operand.value;
     }
-
 }
 
-void Intel386AssemblyGenerator::parseVariable(
-    string& type, string& name, ostream& out
-) {
+bool Intel386AssemblyGenerator::isMemoryOperand(const IrOperand& operand) const {
+    switch (operand.kind) {
+        case IrOperandKind::global: {
+            return true;
+        }
 
-    if (type == "imm") { // 立即数
+        case IrOperandKind::local:
+        case IrOperandKind::param:
+        case IrOperandKind::vreg: {
+            return !allocator.getLocation(operand).isRegister();
+        }
 
-        out << name;
+        default: {
+            return false;
+        }
+    }
+}
 
-    } else if (type == "val") { // 变量
+void Intel386AssemblyGenerator::parseBinary(
+    const IrInstruction& code, const char* mnemonic, ostream& out
+) {
 
-        int valId = -1;
-        try {
-            valId = stoi(name);
-        } catch (...) {}
+    auto& dst = code.operands[0];
+    auto& src = code.operands[1];
 
+    bool isMul = code.opcode == IrOpcode::mul;
+    bool isXchg = code.opcode == IrOpcode::xchg;
 
-        if (valId == -1) {
-            // 全局变量
-            out << "[" << name << "]";
-        } else {
-            // 局部变量
+    if (!isMemoryOperand(dst) || (!isMemoryOperand(src) && !isMul)) {
+        out << "  " << mnemonic << " ";
+        parseVariable(dst, out);
+        out << ", ";
+        parseVariable(src, out);
+        out << endl;
+        return;
+    }
 
-            // 进入函数时，已经预先分配栈空间（add esp, x）。
-            // 因此，栈内存位置应该比 esp 的值大。
+    // 没有空闲的寄存器时，临时压栈保存一个。值都相对 ebp 寻址，压栈不影响操作数。
+    auto scratch = allocator.findScratchRegister(currentPosition, code);
+    bool borrowed = scratch == Intel386Register::none;
+    if (borrowed) {
+        bool srcInEcx = allocator.getLocation(src).reg == Intel386Register::ecx
+            && src.kind != IrOperandKind::imm && src.kind != IrOperandKind::global;
 
-            auto offset = this->variableStackOffsetMap[valId] - 4;
-            out << "[ebp ";
-            if (offset > 0) {
-                out << "+ ";
-                out << offset;
-            } else if (offset == 0) {
-                // do nothing
-            } else { // offset < 0
-                
-                out << offset;
-            }
-            out << "]";
-        }
+        scratch = srcInEcx ? Intel386Register::ebx : Intel386Register::ecx;
+        out << "  push " << Intel386RegisterAllocator::getName(scratch) << endl;
+    }
 
-    } else if (type == "vreg") { // 虚拟寄存器
+    auto scratchName = Intel386RegisterAllocator::getName(scratch);
 
-        if (name == "0") {
-            out << "eax";
-        } else if (name == "1") {
-            out << "edx";
-        }
+    if (isMul || isXchg) {
+        // 在寄存器内运算，再写回。
+        out << "  mov dword " << scratchName << ", ";
+        parseVariable(dst, out);
+        out << endl;
 
-    } else if (type == "fval") { // 函数参数
+        out << "  " << mnemonic << " " << scratchName << ", ";
+        parseVariable(src, out);
+        out << endl;
 
-        auto symIdx = this->currentFunction->findParamSymbolIndex(name);
-        
-        out << "[ebp + ";
-        out << symIdx * 4 + 8;
-        out << "]";
+        out << "  mov dword ";
+        parseVariable(dst, out);
+        out << ", " << scratchName << endl;
+    } else {
+        out << "  mov dword " << scratchName << ", ";
+        parseVariable(src, out);
+        out << endl;
 
+        out << "  " << mnemonic << " ";
+        parseVariable(dst, out);
+        out << ", " << scratchName << endl;
     }
 
+    if (borrowed) {
+        out << "  pop " << scratchName << endl;
+    }
 }
 
 void Intel386AssemblyGenerator::parseCode(
-    tcir::IrInstructionCode& code,
+    const IrInstruction& code,
     ostream& out, 
     ostream& err
 ) {
 
-    if (code.isRet()) {
-        
-        out << "  leave" << endl
-            << "  ret" << endl << endl;
+    /**
+     * 输出双操作数指令。
+     */
+    auto binary = [this, &code, &out] (const char* mnemonic) {
+        parseBinary(code, mnemonic, out);
+    };
+
+    /**
+     * 输出跳转指令。
+     */
+    auto jump = [this, &code, &out] (const char* mnemonic) {
+        out << "  " << mnemonic << " ";
+        parseLabel(code.operands[0], out);
+        out << endl;
+    };
 
-    } else if (code.isLabel()) {
+    switch (code.opcode) {
 
-        out << code[1] << ":" << endl;
+        case IrOpcode::ret: {
+            if (code.isRet()) {
+                for (auto& [reg, offset] : allocator.getSavedRegisters()) {
+                    out << "  mov dword " << Intel386RegisterAllocator::getName(reg)
+                        << ", [ebp - " << -offset << "]" << endl;
+                }
 
-    } else if (code.isCall()) {
+                out << "  leave" << endl
+                    << "  ret" << endl << endl;
+            }
 
-        out << "  call " << code[1] << endl;
-        
-        auto& funcParamList = globalSymTab.getFunction(code[1])->params;
-        int restoreStackSize = 0;
-        for (auto& it : funcParamList) {
-            
-            restoreStackSize += tcir::ValueTypeUtils::getBytes(it.valueType);
+            break;
         }
 
-        if (restoreStackSize) {
-            out << "  add esp, " << restoreStackSize << endl;
+        case IrOpcode::label: {
+            parseLabel(code.operands[0], out);
+            out << ":" << endl;
+            break;
         }
-        
-
-    } else if (code.isPushForCall()) {
-
-        out << "  push ";
-        this->parseVariable(code[2], code[3], out);
 
-        out << endl;
+        case IrOpcode::call: {
+            auto& funName = names->getName(code.operands[0].value);
 
-    } else if (code.isFunLabel()) {
+            out << "  call " << funName << endl;
+            
+            auto& funcParamList = globalTable->getFunction(funName)->params;
+            int restoreStackSize = 0;
+            for (auto& it : funcParamList) {
+                
+                restoreStackSize += tcir::ValueTypeUtils::getBytes(it.valueType);
+            }
 
-        auto& funName = code[1];
+            if (restoreStackSize) {
+                out << "  add esp, " << restoreStackSize << endl;
+            }
+            
+            break;
+        }
 
-        out << endl;
-        out << funName << ":" << endl;
+        case IrOpcode::pushfc:
+        case IrOpcode::push: {
+            out << "  push ";
+            if (isMemoryOperand(code.operands[1])) {
+                out << "dword ";
+            }
 
-        out << "  push ebp" << endl;
-        out << "  mov ebp, esp" << endl;
-        
-        auto pFun = globalSymTab.getFunction(funName);
+            this->parseVariable(code.operands[1], out);
+            out << endl;
+            break;
+        }
 
-        this->currentFunction = pFun;
+        case IrOpcode::funLabel: {
+            auto& funName = names->getName(code.operands[0].value);
 
-        auto funSymTab = this->blockSymTabMap[pFun->rootSymTabId];
+            out << endl;
+            out << funName << ":" << endl;
 
-        const std::function<
-            int (tcir::BlockSymbolTable*)
-        > dfs = [&] (tcir::BlockSymbolTable* currTab) {
+            out << "  push ebp" << endl;
+            out << "  mov ebp, esp" << endl;
+            
+            auto pFun = globalTable->getFunction(funName);
 
-            int res = 0;
+            this->currentFunction = pFun;
 
-            for (auto it : currTab->children) {
-                res = max(res, dfs(it));
+            if (allocator.getFrameSize()) {
+                out << "  sub esp, " << allocator.getFrameSize() << endl;
             }
 
-            res += currTab->symbols.size() * 4;
-
-            return res;
-        };
+            for (auto& [reg, offset] : allocator.getSavedRegisters()) {
+                out << "  mov dword [ebp - " << -offset << "], "
+                    << Intel386RegisterAllocator::getName(reg) << endl;
+            }
 
-        this->currFunctionStackMemory = dfs(funSymTab);
+            for (auto& [reg, offset] : allocator.getParamLoads()) {
+                out << "  mov dword " << Intel386RegisterAllocator::getName(reg)
+                    << ", [ebp + " << offset << "]" << endl;
+            }
 
-        if (this->currFunctionStackMemory) {
-            out << "  sub esp, " << this->currFunctionStackMemory << endl;
+            break;
         }
 
-    } else if (code[0] == "xchg") {
-        out << "  xchg ";
-        parseVariable(code[1], code[2], out);
-        out << ", ";
-        parseVariable(code[3], code[4], out);
-        out << endl;
-    
-    } else if (code[0] == "jmp") {
-
-        out << "  jmp " << code[1] << endl;
-
-    } else if (code[0] == "jge") {
-
-        out << "  jge " << code[1] << endl;
-
-    } else if (code[0] == "jg") {
+        case IrOpcode::xchg: binary("xchg"); break;
+
+        case IrOpcode::jmp: jump("jmp"); break;
+        case IrOpcode::jge: jump("jge"); break;
+        case IrOpcode::jg: jump("jg"); break;
+        case IrOpcode::je: jump("je"); break;
+        case IrOpcode::jl: jump("jl"); break;
+        case IrOpcode::jle: jump("jle"); break;
+        case IrOpcode::jne: jump("jne "); break;
+
+        case IrOpcode::pop: {
+            out << "  pop ";
+            if (code.operandCount > 1) {
+                if (isMemoryOperand(code.operands[1])) {
+                    out << "dword ";
+                }
 
-        out << "  jg " << code[1] << endl;
+                this->parseVariable(code.operands[1], out);
+            }
+            out << endl;
+            break;
+        }
 
-    } else if (code[0] == "je") {
+        case IrOpcode::mov: binary("mov dword"); break;
+        case IrOpcode::add: binary("add dword"); break;
+        case IrOpcode::sub: binary("sub dword"); break;
+        case IrOpcode::mul: binary("imul dword"); break;
+        case IrOpcode::cmp: binary("cmp dword"); break;
+
+        case IrOpcode::neg:
+        case IrOpcode::bitAnd:
+        case IrOpcode::bitOr:
+        case IrOpcode::bitXor:
+        case IrOpcode::bitNot: {
+            // todo
+            break;
+        }
 
-        out << "  je " << code[1] << endl;
+        default: {
+            break;
+        }
+    }
 
-    } else if (code[0] == "jl") {
+    // todo
 
-        out << "  jl " << code[1] << endl;
+}
 
-    } else if (code[0] == "jle") {
+int Intel386AssemblyGenerator::generate(
+    istream& in,
+    ostream& out,
+    ostream& err
+) {
 
-        out << "  jle " << code[1] << endl;
+    string data { istreambuf_iterator<char>(in), istreambuf_iterator<char>() };
+    return this->generate(data.data(), data.size(), out, err);
 
-    } else if (code[0] == "jne") {
+}
 
-        out << "  jne  " << code[1] << endl;
+int Intel386AssemblyGenerator::generate(
+    const char* data,
+    size_t size,
+    ostream& out,
+    ostream& err
+) {
 
-    } else if (code[0] == "push") {
-        out << "  push ";
-        this->parseVariable(code[2], code[3], out);
-        out << endl;
-    } else if (code[0] == "pop") {
-        out << "  pop ";
-        if (code.size() > 2) {
-            this->parseVariable(code[2], code[3], out);
-        }
-        out << endl;
-    } else if (code.isMov()) { 
+    tcir::IrTextReader reader;
+    int resCode = reader.read(data, size, err);
 
-        out << "  mov dword ";
-        
-        parseVariable(code[1], code[2], out);
-        out << ", ";
-        parseVariable(code[3], code[4], out);
-        out << endl;
+    // 无法解析的指令已经报告，跳过它们继续生成。
+    if (resCode == 1 || resCode == 2) {
+        err << "[err] bad tcir." << endl;
+        return -1;
+    }
 
-    } else if (code[0] == "add") {
+    // 读取器需要在生成结束前保持有效。
+    return this->generate(reader.getModule(), out, err);
 
-        out << "  add dword ";
-        parseVariable(code[1], code[2], out);
-        out << ", ";
-        parseVariable(code[3], code[4], out);
-        out << endl;
+}
 
-    } else if (code[0] == "sub") {
+int Intel386AssemblyGenerator::generate(
+    const tcir::IrModule& module,
+    ostream& out,
+    ostream& err
+) {
 
-        out << "  sub dword ";
-        parseVariable(code[1], code[2], out);
-        out << ", ";
-        parseVariable(code[3], code[4], out);
-        out << endl;
+    this->clear();
 
-    } else if (code[0] == "neg") {
-        // todo
-    } else if (code[0] == "mul") {
+    this->globalTable = module.globalSymbolTable;
+    this->names = module.names;
 
-        out << "  imul dword ";
-        parseVariable(code[1], code[2], out);
-        out << ", ";
-        parseVariable(code[3], code[4], out);
-        out << endl;
+    /* 块符号表。父子关系已由生成器建立。 */
+    for (auto symbolTab : *module.blockSymbolTables) {
+        this->blockSymTabMap[symbolTab->id] = symbolTab;
+    }
 
-    } else if (code[0] == "and") {
-        // todo
-    } else if (code[0] == "or") {
-        // todo
-    } else if (code[0] == "xor") {
-        // todo
-    } else if (code[0] == "not") {
-        // todo
-    } else if (code[0] == "cmp") {
-
-        out << "  cmp dword ";
-        parseVariable(code[1], code[2], out);
-        out << ", ";
-        parseVariable(code[3], code[4], out);
-        out << endl;
+    /* 指令。优化会修改指令序列，因此复制一份。 */
+    vector<IrInstruction> instructions = *module.instructions;
 
-    } 
+    this->generateFromSymbolTables(instructions, out, err);
 
-    // todo
+    return 0;
 
 }
 
-void Intel386AssemblyGenerator::buildVariableOffsetMap() {
+int Intel386AssemblyGenerator::generate(
+    const tcir::IrBinaryModule& module,
+    ostream& out,
+    ostream& err
+) {
 
-    /**
-     * 深度优先搜索，为每个局部变量分配一个偏移。
-     */
-    std::function<
-        void (tcir::BlockSymbolTable*, int)
-    > dfs = [&] (tcir::BlockSymbolTable* curr, int memoryUsed) {
+    this->clear();
 
-        for (auto it : curr->symbols) {
-            this->variableStackOffsetMap[it->id] = memoryUsed;
-            memoryUsed += 4; // todo: should be it->bytes;
-        }
+    // 名称 id 按顺序登记，与文件内的名称表一致。
+    for (uint32_t idx = 0; idx < module.getNameCount(); idx++) {
+        irNames.intern(string(module.getName(idx)));
+    }
 
-        for (auto it : curr->children) {
-            dfs(it, memoryUsed);
+    /* 全局符号表。 */
+    for (auto& record : module.getFunctions()) {
+        auto fun = new tcir::FunctionSymbol;
+        fun->symbolType = tcir::SymbolType::functionDefine;
+        fun->visibility = tcir::SymbolVisibility(record.visibility);
+        fun->name = irNames.getName(record.nameId);
+        fun->returnType = tcir::ValueType(record.returnType);
+        fun->isImported = record.isImported;
+        fun->rootSymTabId = record.rootSymTabId;
+
+        for (uint32_t idx = 0; idx < record.paramCount; idx++) {
+            auto& paramRecord = module.getParams()[record.paramBegin + idx];
+
+            tcir::FunctionParamSymbol param;
+            param.symbolType = tcir::SymbolType::functionParam;
+            param.visibility = tcir::SymbolVisibility::internal;
+            param.name = irNames.getName(paramRecord.nameId);
+            param.valueType = tcir::ValueType(paramRecord.valueType);
+            param.isPointer = paramRecord.isPointer;
+            param.isVaList = paramRecord.isVaList;
+            fun->params.push_back(param);
         }
-    
-    };
 
-    for (auto& it : this->blockSymTabMap) {
-        if (it.second == it.second->parent) {
-            dfs(it.second, 0);
-        }
+        globalSymTab.put(fun);
     }
 
-}
+    for (auto& record : module.getVariables()) {
+        auto var = new tcir::VariableSymbol;
+        var->symbolType = tcir::SymbolType::variableDefine;
+        var->visibility = tcir::SymbolVisibility(record.visibility);
+        var->name = irNames.getName(record.nameId);
+        var->id = -1;
+        var->bytes = record.bytes;
+        var->valueType = tcir::ValueType(record.valueType);
+        globalSymTab.put(var);
+    }
 
+    for (auto& record : module.getStaticData()) {
+        auto var = globalSymTab.getVariable(irNames.getName(record.nameId));
+        if (var) {
+            var->initValue = record.initValue;
+        }
+    }
 
-int Intel386AssemblyGenerator::generate(
-    istream& in,
-    ostream& out,
-    ostream& err
-) {
+    /* 块符号表。 */
+    for (auto& record : module.getBlockTables()) {
+        auto symbolTab = this->ownedBlockSymTabs.emplace_back(
+            make_unique<tcir::BlockSymbolTable>()
+        ).get();
+        symbolTab->id = record.id;
+        symbolTab->descTable = &varDescTab;
+
+        for (uint32_t idx = 0; idx < record.symbolCount; idx++) {
+            auto& symbolRecord = module.getBlockSymbols()[record.symbolBegin + idx];
+
+            auto sym = new tcir::VariableSymbol;
+            sym->symbolType = tcir::SymbolType::variableDefine;
+            sym->visibility = tcir::SymbolVisibility::internal;
+            sym->name = irNames.getName(symbolRecord.nameId);
+            sym->id = symbolRecord.id;
+            sym->bytes = symbolRecord.bytes;
+            sym->valueType = tcir::ValueType(symbolRecord.valueType);
+            symbolTab->put(sym);
+        }
 
-    this->clear();
-    string token;
+        this->blockSymTabMap[record.id] = symbolTab;
+    }
 
-    out << "; generated by ToyCompile" << endl;
-    out << "; for intel 386 protected mode environment" << endl;
-    out << endl;
-    out << "[bits 32]" << endl;
-    out << "section .text" << endl << endl;
+    // 母子关系绑定。顺序与生成器登记子表的顺序一致。
+    for (auto& record : module.getBlockTables()) {
+        auto symbolTab = blockSymTabMap[record.id];
+        auto parent = blockSymTabMap[record.parentId];
 
-    
-    while (true) {
-        in >> token;
-        if (token != "@") {
-            err << "[err] bad token." << endl;
-            return -1;
+        if (parent != symbolTab) {
+            parent->children.push_back(symbolTab);
+            symbolTab->parent = parent;
         }
-        
-        in >> token >> token >> token;
-
-        if (token == "extlink") {
+    }
 
-            __processExtLink(in, out, err);
+    /* 指令。直接从映射的记录展开。 */
+    auto& records = module.getInstructions();
+    vector<IrInstruction> instructions;
+    instructions.reserve(records.size());
 
-        } else if (token == "static-data") {
+    for (auto& record : records) {
+        instructions.push_back(record.unpack());
+    }
 
-            this->processStaticData(in, out);
+    this->generateFromSymbolTables(instructions, out, err);
 
-        } else if (token == "global-symtab") {
+    return 0;
 
-            tcir::GlobalSymbolTable::build(in, err, globalSymTab);
+}
 
-        } else if (token == "block-symtab") {
+void Intel386AssemblyGenerator::generateFromSymbolTables(
+    vector<IrInstruction>& instructions,
+    ostream& out,
+    ostream& err
+) {
 
-            tcir::BlockSymbolTable::build(
-                in, err, blockSymTabMap, &varDescTab
-            );
-            
-            this->buildVariableOffsetMap();
+    __writeFileHeader(out);
 
-        } else if (token == "instructions") {
+    /* 符号关联。与 extlink 区段的内容相同。 */
+    for (auto& fun : globalTable->functions) {
+        if (fun.second->isImported) {
+            out << "extern " << fun.first << endl;
+        } else if (fun.second->visibility == tcir::SymbolVisibility::global) {
+            out << "global " << fun.first << endl;
+        }
+    }
 
-            this->processInstructionsSection(in, out, err);
+    for (auto& var : globalTable->variables) {
+        out << "global " << var.first << endl;
+    }
 
-            break;
+    /* 全局数据。 */
+    for (auto& var : globalTable->variables) {
+        __writeStaticInt(out, var.first, uint64_t(var.second->initValue));
+    }
 
-        } 
+    if (this->ssaEnabled) {
+        tcir::IrSsaUtils::optimize(instructions, *names);
     }
 
-    return 0;
+    __optimizeInstructions(instructions);
+
+    buildAssemblyFile(instructions, out, err);
 
 }
 
 void Intel386AssemblyGenerator::clear() {
     this->varDescTab.clear();
     this->globalSymTab.clear();
-    
-    for (auto it : this->blockSymTabMap) {
-        delete it.second;
-    }
+
     this->blockSymTabMap.clear();
-    this->variableStackOffsetMap.clear();
+    this->ownedBlockSymTabs.clear();
+    this->irNames.clear();
+
+    this->globalTable = &this->globalSymTab;
+    this->names = &this->irNames;
 }
 
 
@@ -12,9 +12,13 @@
 
 #include <iostream>
 #include <map>
+#include <memory>
+#include <vector>
 
 #include <core/tcir/SymbolTable.h>
 #include <core/tcir/IrContainer.h>
+#include <core/tcir/IrBinaryModule.h>
+#include <core/Intel386RegisterAllocator.h>
 
 namespace tc::i386 {
 
@@ -24,39 +28,98 @@ public:
 
     Intel386AssemblyGenerator() {}
 
+    /**
+     * 读取文本形式的 TCIR，生成汇编。
+     * 先整体读入内存，再交给 IrTextReader 解析。
+     */
     int generate(
         std::istream& in,
         std::ostream& out,
         std::ostream& err
     );
 
+    /**
+     * 读取内存中的文本 TCIR（通常为 mmap 映射的文件），生成汇编。
+     */
+    int generate(
+        const char* data,
+        size_t size,
+        std::ostream& out,
+        std::ostream& err
+    );
+
+    /**
+     * 直接使用生成器内的 IR 生成汇编，不经过文本。
+     * 生成期间，模块引用的数据需要保持有效。
+     */
+    int generate(
+        const tcir::IrModule& module,
+        std::ostream& out,
+        std::ostream& err
+    );
+
+    /**
+     * 使用二进制 TCIR 模块生成汇编。模块通常绑定在 mmap 映射的文件上。
+     * 指令记录直接从模块内展开，不经过文本解析。
+     */
+    int generate(
+        const tcir::IrBinaryModule& module,
+        std::ostream& out,
+        std::ostream& err
+    );
+
     void clear();
 
+    /**
+     * 生成前是否先在 SSA 形式上做常量传播与无用定义删除。见 IrSsa.h。
+     * 不受 clear 影响。
+     */
+    void setSsaEnabled(bool enabled) { this->ssaEnabled = enabled; }
+
+    /**
+     * 是否把局部变量、参数与临时值分配到寄存器。关闭时全部放在栈上。见 Intel386RegisterAllocator.h。
+     * 默认开启。不受 clear 影响。
+     */
+    void setRegisterAllocationEnabled(bool enabled) { this->registerAllocationEnabled = enabled; }
+
 
 protected:
-    void processInstructionsSection(
-        std::istream& in,
+    /**
+     * 符号表与块符号表就绪后，输出文件头、全局数据与指令。
+     * IR 模块与二进制模块共用。
+     */
+    void generateFromSymbolTables(
+        std::vector<tcir::IrInstruction>& instructions,
         std::ostream& out,
         std::ostream& err
     );
 
-    void processStaticData(std::istream& in, std::ostream& out);
-
     void buildAssemblyFile(
-        std::vector<tcir::IrInstructionCode>& instructions,
+        std::vector<tcir::IrInstruction>& instructions,
         std::ostream& out,
         std::ostream& err
     );
 
     void parseCode(
-        tcir::IrInstructionCode& code,
+        const tcir::IrInstruction& code,
         std::ostream& out,
         std::ostream& err
     );
 
-    void parseVariable(std::string& type, std::string& name, std::ostream& out);
+    void parseVariable(const tcir::IrOperand& operand, std::ostream& out);
 
-    void buildVariableOffsetMap();
+    void parseLabel(const tcir::IrOperand& operand, std::ostream& out);
+
+    /**
+     * 操作数是否在内存中：全局变量，或没有分到寄存器的值。
+     */
+    bool isMemoryOperand(const tcir::IrOperand& operand) const;
+
+    /**
+     * 输出双操作数指令。x86 不允许两个操作数都在内存中，imul 的目标也必须是寄存器，
+     * 这些情况下借一个寄存器中转。
+     */
+    void parseBinary(const tcir::IrInstruction& code, const char* mnemonic, std::ostream& out);
 
 protected:
     tcir::VariableDescriptionTable varDescTab;
@@ -64,23 +127,43 @@ protected:
 
     /**
      * 所有的块符号表。
-     * 容器 key 为符号表 id，value 为符号表本身。
+     * 容器 key 为符号表 id，value 为符号表本身。只负责指向，不负责管理内存。
      */
     std::map<int, tcir::BlockSymbolTable*> blockSymTabMap;
 
     /**
-     * 局部变量偏移表。
-     * key：变量 id
-     * value：变量的偏移量。
-     *        考虑到栈向低地址生长，这个偏移是负值。
-     *        如果汇编生成器在进入函数的地方提前减小 sp 的值，则取变量的偏移应该是正数。
+     * 由本对象创建的块符号表（读取二进制模块时）。直接使用 IR 模块时，符号表属于生成器，不在这里。
      */
-    std::map<int, int> variableStackOffsetMap;
+    std::vector< std::unique_ptr<tcir::BlockSymbolTable> > ownedBlockSymTabs;
+
+    /**
+     * 指令内的名称。
+     */
+    tcir::IrNameTable irNames;
+
+    /**
+     * 生成时使用的全局符号表与名称表。
+     * 使用二进制模块时指向本对象的 globalSymTab 与 irNames，使用 IR 模块（包括读入的文本 TCIR）时指向模块内的数据。
+     */
+    tcir::GlobalSymbolTable* globalTable = &globalSymTab;
+    const tcir::IrNameTable* names = &irNames;
+
+    bool ssaEnabled = false;
+    bool registerAllocationEnabled = true;
 
 protected:
 
     tcir::FunctionSymbol* currentFunction;
-    int currFunctionStackMemory;
+
+    /**
+     * 当前函数的寄存器分配结果。
+     */
+    Intel386RegisterAllocator allocator;
+
+    /**
+     * 正在输出的指令在当前函数内的下标。
+     */
+    int currentPosition = 0;
 
 };
 
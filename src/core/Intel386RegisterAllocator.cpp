@@ -0,0 +1,604 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    i386 寄存器分配。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+#include <core/Intel386RegisterAllocator.h>
+#include <core/tcir/IrCfg.h>
+#include <core/tcir/IrSsa.h>
+
+#include <algorithm>
+
+using namespace std;
+using namespace tc;
+
+using tcir::IrInstruction;
+using tcir::IrOpcode;
+using tcir::IrOperand;
+using tcir::IrOperandKind;
+
+namespace tc::i386 {
+
+static const int REGISTER_COUNT = int(Intel386Register::NUM_REGISTERS);
+
+/**
+ * 分配时尝试寄存器的顺序。调用者保存的寄存器排在前面，使用它们不需要在入口保存。
+ */
+static const Intel386Register __tcAllocationOrder[] = {
+    Intel386Register::ecx,
+    Intel386Register::eax,
+    Intel386Register::edx,
+    Intel386Register::ebx,
+    Intel386Register::esi,
+    Intel386Register::edi
+};
+
+static bool __tcIsTracked(const IrOperand& operand) {
+    return operand.kind == IrOperandKind::local || operand.kind == IrOperandKind::param
+        || operand.kind == IrOperandKind::vreg;
+}
+
+static bool __tcIsTemporary(const IrOperand& operand) {
+    return operand.kind == IrOperandKind::vreg && operand.value >= 2;
+}
+
+/**
+ * 只改写目标操作数、没有其他作用的指令。
+ */
+static bool __tcIsArithmetic(const IrInstruction& ins) {
+    switch (ins.opcode) {
+        case IrOpcode::mov:
+        case IrOpcode::add:
+        case IrOpcode::sub:
+        case IrOpcode::mul:
+        case IrOpcode::neg:
+        case IrOpcode::bitAnd:
+        case IrOpcode::bitOr:
+        case IrOpcode::bitXor:
+        case IrOpcode::bitNot: {
+            return true;
+        }
+
+        default: {
+            return false;
+        }
+    }
+}
+
+/**
+ * vreg 0 与 vreg 1 固定在 eax 与 edx 上。
+ */
+static Intel386Register __tcFixedRegister(const IrOperand& operand) {
+    if (operand.isVreg(0)) {
+        return Intel386Register::eax;
+    } else if (operand.isVreg(1)) {
+        return Intel386Register::edx;
+    } else {
+        return Intel386Register::none;
+    }
+}
+
+static bool __tcTestBit(const vector<uint64_t>& bits, int idx) {
+    return (bits[idx >> 6] >> (idx & 63)) & 1;
+}
+
+static void __tcSetBit(vector<uint64_t>& bits, int idx) {
+    bits[idx >> 6] |= uint64_t(1) << (idx & 63);
+}
+
+static void __tcClearBit(vector<uint64_t>& bits, int idx) {
+    bits[idx >> 6] &= ~(uint64_t(1) << (idx & 63));
+}
+
+template <typename Callback>
+static void __tcForEachBit(const vector<uint64_t>& bits, Callback callback) {
+    for (size_t word = 0; word < bits.size(); word++) {
+        uint64_t rest = bits[word];
+        while (rest) {
+            int bit = __builtin_ctzll(rest);
+            callback(int(word * 64 + bit));
+            rest &= rest - 1;
+        }
+    }
+}
+
+
+const char* Intel386RegisterAllocator::getName(Intel386Register reg) {
+    switch (reg) {
+        case Intel386Register::eax: return "eax";
+        case Intel386Register::ecx: return "ecx";
+        case Intel386Register::edx: return "edx";
+        case Intel386Register::ebx: return "ebx";
+        case Intel386Register::esi: return "esi";
+        case Intel386Register::edi: return "edi";
+        default: return "";
+    }
+}
+
+bool Intel386RegisterAllocator::isCalleeSaved(Intel386Register reg) {
+    return reg == Intel386Register::ebx || reg == Intel386Register::esi
+        || reg == Intel386Register::edi;
+}
+
+int Intel386RegisterAllocator::findValue(const IrOperand& operand) const {
+    auto it = valueIds.find({ int(operand.kind), operand.value });
+    return it == valueIds.end() ? -1 : it->second;
+}
+
+Intel386Location Intel386RegisterAllocator::getLocation(const IrOperand& operand) const {
+    Intel386Location location;
+
+    location.reg = __tcFixedRegister(operand);
+    if (location.isRegister()) {
+        return location;
+    }
+
+    int valueId = findValue(operand);
+    if (valueId >= 0) {
+        return intervals[valueId].location;
+    }
+
+    return location;
+}
+
+
+void Intel386RegisterAllocator::allocate(
+    const vector<IrInstruction>& instructions,
+    bool useRegisters
+) {
+
+    valueIds.clear();
+    intervals.clear();
+    liveAtEntry.clear();
+    deadInstructions.clear();
+    busyRegisters.clear();
+    savedRegisters.clear();
+    paramLoads.clear();
+    frameSize = 0;
+
+    for (auto& prefix : fixedPrefix) {
+        prefix.clear();
+    }
+
+    this->buildIntervals(instructions);
+    this->linearScan(useRegisters);
+}
+
+void Intel386RegisterAllocator::buildIntervals(const vector<IrInstruction>& instructions) {
+
+    int count = instructions.size();
+
+    /* 登记值。call 与 ret 隐式地使用 vreg 0，总是登记它。 */
+
+    auto addValue = [this] (const IrOperand& operand) {
+        auto key = make_pair(int(operand.kind), operand.value);
+        if (valueIds.count(key)) {
+            return;
+        }
+
+        valueIds[key] = intervals.size();
+
+        auto& interval = intervals.emplace_back();
+        interval.value = operand;
+        interval.start = INT32_MAX;
+        interval.end = -1;
+    };
+
+    addValue(IrOperand::vreg(0));
+
+    for (auto& ins : instructions) {
+        for (int opIdx = 0; opIdx < ins.operandCount; opIdx++) {
+            if (__tcIsTracked(ins.operands[opIdx])) {
+                addValue(ins.operands[opIdx]);
+            }
+        }
+    }
+
+    int valueCount = intervals.size();
+    int vreg0 = findValue(IrOperand::vreg(0));
+    int vreg1 = findValue(IrOperand::vreg(1));
+
+    /**
+     * 取指令使用与定义的值。call 定义 vreg 0（返回值），ret 使用 vreg 0。
+     */
+    vector<int> used;
+    vector<int> defined;
+    bool uses[IrInstruction::MAX_OPERANDS];
+    bool defs[IrInstruction::MAX_OPERANDS];
+
+    auto collect = [&] (const IrInstruction& ins) {
+        used.clear();
+        defined.clear();
+
+        tcir::IrSsaUtils::getOperandRoles(ins, uses, defs);
+        for (int opIdx = 0; opIdx < ins.operandCount; opIdx++) {
+            if (!__tcIsTracked(ins.operands[opIdx])) {
+                continue;
+            }
+
+            int valueId = findValue(ins.operands[opIdx]);
+            if (uses[opIdx]) {
+                used.push_back(valueId);
+            }
+
+            if (defs[opIdx]) {
+                defined.push_back(valueId);
+            }
+        }
+
+        if (ins.isCall()) {
+            defined.push_back(vreg0);
+        } else if (ins.opcode == IrOpcode::ret) {
+            used.push_back(vreg0);
+        }
+    };
+
+    /* 块内的使用与定义。 */
+
+    tcir::IrCfg cfg;
+    cfg.build(instructions);
+    auto& blocks = cfg.getBlocks();
+    int blockCount = blocks.size();
+    size_t words = (valueCount + 63) / 64;
+
+    deadInstructions.assign(count, false);
+
+    vector< vector<uint64_t> > liveIn(blockCount, vector<uint64_t>(words, 0));
+    vector< vector<uint64_t> > liveOut(blockCount, vector<uint64_t>(words, 0));
+
+    /**
+     * 求活跃集合。已标记为死的指令不算作使用或定义。
+     */
+    auto solveLiveness = [&] () {
+        vector< vector<uint64_t> > blockUses(blockCount, vector<uint64_t>(words, 0));
+        vector< vector<uint64_t> > blockDefs(blockCount, vector<uint64_t>(words, 0));
+
+        for (int blockIdx = 0; blockIdx < blockCount; blockIdx++) {
+            for (int idx = blocks[blockIdx].begin; idx < blocks[blockIdx].end; idx++) {
+                if (deadInstructions[idx]) {
+                    continue;
+                }
+
+                collect(instructions[idx]);
+
+                for (int valueId : used) {
+                    if (!__tcTestBit(blockDefs[blockIdx], valueId)) {
+                        __tcSetBit(blockUses[blockIdx], valueId);
+                    }
+                }
+
+                for (int valueId : defined) {
+                    __tcSetBit(blockDefs[blockIdx], valueId);
+                }
+            }
+        }
+
+        for (int blockIdx = 0; blockIdx < blockCount; blockIdx++) {
+            fill(liveIn[blockIdx].begin(), liveIn[blockIdx].end(), 0);
+            fill(liveOut[blockIdx].begin(), liveOut[blockIdx].end(), 0);
+        }
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+
+            for (int blockIdx = blockCount - 1; blockIdx >= 0; blockIdx--) {
+                auto& out = liveOut[blockIdx];
+                for (int succ : blocks[blockIdx].succs) {
+                    for (size_t word = 0; word < words; word++) {
+                        out[word] |= liveIn[succ][word];
+                    }
+                }
+
+                auto& in = liveIn[blockIdx];
+                for (size_t word = 0; word < words; word++) {
+                    uint64_t value = blockUses[blockIdx][word]
+                        | (out[word] & ~blockDefs[blockIdx][word]);
+
+                    if (value != in[word]) {
+                        in[word] = value;
+                        changed = true;
+                    }
+                }
+            }
+        }
+    };
+
+    solveLiveness();
+
+    /*
+        标记死指令：结果没有被使用的临时值运算，如语句 i++; 复制出的旧值。
+        倒序扫描时跳过它的使用，使只为它计算的临时值也被删去。
+
+        之后去掉死指令重新求活跃集合。区间与入口活跃的值都以新的集合为准，
+        否则只被死指令使用的参数会被当作入口活跃，而它的区间却从之后的赋值开始。
+        去掉使用只会让活跃集合变小，已标记的指令仍然是死的。
+    */
+
+    for (int blockIdx = 0; blockIdx < blockCount; blockIdx++) {
+        auto& block = blocks[blockIdx];
+        auto live = liveOut[blockIdx];
+
+        for (int idx = block.end - 1; idx >= block.begin; idx--) {
+            auto& ins = instructions[idx];
+            collect(ins);
+
+            bool dead = __tcIsArithmetic(ins) && !defined.empty()
+                && all_of(defined.begin(), defined.end(), [&] (int valueId) {
+                    return __tcIsTemporary(intervals[valueId].value)
+                        && !__tcTestBit(live, valueId);
+                });
+
+            if (dead) {
+                deadInstructions[idx] = true;
+                continue;
+            }
+
+            for (int valueId : defined) {
+                __tcClearBit(live, valueId);
+            }
+
+            for (int valueId : used) {
+                __tcSetBit(live, valueId);
+            }
+        }
+    }
+
+    solveLiveness();
+
+    /* 倒序扫描各块，求区间与固定占用。 */
+
+    vector<uint8_t> occupied[REGISTER_COUNT];
+    for (auto& it : occupied) {
+        it.assign(count, 0);
+    }
+
+    auto extend = [this] (int valueId, int position) {
+        auto& interval = intervals[valueId];
+        interval.start = min(interval.start, position);
+        interval.end = max(interval.end, position);
+    };
+
+    for (int blockIdx = 0; blockIdx < blockCount; blockIdx++) {
+        auto& block = blocks[blockIdx];
+        auto live = liveOut[blockIdx];
+
+        __tcForEachBit(live, [&] (int valueId) { extend(valueId, block.end - 1); });
+
+        for (int idx = block.end - 1; idx >= block.begin; idx--) {
+            if (deadInstructions[idx]) {
+                continue;
+            }
+
+            auto& ins = instructions[idx];
+            collect(ins);
+
+            // 此时 live 为该指令之后活跃的值。
+
+            auto touches = [&] (int valueId) {
+                return valueId >= 0 && (__tcTestBit(live, valueId)
+                    || find(used.begin(), used.end(), valueId) != used.end()
+                    || find(defined.begin(), defined.end(), valueId) != defined.end());
+            };
+
+            if (touches(vreg0)) {
+                occupied[int(Intel386Register::eax)][idx] = 1;
+            }
+
+            if (touches(vreg1)) {
+                occupied[int(Intel386Register::edx)][idx] = 1;
+            }
+
+            if (ins.isCall()) {
+                occupied[int(Intel386Register::eax)][idx] = 1;
+                occupied[int(Intel386Register::ecx)][idx] = 1;
+                occupied[int(Intel386Register::edx)][idx] = 1;
+            }
+
+            for (int valueId : defined) {
+                extend(valueId, idx);
+                __tcClearBit(live, valueId);
+            }
+
+            for (int valueId : used) {
+                extend(valueId, idx);
+                __tcSetBit(live, valueId);
+            }
+        }
+
+        __tcForEachBit(live, [&] (int valueId) { extend(valueId, block.begin); });
+    }
+
+    liveAtEntry.assign(valueCount, false);
+    if (blockCount > 0) {
+        __tcForEachBit(liveIn[0], [this] (int valueId) { liveAtEntry[valueId] = true; });
+    }
+
+    for (int reg = 0; reg < REGISTER_COUNT; reg++) {
+        auto& prefix = fixedPrefix[reg];
+        prefix.assign(count + 1, 0);
+        for (int idx = 0; idx < count; idx++) {
+            prefix[idx + 1] = prefix[idx] + occupied[reg][idx];
+        }
+    }
+
+    busyRegisters.assign(count, 0);
+    for (int reg = 0; reg < REGISTER_COUNT; reg++) {
+        for (int idx = 0; idx < count; idx++) {
+            if (occupied[reg][idx]) {
+                busyRegisters[idx] |= 1 << reg;
+            }
+        }
+    }
+}
+
+void Intel386RegisterAllocator::linearScan(bool useRegisters) {
+
+    int slotCount = 0;
+
+    auto spill = [&slotCount] (Intel386LiveInterval& interval) {
+        interval.location.reg = Intel386Register::none;
+
+        if (interval.value.kind == IrOperandKind::param) {
+            interval.location.offset = 8 + 4 * int(interval.value.value);
+        } else {
+            interval.location.offset = -4 * ++slotCount;
+        }
+    };
+
+    auto compatible = [this] (Intel386Register reg, const Intel386LiveInterval& interval) {
+        auto& prefix = fixedPrefix[int(reg)];
+        return prefix[interval.end + 1] == prefix[interval.start];
+    };
+
+    /* 按起点排序。没有出现在任何指令内的值（如只被 call 隐式定义的 vreg 0）不参与。 */
+
+    vector<int> order;
+    for (int valueId = 0; valueId < int(intervals.size()); valueId++) {
+        auto& interval = intervals[valueId];
+        interval.location.reg = __tcFixedRegister(interval.value);
+
+        if (!interval.location.isRegister() && interval.end >= 0) {
+            order.push_back(valueId);
+        }
+    }
+
+    sort(order.begin(), order.end(), [this] (int a, int b) {
+        auto& lhs = intervals[a];
+        auto& rhs = intervals[b];
+        return lhs.start != rhs.start ? lhs.start < rhs.start : lhs.end < rhs.end;
+    });
+
+    int owners[REGISTER_COUNT];
+    fill(owners, owners + REGISTER_COUNT, -1);
+
+    for (int valueId : order) {
+        auto& current = intervals[valueId];
+
+        if (!useRegisters) {
+            spill(current);
+            continue;
+        }
+
+        for (int reg = 0; reg < REGISTER_COUNT; reg++) {
+            if (owners[reg] >= 0 && intervals[owners[reg]].end < current.start) {
+                owners[reg] = -1;
+            }
+        }
+
+        auto chosen = Intel386Register::none;
+        for (auto reg : __tcAllocationOrder) {
+            if (owners[int(reg)] < 0 && compatible(reg, current)) {
+                chosen = reg;
+                break;
+            }
+        }
+
+        if (chosen == Intel386Register::none) {
+            // 溢出终点最远的区间。
+            auto victim = Intel386Register::none;
+            for (auto reg : __tcAllocationOrder) {
+                int owner = owners[int(reg)];
+                if (owner < 0 || !compatible(reg, current)) {
+                    continue;
+                }
+
+                if (victim == Intel386Register::none
+                    || intervals[owner].end > intervals[owners[int(victim)]].end
+                ) {
+                    victim = reg;
+                }
+            }
+
+            if (victim != Intel386Register::none
+                && intervals[owners[int(victim)]].end > current.end
+            ) {
+                spill(intervals[owners[int(victim)]]);
+                chosen = victim;
+            }
+        }
+
+        if (chosen == Intel386Register::none) {
+            spill(current);
+        } else {
+            current.location.reg = chosen;
+            owners[int(chosen)] = valueId;
+        }
+    }
+
+    /* 被占用的寄存器、需要保存的寄存器与入口读入的参数。 */
+
+    bool used[REGISTER_COUNT] = {};
+
+    for (int valueId : order) {
+        auto& interval = intervals[valueId];
+        if (!interval.location.isRegister()) {
+            continue;
+        }
+
+        int reg = int(interval.location.reg);
+        used[reg] = true;
+
+        for (int idx = interval.start; idx <= interval.end; idx++) {
+            busyRegisters[idx] |= 1 << reg;
+        }
+
+        if (interval.value.kind == IrOperandKind::param && liveAtEntry[valueId]) {
+            paramLoads.emplace_back(interval.location.reg, 8 + 4 * int(interval.value.value));
+        }
+    }
+
+    for (auto reg : __tcAllocationOrder) {
+        if (used[int(reg)] && isCalleeSaved(reg)) {
+            savedRegisters.emplace_back(reg, -4 * ++slotCount);
+        }
+    }
+
+    frameSize = 4 * slotCount;
+}
+
+Intel386Register Intel386RegisterAllocator::findScratchRegister(
+    int position, const IrInstruction& ins
+) const {
+
+    if (position < 0 || position >= int(busyRegisters.size())) {
+        return Intel386Register::none;
+    }
+
+    int mask = busyRegisters[position];
+    for (int opIdx = 0; opIdx < ins.operandCount; opIdx++) {
+        auto location = getLocation(ins.operands[opIdx]);
+        if (__tcIsTracked(ins.operands[opIdx]) && location.isRegister()) {
+            mask |= 1 << int(location.reg);
+        }
+    }
+
+    for (auto reg : __tcAllocationOrder) {
+        if (mask & (1 << int(reg))) {
+            continue;
+        }
+
+        if (isCalleeSaved(reg)) {
+            bool saved = false;
+            for (auto& it : savedRegisters) {
+                saved = saved || it.first == reg;
+            }
+
+            if (!saved) {
+                continue;
+            }
+        }
+
+        return reg;
+    }
+
+    return Intel386Register::none;
+}
+
+}
@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    i386 寄存器分配。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+/*
+
+  分配的对象
+
+    局部变量（val <id>）、函数参数（fval x）与 2 号及以后的虚拟寄存器（表达式的临时值）。
+    vreg 0 与 vreg 1 是 TCIR 约定的累加器与第二操作数，固定在 eax 与 edx 上，
+    它们活跃的位置上，eax 与 edx 不能分给其他值。
+
+  活跃区间
+
+    在控制流图上求出各值的活跃集合，再把每个值出现过的位置合并为一段连续区间 [start, end]。
+    区间是保守的：循环内活跃的值，其区间覆盖整个循环。
+
+  线性扫描
+
+    见 Poletto, Sarkar. Linear Scan Register Allocation.
+    按起点顺序处理区间。没有空闲寄存器时，在占用的区间里选终点最远的一个溢出到栈上。
+
+  调用约定
+
+    call 会破坏 eax、ecx、edx，跨过 call 的区间只能使用 ebx、esi、edi。
+    函数用到的 ebx、esi、edi 在入口保存到栈帧内，在 ret 前恢复。
+
+  栈帧
+
+    ebp 以下依次为溢出的值与保存的寄存器，每项 4 字节。溢出的参数留在调用者压入的位置 [ebp + 8 + 4i]。
+
+*/
+
+#pragma once
+
+#include <core/tcir/IrContainer.h>
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace tc::i386 {
+
+    /**
+     * 参与分配的通用寄存器。ebp 与 esp 用于栈帧。
+     */
+    enum class Intel386Register : int8_t {
+        none = -1,
+        eax, ecx, edx, ebx, esi, edi,
+        NUM_REGISTERS
+    };
+
+    /**
+     * 值的位置：寄存器，或相对 ebp 的栈内存。
+     */
+    struct Intel386Location {
+        Intel386Register reg = Intel386Register::none;
+        int offset = 0;
+
+        bool isRegister() const { return reg != Intel386Register::none; }
+    };
+
+    struct Intel386LiveInterval {
+        tcir::IrOperand value;
+        int start = 0;
+        int end = 0;
+        Intel386Location location;
+    };
+
+    /**
+     * 单个函数的寄存器分配器。
+     */
+    class Intel386RegisterAllocator {
+
+    public:
+
+        /**
+         * 为函数分配寄存器与栈帧。
+         *
+         * @param instructions 函数的指令。以 fun-label 开头。下文的位置均为此处的下标。
+         * @param useRegisters 为 false 时所有值都放在栈上。
+         */
+        void allocate(const std::vector<tcir::IrInstruction>& instructions, bool useRegisters);
+
+        /**
+         * 获取局部变量、参数或虚拟寄存器的位置。
+         */
+        Intel386Location getLocation(const tcir::IrOperand& operand) const;
+
+        /**
+         * ebp 以下需要预留的字节数。
+         */
+        int getFrameSize() const { return frameSize; }
+
+        /**
+         * 需要在入口保存、在 ret 前恢复的寄存器，及其在栈帧内的位置。
+         */
+        const std::vector< std::pair<Intel386Register, int> >& getSavedRegisters() const {
+            return savedRegisters;
+        }
+
+        /**
+         * 放在寄存器内的参数。入口处需要从调用者压入的位置读入。
+         * 每项为 (寄存器, 参数所在的栈位置)。
+         */
+        const std::vector< std::pair<Intel386Register, int> >& getParamLoads() const {
+            return paramLoads;
+        }
+
+        /**
+         * 找一个在 position 处可以随意改写的寄存器。用于两个操作数都在内存中时中转。
+         * 不会返回指令的操作数所在的寄存器，也不会返回未保存的 ebx、esi、edi。
+         *
+         * @return 找不到时返回 none，需要临时压栈保存一个寄存器。
+         */
+        Intel386Register findScratchRegister(int position, const tcir::IrInstruction& ins) const;
+
+        /**
+         * 指令是否只计算了不会被使用的临时值。这样的指令不需要生成代码。
+         */
+        bool isDeadInstruction(int position) const {
+            return position >= 0 && position < int(deadInstructions.size())
+                && deadInstructions[position];
+        }
+
+        const std::vector<Intel386LiveInterval>& getIntervals() const { return intervals; }
+
+        static const char* getName(Intel386Register reg);
+
+        /**
+         * 是否由被调用者保存：ebx、esi、edi。
+         */
+        static bool isCalleeSaved(Intel386Register reg);
+
+    protected:
+
+        /**
+         * 求活跃区间，以及 eax、ecx、edx 被固定占用的位置。
+         */
+        void buildIntervals(const std::vector<tcir::IrInstruction>& instructions);
+
+        void linearScan(bool useRegisters);
+
+        int findValue(const tcir::IrOperand& operand) const;
+
+    protected:
+        std::map< std::pair<int, int64_t>, int > valueIds;
+        std::vector<Intel386LiveInterval> intervals;
+
+        /** 函数入口处活跃的值。放在寄存器内的参数需要在入口读入。 */
+        std::vector<bool> liveAtEntry;
+
+        /** 不需要生成代码的指令。 */
+        std::vector<bool> deadInstructions;
+
+        /**
+         * 各寄存器被 vreg 0、vreg 1 或 call 固定占用的位置个数的前缀和。
+         * fixedPrefix[r][i] 为 [0, i) 内被占用的位置个数。
+         */
+        std::vector<int> fixedPrefix[int(Intel386Register::NUM_REGISTERS)];
+
+        /** 各位置上被占用的寄存器。第 r 位对应寄存器 r。 */
+        std::vector<uint8_t> busyRegisters;
+
+        int frameSize = 0;
+        std::vector< std::pair<Intel386Register, int> > savedRegisters;
+        std::vector< std::pair<Intel386Register, int> > paramLoads;
+
+    };
+
+}
@@ -79,6 +79,43 @@ void Lexer::analyze(
     vector<LexerAnalyzeError>& errorList,
     bool seeCharConstantsAsNumerics
 ) {
+
+    int lastRow = tokenList.empty() ? 0 : tokenList.back().row;
+
+    const auto onBatch = [&tokenList] (vector<Token>& batch) {
+        tokenList.insert(
+            tokenList.end(), 
+            make_move_iterator(batch.begin()), make_move_iterator(batch.end())
+        );
+    };
+
+    this->analyzeInBatches(
+        in, onBatch, errorList, 256, seeCharConstantsAsNumerics, lastRow
+    );
+}
+
+void Lexer::analyze(
+    istream& in,
+    const function<void (vector<Token>&)>& onBatch,
+    vector<LexerAnalyzeError>& errorList,
+    size_t batchSize,
+    bool seeCharConstantsAsNumerics
+) {
+    this->analyzeInBatches(
+        in, onBatch, errorList, batchSize, seeCharConstantsAsNumerics, 0
+    );
+}
+
+/* ------------ 私有方法。 ------------ */
+
+void Lexer::analyzeInBatches(
+    istream& in,
+    const function<void (vector<Token>&)>& onBatch,
+    vector<LexerAnalyzeError>& errorList,
+    size_t batchSize,
+    bool seeCharConstantsAsNumerics,
+    int lastRow
+) {
     /*
 
         Lexer 的分析核心。
@@ -95,6 +132,9 @@ void Lexer::analyze(
 
     in.clear();
 
+    vector<Token> batch;
+    batch.reserve(batchSize);
+
     int rowNum = 1;
     int colNum = 1;
 
@@ -211,7 +251,13 @@ void Lexer::analyze(
             
             }
 
-            tokenList.push_back(token);
+            lastRow = token.row;
+            batch.push_back(move(token));
+
+            if (batch.size() >= batchSize) {
+                onBatch(batch);
+                batch.clear();
+            }
 
         }
     }
@@ -221,18 +267,14 @@ void Lexer::analyze(
     eof.kind = TokenKind::eof;
     eof.content = "<eof>";
     eof.col = 1;
-    if (tokenList.empty()) {
-        eof.row = 1;
-    } else {
-        eof.row = tokenList.back().row + 1;
-    }
+    eof.row = lastRow + 1;
 
-    tokenList.push_back(eof);
+    batch.push_back(eof);
+    onBatch(batch);
+    batch.clear();
 
 }
 
-/* ------------ 私有方法。 ------------ */
-
 void Lexer::fillTokenKind(Token& token) {
 
     auto& tokenKindMap = TokenKindUtils::getInstance().tokenKindMap;
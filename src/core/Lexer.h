@@ -9,6 +9,7 @@
 
 #include <iostream>
 #include <vector>
+#include <functional>
 
 #include <core/Dfa.h>
 #include <core/Token.h>
@@ -56,6 +57,11 @@ namespace tc {
 
         inline bool dfaIsReady() { return dfaReady; }
 
+        /**
+         * 设置 DFA 热点统计。详见 Dfa::setProfile。
+         */
+        void setProfile(DfaProfile* profile) { lexDfa.setProfile(profile); }
+
         /**
          * 词法分析。
          * 
@@ -69,12 +75,42 @@ namespace tc {
             bool seeCharConstantsAsNumerics = false
         );
 
+        /**
+         * 流式词法分析。每识别出 batchSize 个 token，就将这一批交给 onBatch。
+         * 最后一批以 eof 结尾。onBatch 可以取走批内的 token，之后该批会被清空。
+         * 
+         * @param in 字符输入流。应该指向文件内容的开头。
+         * @param onBatch 接收一批 token。
+         * @param batchSize 每批 token 数量。
+         */
+        void analyze(
+            std::istream& in,
+            const std::function<void (std::vector<Token>&)>& onBatch,
+            std::vector<LexerAnalyzeError>& errorList,
+            size_t batchSize,
+            bool seeCharConstantsAsNumerics = false
+        );
+
     protected:
 
         /* ------------ 私有方法。 ------------ */
 
         void fillTokenKind(Token& token);
 
+        /**
+         * 词法分析核心。
+         * 
+         * @param lastRow 已有最后一个 token 的行号。没有时为 0。用于确定 eof 所在行。
+         */
+        void analyzeInBatches(
+            std::istream& in,
+            const std::function<void (std::vector<Token>&)>& onBatch,
+            std::vector<LexerAnalyzeError>& errorList,
+            size_t batchSize,
+            bool seeCharConstantsAsNumerics,
+            int lastRow
+        );
+
     protected:
 
         /* ------------ 私有成员。 ------------ */
@@ -11,8 +11,15 @@
 
 #include <core/Lr1Grammar.h>
 #include <core/LrParserTable.h>
+#include <utils/Fnv1a.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
@@ -99,24 +106,33 @@ bool State::operator != (const State& other) const {
  */
 static void __lr1ExtractFlatExpressions(
     const grammar::Grammar& grammar,
-    vector<grammar::FlatExpression>& flatExpressionContainer,
-    unordered_map<int, vector<int> >& symbolExpressionsMap
+    vector<grammar::FlatExpression>& flatExpressionContainer
 ) {
-    auto& expMap = symbolExpressionsMap;
     auto& container = flatExpressionContainer;
     auto& symbolList = grammar.symbols;
 
-    expMap.clear();
     container.clear();
     for (auto& expression : grammar.expressions) {
-        for (auto& rule : expression.rules) {
+        for (size_t ruleIdx = 0; ruleIdx < expression.rules.size(); ruleIdx++) {
+            auto& rule = expression.rules[ruleIdx];
+
             container.emplace_back();
             auto& exp = container.back();
             exp.targetSymbolId = expression.targetSymbolId;
             exp.rule = rule;
             exp.id = container.size() - 1;
 
-            expMap[exp.targetSymbolId].push_back(exp.id);
+            // 产生式优先级：%prec 指定的，或最后一个终结符的。
+            if (ruleIdx < expression.rulePrecedences.size()) {
+                exp.precedence = expression.rulePrecedences[ruleIdx];
+            }
+
+            for (auto it = rule.rbegin(); exp.precedence == 0 && it != rule.rend(); it++) {
+                if (symbolList[*it].type == grammar::SymbolType::TERMINAL) {
+                    exp.precedence = symbolList[*it].precedence;
+                    break;
+                }
+            }
         }
     }
 }
@@ -127,8 +143,7 @@ static void __lr1ExtractFlatExpressions(
 static int __lr1ExtendGrammar(
     const int& grammarEntrySymbolId,
     vector<grammar::FlatExpression>& flatExpressions,
-    vector< grammar::Symbol >& symbolList,
-    unordered_map<int, vector<int> >& symbolExpressionsMap
+    vector< grammar::Symbol >& symbolList
 ) {
 
     flatExpressions.emplace_back();
@@ -144,7 +159,6 @@ static int __lr1ExtendGrammar(
     targetSymbol.name = "__--lr1_ext_extry--__";
 
     extExp.targetSymbolId = targetSymbol.id;
-    symbolExpressionsMap[extExp.targetSymbolId].push_back(extExp.id);
     
     return targetSymbol.id;
 }
@@ -152,22 +166,25 @@ static int __lr1ExtendGrammar(
 /**
  * 构建 first 集。
  * 
- * @param expressions 表达式集合。
+ * @param grammar 文法。
  * @param container 存储结果的容器。
  */
 static void __lr1ConstructFirstCollection(
-    const vector<grammar::FlatExpression>& expressions,
-    const vector< grammar::Symbol >& symbolList,
+    const grammar::CompiledGrammar& grammar,
     unordered_map<int, unordered_set<int> >& container
 ) {
     container.clear();
 
+    int expressionCount = grammar.getExpressionCount();
+
     // 先将终结符的构建好。因为它比较简单。
-    for (auto& expression : expressions) {
-        for (auto& symbolId : expression.rule) {
-            auto& symbol = symbolList[symbolId];
-            if (symbol.type == grammar::SymbolType::TERMINAL) {
-                container[symbolId].insert(symbolId);
+    for (int expressionId = 0; expressionId < expressionCount; expressionId++) {
+        const int* rhs = grammar.getRhs(expressionId);
+        int rhsLength = grammar.getRhsLength(expressionId);
+
+        for (int idx = 0; idx < rhsLength; idx++) {
+            if (grammar.isTerminal(rhs[idx])) {
+                container[rhs[idx]].insert(rhs[idx]);
             }
         }
     }
@@ -178,19 +195,20 @@ static void __lr1ConstructFirstCollection(
     while (containerUpdated) {
         containerUpdated = false;
 
-        for (auto& expression : expressions) {
+        for (int expressionId = 0; expressionId < expressionCount; expressionId++) {
+
+            auto& expression = grammar.getExpression(expressionId);
 
-            if (expression.rule.size() == 0) {
+            if (expression.rhsLength == 0) {
                 continue; // 理论上不会出现这种情况。出现了就跳过吧。
             }
 
             // 目标。显然，它是非终结符。
-            int targetId = expression.targetSymbolId;
+            int targetId = expression.lhs;
             
-            const auto firstSymbolId = expression.rule[0];
-            auto& firstSymbol = symbolList[firstSymbolId];
+            const auto firstSymbolId = grammar.getRhs(expressionId)[0];
 
-            if (firstSymbol.type == grammar::SymbolType::TERMINAL) {
+            if (grammar.isTerminal(firstSymbolId)) {
                 // 终结符直接插入。
                 if (!container[targetId].count(firstSymbolId)) {
                     containerUpdated = true;
@@ -211,7 +229,7 @@ static void __lr1ConstructFirstCollection(
                 }
             }
 
-        } // for (auto& expression : expressions)
+        } // for (int expressionId = 0; expressionId < expressionCount; expressionId++)
 
     } // while (containerUpdated)
 
@@ -239,12 +257,13 @@ static int __lr1MakeEofSymbol(
  */
 static void __lr1CompleteState(
     State& state,
-    const vector<grammar::FlatExpression>& flatExpressions,
-    unordered_map<int, vector<int> >& symbolExpressionsMap,
-    const vector< grammar::Symbol >& symbolList,
-    unordered_map<int, unordered_set<int> >& firstCollection
+    const grammar::CompiledGrammar& grammar,
+    const unordered_map<int, unordered_set<int> >& firstCollection
 ) {
 
+    // 本函数会被多个工作线程同时调用，因此只允许读取共享的文法与映射表。
+    static const unordered_set<int> emptySymbolIds;
+
     /**
      * 
      * first = expression id
@@ -255,41 +274,45 @@ static void __lr1CompleteState(
     for (int expIdx = 0; expIdx < state.expressions.size(); expIdx++) {
 
         const auto lr1expression = state.expressions[expIdx];
-        const auto& flatExpression = flatExpressions[lr1expression.expressionId];
+        const auto expressionId = lr1expression.expressionId;
         const auto dotPos = lr1expression.dotPos;
         const auto paimonId = lr1expression.paimonId;
+        const int* rhs = grammar.getRhs(expressionId);
+        const int rhsLength = grammar.getRhsLength(expressionId);
 
         if (dotPos == 0) {
             expressionAlreadyExist.insert(
-                make_pair(flatExpression.id, lr1expression.paimonId)
+                make_pair(expressionId, lr1expression.paimonId)
             );
         }
 
-        if (dotPos == flatExpression.rule.size()) {
+        if (dotPos == rhsLength) {
            
             continue; // 已经到结尾了。
         }
 
-        const auto nextSymbolId = flatExpression.rule[dotPos];
-        auto& nextSymbol = symbolList[nextSymbolId];
-        if (nextSymbol.type == grammar::SymbolType::TERMINAL) {
+        const auto nextSymbolId = rhs[dotPos];
+        if (grammar.isTerminal(nextSymbolId)) {
         
             continue; // 遇到终结符，不用展开。
         }
 
-        bool nextSymbolIsLast = dotPos + 1 == flatExpression.rule.size();
+        bool nextSymbolIsLast = dotPos + 1 == rhsLength;
 
         // 接下来，准备展开。
-        for (auto& symbolExpressionId : symbolExpressionsMap[nextSymbolId]) {
+        const int* symbolExpressionIds = grammar.getExpressionsOf(nextSymbolId);
+        const int symbolExpressionCount = grammar.getExpressionCountOf(nextSymbolId);
+
+        for (int idx = 0; idx < symbolExpressionCount; idx++) {
         
-            auto& symbolExpression = flatExpressions[symbolExpressionId];
+            const int symbolExpressionId = symbolExpressionIds[idx];
 
             if (nextSymbolIsLast) {
                 
                 Lr1Expression newExp;
                 newExp.dotPos = 0;
                 newExp.paimonId = paimonId;
-                newExp.expressionId = symbolExpression.id;
+                newExp.expressionId = symbolExpressionId;
 
                 auto infoPair = make_pair(newExp.expressionId, paimonId);
 
@@ -305,15 +328,17 @@ static void __lr1CompleteState(
             
       
                 
-            auto nextNextSymbolId = flatExpression.rule[dotPos + 1];
+            auto nextNextSymbolId = rhs[dotPos + 1];
             
-            auto& firstSymbols = firstCollection[nextNextSymbolId];
+            auto firstSymbolsIt = firstCollection.find(nextNextSymbolId);
+            const auto& firstSymbols = firstSymbolsIt == firstCollection.end()
+                ? emptySymbolIds : firstSymbolsIt->second;
             
             for (auto nextPaimonId : firstSymbols) {
                 Lr1Expression newExp;
                 newExp.dotPos = 0;
                 newExp.paimonId = nextPaimonId;
-                newExp.expressionId = symbolExpression.id;
+                newExp.expressionId = symbolExpressionId;
 
                 auto infoPair = make_pair(newExp.expressionId, nextPaimonId);
                 if (!expressionAlreadyExist.count(infoPair)) {
@@ -324,7 +349,7 @@ static void __lr1CompleteState(
             } // for (auto& nextPaimonId : firstSymbols) 
             
              
-        } // for (auto& symbolExpressionPtr : symbolExpressionsMap[nextSymbolId])
+        } // for (int idx = 0; idx < symbolExpressionCount; idx++)
     } // for (int expIdx = 0; expIdx < state.expressions.size(); expIdx++)
 
 }
@@ -340,27 +365,34 @@ static void __lr1CompleteState(
  *   
  *   可转移字符为：b c E 
  * 
+ * 结果按符号 id 升序排列，以保证状态编号可复现。
+ * 
  * @param state 
- * @param flatExpressions 
+ * @param grammar 
  * @param resultContainer 
  */
 static void __lr1FindToBeViewedSymbols(
     const State& state,
-    const vector< grammar::FlatExpression >& flatExpressions,
-    unordered_set< int >& resultContainer
+    const grammar::CompiledGrammar& grammar,
+    vector< int >& resultContainer
 ) {
+    resultContainer.clear();
+
     for (auto& expression : state.expressions) {
         auto expId = expression.expressionId;
         auto dotPos = expression.dotPos;
-        auto& exp = flatExpressions[expId];
 
-        if (dotPos == exp.rule.size()) {
+        if (dotPos == grammar.getRhsLength(expId)) {
             continue; // 已到结尾。
         }
 
-        auto symbolId = flatExpressions[expId].rule[dotPos];
-        resultContainer.insert(symbolId);
+        resultContainer.push_back(grammar.getRhs(expId)[dotPos]);
     }
+
+    sort(resultContainer.begin(), resultContainer.end());
+    resultContainer.erase(
+        unique(resultContainer.begin(), resultContainer.end()), resultContainer.end()
+    );
 }
 
 /**
@@ -368,24 +400,18 @@ static void __lr1FindToBeViewedSymbols(
  * 
  * @param entryExpressionId 
  * @param eofSymbolId 
- * @param flatExpressions 
- * @param symbolExpressionsMap 
- * @param symbolList 
+ * @param grammar 
  * @param firstCollection 
  * @param stateContainer 
  */
 static void __lr1MakeState0(
     int entryExpressionId,
     int eofSymbolId,
-    const vector< grammar::FlatExpression >& flatExpressions,
-    unordered_map<int, vector<int> >& symbolExpressionsMap,
-    const vector< grammar::Symbol >& symbolList,
-    unordered_map<int, unordered_set<int> >& firstCollection,
+    const grammar::CompiledGrammar& grammar,
+    const unordered_map<int, unordered_set<int> >& firstCollection,
     vector< State >& stateContainer
 ) {
 
-    auto& entryExpression = flatExpressions[entryExpressionId];
-
     auto& states = stateContainer;
 
     states.clear();
@@ -397,156 +423,538 @@ static void __lr1MakeState0(
     auto& state0FirstExpression = state0.expressions.back();
     state0FirstExpression.dotPos = 0;
     state0FirstExpression.paimonId = eofSymbolId;
-    state0FirstExpression.expressionId = entryExpression.id;
+    state0FirstExpression.expressionId = entryExpressionId;
 
     // 填满该状态。
-    __lr1CompleteState(
-        state0, flatExpressions, symbolExpressionsMap, symbolList, firstCollection
-    );
+    __lr1CompleteState(state0, grammar, firstCollection);
     
 }
 
 /**
- * 在现有状态中寻找目标状态的 id。
- * 如果找不到，说明传入状态是新状态。
+ * 计算转移后状态的核心项目。即：将所有 dot 后紧跟转移符号的项目的 dot 后移一位。
+ * 核心项目不含闭包补充的内容。
  * 
- * @return 状态 id。如果目标状态是新状态，会返回 -1.
+ * @param srcState 源状态。
+ * @param kernel 存储核心项目的容器。首先会被清空。
+ * @param symbolId 转移符号。
+ * @param grammar 文法。
  */
-static int __lr1FindStateId(
-    const State& state, const vector< State >& states
+static void __lr1TranslateKernel(
+    const State& srcState,
+    vector< Lr1Expression >& kernel,
+    int symbolId,
+    const grammar::CompiledGrammar& grammar
 ) {
 
-    for (auto& existingState : states) {
-        if (state == existingState) {
-            return existingState.id;
+    kernel.clear();
+
+    for (auto& srcExp : srcState.expressions) {
+
+        if (srcExp.dotPos == grammar.getRhsLength(srcExp.expressionId)) {
+
+            continue; // 到达结尾了。不再移动。
         }
+
+        auto nextSymbolId = grammar.getRhs(srcExp.expressionId)[srcExp.dotPos];
+
+        if (nextSymbolId != symbolId) {
+
+            continue; // 不是想要的转移。
+        }
+
+        kernel.emplace_back(srcExp);
+        kernel.back().dotPos++;
     }
 
-    return -1; // 找不到。
+}
 
+/**
+ * 并行执行任务。任务编号为 [0, taskCount)。
+ * 工作线程数量不大于 1 时，直接在当前线程依次执行。
+ * 
+ * @param taskCount 任务数量。
+ * @param workerCount 工作线程数量（含当前线程）。
+ * @param task 任务。参数为任务编号。
+ */
+static void __lr1ParallelFor(
+    int taskCount,
+    int workerCount,
+    const function< void (int) >& task
+) {
+
+    if (workerCount <= 1 || taskCount <= 1) {
+        for (int taskIdx = 0; taskIdx < taskCount; taskIdx++) {
+            task(taskIdx);
+        }
+
+        return;
+    }
+
+    atomic<int> nextTaskIdx(0);
+
+    auto worker = [&] () {
+        int taskIdx;
+        while ((taskIdx = nextTaskIdx.fetch_add(1)) < taskCount) {
+            task(taskIdx);
+        }
+    };
+
+    vector< thread > threads;
+    int threadCount = min(workerCount, taskCount);
+    for (int threadIdx = 1; threadIdx < threadCount; threadIdx++) {
+        threads.emplace_back(worker);
+    }
+
+    worker(); // 当前线程也参与工作。
+
+    for (auto& it : threads) {
+        it.join();
+    }
 }
 
 /**
- * 转移状态。根据输入状态和转移字符，计算下一状态。
+ * 计时起点。与 __lr1SecondsSince 配合使用。
+ */
+static chrono::steady_clock::time_point __lr1Now() {
+    return chrono::steady_clock::now();
+}
+
+static double __lr1SecondsSince(chrono::steady_clock::time_point begin) {
+    return chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+}
+
+/**
+ * 项目排序规则。用于将核心项目集合整理成唯一的表示形式。
+ */
+static bool __lr1ExpressionLess(const Lr1Expression& a, const Lr1Expression& b) {
+    if (a.expressionId != b.expressionId) {
+        return a.expressionId < b.expressionId;
+    }
+
+    if (a.dotPos != b.dotPos) {
+        return a.dotPos < b.dotPos;
+    }
+
+    return a.paimonId < b.paimonId;
+}
+
+namespace {
+
+    enum class Lr1ConflictResolution {
+        SHIFT,
+        REDUCE,
+
+        /** 两者都不做。该格子为错误。 */
+        ERROR,
+
+        /** 缺少优先级声明，无法判定。 */
+        UNRESOLVED,
+    };
+
+}
+
+/**
+ * 根据优先级和结合性，解决移进-归约冲突。规则与 yacc 相同。
  * 
- * @param srcState 源状态。
- * @param destState 目标状态（存储用）。
- * @param symbolId 转移符号。
- * @param flatExpressions 文法的产生式列表。
- * @param symbolExpressionsMap 文法所有符号的产生式列表（根据符号分类）。
- * @param symbolList 文法符号表。
- * @param firstCollection 文法所有符号的 first 集合。
+ * @param lookahead 向前看的终结符。
+ * @param expressionPrecedence 待归约的产生式的优先级。
  */
-static void __lr1TranslateState(
-    const State& srcState,
-    State& destState,
-    int symbolId,
-    const vector<grammar::FlatExpression>& flatExpressions,
-    unordered_map<int, vector<int> >& symbolExpressionsMap,
+static Lr1ConflictResolution __lr1ResolveShiftReduce(
+    const grammar::Symbol& lookahead,
+    int expressionPrecedence
+) {
+
+    if (lookahead.precedence == 0 || expressionPrecedence == 0) {
+        return Lr1ConflictResolution::UNRESOLVED;
+    }
+
+    if (lookahead.precedence > expressionPrecedence) {
+        return Lr1ConflictResolution::SHIFT;
+    } else if (lookahead.precedence < expressionPrecedence) {
+        return Lr1ConflictResolution::REDUCE;
+    }
+
+    // 优先级相同。同一级别的终结符结合性相同。
+    switch (lookahead.associativity) {
+        case grammar::Associativity::LEFT:
+            return Lr1ConflictResolution::REDUCE;
+        case grammar::Associativity::RIGHT:
+            return Lr1ConflictResolution::SHIFT;
+        case grammar::Associativity::NONASSOC:
+            return Lr1ConflictResolution::ERROR;
+        default:
+            return Lr1ConflictResolution::UNRESOLVED;
+    }
+}
+
+/**
+ * 根据一个已补全的状态，填写它在 Action Goto 表内的一行。
+ * 
+ * 移进-归约冲突在双方都声明了优先级时按优先级和结合性解决。
+ * 其他冲突保持原有行为：后填写的项目覆盖先填写的。
+ * 
+ * @param state 状态。需要已经补全。
+ * @param grammar 文法。
+ * @param symbolList 文法符号表。用于读取终结符的优先级与结合性。
+ * @param entrySymbolId 拓广文法的进入符号 id。
+ * @param transitions 该状态的转移。符号 id -> 目标状态 id。
+ * @param table 存储结果的表。
+ * @param stats 记录冲突数量。
+ */
+static void __lr1FillStateRow(
+    const State& state,
+    const grammar::CompiledGrammar& grammar,
     const vector< grammar::Symbol >& symbolList,
-    unordered_map<int, unordered_set<int> >& firstCollection
+    int entrySymbolId,
+    unordered_map<int, int>& transitions,
+    LrParserTable& table,
+    Lr1BuildStats& stats
 ) {
 
-    destState.id = -1;
-    
-    destState.expressions.clear();
+    auto& row = table.table[state.id];
 
-    for (auto& srcExp : srcState.expressions) {
+    // 被 %nonassoc 判定为错误的终结符。之后不再填写。
+    unordered_set<int> errorSymbolIds;
 
-        auto& flatExp = flatExpressions[srcExp.expressionId];
-        if (srcExp.dotPos == flatExp.rule.size()) {
+    // 已记录过移进-归约冲突的终结符。同一格子可能由多个项目填写，只记一次。
+    unordered_set<int> conflictSymbolIds;
 
-            continue; // 到达结尾了。不再移动。
+    // 检查新命令与格子内已有命令是否构成移进-归约冲突。
+    // 返回 false 表示新命令不应写入。
+    auto resolveConflict = [&] (int symbolId, const LrParserCommand& command) {
+        
+        if (errorSymbolIds.count(symbolId)) {
+            return false;
         }
 
-        auto nextSymbolId = flatExp.rule[srcExp.dotPos];
+        auto it = row.find(symbolId);
+        if (it == row.end()) {
+            return true;
+        }
 
-        if (nextSymbolId != symbolId) {
+        if (it->second.type == command.type) {
+            if (command.type == LrParserCommandType::REDUCE && it->second.target != command.target) {
+                stats.reduceReduce++;
+            }
 
-            continue; // 不是想要的转移。
+            return true;
+        }
+
+        const LrParserCommand* reduceCommand;
+        if (command.type == LrParserCommandType::REDUCE 
+            && it->second.type == LrParserCommandType::SHIFT
+        ) {
+            reduceCommand = &command;
+        } else if (command.type == LrParserCommandType::SHIFT 
+            && it->second.type == LrParserCommandType::REDUCE
+        ) {
+            reduceCommand = &it->second;
+        } else {
+            return true;
+        }
+
+        auto resolution = __lr1ResolveShiftReduce(
+            symbolList[symbolId], grammar.getPrecedence(reduceCommand->target)
+        );
+
+        bool firstConflict = conflictSymbolIds.insert(symbolId).second;
+
+        switch (resolution) {
+            case Lr1ConflictResolution::SHIFT:
+                stats.shiftReduceResolved += firstConflict;
+                return command.type == LrParserCommandType::SHIFT;
+            case Lr1ConflictResolution::REDUCE:
+                stats.shiftReduceResolved += firstConflict;
+                return command.type == LrParserCommandType::REDUCE;
+            case Lr1ConflictResolution::ERROR:
+                // 格子记为错误后不再进入这里，只会记一次。
+                stats.nonassocErrors++;
+                row.erase(it);
+                errorSymbolIds.insert(symbolId);
+                return false;
+            default:
+                stats.shiftReduceUnresolved += firstConflict;
+                return true;
+        }
+    };
+
+    for (auto& expression : state.expressions) {
+
+        auto dotPos = expression.dotPos;
+        auto paimonId = expression.paimonId;
+        auto expressionId = expression.expressionId;
+        auto& exp = grammar.getExpression(expressionId);
+
+        if (dotPos == 1 && exp.lhs == entrySymbolId) {
+            // 是接受句。
+            LrParserCommand command;
+            command.type = LrParserCommandType::ACCEPT;
+            row[paimonId] = command;
+            
+            continue;
+        }
+
+        if (dotPos == exp.rhsLength) {
+            // 是归约句。
+            LrParserCommand command;
+            command.type = LrParserCommandType::REDUCE;
+            command.target = expressionId;
+
+            if (resolveConflict(paimonId, command)) {
+                row[paimonId] = command;
+            }
+
+            continue;
         }
 
-        destState.expressions.emplace_back(srcExp);
-        auto& newExp = destState.expressions.back();
-        newExp.dotPos++;
+        auto nextSymbolId = grammar.getRhs(expressionId)[dotPos];
+
+        LrParserCommand command;
+
+        if (!grammar.isTerminal(nextSymbolId)) {
+            command.type = LrParserCommandType::GOTO;
+        } else {
+            command.type = LrParserCommandType::SHIFT;
+        }
+
+        command.target = transitions[nextSymbolId];
+        if (resolveConflict(nextSymbolId, command)) {
+            row[nextSymbolId] = command;
+        }
+        
     }
 
-    __lr1CompleteState(
-        destState, flatExpressions, symbolExpressionsMap, symbolList, firstCollection
-    );
+}
+
+namespace {
+
+    /**
+     * 状态登记表中的一项。
+     */
+    struct Lr1StateEntry {
+
+        /**
+         * 状态 id。本轮新发现、尚未编号的状态为 -1。
+         */
+        int stateId = -1;
+
+        /**
+         * 发现该状态的任务序号。
+         * 同一状态可能被多个任务同时发现，保留序号最小者的核心，
+         * 使得状态编号与项目顺序都与线程调度无关。
+         */
+        int discoverRank = -1;
+
+        /**
+         * 代表核心。保持发现时的项目顺序。
+         */
+        vector< Lr1Expression > kernel;
+    };
+
+    struct Lr1KernelHash {
+        size_t operator () (const vector< Lr1Expression >& kernel) const {
+            size_t res = kernel.size();
+            for (auto& it : kernel) {
+                res = res * 1000003 ^ size_t(it.expressionId);
+                res = res * 1000003 ^ size_t(it.dotPos);
+                res = res * 1000003 ^ size_t(it.paimonId);
+            }
+
+            return res;
+        }
+    };
+
+    /**
+     * 并发状态登记表。以排序后的核心项目集合为键。
+     * 
+     * 转移得到的状态中，dotPos > 0 的项目全部来自核心，闭包只会补充 dotPos = 0 的项目。
+     * 因此核心相同与状态相同等价。登记时无需先求闭包。
+     * 
+     * 表被分成多个分片，每个分片有自己的锁，以减少线程间的争用。
+     */
+    class Lr1ConcurrentStateTable {
+    public:
+
+        /**
+         * 登记一个核心。若核心已存在，返回已有项；否则新建一项。
+         * 
+         * @param kernel 核心项目。保持原有顺序。
+         * @param discoverRank 发现该核心的任务序号。
+         * @return 登记项。在表的生命周期内保持有效。
+         */
+        Lr1StateEntry* intern(vector< Lr1Expression >& kernel, int discoverRank) {
+            
+            vector< Lr1Expression > key = kernel;
+            sort(key.begin(), key.end(), __lr1ExpressionLess);
+
+            size_t hashValue = Lr1KernelHash()(key);
+            auto& shard = shards[hashValue % SHARD_COUNT];
+
+            lock_guard<mutex> guard(shard.lock);
+
+            auto& entry = shard.entries[move(key)];
+            if (!entry) {
+                entry = make_unique<Lr1StateEntry>();
+            }
+
+            if (entry->stateId == -1 
+                && (entry->discoverRank == -1 || discoverRank < entry->discoverRank)
+            ) {
+                entry->discoverRank = discoverRank;
+                entry->kernel = kernel;
+            }
+
+            return entry.get();
+        }
 
+    protected:
+
+        static const int SHARD_COUNT = 64;
+
+        struct Shard {
+            mutex lock;
+            unordered_map< 
+                vector< Lr1Expression >, unique_ptr< Lr1StateEntry >, Lr1KernelHash 
+            > entries;
+        };
+
+        Shard shards[SHARD_COUNT];
+    };
 
 }
 
+/**
+ * 懒构建上下文。懒构建模式下，状态在其所在行第一次被查询时才补全并展开。
+ */
+struct tc::lr1grammar::Lr1LazyContext {
+
+    /** 文法所有符号的 first 集合。 */
+    unordered_map<int, unordered_set<int> > firstCollection;
+
+    /** 已发现的状态。键为排序后的核心项目，值为状态 id。 */
+    unordered_map< vector< Lr1Expression >, int, Lr1KernelHash > kernelStateMap;
+
+    /** 各状态核心项目的数量。状态补全后，其前若干个项目即为核心。 */
+    vector< int > kernelSizes;
+
+    /** 各状态是否已经补全。 */
+    vector< bool > stateCompleted;
+
+    /** 各状态在表内的行是否已经构建。 */
+    vector< bool > rowBuilt;
+
+    /** 已经构建的行。 */
+    LrParserTable table;
+};
+
 /* -------- 公有方法 -------- */
-Lr1Grammar::Lr1Grammar(const grammar::Grammar& grammar) {
-    this->load(grammar);
+Lr1Grammar::Lr1Grammar(const grammar::Grammar& grammar, int workerCount) {
+    this->load(grammar, workerCount);
 }
 
-void Lr1Grammar::load(const grammar::Grammar& grammar) {
-    // 清空原始数据。
-    this->states.clear();
-    this->transitionMap.clear();
-    this->flatExpressions.clear();
+Lr1Grammar::Lr1Grammar(
+    const grammar::Grammar& grammar, 
+    Lr1BuildMode mode, 
+    const LrParserTable* partialTable
+) {
+    if (mode == Lr1BuildMode::LAZY) {
+        this->loadLazily(grammar, partialTable);
+    } else {
+        this->load(grammar);
+    }
+}
 
-    // 拷贝。
-    this->symbolList = grammar.symbols;
+Lr1Grammar::~Lr1Grammar() = default;
 
-    // 提取表达式。
-    /** 符号表达式映射表。用于快速找全某个非终结符的所有产生式。 */
-    unordered_map<int, vector<int> > symbolExpressionsMap;
-    __lr1ExtractFlatExpressions(grammar, flatExpressions, symbolExpressionsMap);
+void Lr1Grammar::load(const grammar::Grammar& grammar, int workerCount) {
+
+    if (workerCount <= 0) {
+        workerCount = max(1, int(thread::hardware_concurrency()));
+    }
 
-    // 构造 first 集。
     unordered_map<int, unordered_set<int> > firstCollection;
-    __lr1ConstructFirstCollection(flatExpressions, symbolList, firstCollection);
+    this->prepare(grammar, firstCollection);
 
+    auto& compiled = *compiledGrammar;
 
-    // 拓广。
-    this->entrySymbolId = __lr1ExtendGrammar(
-        grammar.entryId, flatExpressions, symbolList, symbolExpressionsMap
-    );
+    /*
+        转移。按轮次并行展开：
 
-    // 引入 eof。
-    this->eofSymbolId = __lr1MakeEofSymbol(symbolList);
+          1. 对上一轮新增的每个状态、每个待转移符号，并行计算转移核心，
+             并在并发状态登记表内查找或登记。
+          2. 按任务序号为本轮新发现的状态编号。任务按（源状态，符号 id）排列，
+             因此编号结果与线程数量及调度顺序无关，构建出的表可以复现。
+          3. 并行计算新状态的闭包。新状态即为下一轮的待展开状态。
+    */
 
-    // 构造初始状态。
-    __lr1MakeState0(
-        symbolExpressionsMap[entrySymbolId][0], eofSymbolId, 
-        flatExpressions, symbolExpressionsMap, symbolList, firstCollection, states
-    );
+    Lr1ConcurrentStateTable stateTable;
 
+    /** 转移任务。first = 源状态 id，second = 转移符号 id。 */
+    vector< pair<int, int> > tasks;
+    vector< Lr1StateEntry* > taskResults;
+    vector< int > toBeViewedSymbols;
 
-    // 转移。
-    for (int stateIdx = 0; stateIdx < states.size(); stateIdx++) {
+    int frontierBegin = 0;
 
-        // 每个表达式的 dot 后续的符号。
-        unordered_set< int > toBeViewedSymbols;
-        __lr1FindToBeViewedSymbols(states[stateIdx], flatExpressions, toBeViewedSymbols);
+    while (frontierBegin < int(states.size())) {
 
-        // 对于每个转移符号，计算转移。
+        int frontierEnd = states.size();
+        auto internBegin = __lr1Now();
 
+        tasks.clear();
+        for (int stateIdx = frontierBegin; stateIdx < frontierEnd; stateIdx++) {
 
-        for (auto& transitionSymbolId : toBeViewedSymbols) {
-            
-            State nextState;
-         
-            __lr1TranslateState(
-                states[stateIdx], nextState, transitionSymbolId, flatExpressions, 
-                symbolExpressionsMap, symbolList, firstCollection
-            );
+            // 每个表达式的 dot 后续的符号。
+            __lr1FindToBeViewedSymbols(states[stateIdx], compiled, toBeViewedSymbols);
 
-            int nextStateId = __lr1FindStateId(nextState, states);
-            if (nextStateId == -1) { // 新状态，添加到状态列表。
-                nextState.id = states.size();
-                states.push_back(nextState);
-                nextStateId = nextState.id;
+            for (auto symbolId : toBeViewedSymbols) {
+                tasks.emplace_back(stateIdx, symbolId);
             }
+        }
 
-            this->transitionMap[stateIdx][transitionSymbolId] = nextStateId;
+        // 计算转移核心并登记。
+        taskResults.assign(tasks.size(), nullptr);
+        __lr1ParallelFor(tasks.size(), workerCount, [&] (int taskIdx) {
+            vector< Lr1Expression > kernel;
+            __lr1TranslateKernel(
+                states[tasks[taskIdx].first], kernel, tasks[taskIdx].second, compiled
+            );
             
+            taskResults[taskIdx] = stateTable.intern(kernel, taskIdx);
+        });
+
+        // 为新状态编号，并记录转移。
+        for (size_t taskIdx = 0; taskIdx < tasks.size(); taskIdx++) {
+            auto entry = taskResults[taskIdx];
+
+            if (entry->stateId == -1) { // 新状态，添加到状态列表。
+                entry->stateId = states.size();
+                states.emplace_back();
+                states.back().id = entry->stateId;
+                states.back().expressions = move(entry->kernel);
+            }
+
+            this->transitionMap[tasks[taskIdx].first][tasks[taskIdx].second] = entry->stateId;
         }
 
+        stats.internSeconds += __lr1SecondsSince(internBegin);
+        stats.transitionCount += tasks.size();
+
+        for (size_t stateIdx = frontierEnd; stateIdx < states.size(); stateIdx++) {
+            stats.kernelItemCount += states[stateIdx].expressions.size();
+        }
+
+        // 补全新状态。
+        auto closureBegin = __lr1Now();
+
+        frontierBegin = frontierEnd;
+        __lr1ParallelFor(states.size() - frontierBegin, workerCount, [&] (int offset) {
+            __lr1CompleteState(states[frontierBegin + offset], compiled, firstCollection);
+        });
+
+        stats.closureSeconds += __lr1SecondsSince(closureBegin);
+        stats.closureCount += states.size() - frontierBegin;
+
     }
 
 }
@@ -556,58 +964,273 @@ void Lr1Grammar::buildParserTable(LrParserTable& table) {
     table.primaryStateId = 0;
     table.flatExpressions = flatExpressions;
     table.symbolList = symbolList;
+    table.compiledGrammar = compiledGrammar;
     table.table.clear();
+    table.partial = false;
+    table.stateKernels.clear();
+    table.buildSymbolIndex();
     
     // 填写转移表。
 
+    auto fillBegin = __lr1Now();
+
     for (const auto& state : states) {
+        __lr1FillStateRow(
+            state, *compiledGrammar, symbolList, entrySymbolId, 
+            transitionMap[state.id], table, stats
+        );
+    }
 
-        for (auto& expression : state.expressions) {
+    stats.fillSeconds += __lr1SecondsSince(fillBegin);
 
-            auto dotPos = expression.dotPos;
-            auto paimonId = expression.paimonId;
-            auto& exp = flatExpressions[expression.expressionId];
+}
 
-            if (dotPos == 1 && exp.targetSymbolId == entrySymbolId) {
-                // 是接受句。
-                LrParserCommand command;
-                command.type = LrParserCommandType::ACCEPT;
-                table.table[state.id][paimonId] = command;
-                
-                continue;
-            }
+bool Lr1Grammar::loadLazily(
+    const grammar::Grammar& grammar, 
+    const LrParserTable* partialTable
+) {
 
-            if (dotPos == exp.rule.size()) {
-                // 是归约句。
-                LrParserCommand command;
-                command.type = LrParserCommandType::REDUCE;
-                command.target = exp.id;
+    this->lazyContext = make_unique<Lr1LazyContext>();
+    auto& lazy = *lazyContext;
+
+    this->prepare(grammar, lazy.firstCollection);
+
+    lazy.table.primaryStateId = 0;
+    lazy.table.symbolList = symbolList;
+    lazy.table.flatExpressions = flatExpressions;
+    lazy.table.compiledGrammar = compiledGrammar;
+    lazy.table.buildSymbolIndex();
+
+    // 0 号状态在 prepare 时已经补全。
+    lazy.kernelSizes.push_back(1);
+    lazy.stateCompleted.push_back(true);
+    lazy.rowBuilt.push_back(false);
+    lazy.kernelStateMap[{ states[0].expressions[0] }] = 0;
+
+    // 从此前保存的不完整表恢复。要求文法没有变化。
+    // 只比较符号与产生式的数量不够：改动一条产生式的内容，数量可以不变。
+    if (partialTable == nullptr 
+        || !partialTable->partial
+        || partialTable->grammarFingerprint != this->getGrammarFingerprint()
+    ) {
+        return false;
+    }
 
-                table.table[state.id][paimonId] = command;
+    for (auto& kernelPair : partialTable->stateKernels) {
+        int stateId = kernelPair.first;
+        auto& values = kernelPair.second;
 
-                continue;
-            }
+        if (stateId < 0) {
+            continue;
+        }
 
-            auto& nextSymbolId = exp.rule[dotPos];
-            auto& nextSymbol = symbolList[nextSymbolId];
+        if (stateId >= int(states.size())) {
+            states.resize(stateId + 1);
+            lazy.kernelSizes.resize(stateId + 1, 0);
+            lazy.stateCompleted.resize(stateId + 1, false);
+            lazy.rowBuilt.resize(stateId + 1, false);
+        }
 
-            LrParserCommand command;
+        if (stateId == 0) {
+            continue; // 0 号状态已经构建。
+        }
 
-            if (nextSymbol.type == grammar::SymbolType::NON_TERMINAL) {
-                command.type = LrParserCommandType::GOTO;
-            } else {
-                command.type = LrParserCommandType::SHIFT;
-            }
+        auto& state = states[stateId];
+        state.id = stateId;
+        state.expressions.clear();
 
-            command.target = transitionMap[state.id][nextSymbolId];
-            table.table[state.id][nextSymbolId] = command;
-            
+        for (size_t idx = 0; idx + 2 < values.size(); idx += 3) {
+            auto& exp = state.expressions.emplace_back();
+            exp.expressionId = values[idx];
+            exp.dotPos = values[idx + 1];
+            exp.paimonId = values[idx + 2];
+        }
+
+        lazy.kernelSizes[stateId] = state.expressions.size();
+
+        auto key = state.expressions;
+        sort(key.begin(), key.end(), __lr1ExpressionLess);
+        lazy.kernelStateMap[move(key)] = stateId;
+    }
+
+    for (auto& rowPair : partialTable->table) {
+        if (rowPair.first >= 0 && rowPair.first < int(lazy.rowBuilt.size())) {
+            lazy.table.table[rowPair.first] = rowPair.second;
+            lazy.rowBuilt[rowPair.first] = true;
         }
     }
 
+    return true;
+}
 
+LrParserCommand Lr1Grammar::getCommand(int stateId, int symbolId) {
+    
+    auto& lazy = *lazyContext;
+
+    if (stateId >= 0 && stateId < int(lazy.rowBuilt.size()) && !lazy.rowBuilt[stateId]) {
+        this->buildLazyRow(stateId);
+    }
+
+    return lazy.table.getCommand(stateId, symbolId);
+}
+
+void Lr1Grammar::exportLazyTable(LrParserTable& table) {
+
+    auto& lazy = *lazyContext;
+
+    table = lazy.table;
+    table.partial = true;
+    table.grammarFingerprint = this->getGrammarFingerprint();
+    table.stateKernels.clear();
+
+    for (auto& state : states) {
+        auto& values = table.stateKernels[state.id];
+        for (int idx = 0; idx < lazy.kernelSizes[state.id]; idx++) {
+            auto& exp = state.expressions[idx];
+            values.push_back(exp.expressionId);
+            values.push_back(exp.dotPos);
+            values.push_back(exp.paimonId);
+        }
+    }
+
+}
+
+uint64_t Lr1Grammar::getGrammarFingerprint() const {
+
+    Fnv1a hash;
+
+    for (auto& sym : symbolList) {
+        hash.update(sym.name).update(sym.id).update(sym.type)
+            .update(sym.tokenKind).update(sym.symbolKind)
+            .update(sym.precedence).update(sym.associativity);
+    }
+
+    for (auto& exp : flatExpressions) {
+        hash.update(exp.id).update(exp.targetSymbolId).update(exp.precedence)
+            .update(uint64_t(exp.rule.size()));
+
+        for (auto it : exp.rule) {
+            hash.update(it);
+        }
+    }
+
+    return hash.digest();
 }
 
 /* -------- 私有方法 -------- */
 
-// 暂无。
+void Lr1Grammar::prepare(
+    const grammar::Grammar& grammar,
+    unordered_map<int, unordered_set<int> >& firstCollection
+) {
+
+    // 清空原始数据。
+    this->states.clear();
+    this->transitionMap.clear();
+    this->flatExpressions.clear();
+    this->stats = Lr1BuildStats();
+
+    auto flattenBegin = __lr1Now();
+
+    // 拷贝。
+    this->symbolList = grammar.symbols;
+
+    // 提取表达式。
+    __lr1ExtractFlatExpressions(grammar, flatExpressions);
+
+    // 拓广。
+    this->entrySymbolId = __lr1ExtendGrammar(grammar.entryId, flatExpressions, symbolList);
+
+    // 引入 eof。
+    this->eofSymbolId = __lr1MakeEofSymbol(symbolList);
+
+    // 符号与产生式不再变化。整理成紧凑形式，供后续步骤及分析器使用。
+    this->compiledGrammar = make_shared<const grammar::CompiledGrammar>(
+        symbolList, flatExpressions
+    );
+
+    stats.flattenSeconds = __lr1SecondsSince(flattenBegin);
+
+    // 构造 first 集。
+    auto firstBegin = __lr1Now();
+    __lr1ConstructFirstCollection(*compiledGrammar, firstCollection);
+    stats.firstSeconds = __lr1SecondsSince(firstBegin);
+
+    // 构造初始状态。
+    auto closureBegin = __lr1Now();
+
+    __lr1MakeState0(
+        compiledGrammar->getExpressionsOf(entrySymbolId)[0], eofSymbolId, 
+        *compiledGrammar, firstCollection, states
+    );
+
+    stats.closureSeconds += __lr1SecondsSince(closureBegin);
+    stats.closureCount++;
+    stats.kernelItemCount++;
+
+}
+
+void Lr1Grammar::buildLazyRow(int stateId) {
+
+    auto& lazy = *lazyContext;
+
+    if (!lazy.stateCompleted[stateId]) {
+        auto closureBegin = __lr1Now();
+        __lr1CompleteState(states[stateId], *compiledGrammar, lazy.firstCollection);
+
+        stats.closureSeconds += __lr1SecondsSince(closureBegin);
+        stats.closureCount++;
+
+        lazy.stateCompleted[stateId] = true;
+    }
+
+    auto internBegin = __lr1Now();
+
+    vector< int > toBeViewedSymbols;
+    __lr1FindToBeViewedSymbols(states[stateId], *compiledGrammar, toBeViewedSymbols);
+
+    auto& transitions = transitionMap[stateId];
+
+    // 只登记转移目标的核心。目标状态的补全推迟到它的行被查询时。
+    for (auto symbolId : toBeViewedSymbols) {
+        vector< Lr1Expression > kernel;
+        __lr1TranslateKernel(states[stateId], kernel, symbolId, *compiledGrammar);
+
+        auto key = kernel;
+        sort(key.begin(), key.end(), __lr1ExpressionLess);
+
+        auto it = lazy.kernelStateMap.find(key);
+        if (it != lazy.kernelStateMap.end()) {
+            transitions[symbolId] = it->second;
+            continue;
+        }
+
+        int nextStateId = states.size();
+        states.emplace_back();
+        states.back().id = nextStateId;
+        states.back().expressions = move(kernel);
+
+        lazy.kernelSizes.push_back(states.back().expressions.size());
+        lazy.stateCompleted.push_back(false);
+        lazy.rowBuilt.push_back(false);
+        lazy.kernelStateMap[move(key)] = nextStateId;
+
+        transitions[symbolId] = nextStateId;
+        stats.kernelItemCount += states.back().expressions.size();
+    }
+
+    stats.internSeconds += __lr1SecondsSince(internBegin);
+    stats.transitionCount += toBeViewedSymbols.size();
+
+    auto fillBegin = __lr1Now();
+
+    __lr1FillStateRow(
+        states[stateId], *compiledGrammar, symbolList, entrySymbolId, 
+        transitions, lazy.table, stats
+    );
+
+    stats.fillSeconds += __lr1SecondsSince(fillBegin);
+
+    lazy.rowBuilt[stateId] = true;
+}
+
@@ -12,8 +12,11 @@
 #pragma once
 
 #include <core/Grammar.h>
+#include <core/CompiledGrammar.h>
 #include <core/LrParserTable.h>
 #include <vector>
+#include <memory>
+#include <unordered_set>
 
 namespace tc::lr1grammar {
 
@@ -76,19 +79,91 @@ namespace tc::lr1grammar {
     };
 
 
+    /**
+     * 状态集构建方式。
+     */
+    enum class Lr1BuildMode {
+        /** 一次性构建全部状态。 */
+        EAGER,
+
+        /** 仅在分析器查询到某个状态时，才构建该状态的行。 */
+        LAZY
+    };
+
+    struct Lr1LazyContext;
+
+    /**
+     * 构建统计。用于评估文法修改对构建时间与分析表规模的影响。
+     * 时间为墙上时间，单位为秒。懒构建时随行的构建累加。
+     */
+    struct Lr1BuildStats {
+
+        /** 提取产生式、拓广文法并整理紧凑文法。 */
+        double flattenSeconds = 0;
+
+        /** 构造 first 集。 */
+        double firstSeconds = 0;
+
+        /** 求闭包（补全状态）。 */
+        double closureSeconds = 0;
+
+        /** 计算转移核心并登记状态。 */
+        double internSeconds = 0;
+
+        /** 填写 Action Goto 表。 */
+        double fillSeconds = 0;
+
+        /** 求闭包的次数，即补全的状态数量。 */
+        long long closureCount = 0;
+
+        /** 计算转移核心的次数。 */
+        long long transitionCount = 0;
+
+        /** 核心项目总数。 */
+        long long kernelItemCount = 0;
+
+        /** 按优先级与结合性解决的移进-归约冲突。每个格子记一次。 */
+        int shiftReduceResolved = 0;
+
+        /** 缺少优先级声明的移进-归约冲突。每个格子记一次，保留后填写的项目。 */
+        int shiftReduceUnresolved = 0;
+
+        /** 被 %nonassoc 判定为错误的格子。 */
+        int nonassocErrors = 0;
+
+        /** 归约-归约冲突。保留后填写的项目。 */
+        int reduceReduce = 0;
+    };
+
     /**
      * LR1 文法。
      */
     class Lr1Grammar {
     public: // 公有方法。
-        Lr1Grammar(const grammar::Grammar& grammar);
+        Lr1Grammar(const grammar::Grammar& grammar, int workerCount = 0);
+
+        /**
+         * @param grammar 输入的文法。
+         * @param mode 构建方式。
+         * @param partialTable 懒构建时，用于恢复的不完整表。详见 loadLazily。
+         */
+        Lr1Grammar(
+            const grammar::Grammar& grammar, 
+            Lr1BuildMode mode, 
+            const LrParserTable* partialTable = nullptr
+        );
+
+        ~Lr1Grammar();
 
         /**
          * 加载文法。通过输入的语法，构建 LR1 文法。
          * 
+         * 状态集按轮次并行展开。状态编号只与文法有关，与线程数量无关。
+         * 
          * @param grammar 输入的文法。要求每个符号已经唯一地编号。
+         * @param workerCount 工作线程数量。不大于 0 时，使用硬件支持的并发线程数。
          */
-        void load(const grammar::Grammar& grammar);
+        void load(const grammar::Grammar& grammar, int workerCount = 0);
 
         /**
          * 根据本 LR1 文法，构建 Action Goto 表。
@@ -97,6 +172,49 @@ namespace tc::lr1grammar {
          */
         void buildParserTable(LrParserTable& table);
 
+        /**
+         * 以懒构建方式加载文法。此时只构建 0 号状态。
+         * 其他状态在 getCommand 第一次查询到时才补全，并登记其转移目标的核心项目。
+         * 
+         * @param grammar 输入的文法。要求每个符号已经唯一地编号。
+         * @param partialTable 此前通过 exportLazyTable 保存的不完整表。可以为空。
+         *                     文法与该表不一致时，忽略该表。
+         * @return 是否从 partialTable 恢复了已构建的部分。
+         */
+        bool loadLazily(
+            const grammar::Grammar& grammar, 
+            const LrParserTable* partialTable = nullptr
+        );
+
+        /**
+         * 查询 Action Goto 表。仅用于懒构建模式。
+         * 若状态所在的行尚未构建，则先构建该行。
+         * 
+         * @param stateId 状态 id。
+         * @param symbolId 符号 id。
+         * @return 分析器指令。对于空白位置，会返回 Error 指令。
+         */
+        LrParserCommand getCommand(int stateId, int symbolId);
+
+        /**
+         * 导出懒构建模式下已经构建的行，以及所有已发现状态的核心项目。
+         * 导出的表被标记为不完整，可以通过 loadLazily 恢复。
+         * 
+         * @param table 导出结果。
+         */
+        void exportLazyTable(LrParserTable& table);
+
+        /**
+         * 是否以懒构建方式加载。
+         */
+        bool isLazy() { return this->lazyContext != nullptr; }
+
+        /**
+         * 文法的指纹。符号、产生式、优先级或结合性有任何不同，指纹就不同。
+         * 仅在加载文法后有效。
+         */
+        uint64_t getGrammarFingerprint() const;
+
     public: // getters
         const std::vector< grammar::Symbol >& getSymbolList() {
             return this->symbolList;
@@ -106,7 +224,21 @@ namespace tc::lr1grammar {
             return this->flatExpressions;
         }
 
+        /**
+         * 紧凑形式的文法。包含拓广产生的符号与产生式。
+         */
+        const std::shared_ptr< const grammar::CompiledGrammar >& getCompiledGrammar() {
+            return this->compiledGrammar;
+        }
+
         int getEntrySymbolId() { return this->entrySymbolId; }
+
+        /**
+         * 已发现的状态。懒构建时，尚未补全的状态只含核心项目。
+         */
+        const std::vector< State >& getStates() { return this->states; }
+
+        const Lr1BuildStats& getStats() { return this->stats; }
         int getEofSymbolId() { return this->eofSymbolId; }
 
     protected: // 私有成员。
@@ -136,6 +268,11 @@ namespace tc::lr1grammar {
          */
         std::vector< grammar::FlatExpression > flatExpressions;
 
+        /**
+         * symbolList 与 flatExpressions 的紧凑形式。构建分析表时使用，并随表共享给分析器。
+         */
+        std::shared_ptr< const grammar::CompiledGrammar > compiledGrammar;
+
         /**
          * 文法进入符号的 id。该符号应该是拓广后产生的。
          */
@@ -146,12 +283,35 @@ namespace tc::lr1grammar {
          */
         int eofSymbolId = -1;
 
+        /**
+         * 懒构建上下文。非懒构建模式下为空。
+         */
+        std::unique_ptr< Lr1LazyContext > lazyContext;
+
+        /**
+         * 构建统计。
+         */
+        Lr1BuildStats stats;
+
     protected: // 私有方法。
-        // 暂无。
+
+        /**
+         * 加载文法的公共步骤：提取产生式，拓广文法，构造紧凑文法与 first 集，
+         * 并构造 0 号状态。
+         */
+        void prepare(
+            const grammar::Grammar& grammar,
+            std::unordered_map<int, std::unordered_set<int> >& firstCollection
+        );
+
+        /**
+         * 懒构建模式下，构建某个状态的行。
+         */
+        void buildLazyRow(int stateId);
 
     private:
-        Lr1Grammar() {}
-        Lr1Grammar(const Lr1Grammar&) {}
+        Lr1Grammar() = delete;
+        Lr1Grammar(const Lr1Grammar&) = delete;
         const Lr1Grammar& operator = (const Lr1Grammar&) { return *this; }
     };
 
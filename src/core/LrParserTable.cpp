@@ -10,15 +10,18 @@
 */
 
 #include <core/LrParserTable.h>
+#include <utils/Fnv1a.h>
 
 using namespace std;
 using namespace tc;
 
-LrParserCommand LrParserTable::getCommand(int stateId, int symbolId) {
-    if (table.count(stateId)) {
-        auto& row = table[stateId];
-        if (row.count(symbolId)) {
-            return row[symbolId];
+LrParserCommand LrParserTable::getCommand(int stateId, int symbolId) const {
+    auto rowIt = table.find(stateId);
+    if (rowIt != table.end()) {
+        auto& row = rowIt->second;
+        auto cellIt = row.find(symbolId);
+        if (cellIt != row.end()) {
+            return cellIt->second;
         }
     }
 
@@ -28,6 +31,56 @@ LrParserCommand LrParserTable::getCommand(int stateId, int symbolId) {
     return err;
 }
 
+void LrParserTable::buildSymbolIndex() {
+    tokenKindSymbolIds.assign(size_t(TokenKind::NUM_TOKENS), -1);
+
+    for (auto& symbol : symbolList) {
+        if (symbol.type == grammar::SymbolType::NON_TERMINAL) {
+            continue;
+        }
+
+        auto idx = static_cast<size_t>(symbol.tokenKind);
+        if (idx < tokenKindSymbolIds.size()) {
+            tokenKindSymbolIds[idx] = symbol.id;
+        }
+    }
+}
+
+void LrParserTable::compileGrammar() {
+    compiledGrammar = make_shared<const grammar::CompiledGrammar>(symbolList, flatExpressions);
+}
+
+uint64_t LrParserTable::fingerprint() const {
+
+    Fnv1a hash;
+
+    hash.update(primaryStateId).update(partial);
+
+    for (auto& sym : symbolList) {
+        hash.update(sym.name).update(sym.id).update(sym.type)
+            .update(sym.tokenKind).update(sym.symbolKind);
+    }
+
+    for (auto& exp : flatExpressions) {
+        hash.update(exp.targetSymbolId).update(uint64_t(exp.rule.size()));
+        for (auto it : exp.rule) {
+            hash.update(it);
+        }
+    }
+
+    // 单元格在哈希表内的顺序不固定。各单元格单独哈希后相加，与顺序无关。
+    uint64_t cellSum = 0;
+
+    for (auto& rowPair : table) {
+        for (auto& cellPair : rowPair.second) {
+            cellSum += Fnv1a().update(rowPair.first).update(cellPair.first)
+                .update(cellPair.second.type).update(cellPair.second.target).digest();
+        }
+    }
+
+    return hash.update(cellSum).digest();
+}
+
 void LrParserTable::dump(ostream& out) {
 
     // primary state id
@@ -49,6 +102,20 @@ void LrParserTable::dump(ostream& out) {
         out << "end" << endl;
     }
 
+    // 懒构建的不完整表
+    if (partial) {
+        out << "partial" << endl;
+        out << "gfp " << grammarFingerprint << endl;
+
+        for (auto& kernelPair : stateKernels) {
+            out << "ks " << kernelPair.first << " ";
+            for (auto it : kernelPair.second) {
+                out << it << " ";
+            }
+            out << "end" << endl;
+        }
+    }
+
     // action goto 表
     for (auto& rowPair : table) {
         for (auto& cellPair : rowPair.second) {
@@ -70,6 +137,9 @@ int LrParserTable::load(istream& in, ostream& msgOut) {
     symbolList.clear();
     flatExpressions.clear();
     table.clear();
+    partial = false;
+    stateKernels.clear();
+    grammarFingerprint = 0;
 
     string cmd;
 
@@ -138,6 +208,39 @@ int LrParserTable::load(istream& in, ostream& msgOut) {
 
                 table[stoi(r)][stoi(c)] = command;
 
+            } else if (cmd == "partial") {
+
+                partial = true;
+
+            } else if (cmd == "gfp") {
+
+                string fp;
+                in >> fp;
+
+                grammarFingerprint = stoull(fp);
+
+            } else if (cmd == "ks") {
+
+                string i;
+                in >> i;
+
+                auto& kernel = stateKernels[stoi(i)];
+                string val;
+                while (true) {
+                    in >> val;
+                    if (val == "end") {
+                        break;
+                    }
+
+                    if (!__lrStreamIsHealthy(in)) {
+                        msgOut << "failed to load parser table." << endl;
+                        msgOut << "ks kernel not closed." << endl;
+                        return -1;
+                    }
+
+                    kernel.push_back(stoi(val));
+                }
+
             } else {
 
                 msgOut << "[warning] strange cmd: " << cmd << endl;
@@ -154,6 +257,74 @@ int LrParserTable::load(istream& in, ostream& msgOut) {
     
     }
 
+    buildSymbolIndex();
+    compileGrammar();
 
     return 0;
 } // int LrParserTable::load(istream& in, ostream& msgOut) 
+
+int LrParserTable::load(const LrParserTableImage& image) {
+
+    primaryStateId = image.primaryStateId;
+    partial = false;
+    stateKernels.clear();
+    grammarFingerprint = 0;
+    table.clear();
+
+    symbolList.clear();
+    symbolList.reserve(image.symbolCount);
+    for (int i = 0; i < image.symbolCount; i++) {
+        auto& entry = image.symbols[i];
+
+        symbolList.emplace_back();
+        auto& sym = symbolList.back();
+        sym.id = i;
+        sym.name = entry.name;
+        sym.type = entry.type;
+        sym.tokenKind = entry.tokenKind;
+        sym.symbolKind = entry.symbolKind;
+    }
+
+    flatExpressions.clear();
+    flatExpressions.reserve(image.expressionCount);
+    for (int i = 0; i < image.expressionCount; i++) {
+        auto& entry = image.expressions[i];
+
+        flatExpressions.emplace_back();
+        auto& exp = flatExpressions.back();
+        exp.id = i;
+        exp.targetSymbolId = entry.targetSymbolId;
+        exp.rule.assign(
+            image.ruleSymbols + entry.ruleBegin, 
+            image.ruleSymbols + entry.ruleBegin + entry.ruleLength
+        );
+    }
+
+    // ACTION 与 GOTO 存在同一张表内。
+    table.reserve(image.stateCount);
+    for (int stateId = 0; stateId < image.stateCount; stateId++) {
+        
+        int actionBegin = image.actionRowBegins[stateId];
+        int actionEnd = image.actionRowBegins[stateId + 1];
+        int gotoBegin = image.gotoRowBegins[stateId];
+        int gotoEnd = image.gotoRowBegins[stateId + 1];
+
+        auto& row = table[stateId];
+        row.reserve(actionEnd - actionBegin + gotoEnd - gotoBegin);
+
+        for (int i = actionBegin; i < actionEnd; i++) {
+            auto& cell = image.actionCells[i];
+            row[cell.symbolId] = { cell.type, cell.target };
+        }
+
+        for (int i = gotoBegin; i < gotoEnd; i++) {
+            auto& cell = image.gotoCells[i];
+            row[cell.symbolId] = { cell.type, cell.target };
+        }
+    }
+
+    buildSymbolIndex();
+    compileGrammar();
+
+    return 0;
+}
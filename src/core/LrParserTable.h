@@ -12,10 +12,14 @@
 #pragma once
 
 #include <vector>
+#include <map>
 #include <unordered_map>
+#include <cstdint>
 
 #include <core/Grammar.h>
+#include <core/CompiledGrammar.h>
 #include <iostream>
+#include <memory>
 
 namespace tc {
 
@@ -74,7 +78,60 @@ namespace tc {
      * 
      *   tc [r] [c] [ty] [tar]: 添加一条指令。
      *                      r -> row, c -> col, ty -> command type, tar -> target
+     * 
+     *   partial: 标记本表不完整（由懒构建产生）。
+     *   gfp [x]: 生成本表的文法的指纹。仅用于不完整的表。
+     *   ks [i] (kernel values...) end: 添加一个状态的核心项目。仅用于不完整的表。
+     *                      i -> state id
+     *                      kernel values 每 3 个值描述一个项目：
+     *                        expression id, dot pos, paimon id
+     */
+    /**
+     * 以静态数组描述的分析表。用于把分析表编译进程序。
+     * 
+     * 所有数组均由构建期生成的头文件以 constexpr 定义，本结构只保存指针。
+     * 第 i 个状态的 ACTION 项为 actionCells[actionRowBegins[i], actionRowBegins[i + 1])，
+     * GOTO 项同理。
      */
+    struct LrParserTableImage {
+
+        struct SymbolEntry {
+            const char* name;
+            grammar::SymbolType type;
+            TokenKind tokenKind;
+            SymbolKind symbolKind;
+        };
+
+        struct ExpressionEntry {
+            int targetSymbolId;
+
+            /** 产生式在 ruleSymbols 内的起始下标。 */
+            int ruleBegin;
+            int ruleLength;
+        };
+
+        struct CellEntry {
+            int symbolId;
+            LrParserCommandType type;
+            int target;
+        };
+
+        int primaryStateId;
+
+        const SymbolEntry* symbols;
+        int symbolCount;
+
+        const ExpressionEntry* expressions;
+        int expressionCount;
+        const int* ruleSymbols;
+
+        int stateCount;
+        const int* actionRowBegins;
+        const CellEntry* actionCells;
+        const int* gotoRowBegins;
+        const CellEntry* gotoCells;
+    };
+
     struct LrParserTable {
 
         /**
@@ -98,6 +155,63 @@ namespace tc {
          */
         std::unordered_map<int, std::unordered_map<int, LrParserCommand>> table;
 
+        /**
+         * 本表是否不完整。懒构建得到的表只包含已被查询过的行，
+         * 不能直接用于分析，需要交给 Lr1Grammar::loadLazily 继续构建。
+         */
+        bool partial = false;
+
+        /**
+         * 各状态的核心项目。仅不完整的表使用。
+         * 状态 id -> 项目列表。每 3 个值描述一个项目：expression id, dot pos, paimon id。
+         */
+        std::map<int, std::vector<int> > stateKernels;
+
+        /**
+         * 生成本表的文法的指纹。仅不完整的表使用。
+         * 由 Lr1Grammar 计算，包括不保存到 tcpt 文件的优先级与结合性。
+         * 恢复时文法的指纹不同，则整张表作废。
+         */
+        uint64_t grammarFingerprint = 0;
+
+        /**
+         * symbolList 与 flatExpressions 的紧凑形式。分析器归约时使用。
+         * 
+         * 由 Lr1Grammar 构建的表与文法共享同一份；从文件或静态数组加载时
+         * 由 compileGrammar 生成。不保存到 tcpt 文件。
+         */
+        std::shared_ptr< const grammar::CompiledGrammar > compiledGrammar;
+
+        /**
+         * 根据符号表与产生式列表，生成 compiledGrammar。
+         * 修改符号表或产生式列表后需要重新调用。
+         */
+        void compileGrammar();
+
+        /**
+         * token 类型 -> 终结符 id。以 TokenKind 的值为下标。
+         * 文法中不存在的 token 类型对应 -1。
+         * 
+         * 由 buildSymbolIndex 根据符号表生成，不保存到 tcpt 文件。
+         */
+        std::vector<int> tokenKindSymbolIds;
+
+        /**
+         * 根据符号表，生成 tokenKindSymbolIds。
+         * 修改符号表后需要重新调用。
+         */
+        void buildSymbolIndex();
+
+        /**
+         * 获取 token 类型对应的终结符 id。
+         * 
+         * @return 终结符 id。文法中不存在该类型时，返回 -1。
+         */
+        int getSymbolIdByTokenKind(TokenKind kind) const {
+            auto idx = static_cast<size_t>(kind);
+            return idx < tokenKindSymbolIds.size() ? tokenKindSymbolIds[idx] : -1;
+        }
+
         /**
          * 获取转移指令。
          * 
@@ -105,7 +219,13 @@ namespace tc {
          * @param symbolId 即将遇到的符号的 id。
          * @return 转移指令。对于空白位置，会返回 Error 指令。
          */
-        LrParserCommand getCommand(int stateId, int symbolId);
+        LrParserCommand getCommand(int stateId, int symbolId) const;
+
+        /**
+         * 本表的指纹。符号表、表达式表或任意一个单元格不同，指纹就不同。
+         * 与单元格的存储顺序无关。可用于判断依赖本表的缓存是否仍然有效。
+         */
+        uint64_t fingerprint() const;
 
         /**
          * 导出本表，以便后续加载。
@@ -123,6 +243,13 @@ namespace tc {
          * @return 加载结果。返回 0 表示加载成功。失败会返回非 0 值。
          */
         int load(std::istream& in, std::ostream& msgOut);
+
+        /**
+         * 从编译进程序的静态数组加载分析表。不访问文件系统。
+         * 
+         * @return 加载结果。返回 0 表示加载成功。
+         */
+        int load(const LrParserTableImage& image);
     };
 
 }
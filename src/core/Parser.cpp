@@ -9,6 +9,13 @@
 */
 
 #include <core/Parser.h>
+#include <core/Lr1Grammar.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <thread>
 
 using namespace std;
 using namespace tc;
@@ -21,45 +28,602 @@ Parser::Parser(const LrParserTable& parserTable) {
     this->loadParserTable(parserTable);
 }
 
+Parser::Parser(shared_ptr<const LrParserTable> parserTable) {
+    this->loadParserTable(move(parserTable));
+}
+
 void Parser::loadParserTable(const LrParserTable& parserTable) {
-    this->parserTable = parserTable;
+    this->loadParserTable(make_shared<const LrParserTable>(parserTable));
+}
+
+void Parser::loadParserTable(shared_ptr<const LrParserTable> parserTable) {
+    this->parserTable = move(parserTable);
+    this->lazyGrammar = nullptr;
+
+    // 自行构造的表可能没有紧凑文法。此时为本分析器生成一份。
+    if (this->parserTable == nullptr) {
+        this->compiledGrammar = nullptr;
+    } else if (this->parserTable->compiledGrammar) {
+        this->compiledGrammar = this->parserTable->compiledGrammar;
+    } else {
+        this->compiledGrammar = make_shared<const grammar::CompiledGrammar>(
+            this->parserTable->symbolList, this->parserTable->flatExpressions
+        );
+    }
+}
+
+void Parser::loadLazyGrammar(lr1grammar::Lr1Grammar* lazyGrammar) {
+    this->lazyGrammar = lazyGrammar;
+
+    if (lazyGrammar != nullptr) {
+        // 语法树节点引用分析表内的符号表，因此需要将符号表拷贝过来。
+        // 这样即使文法先于语法树释放，语法树仍然可用。
+        auto table = make_shared<LrParserTable>();
+        table->primaryStateId = 0;
+        table->symbolList = lazyGrammar->getSymbolList();
+        table->flatExpressions = lazyGrammar->getFlatExpressions();
+        table->compiledGrammar = lazyGrammar->getCompiledGrammar();
+        table->buildSymbolIndex();
+        
+        this->parserTable = move(table);
+        this->compiledGrammar = lazyGrammar->getCompiledGrammar();
+    }
+}
+
+void Parser::setUnitReductionCollapse(bool enable, const vector<SymbolKind>& keepKinds) {
+    keepSymbolKinds.clear();
+
+    if (!enable) {
+        return;
+    }
+
+    keepSymbolKinds.resize(size_t(SymbolKind::NUM_SYMBOLS), false);
+    for (auto kind : keepKinds) {
+        keepSymbolKinds[size_t(kind)] = true;
+    }
+}
+
+void Parser::setReduceListener(function<void (AstNode*)> listener) {
+    this->reduceListener = move(listener);
+}
+
+int Parser::parse(
+    vector< Token >& tokens,
+    vector< ParserParseError >& errorList
+) {
+    return this->parse(tokens, nullptr, errorList);
 }
 
 int Parser::parse(
     vector< Token >& tokens,
+    const function<bool (vector< Token >&)>& fetchTokens,
     vector< ParserParseError >& errorList
 ) {
 
     this->clear();
 
-    // 状态栈。
+    if (parserTable == nullptr) {
+        errorList.emplace_back();
+        auto& err = errorList.back();
+        err.tokenRelated = false;
+        err.msg = "parser table not loaded.";
+        
+        return 1;
+    }
+
+    // 语法树共同持有分析表内的符号表。即使 parser 之后换了表，语法树仍然可用。
+    astContext.bind(
+        shared_ptr< const vector< grammar::Symbol > >(parserTable, &parserTable->symbolList), 
+        &tokens
+    );
+    astContext.bindStreamTokens(streamTokens);
+
+    tokenShiftStates.clear();
+
+    if (actions != nullptr) {
+        
+        // 语法制导翻译。按名称把回调绑定到当前表的产生式上。
+        vector< string > unresolved;
+        if (actions->bind(*parserTable, unresolved)) {
+            for (auto& production : unresolved) {
+                errorList.emplace_back();
+                auto& err = errorList.back();
+                err.tokenRelated = false;
+                err.msg = "production not found in grammar: " + production;
+            }
+            
+            return unresolved.size();
+        }
+
+        actions->begin(tokens);
+
+    } else {
+        tokenShiftStates.reserve(tokens.size());
+    }
+
+    ParserSession session(*this, tokens, fetchTokens, errorList);
+
+    int errorCount = this->runSession(session);
+    astRoot = session.getRoot();
+
+    parsedTokenCount = astRoot != nullptr ? tokens.size() : 0;
+
+    return errorCount;
+}
+
+int Parser::runSession(ParserSession& session) {
+
+    // 直接编码的分析器是针对完整的表生成的。懒构建时不使用。
+    if (profile != nullptr) {
+        return this->parseByTable<true>(session);
+    } else if (directParser != nullptr && lazyGrammar == nullptr) {
+        return directParser(session);
+    } else {
+        return this->parseByTable<false>(session);
+    }
+}
+
+/**
+ * 找出各个外部声明的结束位置。
+ * 
+ * 外部声明结束于花括号与圆括号之外的 ';'，或者函数体的 '}'。
+ * 函数体指紧跟在 ')' 之后的最外层花括号。struct、enum 与初始化列表的 '}' 
+ * 之后还有声明的其余部分，不能在那里切分。
+ * 
+ * @param ends 各声明之后第一个 token 的下标。
+ */
+static void __tcFindDeclarationEnds(const vector< Token >& tokens, vector< int >& ends) {
+    
+    int braceDepth = 0;
+    int parenDepth = 0;
+    bool inFunctionBody = false;
+    auto prevKind = TokenKind::unknown;
+
+    for (int idx = 0; idx < int(tokens.size()); idx++) {
+        
+        auto kind = tokens[idx].kind;
+
+        if (kind == TokenKind::multi_line_comment || kind == TokenKind::single_line_comment) {
+            continue;
+        }
+
+        if (kind == TokenKind::eof) {
+            break;
+        }
+
+        switch (kind) {
+            case TokenKind::l_paren:
+                parenDepth++;
+                break;
+
+            case TokenKind::r_paren:
+                parenDepth--;
+                break;
+
+            case TokenKind::l_brace:
+                if (braceDepth == 0) {
+                    inFunctionBody = prevKind == TokenKind::r_paren;
+                }
+                
+                braceDepth++;
+                break;
+
+            case TokenKind::r_brace:
+                braceDepth--;
+                if (braceDepth == 0 && parenDepth == 0 && inFunctionBody) {
+                    ends.push_back(idx + 1);
+                }
+
+                break;
+
+            case TokenKind::semi:
+                if (braceDepth == 0 && parenDepth == 0) {
+                    ends.push_back(idx + 1);
+                }
+
+                break;
+
+            default:
+                break;
+        }
+
+        prevKind = kind;
+    }
+}
+
+int Parser::parseParallel(
+    vector< Token >& tokens,
+    vector< ParserParseError >& errorList,
+    int threadCount
+) {
+
+    if (threadCount <= 0) {
+        threadCount = max(1u, thread::hardware_concurrency());
+    }
+
+    // 分析过程中不能回调监听器：它并不要求线程安全，且需要按顺序收到节点。
+    if (threadCount == 1 || parserTable == nullptr || lazyGrammar != nullptr 
+        || reduceListener || actions || profile || tokens.empty() || tokens.back().kind != TokenKind::eof
+    ) {
+        return this->parse(tokens, errorList);
+    }
+
+    auto& table = *parserTable;
+
+    // translation_unit -> external_declaration
+    // translation_unit -> translation_unit external_declaration
+    int unitExpressionId = -1;
+    int chainExpressionId = -1;
+
+    auto kindOf = [&table] (int symbolId) { return table.symbolList[symbolId].symbolKind; };
+
+    auto& grammar = *compiledGrammar;
+
+    for (int expressionId = 0; expressionId < grammar.getExpressionCount(); expressionId++) {
+        const int* rule = grammar.getRhs(expressionId);
+        const int ruleSize = grammar.getRhsLength(expressionId);
+
+        if (kindOf(grammar.getLhs(expressionId)) != SymbolKind::translation_unit) {
+            continue;
+        }
+
+        if (ruleSize == 1 && kindOf(rule[0]) == SymbolKind::external_declaration) {
+            unitExpressionId = expressionId;
+        } else if (ruleSize == 2 
+            && kindOf(rule[0]) == SymbolKind::translation_unit 
+            && kindOf(rule[1]) == SymbolKind::external_declaration
+        ) {
+            chainExpressionId = expressionId;
+        }
+    }
+
+    int eofSymbolId = table.getSymbolIdByTokenKind(TokenKind::eof);
+
+    if (unitExpressionId < 0 || chainExpressionId < 0 || eofSymbolId < 0) {
+        return this->parse(tokens, errorList);
+    }
+
+    // 切分。每个线程大约分到 4 段，使各线程的工作量较为均衡。
+    
+    vector< int > declarationEnds;
+    __tcFindDeclarationEnds(tokens, declarationEnds);
+
+    int eofIdx = tokens.size() - 1;
+    int chunkSize = eofIdx / (threadCount * 4) + 1;
+
+    // 每段 [first, second)。最后一段延伸到 eof，包含末尾的注释等。
+    vector< pair< int, int > > chunks;
+    int chunkBegin = 0;
+
+    for (size_t idx = 0; idx + 1 < declarationEnds.size(); idx++) {
+        int end = declarationEnds[idx];
+        if (end - chunkBegin >= chunkSize) {
+            chunks.emplace_back(chunkBegin, end);
+            chunkBegin = end;
+        }
+    }
+
+    chunks.emplace_back(chunkBegin, eofIdx);
+
+    if (chunks.size() < 2) {
+        return this->parse(tokens, errorList);
+    }
+
+    this->clear();
+
+    astContext.bind(
+        shared_ptr< const vector< grammar::Symbol > >(parserTable, &parserTable->symbolList), 
+        &tokens
+    );
+
+    // 提前分配好，各线程只写入各自 token 的位置。
+    tokenShiftStates.assign(tokens.size(), -1);
+
+    int chunkCount = chunks.size();
+
+    vector< AstNodeAllocator* > allocators;
+    for (int chunkIdx = 0; chunkIdx < chunkCount; chunkIdx++) {
+        allocators.push_back(&astContext.newAllocator());
+    }
+
+    vector< AstNode* > chunkRoots(chunkCount, nullptr);
+    vector< int > chunkErrorCounts(chunkCount, 0);
+    atomic< int > nextChunkIdx { 0 };
+
+    auto worker = [&] () {
+        vector< ParserParseError > chunkErrors;
+
+        while (true) {
+            int chunkIdx = nextChunkIdx.fetch_add(1, memory_order_relaxed);
+            if (chunkIdx >= chunkCount) {
+                return;
+            }
+
+            ParserSession session(*this, tokens, nullptr, chunkErrors);
+            session.setAllocator(*allocators[chunkIdx]);
+            session.limitTokens(chunks[chunkIdx].first, chunks[chunkIdx].second, eofSymbolId);
+
+            chunkErrorCounts[chunkIdx] = this->runSession(session);
+            chunkRoots[chunkIdx] = session.getRoot();
+        }
+    };
+
+    vector< thread > threads;
+    for (int threadIdx = 1; threadIdx < min(threadCount, chunkCount); threadIdx++) {
+        threads.emplace_back(worker);
+    }
+
+    worker();
+
+    for (auto& it : threads) {
+        it.join();
+    }
+
+    for (int chunkIdx = 0; chunkIdx < chunkCount; chunkIdx++) {
+        if (chunkErrorCounts[chunkIdx] != 0 || chunkRoots[chunkIdx] == nullptr) {
+            // 切分位置不对，或者源码本身有错。由顺序分析给出准确的报错位置。
+            return this->parse(tokens, errorList);
+        }
+    }
+
+    // 取出各段的外部声明。每段是一条左递归的 translation_unit 链。
+
+    vector< AstNode* > declarations;
+
+    for (auto node : chunkRoots) {
+        size_t first = declarations.size();
+
+        while (node->symbolKind() == SymbolKind::translation_unit) {
+            if (node->children.size() == 2) {
+                declarations.push_back(node->children[1]);
+            }
+
+            node = node->children[0];
+        }
+
+        declarations.push_back(node);
+        reverse(declarations.begin() + first, declarations.end());
+    }
+
+    // 按顺序重新串成一条链。与顺序分析的归约过程保持一致。
+
+    auto link = [this] (int expressionId, AstNode** children, int count) {
+        AstNode* node = astContext.newNode(
+            compiledGrammar->getLhs(expressionId), children[0]->tokenIdx
+        );
+        node->children = astContext.newChildren(count);
+
+        for (int childIdx = 0; childIdx < count; childIdx++) {
+            children[childIdx]->mother = node;
+            node->children[childIdx] = children[childIdx];
+        }
+
+        return node;
+    };
+
+    AstNode* unit = declarations[0];
+    
+    bool collapseUnit = !keepSymbolKinds.empty() 
+        && !keepSymbolKinds[size_t(SymbolKind::translation_unit)]
+        && unit->symbolType() == grammar::SymbolType::NON_TERMINAL;
+
+    if (collapseUnit) {
+        unit->mother = nullptr;
+    } else {
+        unit = link(unitExpressionId, &declarations[0], 1);
+    }
+
+    for (size_t idx = 1; idx < declarations.size(); idx++) {
+        AstNode* children[] = { unit, declarations[idx] };
+        unit = link(chainExpressionId, children, 2);
+    }
+
+    unit->mother = nullptr;
+    astRoot = unit;
+    parsedTokenCount = tokens.size();
+
+    return 0;
+}
+
+int Parser::reparse(
+    vector< Token >& tokens,
+    const TokenEdit& edit,
+    vector< ParserParseError >& errorList
+) {
+
+    int newTokenCount = tokens.size();
+
+    bool editValid = edit.begin >= 0 
+        && edit.begin <= edit.oldEnd && edit.oldEnd <= parsedTokenCount
+        && edit.begin <= edit.newEnd && edit.newEnd <= newTokenCount
+        && edit.newEnd - edit.oldEnd == newTokenCount - parsedTokenCount;
+
+    // 无法复用时，退回完整分析。
+    if (astRoot == nullptr || parserTable == nullptr || !keepSymbolKinds.empty() 
+        || actions || !editValid
+    ) {
+        return this->parse(tokens, errorList);
+    }
+
+    AstNode* oldRoot = astRoot;
+    astRoot = nullptr;
+
+    // 旧树的节点保留原来的 token 下标，由上下文映射到新列表。
+    astContext.applyTokenEdit(&tokens, parsedTokenCount, edit);
+    tokenShiftStates.resize(astContext.getVirtualTokenCount(newTokenCount), -1);
+    parsedTokenCount = 0;
+
+    auto& table = *parserTable;
+    auto& grammar = *compiledGrammar;
+
+    auto getCommand = [this, &table] (int stateId, int symbolId) {
+        return lazyGrammar 
+            ? lazyGrammar->getCommand(stateId, symbolId)
+            : table.getCommand(stateId, symbolId);
+    };
+
+    ParserSession session(*this, tokens, nullptr, errorList);
+
     vector< int > states;
+    states.push_back(table.primaryStateId);
 
-    // 符号栈。
-    vector< AstNode* > nodes;
+    /*
+        待复用的旧子树。栈顶是输入中最靠前的一棵，整个栈按顺序覆盖旧树尚未处理的部分。
+        
+        当待进入 token 即将被移进时，检查栈顶子树：
+          从该 token 开始、完整位于编辑范围之外、其后的 token 未被编辑、
+          且其第一个 token 当初被移进时的状态与当前状态相同 —— 则整体移进。
+          否则拆成孩子继续尝试。已经越过或被删除的终结符直接丢弃。
+    */
+    vector< AstNode* > rightStack;
+    rightStack.push_back(oldRoot);
+
+    int eofIdx = newTokenCount - 1;
+
+    // 旧节点在新列表内的起始位置。已被删除时为 -1。
+    auto startOf = [this] (AstNode* node) {
+        return node->tokenIdx < 0 ? -1 : astContext.toRealTokenIdx(node->tokenIdx);
+    };
+
+    while (true) {
+
+        auto symbolId = session.lookahead();
+
+        if (symbolId == ParserSession::END_OF_TOKENS) {
+            return session.unexpectedEnd();
+        }
+
+        auto command = getCommand(states.back(), symbolId);
+
+        if (command.type == LrParserCommandType::ERROR) {
+            return session.unexpectedToken();
+        }
+
+        if (command.type == LrParserCommandType::ACCEPT) {
+            int errorCount = session.accept();
+            astRoot = session.getRoot();
+            parsedTokenCount = newTokenCount;
+            return errorCount;
+        }
+
+        if (command.type == LrParserCommandType::GOTO) {
+            return session.internalError("unexpected command GOTO.");
+        }
+
+        if (command.type == LrParserCommandType::SHIFT) {
+
+            int tokenIdx = session.getTokenIdx();
+            bool reused = false;
+
+            while (!rightStack.empty()) {
+                AstNode* node = rightStack.back();
+                int start = startOf(node);
+
+                if (start > tokenIdx) {
+                    break; // 子树在更右侧。
+                }
+
+                if (start == tokenIdx) {
+
+                    if (node->symbolType() == grammar::SymbolType::TERMINAL) {
+                        // 同一个 token。
+                        rightStack.pop_back();
+                        
+                        tokenShiftStates[node->tokenIdx] = states.back();
+                        session.shiftSubtree(node, tokenIdx + 1);
+                        states.push_back(command.target);
+                        reused = true;
+                        
+                        break;
+                    }
+
+                    int nextIdx = rightStack.size() > 1 
+                        ? startOf(rightStack[rightStack.size() - 2]) : eofIdx;
+                    
+                    bool outsideEdit = nextIdx >= 0 
+                        && (nextIdx < edit.begin || start >= edit.newEnd);
+
+                    if (outsideEdit && tokenShiftStates[node->tokenIdx] == states.back()) {
+                        auto gotoCommand = getCommand(states.back(), node->symbolId);
+                        
+                        if (gotoCommand.type == LrParserCommandType::GOTO) {
+                            rightStack.pop_back();
+                            session.shiftSubtree(node, nextIdx);
+                            states.push_back(gotoCommand.target);
+                            reused = true;
+
+                            break;
+                        }
+                    }
+                }
+
+                // 不能整体复用。拆开，或丢弃已越过、被删除的终结符。
+                rightStack.pop_back();
+                for (int childIdx = node->children.size() - 1; childIdx >= 0; childIdx--) {
+                    rightStack.push_back(node->children[childIdx]);
+                }
+            }
+
+            if (!reused) {
+                session.shift(symbolId, states.back());
+                states.push_back(command.target);
+            }
 
-    // 提取分析表内的元素。
-    auto& table = parserTable.table;
-    auto& symbolList = parserTable.symbolList;
-    auto& flatExpressions = parserTable.flatExpressions;
-
-    // 构建 token kind -> symbol id 映射表。
-    unordered_map<TokenKind, int> tokenKindToSymbolIdMap;
-    for (auto& symbol : symbolList) {
-        if (symbol.type == grammar::SymbolType::NON_TERMINAL) {
             continue;
         }
 
-        tokenKindToSymbolIdMap[symbol.tokenKind] = symbol.id;
+        // reduce.
+
+        const auto& expression = grammar.getExpression(command.target);
+
+        session.reduce(command.target);
+        states.resize(states.size() - expression.rhsLength);
+
+        auto gotoCommand = getCommand(states.back(), expression.lhs);
+
+        if (gotoCommand.type == LrParserCommandType::GOTO) {
+            states.push_back(gotoCommand.target);
+        } else if (gotoCommand.type == LrParserCommandType::ERROR) {
+            return session.unexpectedToken();
+        } else {
+            return session.internalError("unexpected command.");
+        }
     }
 
-    int currentTokenIdx = 0;
-    int tokenListSize = tokens.size();
+}
 
-    // 初状态。
-    states.push_back(parserTable.primaryStateId);
+void Parser::setDirectParser(DirectParseFunction directParser) {
+    this->directParser = directParser;
+}
+
+void Parser::setActions(ParserActions* actions) {
+    this->actions = actions;
+}
+
+void Parser::setStreamTokens(const AppendOnlyList< Token >* streamTokens) {
+    this->streamTokens = streamTokens;
+    astContext.bindStreamTokens(streamTokens);
+}
+
+template <bool profiled>
+int Parser::parseByTable(ParserSession& session) {
+
+    // 状态栈。
+    vector< int > states;
+
+    // 提取分析表内的元素。
+    auto& table = *parserTable;
+    auto& grammar = *compiledGrammar;
 
-    int errorCount = 0;
+    // 查表。懒构建模式下，由文法按需构建对应的行。
+    auto getCommand = [this, &table] (int stateId, int symbolId) {
+        return lazyGrammar 
+            ? lazyGrammar->getCommand(stateId, symbolId)
+            : table.getCommand(stateId, symbolId);
+    };
+
+    // 初状态。
+    states.push_back(table.primaryStateId);
 
     while (true) {
         
@@ -74,91 +638,39 @@ int Parser::parse(
                 3. 尝试移动 1 个状态。失败就结束。成功就继续。
         */
 
-
-        // 异常结尾。
-        if (currentTokenIdx == tokenListSize) {
-            errorList.emplace_back();
-            ParserParseError& error = errorList.back();
-            error.tokenRelated = false;
-            error.msg = "unexpected end of tokens.";
-            errorCount++;
-            
-            break;
-        }
-
         // 下一个字符。当然，它是终结符。
-        auto& token = tokens[currentTokenIdx];
+        auto symbolId = session.lookahead();
 
-        if (token.kind == TokenKind::multi_line_comment 
-            || token.kind == TokenKind::single_line_comment
-        ) {
-            currentTokenIdx++;
-            continue; // 忽略注释。
+        // 异常结尾。
+        if (symbolId == ParserSession::END_OF_TOKENS) {
+            return session.unexpectedEnd();
         }
 
-        auto symbolId = tokenKindToSymbolIdMap[token.kind];
-
         // 指令。
-        auto command = parserTable.getCommand(states.back(), symbolId);
+        auto command = getCommand(states.back(), symbolId);
 
         // 错误。
         if (command.type == LrParserCommandType::ERROR) {
-            errorList.emplace_back();
-            auto& err = errorList.back();
-            err.tokenRelated = true;
-            err.token = token;
-            err.msg = "(";
-            err.msg.append( to_string(token.row) )
-                .append( ", " )
-                .append( to_string(token.col) )
-                .append( ") " )
-                .append( "unexpected token: " )
-                .append( token.content );
-
-            errorCount++;
-
-            break;
+            return session.unexpectedToken();
         }
 
         // 接受。
         if (command.type == LrParserCommandType::ACCEPT) {
-            if (!nodes.empty()) {
-                astRoot = nodes[0];
-                while (astRoot->mother != nullptr) {
-                    astRoot = astRoot->mother;
-                }
-            }
-
-            break;
+            return session.accept();
         }
 
         // goto。不应该出现。
         if (command.type == LrParserCommandType::GOTO) {
-            errorList.emplace_back();
-            auto& err = errorList.back();
-            err.tokenRelated = true;
-            err.token = token;
-            err.msg = "(";
-            err.msg.append( to_string(token.row) )
-                .append( ", " )
-                .append( to_string(token.col) )
-                .append( ") " )
-                .append("internal error: unexpected command GOTO. token: ")
-                .append( token.content );
-
-            errorCount++;
-
-            break;
+            return session.internalError("unexpected command GOTO.");
         }
 
         // shift.
         if (command.type == LrParserCommandType::SHIFT) {
-            currentTokenIdx++;
-            AstNode* node = new AstNode;
-            nodes.push_back(node);
+            if constexpr (profiled) {
+                profile->shifts.add(states.back());
+            }
 
-            node->symbol = symbolList[symbolId];
-            node->token = token;
+            session.shift(symbolId, states.back());
             states.push_back(command.target);
 
             continue;
@@ -167,28 +679,18 @@ int Parser::parse(
 
         // reduce.
         
-        const auto& expression = flatExpressions[command.target];
-
-        AstNode* reducedNode = new AstNode; // 归约得到的节点。
-        reducedNode->symbol = symbolList[expression.targetSymbolId];
+        const auto& expression = grammar.getExpression(command.target);
 
-        int ruleSize = expression.rule.size();
-        
-        for (int nodeIdx = nodes.size() - ruleSize; nodeIdx < nodes.size(); nodeIdx++) {
-            auto node = nodes[nodeIdx];
-            node->mother = reducedNode;
-            reducedNode->children.push_back(node);
-        }
+        session.reduce(command.target);
+        states.resize(states.size() - expression.rhsLength);
 
-        for (int counter = 0; counter < ruleSize; counter++) {
-            nodes.pop_back();
-            states.pop_back();
+        if constexpr (profiled) {
+            profile->reductions.add(command.target);
+            profile->gotoLookups.add(states.back());
         }
 
-        nodes.push_back(reducedNode);
-
         // 移动 1 个状态。
-        auto gotoCommand = parserTable.getCommand(states.back(), reducedNode->symbol.id);
+        auto gotoCommand = getCommand(states.back(), expression.lhs);
 
         if (gotoCommand.type == LrParserCommandType::GOTO) {
 
@@ -196,50 +698,484 @@ int Parser::parse(
 
         } else if (gotoCommand.type == LrParserCommandType::ERROR) {
 
-            errorList.emplace_back();
-            auto& err = errorList.back();
-            err.tokenRelated = true;
-            err.token = token;
-            err.msg = "(";
-            err.msg.append( to_string(token.row) )
-                .append( ", " )
-                .append( to_string(token.col) )
-                .append( ") " )
-                .append( "unexpected token: " )
-                .append( token.content );
+            return session.unexpectedToken();
 
-            errorCount++;
+        } else {
+            
+            return session.internalError("unexpected command.");
+        }
 
-            break;
+    }
 
-        } else {
-            errorList.emplace_back();
-            auto& err = errorList.back();
-            err.tokenRelated = true;
-            err.token = token;
-            err.msg = "(";
-            err.msg.append( to_string(token.row) )
-                .append( ", " )
-                .append( to_string(token.col) )
-                .append( ") " )
-                .append("internal error: unexpected command. token: ")
-                .append( token.content );
-
-            errorCount++;
+}
 
-            break;
+/* ------------ ParserProfile ------------ */
+
+void ParserProfile::clear() {
+    shifts.clear();
+    reductions.clear();
+    gotoLookups.clear();
+}
+
+static void __tcReportStates(ostream& out, const char* title, const HotCounter& counter, int topN) {
+    
+    vector< pair< int, uint64_t > > hot;
+    counter.top(topN, hot);
+
+    out << title << ": " << counter.getTotal() << endl;
+    for (auto& it : hot) {
+        out << "  state " << setw(5) << it.first << " : " << it.second 
+            << " (" << HotCounter::formatPercent(it.second, counter.getTotal()) << ")" << endl;
+    }
+}
+
+void ParserProfile::report(ostream& out, const LrParserTable& table, int topN) const {
+
+    out << "--- parser profile ---" << endl;
+
+    __tcReportStates(out, "shifts", shifts, topN);
+
+    vector< pair< int, uint64_t > > hot;
+    reductions.top(topN, hot);
+
+    out << "reductions: " << reductions.getTotal() << endl;
+    for (auto& it : hot) {
+        auto& expression = table.flatExpressions[it.first];
+        auto& symbolList = table.symbolList;
+
+        bool isUnit = expression.rule.size() == 1 
+            && symbolList[expression.rule[0]].type == grammar::SymbolType::NON_TERMINAL;
+
+        out << "  " << setw(5) << it.first << " : " << it.second 
+            << " (" << HotCounter::formatPercent(it.second, reductions.getTotal()) << ") "
+            << symbolList[expression.targetSymbolId].name << " ->";
+        
+        for (auto symbolId : expression.rule) {
+            out << " " << symbolList[symbolId].name;
+        }
+
+        out << (isUnit ? " [unit]" : "") << endl;
+    }
+
+    __tcReportStates(out, "goto lookups", gotoLookups, topN);
+
+    out << "--- end of parser profile ---" << endl;
+}
+
+/* ------------ ParserSession ------------ */
+
+ParserSession::ParserSession(
+    Parser& parser,
+    vector< Token >& tokens,
+    const function<bool (vector< Token >&)>& fetchTokens,
+    vector< ParserParseError >& errorList
+) : parser(parser), table(*parser.parserTable), grammar(*parser.compiledGrammar), 
+    tokens(tokens), fetchTokens(fetchTokens), errorList(errorList), 
+    allocator(&parser.astContext.getMainAllocator()), actions(parser.actions), 
+    tokenListSize(tokens.size()) 
+{
+    
+}
+
+void ParserSession::limitTokens(int begin, int end, int eofSymbolId) {
+    this->currentTokenIdx = begin;
+    this->tokenEnd = end;
+    this->eofSymbolId = eofSymbolId;
+    this->lookaheadSymbolId = NOT_FETCHED;
+}
+
+int ParserSession::fetchLookahead() {
+
+    while (true) {
+
+        // 只分析一段时，段尾当作 eof。
+        if (currentTokenIdx == tokenEnd) {
+            lookaheadSymbolId = eofSymbolId;
+            return lookaheadSymbolId;
+        }
+
+        // 流式输入时，现有 token 用完就去取下一批。
+        while (currentTokenIdx == tokenListSize && fetchTokens && fetchTokens(tokens)) {
+            tokenListSize = tokens.size();
+        }
+
+        if (currentTokenIdx == tokenListSize) {
+            return END_OF_TOKENS;
+        }
+
+        auto kind = tokens[currentTokenIdx].kind;
+
+        if (kind == TokenKind::multi_line_comment 
+            || kind == TokenKind::single_line_comment
+        ) {
+            currentTokenIdx++;
+            continue; // 忽略注释。
         }
 
+        lookaheadSymbolId = table.getSymbolIdByTokenKind(kind);
+        return lookaheadSymbolId;
+    }
+
+}
+
+void ParserSession::shift(int symbolId, int fromState) {
+
+    if (actions) {
+        values.push_back(actions->shift(currentTokenIdx));
+
+        currentTokenIdx++;
+        lookaheadSymbolId = NOT_FETCHED;
+        return;
+    }
+
+    int tokenIdx = parser.astContext.toVirtualTokenIdx(currentTokenIdx);
+    nodes.push_back(parser.astContext.newNode(*allocator, symbolId, tokenIdx));
+
+    // 记录移进时的状态，供增量分析使用。
+    auto& shiftStates = parser.tokenShiftStates;
+    if (size_t(tokenIdx) >= shiftStates.size()) {
+        shiftStates.resize(tokenIdx + 1, -1);
+    }
+
+    shiftStates[tokenIdx] = fromState;
+
+    currentTokenIdx++;
+    lookaheadSymbolId = NOT_FETCHED;
+}
+
+void ParserSession::shiftSubtree(AstNode* node, int nextTokenIdx) {
+    node->mother = nullptr;
+    nodes.push_back(node);
+
+    currentTokenIdx = nextTokenIdx;
+    lookaheadSymbolId = NOT_FETCHED;
+}
+
+void ParserSession::reduce(int expressionId) {
+
+    auto& astContext = parser.astContext;
+    auto& keepSymbolKinds = parser.keepSymbolKinds;
+
+    const auto& expression = grammar.getExpression(expressionId);
+
+    int ruleSize = expression.rhsLength;
+
+    if (actions) {
+        // 语法制导翻译：只归约语义值，不创建节点。
+        // 此时 lookahead 已经取得，currentTokenIdx 即为待进入 token 的下标。
+        ParserValue* args = values.data() + values.size() - ruleSize;
+        ParserValue value = actions->reduce(expressionId, args, ruleSize, currentTokenIdx);
+        
+        values.resize(values.size() - ruleSize);
+        values.push_back(value);
+        return;
+    }
+
+    // 单产生式折叠：对于 A -> B（B 为非终结符），若 A 不需要保留，
+    // 则不为 A 创建节点，直接让 B 的节点代替 A。
+    bool collapse = ruleSize == 1 
+        && !keepSymbolKinds.empty()
+        && nodes.back()->symbolType() == grammar::SymbolType::NON_TERMINAL
+        && !keepSymbolKinds[size_t(table.symbolList[expression.lhs].symbolKind)];
+
+    if (collapse) {
+        return;
+    }
+
+    // 归约得到的节点。记录子树内第一个 token 的下标。
+    AstNode* reducedNode = astContext.newNode(
+        *allocator,
+        expression.lhs, 
+        ruleSize > 0 ? nodes[nodes.size() - ruleSize]->tokenIdx : -1
+    );
+
+    reducedNode->children = astContext.newChildren(*allocator, ruleSize);
+    
+    for (int childIdx = 0; childIdx < ruleSize; childIdx++) {
+        auto node = nodes[nodes.size() - ruleSize + childIdx];
+        node->mother = reducedNode;
+        reducedNode->children[childIdx] = node;
+    }
+
+    nodes.resize(nodes.size() - ruleSize);
+    nodes.push_back(reducedNode);
+
+    if (parser.reduceListener) {
+        parser.reduceListener(reducedNode);
+    }
+
+}
+
+int ParserSession::accept() {
+    
+    if (actions) {
+        actions->accept(values.empty() ? 0 : values.back());
+        return errorCount;
+    }
+
+    if (!nodes.empty()) {
+        root = nodes[0];
+        while (root->mother != nullptr) {
+            root = root->mother;
+        }
     }
 
     return errorCount;
 }
 
-void Parser::clear() {
-    if (this->astRoot != nullptr) {
-        delete this->astRoot;
-        this->astRoot = nullptr;
+int ParserSession::unexpectedToken() {
+    auto& token = tokens[currentTokenIdx];
+
+    errorList.emplace_back();
+    auto& err = errorList.back();
+    err.tokenRelated = true;
+    err.token = token;
+    err.msg = "(";
+    err.msg.append( to_string(token.row) )
+        .append( ", " )
+        .append( to_string(token.col) )
+        .append( ") " )
+        .append( "unexpected token: " )
+        .append( token.content );
+
+    return ++errorCount;
+}
+
+int ParserSession::unexpectedEnd() {
+    errorList.emplace_back();
+    ParserParseError& error = errorList.back();
+    error.tokenRelated = false;
+    error.msg = "unexpected end of tokens.";
+    
+    return ++errorCount;
+}
+
+int ParserSession::internalError(const char* what) {
+    auto& token = tokens[currentTokenIdx];
+
+    errorList.emplace_back();
+    auto& err = errorList.back();
+    err.tokenRelated = true;
+    err.token = token;
+    err.msg = "(";
+    err.msg.append( to_string(token.row) )
+        .append( ", " )
+        .append( to_string(token.col) )
+        .append( ") " )
+        .append( "internal error: " )
+        .append( what )
+        .append( " token: " )
+        .append( token.content );
+
+    return ++errorCount;
+}
+
+/* ------------ 语法树缓存 ------------ */
+
+namespace {
+
+    constexpr char AST_CACHE_MAGIC[4] = { 'T', 'C', 'A', 'S' };
+    constexpr uint32_t AST_CACHE_VERSION = 1;
+
+    struct AstCacheHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        uint32_t tokenCount;
+        uint32_t nodeCount;
+        uint32_t stringBytes;
+        uint32_t reserved;
+    };
+
+    struct AstCacheToken {
+        int32_t kind;
+        int32_t row;
+        int32_t col;
+        uint32_t contentLength;
+    };
+
+    struct AstCacheNode {
+        int32_t symbolId;
+        int32_t tokenIdx;
+        int32_t childCount;
+    };
+
+}
+
+int Parser::dumpAst(ostream& out, uint64_t key, const vector< Token >& tokens) {
+
+    if (astRoot == nullptr) {
+        return 1;
     }
+
+    AstCacheHeader header = {};
+    memcpy(header.magic, AST_CACHE_MAGIC, sizeof(header.magic));
+    header.version = AST_CACHE_VERSION;
+    header.key = key;
+    header.tokenCount = tokens.size();
+
+    vector< AstCacheToken > tokenRecords;
+    tokenRecords.reserve(tokens.size());
+
+    for (auto& token : tokens) {
+        tokenRecords.push_back({ 
+            int32_t(token.kind), token.row, token.col, uint32_t(token.content.size()) 
+        });
+
+        header.stringBytes += token.content.size();
+    }
+
+    // 先序遍历。用显式栈，避免长的左递归链导致栈溢出。
+    vector< AstCacheNode > nodeRecords;
+    vector< AstNode* > stack = { astRoot };
+
+    while (!stack.empty()) {
+        AstNode* node = stack.back();
+        stack.pop_back();
+
+        int tokenIdx = node->tokenIdx < 0 ? -1 : astContext.toRealTokenIdx(node->tokenIdx);
+        nodeRecords.push_back({ node->symbolId, tokenIdx, int32_t(node->children.size()) });
+
+        for (int childIdx = node->children.size() - 1; childIdx >= 0; childIdx--) {
+            stack.push_back(node->children[childIdx]);
+        }
+    }
+
+    header.nodeCount = nodeRecords.size();
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(
+        reinterpret_cast<const char*>(tokenRecords.data()), 
+        tokenRecords.size() * sizeof(AstCacheToken)
+    );
+    out.write(
+        reinterpret_cast<const char*>(nodeRecords.data()), 
+        nodeRecords.size() * sizeof(AstCacheNode)
+    );
+
+    for (auto& token : tokens) {
+        out.write(token.content.data(), token.content.size());
+    }
+
+    return out.good() ? 0 : 2;
+}
+
+int Parser::loadAst(const char* data, size_t size, uint64_t key, vector< Token >& tokens) {
+
+    this->clear();
+
+    if (parserTable == nullptr || size < sizeof(AstCacheHeader)) {
+        return 1;
+    }
+
+    AstCacheHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    if (memcmp(header.magic, AST_CACHE_MAGIC, sizeof(header.magic)) != 0
+        || header.version != AST_CACHE_VERSION || header.key != key
+    ) {
+        return 2;
+    }
+
+    size_t expectedSize = sizeof(AstCacheHeader) 
+        + size_t(header.tokenCount) * sizeof(AstCacheToken)
+        + size_t(header.nodeCount) * sizeof(AstCacheNode)
+        + header.stringBytes;
+
+    if (size != expectedSize || header.nodeCount == 0) {
+        return 3;
+    }
+
+    auto tokenRecords = data + sizeof(AstCacheHeader);
+    auto nodeRecords = tokenRecords + size_t(header.tokenCount) * sizeof(AstCacheToken);
+    auto strings = nodeRecords + size_t(header.nodeCount) * sizeof(AstCacheNode);
+    size_t stringOffset = 0;
+
+    tokens.clear();
+    tokens.resize(header.tokenCount);
+
+    for (uint32_t idx = 0; idx < header.tokenCount; idx++) {
+        AstCacheToken record;
+        memcpy(&record, tokenRecords + idx * sizeof(AstCacheToken), sizeof(record));
+
+        if (record.contentLength > header.stringBytes - stringOffset) {
+            tokens.clear();
+            return 3;
+        }
+
+        auto& token = tokens[idx];
+        token.kind = TokenKind(record.kind);
+        token.row = record.row;
+        token.col = record.col;
+        token.content.assign(strings + stringOffset, record.contentLength);
+        stringOffset += record.contentLength;
+    }
+
+    astContext.bind(
+        shared_ptr< const vector< grammar::Symbol > >(parserTable, &parserTable->symbolList), 
+        &tokens
+    );
+
+    int symbolCount = parserTable->symbolList.size();
+
+    // 尚未填满孩子的节点，及已填入的孩子数。
+    vector< pair< AstNode*, int > > stack;
+    AstNode* root = nullptr;
+
+    for (uint32_t idx = 0; idx < header.nodeCount; idx++) {
+        AstCacheNode record;
+        memcpy(&record, nodeRecords + idx * sizeof(AstCacheNode), sizeof(record));
+
+        bool valid = record.symbolId >= 0 && record.symbolId < symbolCount
+            && record.tokenIdx >= -1 && record.tokenIdx < int32_t(header.tokenCount)
+            && record.childCount >= 0 
+            && record.childCount < int32_t(header.nodeCount - idx)
+            && (root == nullptr || !stack.empty());
+
+        if (!valid) {
+            this->clear();
+            tokens.clear();
+            return 3;
+        }
+
+        AstNode* node = astContext.newNode(record.symbolId, record.tokenIdx);
+        node->children = astContext.newChildren(record.childCount);
+
+        if (root == nullptr) {
+            root = node;
+        } else {
+            auto& parent = stack.back();
+            node->mother = parent.first;
+            parent.first->children[parent.second++] = node;
+        }
+
+        if (record.childCount > 0) {
+            stack.emplace_back(node, 0);
+        }
+
+        while (!stack.empty() && size_t(stack.back().second) == stack.back().first->children.size()) {
+            stack.pop_back();
+        }
+    }
+
+    if (!stack.empty()) {
+        this->clear();
+        tokens.clear();
+        return 3;
+    }
+
+    astRoot = root;
+    tokenShiftStates.clear();
+    parsedTokenCount = 0;
+
+    return 0;
+}
+
+void Parser::clear() {
+    // 语法树的节点都由 astContext 持有，一并释放即可。
+    // 分析失败时残留在符号栈内的节点也会在此释放。
+    this->astRoot = nullptr;
+    astContext.clear();
 }
 
 Parser::~Parser() {
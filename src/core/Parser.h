@@ -32,10 +32,40 @@
     转换成 Action Goto 表。本 Parser 依赖该表格进行分析。
 
   
+  懒构建
+
+    Parser 也可以不持有完整的表，而是直接查询以懒构建方式加载的
+    Lr1Grammar。此时，只有分析过程实际到达的状态才会被构建。
+
+  语法树缓存
+
+    dumpAst 将语法树连同 token 列表保存为紧凑的二进制格式，loadAst 一次性
+    读回到节点内存中，不需要词法分析和语法分析。格式（本机字节序）：
+
+      头部      char[4] "TCAS"，uint32 版本，uint64 键，
+                uint32 token 数，uint32 节点数，uint32 字符串字节数，uint32 保留
+      token     每个 { int32 kind, int32 row, int32 col, uint32 内容长度 }
+      节点      先序排列，每个 { int32 符号 id, int32 token 下标, int32 孩子数 }
+      字符串    各 token 的内容，按顺序首尾相接
+
+    键由调用者决定，一般是源码与分析表等输入的哈希。键不符时拒绝加载。
+
+  语法制导翻译
+
+    设置 ParserActions 后，Parser 不创建语法树，而是在移进与归约时
+    调用注册的回调，由回调直接完成翻译。详见 tc/core/ParserActions.h
+
+  热点统计
+
+    设置 ParserProfile 后，查表分析会记录各状态的移进次数、各产生式的归约次数
+    与各状态的 goto 查询次数，用于找出值得折叠的单产生式链与最常经过的状态。
+    查表循环以模板参数区分是否计数，未设置统计时运行的版本不含计数代码。
+
   缓存优化（外部设计）
 
-    Parser 并不关心 Action Goto 表的构建过程。它只将外部传递
-    的表拷贝到自己内部，并在分析时使用。
+    Parser 并不关心 Action Goto 表的构建过程。它只持有外部传递
+    的表，并在分析时使用。表是只读的，可以被多个 Parser 共享，
+    因此创建 Parser 几乎没有开销。
 
     考虑到 Action Goto 表构建较为费时，外部可以考虑一次构建后，
     保存到文件，后续直接加载此前构建完毕的表，以节省启动时间。    
@@ -45,13 +75,25 @@
 #pragma once
 
 #include <core/AstNode.h>
+#include <core/AstContext.h>
 #include <core/Grammar.h>
+#include <core/CompiledGrammar.h>
 #include <core/LrParserTable.h>
+#include <core/ParserActions.h>
+#include <core/HotCounter.h>
 #include <vector>
 #include <string>
+#include <memory>
+#include <functional>
+#include <cstdint>
+#include <iostream>
 
 namespace tc {
 
+    namespace lr1grammar {
+        class Lr1Grammar;
+    }
+
     /**
      * 文法分析器报错信息。
      */
@@ -72,6 +114,45 @@ namespace tc {
         std::string msg;
     };
 
+    class Parser;
+    class ParserSession;
+
+    /**
+     * 语法分析热点统计。见 Parser::setProfile。
+     */
+    struct ParserProfile {
+
+        /** 各状态执行移进的次数。键为移进前栈顶的状态 id。 */
+        HotCounter shifts;
+
+        /** 各产生式的归约次数。键为产生式 id。 */
+        HotCounter reductions;
+
+        /** 归约后查询 goto 的次数。键为弹出右部后栈顶的状态 id。 */
+        HotCounter gotoLookups;
+
+        void clear();
+
+        /**
+         * 输出最热的状态与产生式。右部只有一个非终结符的产生式会标出 [unit]，
+         * 它们是单产生式折叠的候选。
+         * 
+         * @param table 分析时使用的表。用于显示产生式。
+         * @param topN 每一类最多输出的项数。
+         */
+        void report(std::ostream& out, const LrParserTable& table, int topN) const;
+    };
+
+    /**
+     * 直接编码的分析器。
+     * 
+     * 由 TableGen 针对某张分析表生成：每个状态是一个标号，按待进入符号 switch，
+     * 移进与 goto 直接跳转到目标状态，不再查表。只能与生成时所用的表一起使用。
+     * 
+     * @return 错误数量。
+     */
+    using DirectParseFunction = int (*)(ParserSession& session);
+
     /**
      * 语法分析器。基于 LR 语法表，识别输入串，构建语法树。
      */
@@ -80,6 +161,7 @@ namespace tc {
 
         Parser();
         Parser(const LrParserTable& parserTable);
+        Parser(std::shared_ptr<const LrParserTable> parserTable);
 
         /**
          * 加载 Action Goto 表。会将输入的表复制一份到 parser 内。
@@ -88,10 +170,26 @@ namespace tc {
          */
         void loadParserTable(const LrParserTable& parserTable);
 
+        /**
+         * 加载 Action Goto 表。不复制，与其他持有者共享同一张表。
+         * 
+         * @param parserTable Action Goto 表。
+         */
+        void loadParserTable(std::shared_ptr<const LrParserTable> parserTable);
+
+        /**
+         * 使用以懒构建方式加载的 LR1 文法代替 Action Goto 表。
+         * Parser 不会接管该文法，调用者需保证其生命周期覆盖分析过程。
+         * 
+         * @param lazyGrammar 以懒构建方式加载的文法。传入空指针表示改回使用表。
+         */
+        void loadLazyGrammar(lr1grammar::Lr1Grammar* lazyGrammar);
+
         /**
          * 根据输入的符号列表，构建语法树。
          * 
          * @param tokens 符号表。结尾需要是 eof 符号。
+         *               语法树节点引用该列表内的 token，其生命周期需覆盖语法树。
          * @param errorList 语法错误列表。
          * @return 错误数量。为 0 表示没有遇到语法错误。
          */
@@ -100,6 +198,154 @@ namespace tc {
             std::vector< ParserParseError >& errorList
         );
 
+        /**
+         * 流式构建语法树。现有 token 用完时，调用 fetchTokens 向列表尾部追加下一批。
+         * 
+         * @param tokens 符号表。可以一开始为空。语法树节点引用该列表内的 token。
+         *               追加 token 导致列表扩容时，调用者需保证没有其他线程在读取语法树。
+         * @param fetchTokens 向列表尾部追加 token。返回 false 表示没有更多 token。可以为空。
+         * @param errorList 语法错误列表。
+         * @return 错误数量。为 0 表示没有遇到语法错误。
+         */
+        int parse(
+            std::vector< Token >& tokens,
+            const std::function<bool (std::vector< Token >&)>& fetchTokens,
+            std::vector< ParserParseError >& errorList
+        );
+
+        /**
+         * 并行构建语法树。
+         * 
+         * 在花括号外的 ';' 与函数体的 '}' 之后切分 token 列表，得到若干段完整的外部声明。
+         * 各段分给多个线程同时分析，再按原顺序拼接成一棵 translation_unit 树。
+         * 结果与 parse 相同。
+         * 
+         * 以下情况退回 parse：线程数为 1；文法没有 translation_unit 的两条产生式；
+         * 懒构建模式；设置了归约监听器或语法制导回调；切分得到的段少于 2。
+         * 某段分析失败时，也会重新顺序分析，以得到与 parse 相同的报错。
+         * 
+         * @param tokens 符号表。结尾需要是 eof 符号。
+         * @param errorList 语法错误列表。
+         * @param threadCount 线程数（含调用线程）。为 0 时使用硬件并发数。
+         * @return 错误数量。为 0 表示没有遇到语法错误。
+         */
+        int parseParallel(
+            std::vector< Token >& tokens,
+            std::vector< ParserParseError >& errorList,
+            int threadCount = 0
+        );
+
+        /**
+         * 增量分析。在上一次分析得到的语法树基础上，分析编辑后的 token 列表。
+         * 
+         * 旧树中完全位于编辑范围之外、其后一个 token 也未被编辑、
+         * 且开始分析时 LR 状态与当初相同的子树会被整体复用，
+         * 只有编辑点附近的部分需要重新分析。结果与完整分析相同。
+         * 
+         * 以下情况会退回完整分析：此前没有成功的分析；开启了单产生式折叠；
+         * 设置了语法制导回调；编辑范围不合法。
+         * 
+         * 复用的子树内部不会再次触发归约监听器。
+         * 旧树中未被复用的节点直到下一次 parse 或 clear 才会释放。
+         * 
+         * @param tokens 编辑后的 token 列表。结尾需要是 eof 符号。
+         *               可以与上次分析使用的是同一个列表对象。
+         * @param edit 相对于上次分析的 token 列表的编辑范围。
+         * @param errorList 语法错误列表。
+         * @return 错误数量。为 0 表示没有遇到语法错误。
+         */
+        int reparse(
+            std::vector< Token >& tokens,
+            const TokenEdit& edit,
+            std::vector< ParserParseError >& errorList
+        );
+
+        /**
+         * 以二进制格式保存语法树及其引用的 token 列表。格式见文件开头说明。
+         * 
+         * @param out 输出流。需要以二进制模式打开。
+         * @param key 缓存键。加载时需要提供相同的键。
+         * @param tokens 分析时使用的 token 列表。
+         * @return 0 表示成功。没有语法树时返回非 0。
+         */
+        int dumpAst(std::ostream& out, uint64_t key, const std::vector< Token >& tokens);
+
+        /**
+         * 加载 dumpAst 保存的语法树。节点直接在语法树上下文内创建。
+         * 加载得到的树不记录 LR 状态，之后的 reparse 会退回完整分析。
+         * 
+         * @param data 保存的数据。
+         * @param size 数据字节数。
+         * @param key 缓存键。与保存时不同则加载失败。
+         * @param tokens 用于存放保存时的 token 列表。原有内容会被替换。
+         *               语法树节点引用该列表，其生命周期需覆盖语法树。
+         * @return 0 表示成功。键不符、数据损坏或未加载分析表时返回非 0，且不产生语法树。
+         */
+        int loadAst(const char* data, size_t size, uint64_t key, std::vector< Token >& tokens);
+
+        /**
+         * 设置归约监听器。每完成一次归约，就将归约得到的节点交给监听器。
+         * 此时该节点的子树已经完整，但它的 mother 尚未确定。
+         * 
+         * @param listener 监听器。传入空函数表示取消监听。
+         */
+        void setReduceListener(std::function<void (AstNode*)> listener);
+
+        /**
+         * 设置单产生式折叠。
+         * 
+         * 开启后，对于形如 A -> B（B 为非终结符）的归约，若 A 的类型不在保留名单内，
+         * 则不为 A 创建节点，B 的节点直接出现在 A 的位置。
+         * 如：expression -> assignment_expression -> ... -> primary_expression 
+         * 这样的长链会只剩下 primary_expression。
+         * 
+         * 被折叠的节点不会交给归约监听器。
+         * 
+         * @param enable 是否开启。默认关闭。
+         * @param keepKinds 保留名单。名单内类型的节点总是会被创建。
+         */
+        void setUnitReductionCollapse(
+            bool enable, 
+            const std::vector<SymbolKind>& keepKinds = {}
+        );
+
+        /**
+         * 使用直接编码的分析器代替查表循环。
+         * 调用者需保证它是针对当前加载的表生成的。懒构建模式下不生效。
+         * 
+         * @param directParser 分析器。传入空指针表示改回查表。
+         */
+        void setDirectParser(DirectParseFunction directParser);
+
+        /**
+         * 设置语法制导翻译的回调。设置后，parse 不再构建语法树，
+         * 改为在移进与归约时调用回调。归约监听器与单产生式折叠不再生效。
+         * Parser 不会接管回调集合，调用者需保证其生命周期覆盖分析过程。
+         * 
+         * @param actions 回调集合。传入空指针表示改回构建语法树。
+         */
+        void setActions(ParserActions* actions);
+
+        /**
+         * 设置热点统计。设置后，parse 使用带计数的查表分析：
+         * 不使用直接编码的分析器，parseParallel 退回顺序分析。reparse 不计数。
+         * Parser 不会接管统计对象，调用者需保证其生命周期覆盖分析过程。
+         * 
+         * @param profile 统计对象。传入空指针表示停止统计。
+         */
+        void setProfile(ParserProfile* profile) { this->profile = profile; }
+
+        /**
+         * 设置语法树读取 token 的只追加列表。见 AstContext::bindStreamTokens。
+         * 立即作用于当前的语法树，之后的 parse 也会使用它。
+         * 
+         * 流水线用它让 IR 线程读取 token，而语法分析在 tokens 尾部继续追加。
+         * 调用者需保证列表覆盖语法树用到的 token，且生命周期覆盖语法树的使用。
+         * 
+         * @param streamTokens 只追加列表。传入空指针表示改回从 tokens 读取。
+         */
+        void setStreamTokens(const AppendOnlyList< Token >* streamTokens);
+
         /**
          * 清理。会释放语法树。
          */
@@ -109,6 +355,7 @@ namespace tc {
 
     public: // getters
         AstNode* getAstRoot() { return this->astRoot; }
+        const std::shared_ptr<const LrParserTable>& getParserTable() { return this->parserTable; }
 
     protected:
     
@@ -120,13 +367,228 @@ namespace tc {
         AstNode* astRoot = nullptr;
 
         /**
-         * Action Goto 表。
+         * 语法树节点的分配器。语法树的所有节点都由它持有。
+         */
+        AstContext astContext;
+
+        /**
+         * Action Goto 表。只读，可能与其他 Parser 共享。
          */
-        LrParserTable parserTable;
+        std::shared_ptr<const LrParserTable> parserTable;
+
+        /**
+         * 分析表对应的紧凑文法。归约时读取产生式左部与右部长度。
+         */
+        std::shared_ptr<const grammar::CompiledGrammar> compiledGrammar;
+
+        /**
+         * 懒构建的 LR1 文法。不为空时，优先于 parserTable 使用。
+         */
+        lr1grammar::Lr1Grammar* lazyGrammar = nullptr;
+
+        /**
+         * 归约监听器。可以为空。
+         */
+        std::function<void (AstNode*)> reduceListener;
+
+        /**
+         * 单产生式折叠的保留名单。以 SymbolKind 的值为下标。
+         * 为空表示不折叠。
+         */
+        std::vector<bool> keepSymbolKinds;
+
+        /**
+         * 直接编码的分析器。为空时查表分析。
+         */
+        DirectParseFunction directParser = nullptr;
+
+        /**
+         * 语法制导翻译的回调。不为空时，不构建语法树。
+         */
+        ParserActions* actions = nullptr;
+
+        /**
+         * 热点统计。可以为空。
+         */
+        ParserProfile* profile = nullptr;
+
+        /**
+         * 语法树读取 token 的只追加列表。可以为空。
+         */
+        const AppendOnlyList< Token >* streamTokens = nullptr;
+
+        /**
+         * 各 token 被移进时栈顶的 LR 状态。以节点内的 token 下标为下标。
+         * 增量分析据此判断子树能否复用。
+         */
+        std::vector< int32_t > tokenShiftStates;
+
+        /**
+         * 上次成功分析的 token 列表长度。
+         */
+        int parsedTokenCount = 0;
+
+    protected:
+
+        /**
+         * 查表分析。profiled 为 true 时计入热点统计。
+         */
+        template <bool profiled>
+        int parseByTable(ParserSession& session);
+
+        /**
+         * 用选定的分析器（直接编码或查表）完成一次分析。
+         */
+        int runSession(ParserSession& session);
+
+        friend class ParserSession;
 
     private:
 
-        Parser(const Parser&) {};
+        Parser(const Parser&) = delete;
+
+    };
+
+    /**
+     * 一次分析过程的输入与符号栈。
+     * 
+     * 查表分析与直接编码的分析器都通过它移进、归约和报错，
+     * 因此两者构建出的语法树与报错信息完全相同。状态栈由分析器自己维护。
+     */
+    class ParserSession {
+    public:
+
+        /** lookahead 的返回值：token 已耗尽。 */
+        static constexpr int END_OF_TOKENS = -3;
+
+        ParserSession(
+            Parser& parser,
+            std::vector< Token >& tokens,
+            const std::function<bool (std::vector< Token >&)>& fetchTokens,
+            std::vector< ParserParseError >& errorList
+        );
+
+        /**
+         * 获取待进入的终结符 id。跳过注释，必要时取下一批 token。
+         * 结果会被缓存，直到下一次移进。
+         * 
+         * @return 终结符 id。文法中不存在的 token 类型返回 -1，查表时会得到 ERROR。
+         *         token 耗尽时返回 END_OF_TOKENS。
+         */
+        int lookahead() {
+            return lookaheadSymbolId != NOT_FETCHED ? lookaheadSymbolId : fetchLookahead();
+        }
+
+        /**
+         * 只分析 token 列表的 [begin, end) 段。到达 end 时视作遇到 eof。
+         * 需要在分析开始前调用。
+         * 
+         * @param eofSymbolId eof 的终结符 id。
+         */
+        void limitTokens(int begin, int end, int eofSymbolId);
+
+        /**
+         * 使用指定的分配器创建节点。需要在分析开始前调用。
+         * 默认使用语法树上下文的默认分配器。
+         */
+        void setAllocator(AstNodeAllocator& allocator) { this->allocator = &allocator; }
+
+        /**
+         * 接受后得到的根节点。未接受时为空。
+         */
+        AstNode* getRoot() const { return root; }
+
+        /**
+         * 当前 token 在 token 列表内的下标。
+         */
+        int getTokenIdx() const { return currentTokenIdx; }
+
+        /**
+         * 移进当前 token。设置了语法制导回调时，改为压入其语义值。
+         * 
+         * @param symbolId 终结符 id。
+         * @param fromState 移进前栈顶的状态。
+         */
+        void shift(int symbolId, int fromState);
+
+        /**
+         * 把一棵已有的子树当作一个符号移进。增量分析使用。
+         * 
+         * @param node 子树根节点。
+         * @param nextTokenIdx 子树之后的第一个 token 的下标。
+         */
+        void shiftSubtree(AstNode* node, int nextTokenIdx);
+
+        /**
+         * 按产生式归约符号栈顶部的节点。设置了语法制导回调时，改为归约语义值。
+         * 调用者需自行从状态栈弹出右部长度个状态，再按 goto 转移。
+         */
+        void reduce(int expressionId);
+
+        /**
+         * 接受。确定语法树根节点，可通过 getRoot 获取。
+         * 
+         * @return 错误数量。
+         */
+        int accept();
+
+        /**
+         * 报告当前 token 不合法。分析应随即结束。
+         * 
+         * @return 错误数量。
+         */
+        int unexpectedToken();
+
+        /**
+         * 报告 token 意外耗尽。分析应随即结束。
+         * 
+         * @return 错误数量。
+         */
+        int unexpectedEnd();
+
+        /**
+         * 报告分析表内部错误。分析应随即结束。
+         * 
+         * @return 错误数量。
+         */
+        int internalError(const char* what);
+
+    protected:
+
+        static constexpr int NOT_FETCHED = -2;
+
+        int fetchLookahead();
+
+        Parser& parser;
+        const LrParserTable& table;
+        const grammar::CompiledGrammar& grammar;
+
+        std::vector< Token >& tokens;
+        std::function<bool (std::vector< Token >&)> fetchTokens;
+        std::vector< ParserParseError >& errorList;
+
+        AstNodeAllocator* allocator;
+
+        /** 符号栈。 */
+        std::vector< AstNode* > nodes;
+
+        /** 语法制导翻译的回调。为空时构建语法树。 */
+        ParserActions* actions;
+
+        /** 语义值栈。仅在设置了语法制导回调时使用，代替符号栈。 */
+        std::vector< ParserValue > values;
+
+        AstNode* root = nullptr;
+
+        int currentTokenIdx = 0;
+        int tokenListSize;
+
+        /** limitTokens 设置的结束位置。-1 表示不限制。 */
+        int tokenEnd = -1;
+        int eofSymbolId = -1;
+
+        int lookaheadSymbolId = NOT_FETCHED;
+        int errorCount = 0;
 
     };
 
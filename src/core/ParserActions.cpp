@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    Parser Actions
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+#include <core/ParserActions.h>
+
+#include <sstream>
+#include <unordered_map>
+
+using namespace std;
+using namespace tc;
+
+string ParserActions::normalizeProduction(const string& production) {
+
+    stringstream ss(production);
+    string symbolName;
+    string result;
+
+    while (ss >> symbolName) {
+        if (!result.empty()) {
+            result += ' ';
+        }
+
+        result += symbolName;
+    }
+
+    return result;
+}
+
+void ParserActions::onReduce(const string& production, ReduceAction action) {
+    reduceActions.emplace_back(normalizeProduction(production), move(action));
+}
+
+int ParserActions::bind(const LrParserTable& table, vector< string >& unresolved) {
+
+    auto& symbolList = table.symbolList;
+    auto& flatExpressions = table.flatExpressions;
+
+    unordered_map< string, int > expressionIds;
+    expressionIds.reserve(flatExpressions.size());
+
+    string production;
+    for (int expressionId = 0; expressionId < int(flatExpressions.size()); expressionId++) {
+        const auto& expression = flatExpressions[expressionId];
+
+        production = symbolList[expression.targetSymbolId].name;
+        production += " :";
+
+        for (auto symbolId : expression.rule) {
+            production += ' ';
+            production += symbolList[symbolId].name;
+        }
+
+        expressionIds[production] = expressionId;
+    }
+
+    this->table = &table;
+
+    boundActions.clear();
+    boundActions.resize(flatExpressions.size());
+
+    int unresolvedCount = 0;
+
+    for (auto& it : reduceActions) {
+        auto expressionIt = expressionIds.find(it.first);
+        if (expressionIt == expressionIds.end()) {
+            unresolved.push_back(it.first);
+            unresolvedCount++;
+            continue;
+        }
+
+        boundActions[expressionIt->second] = it.second;
+    }
+
+    return unresolvedCount;
+}
@@ -0,0 +1,189 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    Parser Actions
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+/*
+
+  语法制导翻译
+
+    默认情况下，Parser 为每次移进和归约创建语法树节点，
+    之后再由 IR 生成器等遍历整棵树。
+
+    设置 ParserActions 后，Parser 不再创建节点，而是像 yacc 那样
+    维护一个语义值栈：
+      移进时，调用移进回调，得到终结符的语义值（默认为 token 下标）。
+      归约时，将产生式右部各符号的语义值交给该产生式的归约回调，
+      回调返回值成为左部符号的语义值（默认为 $$ = $1）。
+    分析结束时，得到的语义值即为整个输入的翻译结果。
+
+    语义值是一个指针大小的整数，具体含义由回调自行约定。
+    如：终结符用 token 下标，非终结符用回调自己管理的对象的地址。
+
+  产生式写法
+
+    与文法文件一致，符号之间用空白隔开，如：
+
+      additive_expression : additive_expression '+' multiplicative_expression
+
+    绑定到分析表时，按名称查找对应的产生式。
+
+*/
+
+#pragma once
+
+#include <core/LrParserTable.h>
+#include <core/Token.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tc {
+
+    /**
+     * 语义值。指针大小的整数。
+     */
+    using ParserValue = intptr_t;
+
+    /**
+     * 语法制导翻译的回调集合。用法见文件开头说明。
+     */
+    class ParserActions {
+    public:
+
+        /**
+         * 分析开始时调用。
+         *
+         * @param tokens 本次分析的 token 列表。回调中可以按下标访问。
+         */
+        using BeginAction = std::function<void (const std::vector< Token >& tokens)>;
+
+        /**
+         * 移进时调用。
+         *
+         * @param tokenIdx 被移进的 token 的下标。
+         * @return 终结符的语义值。
+         */
+        using ShiftAction = std::function<ParserValue (int tokenIdx)>;
+
+        /**
+         * 归约时调用。
+         *
+         * @param values 右部各符号的语义值，即 $1 ... $n。
+         *               values[-1] 为右部之前的语义值（yacc 的 $0），
+         *               仅当产生式所处的上下文保证该位置存在时才能访问。
+         * @param count 右部符号数量。
+         * @return 左部符号的语义值。
+         */
+        using ReduceAction = std::function<ParserValue (ParserValue* values, int count)>;
+
+        /**
+         * 接受时调用。
+         *
+         * @param value 开始符号的语义值。
+         */
+        using AcceptAction = std::function<void (ParserValue value)>;
+
+        void onBegin(BeginAction action) { beginAction = std::move(action); }
+        void onShift(ShiftAction action) { shiftAction = std::move(action); }
+        void onAccept(AcceptAction action) { acceptAction = std::move(action); }
+
+        /**
+         * 为产生式注册归约回调。同一产生式重复注册时，后者生效。
+         *
+         * @param production 产生式。写法见文件开头说明。
+         * @param action 回调。
+         */
+        void onReduce(const std::string& production, ReduceAction action);
+
+        /**
+         * 按名称将已注册的回调与分析表内的产生式对应起来。
+         *
+         * @param table 分析表。
+         * @param unresolved 存放分析表内找不到的产生式。
+         * @return 找不到的产生式数量。
+         */
+        int bind(const LrParserTable& table, std::vector< std::string >& unresolved);
+
+    public: // Parser 在分析过程中调用。
+
+        void begin(const std::vector< Token >& tokens) {
+            if (beginAction) {
+                beginAction(tokens);
+            }
+        }
+
+        ParserValue shift(int tokenIdx) {
+            return shiftAction ? shiftAction(tokenIdx) : ParserValue(tokenIdx);
+        }
+
+        /**
+         * @param lookaheadTokenIdx 归约时待进入 token 的下标。
+         */
+        ParserValue reduce(int expressionId, ParserValue* values, int count, int lookaheadTokenIdx) {
+            this->lookaheadTokenIdx = lookaheadTokenIdx;
+
+            auto& action = boundActions[expressionId];
+            if (action) {
+                return action(values, count);
+            }
+
+            return count > 0 ? values[0] : 0;
+        }
+
+        void accept(ParserValue value) {
+            if (acceptAction) {
+                acceptAction(value);
+            }
+        }
+
+    public: // getters
+
+        /**
+         * 当前归约时待进入 token 的下标（类似 yacc 的 yychar）。
+         * 只在归约回调内有意义。
+         */
+        int getLookaheadTokenIdx() const { return lookaheadTokenIdx; }
+
+        /**
+         * 最近一次绑定的分析表。可用于查询符号名称。
+         */
+        const LrParserTable* getTable() const { return table; }
+
+    protected:
+
+        /**
+         * 将产生式写法规范化：去掉多余空白，符号之间只保留一个空格。
+         */
+        static std::string normalizeProduction(const std::string& production);
+
+        BeginAction beginAction;
+        ShiftAction shiftAction;
+        AcceptAction acceptAction;
+
+        /**
+         * 已注册的归约回调。产生式已经规范化。
+         */
+        std::vector< std::pair< std::string, ReduceAction > > reduceActions;
+
+        /**
+         * 绑定后的归约回调。以产生式 id 为下标。为空的使用默认动作。
+         */
+        std::vector< ReduceAction > boundActions;
+
+        const LrParserTable* table = nullptr;
+
+        int lookaheadTokenIdx = -1;
+
+    };
+
+}
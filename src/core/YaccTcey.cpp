@@ -11,6 +11,7 @@
 
 #include <core/YaccTcey.h>
 #include <fstream>
+#include <sstream>
 
 #include <core/config.h>
 
@@ -93,6 +94,7 @@ YaccTceyError YaccTcey::loadGrammar(istream& grammarIn) {
     this->grammar.expressions.clear();
     this->symbolMap.clear();
     this->symbolList.clear();
+    this->precedenceLevelCount = 0;
 
     while (true) {
 
@@ -122,6 +124,18 @@ YaccTceyError YaccTcey::loadGrammar(istream& grammarIn) {
             this->loadGrammarBody(in);
             break;
        
+        } else if (keyword == "%left") {
+
+            this->loadPrecedenceDeclaration(in, grammar::Associativity::LEFT);
+
+        } else if (keyword == "%right") {
+
+            this->loadPrecedenceDeclaration(in, grammar::Associativity::RIGHT);
+
+        } else if (keyword == "%nonassoc") {
+
+            this->loadPrecedenceDeclaration(in, grammar::Associativity::NONASSOC);
+
         } else if (keyword[0] == '%') {
        
             __tceyIgnoreLine(in);
@@ -267,6 +281,7 @@ bool YaccTcey::loadExpression(istream& in) {
     // A -> ABC | BC
     // 其中，ABC 是一个 rule，BC 也是一个 rule.
     vector<int> rule;
+    int rulePrecedence = 0; // 由 %prec 指定。
 
     // 循环读取，把表达式吃进来。
     while (true) {
@@ -284,13 +299,25 @@ bool YaccTcey::loadExpression(istream& in) {
             // 单个 andExpression 结束。
             if (!rule.empty()) {
                 rules.push_back(rule);
+                expression.rulePrecedences.push_back(rulePrecedence);
                 rule.clear();
             }
 
+            rulePrecedence = 0;
+
             if (keyword == ";") {
                 break;
             }
 
+        } else if (keyword == "%prec") {
+
+            // 产生式的优先级与指定的终结符相同。该终结符应已声明优先级。
+            in >> keyword;
+            auto symbol = this->nameToGrammarSymbol(keyword);
+            if (symbol.id >= 0) {
+                rulePrecedence = symbolList[symbol.id].precedence;
+            }
+
         } else {
 
             rule.push_back(this->nameToGrammarSymbol(keyword).id);
@@ -302,6 +329,57 @@ bool YaccTcey::loadExpression(istream& in) {
     return true;
 }
 
+YaccTceyError YaccTcey::loadPrecedenceDeclaration(
+    istream& in, grammar::Associativity associativity
+) {
+
+    /*
+        %left '+' '-'
+        %left '*' '/'
+        %right '='
+
+        越晚声明，优先级越高。同一行的终结符优先级相同。
+    */
+
+    string line;
+    getline(in, line);
+    istringstream lineIn(line);
+
+    int precedence = ++this->precedenceLevelCount;
+
+    string symbolName;
+    while (lineIn >> symbolName) {
+
+        if (symbolName[0] == '<') {
+            // 类型标签，如 %left <val> '+'。忽略。
+            continue;
+        }
+
+        if (!this->symbolMap.count(symbolName) && !this->tokenKeyKindMap.count(symbolName)) {
+            // 只用于 %prec 的占位终结符，如 UMINUS。不对应任何 token。
+            this->symbolList.emplace_back();
+            auto& placeholder = this->symbolList.back();
+            placeholder.id = this->symbolList.size() - 1;
+            placeholder.name = symbolName;
+            placeholder.type = grammar::SymbolType::TERMINAL;
+            placeholder.tokenKind = TokenKind::unknown;
+            this->symbolMap[symbolName] = placeholder;
+        }
+
+        auto symbol = this->nameToGrammarSymbol(symbolName);
+        if (symbol.id < 0 || symbol.type != grammar::SymbolType::TERMINAL) {
+            continue;
+        }
+
+        auto& target = this->symbolList[symbol.id];
+        target.precedence = precedence;
+        target.associativity = associativity;
+        this->symbolMap[symbolName] = target;
+    }
+
+    return this->errcode;
+}
+
 YaccTceyError YaccTcey::loadTceyBlock(istream& in) {
     string keyword;
     string key;
@@ -33,6 +33,11 @@
       不支持单行注释。
       “可解析注释”开始符号后至少跟随 1 个空白符好。
 
+    优先级声明：
+      支持 yacc 的 %left, %right, %nonassoc 与产生式内的 %prec。
+      用于在构建分析表时解决移进-归约冲突。
+      优先级声明需位于“可解析注释”之后，%% 之前，每个声明独占一行。
+
 */
 
 #pragma once
@@ -113,6 +118,15 @@ namespace tc {
          */
         bool loadExpression(std::istream& in);
 
+        /**
+         * 加载 %left, %right, %nonassoc 声明。读取到行尾。
+         * 
+         * @param associativity 本行终结符的结合性。
+         */
+        YaccTceyError loadPrecedenceDeclaration(
+            std::istream& in, grammar::Associativity associativity
+        );
+
         /**
          * 加载 tcey 拓展定义区域。
          */
@@ -132,6 +146,11 @@ namespace tc {
          */
         std::vector<grammar::Symbol>& symbolList = grammar.symbols;
 
+        /**
+         * 已声明的优先级数量。每行 %left, %right, %nonassoc 占一级。
+         */
+        int precedenceLevelCount = 0;
+
     private:
         YaccTcey(const YaccTcey&) {};
 
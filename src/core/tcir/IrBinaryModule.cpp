@@ -0,0 +1,352 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    二进制 TCIR 模块。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+#include <core/tcir/IrBinaryModule.h>
+
+#include <cstring>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+namespace tc::tcir {
+
+namespace {
+
+    constexpr char IR_BINARY_MAGIC[4] = { 'T', 'C', 'I', 'B' };
+    constexpr uint32_t IR_BINARY_VERSION = 1;
+
+    constexpr size_t IR_BINARY_ALIGN = 8;
+
+}
+
+static size_t __tcAlign(size_t pos) {
+    return (pos + IR_BINARY_ALIGN - 1) / IR_BINARY_ALIGN * IR_BINARY_ALIGN;
+}
+
+/**
+ * 写出一段字节，并补齐到对齐边界。
+ */
+static void __tcWritePadded(ostream& out, const void* data, size_t size) {
+    static const char zeros[IR_BINARY_ALIGN] = {};
+
+    out.write(static_cast<const char*>(data), size);
+    out.write(zeros, __tcAlign(size) - size);
+}
+
+template <typename T>
+static void __tcWriteSection(ostream& out, const vector<T>& records) {
+    __tcWritePadded(out, records.data(), records.size() * sizeof(T));
+}
+
+int IrBinaryModule::write(ostream& out, const IrModule& module) {
+
+    // 指令内的名称 id 保持不变，其余符号名追加在后面。
+    IrNameTable names = *module.names;
+
+    vector<IrBinaryFunction> functionRecords;
+    vector<IrBinaryParam> paramRecords;
+    vector<IrBinaryVariable> variableRecords;
+    vector<IrBinaryStaticData> staticDataRecords;
+    vector<IrBinaryBlockTable> blockTableRecords;
+    vector<IrBinaryBlockSymbol> blockSymbolRecords;
+    vector<IrBinaryInstruction> instructionRecords;
+
+    for (auto& it : module.globalSymbolTable->functions) {
+        auto fun = it.second;
+
+        IrBinaryFunction record = {};
+        record.nameId = names.intern(it.first);
+        record.paramBegin = paramRecords.size();
+        record.paramCount = fun->params.size();
+        record.rootSymTabId = fun->rootSymTabId;
+        record.visibility = uint8_t(fun->visibility);
+        record.returnType = uint8_t(fun->returnType);
+        record.isImported = fun->isImported;
+        functionRecords.push_back(record);
+
+        for (auto& param : fun->params) {
+            IrBinaryParam paramRecord = {};
+            paramRecord.nameId = names.intern(param.name);
+            paramRecord.valueType = uint8_t(param.valueType);
+            paramRecord.isPointer = param.isPointer;
+            paramRecord.isVaList = param.isVaList;
+            paramRecords.push_back(paramRecord);
+        }
+    }
+
+    for (auto& it : module.globalSymbolTable->variables) {
+        auto var = it.second;
+        uint32_t nameId = names.intern(it.first);
+
+        IrBinaryVariable record = {};
+        record.nameId = nameId;
+        record.bytes = ValueTypeUtils::getBytes(var->valueType);
+        record.valueType = uint8_t(var->valueType);
+        record.visibility = uint8_t(var->visibility);
+        variableRecords.push_back(record);
+
+        IrBinaryStaticData data = {};
+        data.nameId = nameId;
+        data.valueType = uint8_t(var->valueType);
+        data.initValue = var->initValue;
+        staticDataRecords.push_back(data);
+    }
+
+    for (auto symbolTab : *module.blockSymbolTables) {
+        IrBinaryBlockTable record = {};
+        record.id = symbolTab->id;
+        record.parentId = symbolTab->parent->id;
+        record.symbolBegin = blockSymbolRecords.size();
+        record.symbolCount = symbolTab->symbols.size();
+        blockTableRecords.push_back(record);
+
+        for (auto sym : symbolTab->symbols) {
+            IrBinaryBlockSymbol symbolRecord = {};
+            symbolRecord.id = sym->id;
+            symbolRecord.nameId = names.intern(sym->name);
+            symbolRecord.bytes = ValueTypeUtils::getBytes(sym->valueType);
+            symbolRecord.valueType = uint8_t(sym->valueType);
+            blockSymbolRecords.push_back(symbolRecord);
+        }
+    }
+
+    instructionRecords.reserve(module.instructions->size());
+    for (auto& ins : *module.instructions) {
+        instructionRecords.push_back(IrBinaryInstruction::pack(ins));
+    }
+
+    vector<uint32_t> nameOffsets;
+    string strings;
+    nameOffsets.reserve(names.getNameCount() + 1);
+
+    for (int idx = 0; idx < names.getNameCount(); idx++) {
+        nameOffsets.push_back(strings.size());
+        strings.append(names.getName(idx));
+    }
+
+    nameOffsets.push_back(strings.size());
+
+    IrBinaryHeader header = {};
+    memcpy(header.magic, IR_BINARY_MAGIC, sizeof(header.magic));
+    header.version = IR_BINARY_VERSION;
+    header.nameCount = names.getNameCount();
+    header.stringBytes = strings.size();
+    header.functionCount = functionRecords.size();
+    header.paramCount = paramRecords.size();
+    header.variableCount = variableRecords.size();
+    header.staticDataCount = staticDataRecords.size();
+    header.blockTableCount = blockTableRecords.size();
+    header.blockSymbolCount = blockSymbolRecords.size();
+    header.instructionCount = instructionRecords.size();
+
+    __tcWritePadded(out, &header, sizeof(header));
+    __tcWriteSection(out, nameOffsets);
+    __tcWritePadded(out, strings.data(), strings.size());
+    __tcWriteSection(out, functionRecords);
+    __tcWriteSection(out, paramRecords);
+    __tcWriteSection(out, variableRecords);
+    __tcWriteSection(out, staticDataRecords);
+    __tcWriteSection(out, blockTableRecords);
+    __tcWriteSection(out, blockSymbolRecords);
+    __tcWriteSection(out, instructionRecords);
+
+    return out.good() ? 0 : 2;
+}
+
+
+static bool __tcIsValueType(uint8_t type) {
+    return type <= uint8_t(ValueType::type_void);
+}
+
+/**
+ * 检查指令记录。引用名称的操作数需要落在名称表内。
+ */
+static bool __tcIsValidInstruction(const IrBinaryInstruction& ins, uint32_t nameCount) {
+
+    if (ins.opcode >= uint8_t(IrOpcode::NUM_OPCODES)
+        || ins.operandCount > IrInstruction::MAX_OPERANDS
+    ) {
+        return false;
+    }
+
+    for (int idx = 0; idx < ins.operandCount; idx++) {
+        auto kind = IrOperandKind(ins.kinds[idx]);
+        auto labelKind = IrLabelKind(ins.labelKinds[idx]);
+        int64_t value = ins.values[idx];
+
+        if (kind > IrOperandKind::condition || labelKind >= IrLabelKind::NUM_LABEL_KINDS) {
+            return false;
+        }
+
+        IrOperand operand = { kind, labelKind, value };
+
+        if (operand.isName() && (value < 0 || value >= int64_t(nameCount))) {
+            return false;
+        }
+
+        if (kind == IrOperandKind::condition
+            && (value < 0 || value >= int64_t(IrCondition::NUM_CONDITIONS))
+        ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int IrBinaryModule::bind(const char* data, size_t size) {
+
+    this->clear();
+
+    if (data == nullptr || size < sizeof(IrBinaryHeader)
+        || reinterpret_cast<uintptr_t>(data) % IR_BINARY_ALIGN != 0
+    ) {
+        return 1;
+    }
+
+    IrBinaryHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    if (memcmp(header.magic, IR_BINARY_MAGIC, sizeof(header.magic)) != 0
+        || header.version != IR_BINARY_VERSION
+    ) {
+        return 2;
+    }
+
+    /* 计算各区段位置。计数均为 32 位，相加不会溢出 size_t。 */
+
+    size_t pos = __tcAlign(sizeof(IrBinaryHeader));
+
+    auto nameOffsetsPos = pos;
+    pos = __tcAlign(pos + (size_t(header.nameCount) + 1) * sizeof(uint32_t));
+
+    auto stringsPos = pos;
+    pos = __tcAlign(pos + header.stringBytes);
+
+    auto locate = [&pos, data] (auto& section, uint32_t count) {
+        using Record = typename std::remove_reference_t<decltype(section)>::Record;
+        section.data = reinterpret_cast<const Record*>(data + pos);
+        section.count = count;
+        pos = __tcAlign(pos + size_t(count) * sizeof(Record));
+    };
+
+    struct {
+        IrBinarySection<IrBinaryFunction> functions;
+        IrBinarySection<IrBinaryParam> params;
+        IrBinarySection<IrBinaryVariable> variables;
+        IrBinarySection<IrBinaryStaticData> staticData;
+        IrBinarySection<IrBinaryBlockTable> blockTables;
+        IrBinarySection<IrBinaryBlockSymbol> blockSymbols;
+        IrBinarySection<IrBinaryInstruction> instructions;
+    } sections;
+
+    locate(sections.functions, header.functionCount);
+    locate(sections.params, header.paramCount);
+    locate(sections.variables, header.variableCount);
+    locate(sections.staticData, header.staticDataCount);
+    locate(sections.blockTables, header.blockTableCount);
+    locate(sections.blockSymbols, header.blockSymbolCount);
+    locate(sections.instructions, header.instructionCount);
+
+    if (pos != size) {
+        return 3;
+    }
+
+    /* 名称表。 */
+
+    auto offsets = reinterpret_cast<const uint32_t*>(data + nameOffsetsPos);
+    if (offsets[0] != 0 || offsets[header.nameCount] != header.stringBytes) {
+        return 3;
+    }
+
+    for (uint32_t idx = 0; idx < header.nameCount; idx++) {
+        if (offsets[idx] > offsets[idx + 1]) {
+            return 3;
+        }
+    }
+
+    /* 符号与指令。 */
+
+    uint32_t nameCount = header.nameCount;
+
+    for (auto& fun : sections.functions) {
+        if (fun.nameId >= nameCount || !__tcIsValueType(fun.returnType)
+            || fun.visibility > uint8_t(SymbolVisibility::global)
+            || uint64_t(fun.paramBegin) + fun.paramCount > header.paramCount
+        ) {
+            return 3;
+        }
+    }
+
+    for (auto& param : sections.params) {
+        if (param.nameId >= nameCount || !__tcIsValueType(param.valueType)) {
+            return 3;
+        }
+    }
+
+    for (auto& var : sections.variables) {
+        if (var.nameId >= nameCount || !__tcIsValueType(var.valueType)
+            || var.visibility > uint8_t(SymbolVisibility::global)
+        ) {
+            return 3;
+        }
+    }
+
+    for (auto& var : sections.staticData) {
+        if (var.nameId >= nameCount || !__tcIsValueType(var.valueType)) {
+            return 3;
+        }
+    }
+
+    unordered_set<int32_t> blockTableIds;
+    for (auto& symbolTab : sections.blockTables) {
+        if (uint64_t(symbolTab.symbolBegin) + symbolTab.symbolCount > header.blockSymbolCount
+            || !blockTableIds.insert(symbolTab.id).second
+        ) {
+            return 3;
+        }
+    }
+
+    for (auto& symbolTab : sections.blockTables) {
+        if (!blockTableIds.count(symbolTab.parentId)) {
+            return 3;
+        }
+    }
+
+    for (auto& sym : sections.blockSymbols) {
+        if (sym.nameId >= nameCount || !__tcIsValueType(sym.valueType)) {
+            return 3;
+        }
+    }
+
+    for (auto& ins : sections.instructions) {
+        if (!__tcIsValidInstruction(ins, nameCount)) {
+            return 3;
+        }
+    }
+
+    this->nameCount = nameCount;
+    this->nameOffsets = offsets;
+    this->strings = data + stringsPos;
+    this->functions = sections.functions;
+    this->params = sections.params;
+    this->variables = sections.variables;
+    this->staticData = sections.staticData;
+    this->blockTables = sections.blockTables;
+    this->blockSymbols = sections.blockSymbols;
+    this->instructions = sections.instructions;
+
+    return 0;
+}
+
+}
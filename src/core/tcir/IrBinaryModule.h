@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    二进制 TCIR 模块。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+/*
+
+  文件布局
+
+    所有整数使用本机字节序。每个区段的起始位置按 8 字节对齐，
+    映射到内存后可以直接按记录访问，不需要逐项解析。
+
+      header                 IrBinaryHeader
+      name offsets           uint32_t[nameCount + 1]
+      name strings           char[stringBytes]，不含 '\0'。之后补齐到 8 字节
+      functions              IrBinaryFunction[functionCount]
+      params                 IrBinaryParam[paramCount]
+      variables              IrBinaryVariable[variableCount]        全局符号表内的变量
+      static data            IrBinaryStaticData[staticDataCount]
+      block tables           IrBinaryBlockTable[blockTableCount]
+      block symbols          IrBinaryBlockSymbol[blockSymbolCount]
+      instructions           IrBinaryInstruction[instructionCount]
+
+    名称表的前若干项与生成器的 IrNameTable 一一对应，指令内的名称 id 因此可以直接使用。
+    其余符号名（参数名、局部变量名等）排在其后。
+
+*/
+
+#pragma once
+
+#include <core/tcir/IrContainer.h>
+
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+#include <string_view>
+
+namespace tc::tcir {
+
+    struct IrBinaryHeader {
+        char magic[4];
+        uint32_t version;
+
+        uint32_t nameCount;
+        uint32_t stringBytes;
+
+        uint32_t functionCount;
+        uint32_t paramCount;
+        uint32_t variableCount;
+        uint32_t staticDataCount;
+        uint32_t blockTableCount;
+        uint32_t blockSymbolCount;
+        uint32_t instructionCount;
+        uint32_t reserved;
+    };
+
+    struct IrBinaryFunction {
+        uint32_t nameId;
+
+        /** 参数在 params 区段内的范围。 */
+        uint32_t paramBegin;
+        uint32_t paramCount;
+
+        int32_t rootSymTabId;
+        uint8_t visibility;
+        uint8_t returnType;
+        uint8_t isImported;
+        uint8_t reserved[5];
+    };
+
+    struct IrBinaryParam {
+        uint32_t nameId;
+        uint8_t valueType;
+        uint8_t isPointer;
+        uint8_t isVaList;
+        uint8_t reserved;
+    };
+
+    struct IrBinaryVariable {
+        uint32_t nameId;
+        int32_t bytes;
+        uint8_t valueType;
+        uint8_t visibility;
+        uint8_t reserved[6];
+    };
+
+    struct IrBinaryStaticData {
+        uint32_t nameId;
+        uint8_t valueType;
+        uint8_t reserved[3];
+        int64_t initValue;
+    };
+
+    struct IrBinaryBlockTable {
+        int32_t id;
+        int32_t parentId;
+
+        /** 符号在 block symbols 区段内的范围。 */
+        uint32_t symbolBegin;
+        uint32_t symbolCount;
+    };
+
+    struct IrBinaryBlockSymbol {
+        int32_t id;
+        uint32_t nameId;
+        int32_t bytes;
+        uint8_t valueType;
+        uint8_t reserved[3];
+    };
+
+    /**
+     * 紧凑的指令记录。与 IrInstruction 一一对应，但没有填充字节。
+     */
+    struct IrBinaryInstruction {
+        uint8_t opcode;
+        uint8_t operandCount;
+        uint8_t kinds[IrInstruction::MAX_OPERANDS];
+        uint8_t labelKinds[IrInstruction::MAX_OPERANDS];
+        int64_t values[IrInstruction::MAX_OPERANDS];
+
+    public:
+        static IrBinaryInstruction pack(const IrInstruction& ins) {
+            IrBinaryInstruction res = {};
+            res.opcode = uint8_t(ins.opcode);
+            res.operandCount = uint8_t(ins.operandCount);
+
+            for (int idx = 0; idx < ins.operandCount; idx++) {
+                res.kinds[idx] = uint8_t(ins.operands[idx].kind);
+                res.labelKinds[idx] = uint8_t(ins.operands[idx].labelKind);
+                res.values[idx] = ins.operands[idx].value;
+            }
+
+            return res;
+        }
+
+        IrInstruction unpack() const {
+            IrInstruction res { IrOpcode(opcode) };
+            res.operandCount = operandCount;
+
+            for (int idx = 0; idx < operandCount; idx++) {
+                res.operands[idx].kind = IrOperandKind(kinds[idx]);
+                res.operands[idx].labelKind = IrLabelKind(labelKinds[idx]);
+                res.operands[idx].value = values[idx];
+            }
+
+            return res;
+        }
+    };
+
+
+    /**
+     * 区段视图。指向映射内存内的记录数组，不管理内存。
+     */
+    template <typename T>
+    struct IrBinarySection {
+        using Record = T;
+
+        const T* data = nullptr;
+        uint32_t count = 0;
+
+        const T* begin() const { return data; }
+        const T* end() const { return data + count; }
+        uint32_t size() const { return count; }
+        const T& operator [] (uint32_t idx) const { return data[idx]; }
+    };
+
+
+    /**
+     * 二进制 TCIR 模块。
+     *
+     * 写出时从 IrModule 收集数据；读取时只检查并记录各区段的位置，
+     * 所有记录都直接引用传入的内存（通常为 mmap 映射的文件）。
+     * 绑定期间，传入的内存需要保持有效。
+     */
+    class IrBinaryModule {
+
+    public:
+
+        /**
+         * 以二进制格式写出 IR 模块。
+         *
+         * @return 0 表示成功。2 表示写入失败。
+         */
+        static int write(std::ostream& out, const IrModule& module);
+
+        /**
+         * 绑定一段二进制 TCIR 数据。会检查全部记录，保证之后按记录访问不会越界。
+         *
+         * @param data 数据起始地址。需要 8 字节对齐。
+         * @param size 数据字节数。
+         * @return 0 表示成功。1 表示数据为空或未对齐。2 表示格式或版本不符。3 表示数据损坏。
+         */
+        int bind(const char* data, size_t size);
+
+        uint32_t getNameCount() const { return nameCount; }
+        std::string_view getName(uint32_t nameId) const {
+            return std::string_view(strings + nameOffsets[nameId], nameOffsets[nameId + 1] - nameOffsets[nameId]);
+        }
+
+        const IrBinarySection<IrBinaryFunction>& getFunctions() const { return functions; }
+        const IrBinarySection<IrBinaryParam>& getParams() const { return params; }
+        const IrBinarySection<IrBinaryVariable>& getVariables() const { return variables; }
+        const IrBinarySection<IrBinaryStaticData>& getStaticData() const { return staticData; }
+        const IrBinarySection<IrBinaryBlockTable>& getBlockTables() const { return blockTables; }
+        const IrBinarySection<IrBinaryBlockSymbol>& getBlockSymbols() const { return blockSymbols; }
+        const IrBinarySection<IrBinaryInstruction>& getInstructions() const { return instructions; }
+
+        void clear() { *this = IrBinaryModule(); }
+
+    protected:
+        uint32_t nameCount = 0;
+        const uint32_t* nameOffsets = nullptr;
+        const char* strings = nullptr;
+
+        IrBinarySection<IrBinaryFunction> functions;
+        IrBinarySection<IrBinaryParam> params;
+        IrBinarySection<IrBinaryVariable> variables;
+        IrBinarySection<IrBinaryStaticData> staticData;
+        IrBinarySection<IrBinaryBlockTable> blockTables;
+        IrBinarySection<IrBinaryBlockSymbol> blockSymbols;
+        IrBinarySection<IrBinaryInstruction> instructions;
+
+    };
+
+}
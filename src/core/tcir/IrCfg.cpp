@@ -0,0 +1,236 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    TCIR 控制流图。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+#include <core/tcir/IrCfg.h>
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+using namespace std;
+
+namespace tc::tcir {
+
+bool IrCfg::isConditionalJump(const IrInstruction& ins) {
+    switch (ins.opcode) {
+        case IrOpcode::je:
+        case IrOpcode::jne:
+        case IrOpcode::jg:
+        case IrOpcode::jge:
+        case IrOpcode::jl:
+        case IrOpcode::jle:
+        case IrOpcode::j: {
+            return true;
+        }
+
+        default: {
+            return false;
+        }
+    }
+}
+
+bool IrCfg::isTerminator(const IrInstruction& ins) {
+    return ins.opcode == IrOpcode::jmp || ins.isRet() || isConditionalJump(ins);
+}
+
+void IrCfg::build(const vector<IrInstruction>& instructions) {
+
+    blocks.clear();
+    reversePostOrder.clear();
+    rpoIndex.clear();
+
+    /* 切分基本块。 */
+
+    int count = instructions.size();
+    map< pair<int, int64_t>, int > labelBlocks;
+
+    for (int idx = 0; idx < count; idx++) {
+        auto& ins = instructions[idx];
+
+        bool startsBlock = blocks.empty() || ins.isFunLabel() || ins.isLabel()
+            || isTerminator(instructions[idx - 1]);
+
+        if (startsBlock) {
+            if (!blocks.empty()) {
+                blocks.back().end = idx;
+            }
+
+            auto& block = blocks.emplace_back();
+            block.begin = idx;
+        }
+
+        if (ins.isLabel()) {
+            auto& label = ins.operands[0];
+            labelBlocks[{ int(label.labelKind), label.value }] = blocks.size() - 1;
+        }
+    }
+
+    if (!blocks.empty()) {
+        blocks.back().end = count;
+    }
+
+    /* 连边。 */
+
+    int blockCount = blocks.size();
+
+    auto addEdge = [this] (int from, int to) {
+        auto& succs = blocks[from].succs;
+        if (find(succs.begin(), succs.end(), to) == succs.end()) {
+            succs.push_back(to);
+            blocks[to].preds.push_back(from);
+        }
+    };
+
+    for (int blockIdx = 0; blockIdx < blockCount; blockIdx++) {
+        auto& last = instructions[blocks[blockIdx].end - 1];
+        bool fallsThrough = !last.isRet() && last.opcode != IrOpcode::jmp;
+
+        if (last.opcode == IrOpcode::jmp || isConditionalJump(last)) {
+            auto& label = last.operands[0];
+            auto it = labelBlocks.find({ int(label.labelKind), label.value });
+            if (it != labelBlocks.end()) {
+                addEdge(blockIdx, it->second);
+            }
+        }
+
+        if (fallsThrough && blockIdx + 1 < blockCount) {
+            addEdge(blockIdx, blockIdx + 1);
+        }
+    }
+
+    this->buildDominators();
+}
+
+void IrCfg::buildDominators() {
+
+    int blockCount = blocks.size();
+    rpoIndex.assign(blockCount, -1);
+
+    if (blockCount == 0) {
+        return;
+    }
+
+    /* 逆后序。用显式栈，避免块很多时栈溢出。 */
+
+    vector<int> postOrder;
+    vector<bool> visited(blockCount, false);
+    vector< pair<int, size_t> > stack = { { 0, 0 } };
+    visited[0] = true;
+
+    while (!stack.empty()) {
+        auto& [blockIdx, succIdx] = stack.back();
+        auto& succs = blocks[blockIdx].succs;
+
+        if (succIdx < succs.size()) {
+            int next = succs[succIdx++];
+            if (!visited[next]) {
+                visited[next] = true;
+                stack.emplace_back(next, 0);
+            }
+        } else {
+            postOrder.push_back(blockIdx);
+            stack.pop_back();
+        }
+    }
+
+    reversePostOrder.assign(postOrder.rbegin(), postOrder.rend());
+    for (int idx = 0; idx < int(reversePostOrder.size()); idx++) {
+        rpoIndex[reversePostOrder[idx]] = idx;
+    }
+
+    /*
+     * 支配树。迭代求解，见：
+     *   Cooper, Harvey, Kennedy. A Simple, Fast Dominance Algorithm.
+     */
+
+    auto intersect = [this] (int a, int b) {
+        while (a != b) {
+            while (rpoIndex[a] > rpoIndex[b]) {
+                a = blocks[a].idom;
+            }
+
+            while (rpoIndex[b] > rpoIndex[a]) {
+                b = blocks[b].idom;
+            }
+        }
+
+        return a;
+    };
+
+    blocks[0].idom = 0;
+    bool changed = true;
+
+    while (changed) {
+        changed = false;
+
+        for (size_t idx = 1; idx < reversePostOrder.size(); idx++) {
+            int blockIdx = reversePostOrder[idx];
+            int newIdom = -1;
+
+            for (int pred : blocks[blockIdx].preds) {
+                if (blocks[pred].idom < 0) {
+                    continue;
+                }
+
+                newIdom = newIdom < 0 ? pred : intersect(pred, newIdom);
+            }
+
+            if (blocks[blockIdx].idom != newIdom) {
+                blocks[blockIdx].idom = newIdom;
+                changed = true;
+            }
+        }
+    }
+
+    for (int blockIdx : reversePostOrder) {
+        if (blockIdx != 0) {
+            blocks[blocks[blockIdx].idom].domChildren.push_back(blockIdx);
+        }
+    }
+
+    /* 支配边界。 */
+
+    for (int blockIdx : reversePostOrder) {
+        auto& block = blocks[blockIdx];
+        if (block.preds.size() < 2) {
+            continue;
+        }
+
+        for (int pred : block.preds) {
+            if (!isReachable(pred)) {
+                continue;
+            }
+
+            for (int runner = pred; runner != block.idom; runner = blocks[runner].idom) {
+                auto& frontier = blocks[runner].frontier;
+                if (find(frontier.begin(), frontier.end(), blockIdx) == frontier.end()) {
+                    frontier.push_back(blockIdx);
+                }
+            }
+        }
+    }
+}
+
+bool IrCfg::dominates(int a, int b) const {
+    while (true) {
+        if (a == b) {
+            return true;
+        }
+
+        if (b == 0 || blocks[b].idom < 0) {
+            return false;
+        }
+
+        b = blocks[b].idom;
+    }
+}
+
+}
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    TCIR 控制流图。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+#pragma once
+
+#include <core/tcir/IrContainer.h>
+
+#include <vector>
+
+namespace tc::tcir {
+
+    /**
+     * 基本块。对应指令序列内 [begin, end) 范围的指令。
+     */
+    struct IrBasicBlock {
+        int begin = 0;
+        int end = 0;
+
+        std::vector<int> preds;
+        std::vector<int> succs;
+
+        /** 直接支配者。入口块为自身，不可达的块为 -1。 */
+        int idom = -1;
+
+        /** 支配树上的孩子。 */
+        std::vector<int> domChildren;
+
+        /** 支配边界。 */
+        std::vector<int> frontier;
+    };
+
+    /**
+     * 单个函数的控制流图。
+     *
+     * 在 fun-label 与 label 处开始新块，在 jmp、条件跳转与 ret 之后结束当前块。
+     * 0 号块为入口块。ret 之后的死代码会形成不可达的块，它们不参与支配关系的计算。
+     */
+    class IrCfg {
+
+    public:
+
+        /**
+         * 构造控制流图，并计算支配树与支配边界。
+         *
+         * @param instructions 函数的指令。通常以 fun-label 开头。
+         */
+        void build(const std::vector<IrInstruction>& instructions);
+
+        std::vector<IrBasicBlock>& getBlocks() { return blocks; }
+        const std::vector<IrBasicBlock>& getBlocks() const { return blocks; }
+
+        /**
+         * 可达块的逆后序。第一项为入口块。
+         */
+        const std::vector<int>& getReversePostOrder() const { return reversePostOrder; }
+
+        bool isReachable(int blockIdx) const { return blocks[blockIdx].idom >= 0; }
+
+        /**
+         * a 是否支配 b。两块都需要可达。
+         */
+        bool dominates(int a, int b) const;
+
+        /**
+         * 指令是否结束基本块：无条件跳转、条件跳转与 ret。
+         */
+        static bool isTerminator(const IrInstruction& ins);
+
+        /**
+         * 指令是否为条件跳转。执行后可能落到下一块。
+         */
+        static bool isConditionalJump(const IrInstruction& ins);
+
+    protected:
+        void buildDominators();
+
+    protected:
+        std::vector<IrBasicBlock> blocks;
+        std::vector<int> reversePostOrder;
+
+        /** 块在逆后序中的位置。不可达的块为 -1。 */
+        std::vector<int> rpoIndex;
+
+    };
+
+}
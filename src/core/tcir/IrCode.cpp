@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    TCIR 内存表示结构。
+
+    created on 2026.10.18
+
+*/
+
+#include <core/tcir/IrCode.h>
+
+#include <cstring>
+#include <charconv>
+#include <unordered_map>
+
+using namespace std;
+using namespace tc::tcir;
+
+static const char* const __tcOpcodeNames[] = {
+#define IR_OPCODE(X, Y) Y,
+    #include "core/tcir/IrCode.def"
+};
+
+static const char* const __tcLabelPrefixes[] = {
+    "",
+#define IR_LABEL_KIND(X, Y) Y,
+    #include "core/tcir/IrCode.def"
+};
+
+static const char* const __tcConditionNames[] = {
+#define IR_CONDITION(X) #X,
+    #include "core/tcir/IrCode.def"
+};
+
+const char* IrCodeUtils::getName(IrOpcode opcode) {
+    return __tcOpcodeNames[size_t(opcode)];
+}
+
+const char* IrCodeUtils::getName(IrCondition condition) {
+    return __tcConditionNames[size_t(condition)];
+}
+
+const char* IrCodeUtils::getLabelPrefix(IrLabelKind kind) {
+    return __tcLabelPrefixes[size_t(kind)];
+}
+
+IrOpcode IrCodeUtils::findOpcode(string_view name) {
+
+    static const unordered_map< string_view, IrOpcode > opcodeMap = [] () {
+        unordered_map< string_view, IrOpcode > res;
+        for (size_t idx = 1; idx < size_t(IrOpcode::NUM_OPCODES); idx++) {
+            res[__tcOpcodeNames[idx]] = IrOpcode(idx);
+        }
+
+        return res;
+    } ();
+
+    auto it = opcodeMap.find(name);
+    return it == opcodeMap.end() ? IrOpcode::unknown : it->second;
+}
+
+bool IrCodeUtils::findCondition(string_view name, IrCondition& result) {
+    for (size_t idx = 0; idx < size_t(IrCondition::NUM_CONDITIONS); idx++) {
+        if (name == __tcConditionNames[idx]) {
+            result = IrCondition(idx);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool IrCodeUtils::splitLabelName(string_view name, IrLabelKind& kind, int& id) {
+
+    for (size_t idx = 1; idx < size_t(IrLabelKind::NUM_LABEL_KINDS); idx++) {
+        const char* prefix = __tcLabelPrefixes[idx];
+        size_t prefixLen = strlen(prefix);
+
+        if (name.size() <= prefixLen || name.compare(0, prefixLen, prefix) != 0) {
+            continue;
+        }
+
+        int value = 0;
+        for (size_t pos = prefixLen; pos < name.size(); pos++) {
+            if (name[pos] < '0' || name[pos] > '9') {
+                return false;
+            }
+
+            value = value * 10 + (name[pos] - '0');
+        }
+
+        kind = IrLabelKind(idx);
+        id = value;
+        return true;
+    }
+
+    return false;
+}
+
+int64_t IrCodeUtils::toInt(string_view text) {
+    bool negative = !text.empty() && text[0] == '-';
+    if (negative || (!text.empty() && text[0] == '+')) {
+        text.remove_prefix(1);
+    }
+
+    int base = 10;
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        base = 16;
+        text.remove_prefix(2);
+    } else if (text.size() > 1 && text[0] == '0') {
+        base = 8;
+        text.remove_prefix(1);
+    }
+
+    uint64_t value = 0;
+    from_chars(text.data(), text.data() + text.size(), value, base);
+    return negative ? int64_t(0 - value) : int64_t(value);
+}
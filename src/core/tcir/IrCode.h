@@ -8,8 +8,198 @@
 
 */
 
+/*
+
+  指令的内存表示
+
+    文本形式的 TCIR 指令由若干段组成，如 "mov vreg 0 val 3"。
+    内存中，每条指令为一个指令码加至多 3 个操作数。操作数带有类别标记：
+
+      vreg 0       ->  { vreg, 0 }
+      val 3        ->  { local, 3 }          局部变量 id
+      val counter  ->  { global, 名称 id }
+      fval x       ->  { param, 参数下标 }
+      imm 42       ->  { imm, 42 }
+      .if_end_3    ->  { label, ifEnd, 3 }
+      eq           ->  { condition, eq }
+
+    名称（全局变量名、函数名、非生成器产生的标签名）存放在 IrNameTable 内，
+    操作数只记录名称 id。参数在文本中使用参数名，内存中使用参数下标，
+    文本化时需要提供所在函数的参数表。
+
+*/
+
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace tc::tcir {
+
+    enum class IrOpcode : uint8_t {
+
+#define IR_OPCODE(X, Y) X,
+        #include "core/tcir/IrCode.def"
+
+        NUM_OPCODES
+    };
+
+    enum class IrLabelKind : uint8_t {
+
+        /** 不属于预定义类别的标签。编号为名称 id。 */
+        named,
+
+#define IR_LABEL_KIND(X, Y) X,
+        #include "core/tcir/IrCode.def"
+
+        NUM_LABEL_KINDS
+    };
+
+    enum class IrCondition : uint8_t {
+
+#define IR_CONDITION(X) X,
+        #include "core/tcir/IrCode.def"
+
+        NUM_CONDITIONS
+    };
+
+    enum class IrOperandKind : uint8_t {
+        none,
+
+        /** 虚拟寄存器。值为寄存器编号。 */
+        vreg,
+
+        /** 局部变量。值为变量 id。 */
+        local,
+
+        /** 函数参数。值为参数下标。 */
+        param,
+
+        /** 全局变量。值为名称 id。 */
+        global,
+
+        /** 立即数。 */
+        imm,
+
+        /** 标签。值为编号，或名称 id（named 类别）。 */
+        label,
+
+        /**
+         * 标签槽位。值为槽位号。
+         * 语法制导生成器在标签 id 确定前使用，函数生成结束时换成 label。
+         */
+        labelSlot,
+
+        /** 函数。值为名称 id。 */
+        function,
+
+        /** 普通整数。如 push 的字节数、fun-label 的符号表 id。 */
+        number,
+
+        /** 比较条件。值为 IrCondition。 */
+        condition,
+
+        /**
+         * SSA 值。值为函数内的 SSA 值编号。
+         * 只在 SSA 形式内出现，析构后换回原来的变量。
+         */
+        ssa
+    };
+
+    /**
+     * 指令操作数。
+     */
+    struct IrOperand {
+
+        IrOperandKind kind = IrOperandKind::none;
+
+        /** 标签类别。仅对 label 与 labelSlot 有效。 */
+        IrLabelKind labelKind = IrLabelKind::named;
+
+        int64_t value = 0;
+
+    public:
+
+        static IrOperand vreg(int idx) { return { IrOperandKind::vreg, IrLabelKind::named, idx }; }
+        static IrOperand local(int varId) { return { IrOperandKind::local, IrLabelKind::named, varId }; }
+        static IrOperand param(int idx) { return { IrOperandKind::param, IrLabelKind::named, idx }; }
+        static IrOperand global(int nameId) { return { IrOperandKind::global, IrLabelKind::named, nameId }; }
+        static IrOperand imm(int64_t value) { return { IrOperandKind::imm, IrLabelKind::named, value }; }
+        static IrOperand function(int nameId) { return { IrOperandKind::function, IrLabelKind::named, nameId }; }
+        static IrOperand number(int64_t value) { return { IrOperandKind::number, IrLabelKind::named, value }; }
+
+        static IrOperand label(IrLabelKind kind, int id) {
+            return { IrOperandKind::label, kind, id };
+        }
+
+        static IrOperand labelSlot(IrLabelKind kind, int slot) {
+            return { IrOperandKind::labelSlot, kind, slot };
+        }
+
+        static IrOperand condition(IrCondition cond) {
+            return { IrOperandKind::condition, IrLabelKind::named, int64_t(cond) };
+        }
+
+        static IrOperand ssa(int valueId) { return { IrOperandKind::ssa, IrLabelKind::named, valueId }; }
+
+        /**
+         * 是否为可以参与运算的值：寄存器、变量、参数、立即数或 SSA 值。
+         */
+        bool isValue() const {
+            return kind == IrOperandKind::vreg || kind == IrOperandKind::local
+                || kind == IrOperandKind::param || kind == IrOperandKind::global
+                || kind == IrOperandKind::imm || kind == IrOperandKind::ssa;
+        }
+
+        /**
+         * 值是否为名称 id：全局变量、函数与 named 类别的标签。
+         */
+        bool isName() const {
+            return kind == IrOperandKind::global || kind == IrOperandKind::function
+                || ((kind == IrOperandKind::label || kind == IrOperandKind::labelSlot)
+                    && labelKind == IrLabelKind::named);
+        }
+
+        bool isVreg(int idx) const { return kind == IrOperandKind::vreg && value == idx; }
+
+        bool operator == (const IrOperand& other) const {
+            return kind == other.kind && labelKind == other.labelKind && value == other.value;
+        }
+
+        bool operator != (const IrOperand& other) const { return !(*this == other); }
+    };
+
+    class IrCodeUtils {
+    public:
+        static const char* getName(IrOpcode opcode);
+        static const char* getName(IrCondition condition);
+
+        /**
+         * 标签名前缀。named 类别返回空串。
+         */
+        static const char* getLabelPrefix(IrLabelKind kind);
+
+        /**
+         * 根据文本查找指令码。找不到时返回 IrOpcode::unknown。
+         */
+        static IrOpcode findOpcode(std::string_view name);
+
+        /**
+         * 根据文本查找比较条件。找不到时返回 false。
+         */
+        static bool findCondition(std::string_view name, IrCondition& result);
 
+        /**
+         * 把生成器格式的标签名拆成类别与编号。不符合格式时返回 false。
+         */
+        static bool splitLabelName(std::string_view name, IrLabelKind& kind, int& id);
 
+        /**
+         * 把文本转为整数。与 strtoll(text, nullptr, 0) 相同，支持 0x 与 0 前缀。
+         * 无法转换的部分被忽略。
+         */
+        static int64_t toInt(std::string_view text);
+    };
 
+}
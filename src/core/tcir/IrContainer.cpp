@@ -10,149 +10,315 @@
 
 #include <core/tcir/IrContainer.h>
 
+#include <cstdlib>
+
 using namespace tc;
 using namespace std;
 
 namespace tc::tcir {
 
-bool IrInstructionCode::isRet() {
-    return size() == 1 && front() == "ret";
-}
+int IrNameTable::intern(const string& name) {
+    auto it = nameIds.find(name);
+    if (it != nameIds.end()) {
+        return it->second;
+    }
 
-bool IrInstructionCode::isPush() {
-    return front() == "push";
+    int nameId = names.size();
+    names.push_back(name);
+    nameIds[name] = nameId;
+    return nameId;
 }
 
-bool IrInstructionCode::isPop() {
-    return front() == "pop";
+void IrNameTable::clear() {
+    names.clear();
+    nameIds.clear();
 }
 
-bool IrInstructionCode::isLabel() {
-    return front() == "label";
-}
 
-bool IrInstructionCode::isFunLabel() {
-    return front() == "fun-label";
+bool IrInstruction::isMovToSameTargetWith(const IrInstruction& other) const {
+    // other 读取本指令的结果时（如 mov x, g; mov x, x），本指令不能丢弃。
+    return this->isMov() && other.isMov() && operands[0] == other.operands[0]
+        && other.operands[1] != operands[0];
 }
 
-bool IrInstructionCode::isCall() {
-    return front() == "call";
+bool IrInstruction::isCircularMovWith(const IrInstruction& other) const {
+    return this->isMov() && other.isMov()
+        && operands[0] == other.operands[1] && operands[1] == other.operands[0];
 }
 
-bool IrInstructionCode::isMov() {
-    return front() == "mov";
-}
+bool IrInstruction::isPairedPushPopWith(const IrInstruction& other) const {
+    if (!(this->isPush() && other.isPop()) && !(this->isPop() && other.isPush())) {
+        return false;
+    }
 
-bool IrInstructionCode::isPushForCall() {
-    return front() == "pushfc";
-}
+    if (operandCount != other.operandCount) {
+        return false;
+    }
 
-bool IrInstructionCode::isPushVreg0() {
-    return isPushVreg() && (*this)[3] == "0";
-}
+    for (int idx = 0; idx < operandCount; idx++) {
+        if (operands[idx] != other.operands[idx]) {
+            return false;
+        }
+    }
 
-bool IrInstructionCode::isPushVreg1() {
-    return isPushVreg() && (*this)[3] == "1";
+    return true;
 }
 
-bool IrInstructionCode::isPushVreg() {
-    return isPush() && (*this)[2] == "vreg";
-}
+bool IrInstruction::operator == (const IrInstruction& other) const {
+    if (opcode != other.opcode || operandCount != other.operandCount) {
+        return false;
+    }
 
-bool IrInstructionCode::isPopVreg0() {
-    return isPopVreg() && (*this)[3] == "0";
-}
+    for (int idx = 0; idx < operandCount; idx++) {
+        if (operands[idx] != other.operands[idx]) {
+            return false;
+        }
+    }
 
-bool IrInstructionCode::isPopVreg1() {
-    return isPopVreg() && (*this)[3] == "1";
+    return true;
 }
 
-bool IrInstructionCode::isPopVreg() {
-    return isPop() && (*this)[2] == "vreg";
-}
 
-bool IrInstructionCode::isMovToVreg0() {
-    return this->isMov() && (*this)[1] == "vreg" && (*this)[2] == "0";
-}
+static void __tcWriteOperand(
+    ostream& out,
+    const IrOperand& operand,
+    const IrNameTable& names,
+    const vector<FunctionParamSymbol>* params
+) {
+
+    switch (operand.kind) {
+        case IrOperandKind::none: {
+            break;
+        }
+
+        case IrOperandKind::vreg: {
+            out << "vreg " << operand.value << " ";
+            break;
+        }
+
+        case IrOperandKind::local: {
+            out << "val " << operand.value << " ";
+            break;
+        }
+
+        case IrOperandKind::param: {
+            out << "fval ";
+            if (params && operand.value >= 0 && operand.value < int64_t(params->size())) {
+                out << (*params)[operand.value].name;
+            }
+
+            out << " ";
+            break;
+        }
+
+        case IrOperandKind::global: {
+            out << "val " << names.getName(operand.value) << " ";
+            break;
+        }
+
+        case IrOperandKind::imm: {
+            out << "imm " << operand.value << " ";
+            break;
+        }
+
+        case IrOperandKind::label:
+        case IrOperandKind::labelSlot: {
+            if (operand.labelKind == IrLabelKind::named) {
+                out << names.getName(operand.value) << " ";
+            } else {
+                out << IrCodeUtils::getLabelPrefix(operand.labelKind) << operand.value << " ";
+            }
+
+            break;
+        }
+
+        case IrOperandKind::function: {
+            out << names.getName(operand.value) << " ";
+            break;
+        }
+
+        case IrOperandKind::number: {
+            out << operand.value << " ";
+            break;
+        }
 
-bool IrInstructionCode::isMovToSameTargetWith(IrInstructionCode& other) {
-    return this->isMov() && other.isMov() 
-        && (*this)[1] == other[1] && (*this)[2] == other[2];
+        case IrOperandKind::condition: {
+            out << IrCodeUtils::getName(IrCondition(operand.value)) << " ";
+            break;
+        }
+
+        case IrOperandKind::ssa: {
+            out << "ssa " << operand.value << " ";
+            break;
+        }
+    }
 }
 
-bool IrInstructionCode::isCircularMovWith(IrInstructionCode& other) {
-    return this->isMov() && other.isMov()
-        && (*this)[1] == other[3] && (*this)[2] == other[4]
-        && (*this)[3] == other[1] && (*this)[4] == other[2];
+void IrInstruction::write(
+    ostream& out,
+    const IrNameTable& names,
+    const vector<FunctionParamSymbol>* params
+) const {
+
+    out << IrCodeUtils::getName(opcode) << " ";
+
+    for (int idx = 0; idx < operandCount; idx++) {
+        __tcWriteOperand(out, operands[idx], names, params);
+    }
 }
 
-bool IrInstructionCode::isPairedPushPopWith(IrInstructionCode& other) {
-    bool thisIsPop;
-    if (this->isPush() && other.isPop()) {
-        thisIsPop = false;
-    } else if (this->isPop() && other.isPush()) {
-        thisIsPop = true;
+
+static bool __tcParseValueOperand(
+    string_view type,
+    string_view name,
+    IrNameTable& names,
+    FunctionSymbol* function,
+    IrOperand& result
+) {
+
+    if (name.empty()) {
+        return false;
+    }
+
+    if (type == "vreg") {
+        result = IrOperand::vreg(int(IrCodeUtils::toInt(name)));
+    } else if (type == "val") {
+        // 局部变量使用 id，全局变量使用变量名。变量名不以数字开头。
+        if (name[0] == '-' || (name[0] >= '0' && name[0] <= '9')) {
+            result = IrOperand::local(int(IrCodeUtils::toInt(name)));
+        } else {
+            result = IrOperand::global(names.intern(name));
+        }
+    } else if (type == "fval") {
+        if (!function) {
+            return false;
+        }
+
+        result = IrOperand::param(function->findParamSymbolIndex(string(name)));
+    } else if (type == "imm") {
+        result = IrOperand::imm(IrCodeUtils::toInt(name));
     } else {
         return false;
     }
 
-    front() = thisIsPop ? "push" : "pop";
-    bool res = *this == other;
-    front() = thisIsPop ? "pop" : "push";
-    return res;
+    return true;
 }
 
+static IrOperand __tcParseLabelOperand(string_view name, IrNameTable& names) {
+    IrLabelKind kind;
+    int id;
+    if (IrCodeUtils::splitLabelName(name, kind, id)) {
+        return IrOperand::label(kind, id);
+    }
 
-const IrInstructionCode& IrInstructionCode::operator= (const string& code) {
-
-    string codeCopy = code;
+    return IrOperand::label(IrLabelKind::named, names.intern(name));
+}
 
-    this->clear();
+bool IrInstruction::parse(
+    const vector<string_view>& segments,
+    IrNameTable& names,
+    FunctionSymbol* function
+) {
 
-    auto isBlank = [] (const char c) {
-        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
-    };
+    *this = IrInstruction();
 
-    while (codeCopy.length() > 0 && isBlank(codeCopy.back())) {
-        codeCopy.pop_back();
+    if (segments.empty()) {
+        return false;
     }
 
-    if (codeCopy.length() == 0) {
-        return *this;
-    }
+    opcode = IrCodeUtils::findOpcode(segments[0]);
 
-    string codeSegment;
+    size_t pos = 1;
 
-    int currPos = 0;
+    auto addOperand = [this] (const IrOperand& operand) {
+        if (operandCount < MAX_OPERANDS) {
+            operands[operandCount++] = operand;
+        }
+    };
 
-    // code: "  xxxx   xxxx   xxxx"  <-- 结尾没有空格。
-    while (currPos < codeCopy.length()) {
-        char c = codeCopy[currPos];
+    switch (opcode) {
+        case IrOpcode::unknown: {
+            return false;
+        }
 
-        while (isBlank(c)) {
-            c = codeCopy[++currPos];
+        case IrOpcode::ret: {
+            return segments.size() == 1;
         }
 
-        codeSegment.clear();
+        case IrOpcode::funLabel: {
+            if (segments.size() != 3) {
+                return false;
+            }
 
-        while (true) {
-            codeSegment += c;
+            addOperand(IrOperand::function(names.intern(segments[1])));
+            addOperand(IrOperand::number(IrCodeUtils::toInt(segments[2])));
+            return true;
+        }
 
-            if ((++currPos) >= codeCopy.length()) {
-                break;
+        case IrOpcode::call: {
+            if (segments.size() != 2) {
+                return false;
             }
 
-            c = codeCopy[currPos];
-            
-            if (isBlank(c)) {
-                break;
+            addOperand(IrOperand::function(names.intern(segments[1])));
+            return true;
+        }
+
+        case IrOpcode::label:
+        case IrOpcode::jmp:
+        case IrOpcode::je:
+        case IrOpcode::jne:
+        case IrOpcode::jg:
+        case IrOpcode::jge:
+        case IrOpcode::jl:
+        case IrOpcode::jle:
+        case IrOpcode::j: {
+            if (segments.size() != 2) {
+                return false;
+            }
+
+            addOperand(__tcParseLabelOperand(segments[1], names));
+            return true;
+        }
+
+        case IrOpcode::push:
+        case IrOpcode::pushfc:
+        case IrOpcode::pop: {
+            if (segments.size() < 2) {
+                return false;
             }
+
+            addOperand(IrOperand::number(IrCodeUtils::toInt(segments[1])));
+            pos = 2;
+            break;
+        }
+
+        default: {
+            break;
+        }
+    }
+
+    // 其余为成对的值操作数，cmp 最后跟一个比较条件。
+    while (pos + 1 < segments.size()) {
+        IrOperand operand;
+        if (!__tcParseValueOperand(segments[pos], segments[pos + 1], names, function, operand)) {
+            return false;
+        }
+
+        addOperand(operand);
+        pos += 2;
+    }
+
+    if (pos < segments.size()) {
+        IrCondition cond;
+        if (opcode != IrOpcode::cmp || !IrCodeUtils::findCondition(segments[pos], cond)) {
+            return false;
         }
 
-        this->push_back(codeSegment);
+        addOperand(IrOperand::condition(cond));
     }
 
-    return *this;
+    return true;
 }
 
 }
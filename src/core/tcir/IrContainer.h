@@ -10,52 +10,155 @@
 
 #pragma once
 
+#include <core/tcir/IrCode.h>
+#include <core/tcir/SymbolTable.h>
+
 #include <vector>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <iostream>
 
 namespace tc::tcir {
 
 /**
- * 单条 IR 指令码。
+ * 名称表。为全局变量名、函数名等分配从 0 开始的连续 id。
+ */
+class IrNameTable {
+
+public:
+    /**
+     * 获取名称的 id。名称不存在时登记。
+     */
+    int intern(const std::string& name);
+    int intern(std::string_view name) { return intern(std::string(name)); }
+
+    const std::string& getName(int nameId) const { return names[nameId]; }
+
+    int getNameCount() const { return int(names.size()); }
+
+    void clear();
+
+protected:
+    std::vector<std::string> names;
+    std::unordered_map<std::string, int> nameIds;
+
+};
+
+
+/**
+ * 单条 IR 指令。
  *
- *   mov   vreg  0   vreg  1  <- 1条指令。
- *    ^     ^    ^    ^    ^   
- *   [0]   [1]  [2]  [3]  [4]
- * 
+ *   mov   vreg 0   val 3     <- 1条指令。
+ *    ^     ^        ^
+ * opcode  [0]      [1]       <- operands
+ *
+ * 各指令的操作数：
+ *   fun-label  function number(符号表 id)
+ *   label      label
+ *   call       function
+ *   push, pushfc, pop   number(字节数) value
+ *   mov, xchg, add, sub, mul   value value
+ *   cmp        value value condition
+ *   jmp, je, jne ...   label
  */
-class IrInstructionCode : public std::vector<std::string> {
+class IrInstruction {
 
 public:
-    bool isRet();
-    bool isPush();
-    bool isPop();
-    bool isLabel();
-    bool isFunLabel();
-    bool isCall();
-    bool isPushForCall();
-    bool isMov();
+    static const int MAX_OPERANDS = 3;
 
-    bool isPushVreg0();
-    bool isPushVreg1();
-    bool isPushVreg();
-    bool isPopVreg0();
-    bool isPopVreg1();
-    bool isPopVreg();
+    IrOpcode opcode = IrOpcode::unknown;
+    int operandCount = 0;
+    IrOperand operands[MAX_OPERANDS];
 
-    
-    bool isMovToVreg0();
+public:
+    IrInstruction() {}
+    explicit IrInstruction(IrOpcode opcode) : opcode(opcode) {}
 
-    bool isMovToSameTargetWith(IrInstructionCode& other);
-    bool isCircularMovWith(IrInstructionCode& other);
+    IrInstruction(IrOpcode opcode, const IrOperand& a)
+        : opcode(opcode), operandCount(1), operands { a } {}
 
-    bool isPairedPushPopWith(IrInstructionCode& other);
+    IrInstruction(IrOpcode opcode, const IrOperand& a, const IrOperand& b)
+        : opcode(opcode), operandCount(2), operands { a, b } {}
 
-    const IrInstructionCode& operator= (const std::string& code);
+    IrInstruction(
+        IrOpcode opcode, const IrOperand& a, const IrOperand& b, const IrOperand& c
+    ) : opcode(opcode), operandCount(3), operands { a, b, c } {}
 
-};
+public:
+    bool isRet() const { return opcode == IrOpcode::ret && operandCount == 0; }
+    bool isPush() const { return opcode == IrOpcode::push; }
+    bool isPop() const { return opcode == IrOpcode::pop; }
+    bool isLabel() const { return opcode == IrOpcode::label; }
+    bool isFunLabel() const { return opcode == IrOpcode::funLabel; }
+    bool isCall() const { return opcode == IrOpcode::call; }
+    bool isPushForCall() const { return opcode == IrOpcode::pushfc; }
+    bool isMov() const { return opcode == IrOpcode::mov; }
+
+    bool isPushVreg0() const { return isPush() && operands[1].isVreg(0); }
+    bool isPushVreg1() const { return isPush() && operands[1].isVreg(1); }
+    bool isPushVreg() const { return isPush() && operands[1].kind == IrOperandKind::vreg; }
+    bool isPopVreg0() const { return isPop() && operands[1].isVreg(0); }
+    bool isPopVreg1() const { return isPop() && operands[1].isVreg(1); }
+    bool isPopVreg() const { return isPop() && operands[1].kind == IrOperandKind::vreg; }
+
+    bool isMovToVreg0() const { return isMov() && operands[0].isVreg(0); }
+
+    /**
+     * 本指令与 other 都是 mov，目标相同，且 other 不读取该目标。此时本指令可以删去。
+     */
+    bool isMovToSameTargetWith(const IrInstruction& other) const;
+    bool isCircularMovWith(const IrInstruction& other) const;
+
+    bool isPairedPushPopWith(const IrInstruction& other) const;
+
+    bool operator == (const IrInstruction& other) const;
+    bool operator != (const IrInstruction& other) const { return !(*this == other); }
+
+public:
 
+    /**
+     * 输出指令的文本形式。每段之后跟一个空格，不换行。
+     *
+     * @param names 名称表。
+     * @param params 指令所在函数的参数表。用于写出参数名。
+     */
+    void write(
+        std::ostream& out,
+        const IrNameTable& names,
+        const std::vector<FunctionParamSymbol>* params
+    ) const;
+
+    /**
+     * 从文本形式的各段解析指令。
+     *
+     * @param segments 指令的各段。
+     * @param names 名称表。新名称会被登记。
+     * @param function 指令所在函数。用于把参数名换成下标。
+     * @return 是否成功。
+     */
+    bool parse(
+        const std::vector<std::string_view>& segments,
+        IrNameTable& names,
+        FunctionSymbol* function
+    );
 
+};
 
 
-}
+/**
+ * IR 模块。生成器把结果直接交给后端时使用。
+ * 只引用生成器内的数据，不管理内存。
+ */
+struct IrModule {
+    const std::vector<IrInstruction>* instructions = nullptr;
+    const IrNameTable* names = nullptr;
+    GlobalSymbolTable* globalSymbolTable = nullptr;
+
+    /**
+     * 所有块符号表。父子关系已通过 parent 与 children 建立。
+     */
+    const std::vector<BlockSymbolTable*>* blockSymbolTables = nullptr;
+};
 
+}
@@ -7,17 +7,30 @@
 */
 
 #include <core/tcir/IrGenerator.h>
+#include <core/tcir/IrBinaryModule.h>
 #include <utils/ConsoleColorPad.h>
 
+#include <cstdlib>
+
 using namespace std;
 using namespace tc;
 
-static tcir::IrInstructionCode __tcMakeIrInstruction(const string& tcirCode) {
+using tcir::IrInstruction;
+using tcir::IrOpcode;
+using tcir::IrOperand;
+using tcir::IrOperandKind;
+using tcir::IrLabelKind;
+using tcir::IrCondition;
+
+static const IrOperand __tcVreg0 = IrOperand::vreg(0);
 
-    tcir::IrInstructionCode ins;
-    ins = tcirCode;
-    return ins;
+/** push 与 pop 的字节数。 */
+static const IrOperand __tcWordSize = IrOperand::number(4);
 
+tcir::IrGenerator::~IrGenerator() {
+    for (auto symbolTab : this->blockSymbolTables) {
+        delete symbolTab;
+    }
 }
 
 int tcir::IrGenerator::process(AstNode* root) {
@@ -29,6 +42,51 @@ int tcir::IrGenerator::process(AstNode* root) {
     return this->errorList.size();
 }
 
+int tcir::IrGenerator::processExternalDeclarationIncrementally(AstNode* node) {
+
+    this->processExternalDeclaration(node);
+
+    return this->errorList.size();
+}
+
+vector<SymbolKind> tcir::IrGenerator::getUnitReductionKeepList() {
+
+    // 表达式节点按实际类型分派，可以折叠。其他节点的结构被直接依赖，需要保留。
+    static const SymbolKind collapsibleKinds[] = {
+        SymbolKind::expression,
+        SymbolKind::assignment_expression,
+        SymbolKind::conditional_expression,
+        SymbolKind::logical_or_expression,
+        SymbolKind::logical_and_expression,
+        SymbolKind::inclusive_or_expression,
+        SymbolKind::exclusive_or_expression,
+        SymbolKind::and_expression,
+        SymbolKind::equality_expression,
+        SymbolKind::relational_expression,
+        SymbolKind::shift_expression,
+        SymbolKind::additive_expression,
+        SymbolKind::multiplicative_expression,
+        SymbolKind::cast_expression,
+        SymbolKind::unary_expression,
+        SymbolKind::postfix_expression,
+        SymbolKind::primary_expression
+    };
+
+    vector<bool> collapsible(size_t(SymbolKind::NUM_SYMBOLS), false);
+    for (auto kind : collapsibleKinds) {
+        collapsible[size_t(kind)] = true;
+    }
+
+    vector<SymbolKind> keepList;
+    for (size_t kind = 0; kind < collapsible.size(); kind++) {
+        if (!collapsible[kind]) {
+            keepList.push_back(SymbolKind(kind));
+        }
+    }
+
+    return keepList;
+}
+
 void tcir::IrGenerator::dump(ostream& out, bool withColor) {
 
     auto setColor = [withColor] (int red = -1, int green = 0, int blue = 0) {
@@ -115,18 +173,26 @@ void tcir::IrGenerator::dump(ostream& out, bool withColor) {
     
     setColor(0x43, 0xb2, 0x44);
     out << "@ begin of block-symtab" << endl;
-    out << blockSymbolTableIrDumps.str() << endl;
+    for (auto symbolTab : this->blockSymbolTables) {
+        symbolTab->dump(out);
+    }
+    out << endl;
     out << "@ end of block-symtab" << endl;
     out << endl;
 
     /* 指令。 */
     setColor(0xfc, 0xa1, 0x06);
     out << "@ begin of instructions" << endl;
-    for (auto& insCode : this->instructionList) {
-        for (auto& codeSegment : insCode) {
-            out << codeSegment << " ";
+    // 参数在指令内记录为下标，输出时需要所在函数的参数表。
+    const vector< FunctionParamSymbol >* params = nullptr;
+    for (auto& ins : this->instructionList) {
+        if (ins.isFunLabel()) {
+            auto fun = globalSymbolTable.getFunction(irNames.getName(ins.operands[0].value));
+            params = fun ? &fun->params : nullptr;
         }
-        out << endl;
+
+        ins.write(out, irNames, params);
+        out << '\n';
     }
     out << "@ end of instructions" << endl;
 
@@ -136,12 +202,30 @@ void tcir::IrGenerator::dump(ostream& out, bool withColor) {
 
 }
 
+int tcir::IrGenerator::dumpBinary(ostream& out) {
+    return IrBinaryModule::write(out, this->getModule());
+}
+
+tcir::IrModule tcir::IrGenerator::getModule() {
+    IrModule module;
+    module.instructions = &this->instructionList;
+    module.names = &this->irNames;
+    module.globalSymbolTable = &this->globalSymbolTable;
+    module.blockSymbolTables = &this->blockSymbolTables;
+    return module;
+}
+
 void tcir::IrGenerator::clear() {
     this->varDescTable.clear();
     this->errorList.clear();
     this->globalSymbolTable.clear();
     this->instructionList.clear();
-    this->blockSymbolTableIrDumps.str(string());
+    this->irNames.clear();
+
+    for (auto symbolTab : this->blockSymbolTables) {
+        delete symbolTab;
+    }
+    this->blockSymbolTables.clear();
 
     if (this->currentBlockSymbolTable) {
         delete this->currentBlockSymbolTable;
@@ -151,6 +235,8 @@ void tcir::IrGenerator::clear() {
     this->nextLabelId = 1;
     this->nextVarId = 1;
     this->nextBlockSymTabId = 1;
+    this->nextTemporaryId = 2;
+    this->resultOperand = __tcVreg0;
 }
 
 void tcir::IrGenerator::addUnsupportedGrammarError(AstNode* node) {
@@ -158,20 +244,20 @@ void tcir::IrGenerator::addUnsupportedGrammarError(AstNode* node) {
     auto& err = errorList.emplace_back();
 
     AstNode* firstToken = node;
-    while (firstToken->symbolType == grammar::SymbolType::NON_TERMINAL) {
+    while (firstToken->symbolType() == grammar::SymbolType::NON_TERMINAL) {
         firstToken = firstToken->children[0];
     }
 
     err.astNode = node;
 
     err.msg = "not supported: (";
-    err.msg += to_string(firstToken->token.row);
+    err.msg += to_string(firstToken->token().row);
     err.msg += ", ";
-    err.msg += to_string(firstToken->token.col);
+    err.msg += to_string(firstToken->token().col);
     err.msg += ") ";
-    err.msg += firstToken->token.content;
+    err.msg += firstToken->token().content;
     err.msg += " as ";
-    err.msg += node->symbol.name;
+    err.msg += node->symbol().name;
 }
 
 /* ----------- 模块处理函数。 ------------ */
@@ -204,7 +290,7 @@ void tcir::IrGenerator::processExternalDeclaration(AstNode* node) {
 
     AstNode* child = node->children[0];
 
-    if (child->symbolKind == SymbolKind::function_definition) {
+    if (child->symbolKind() == SymbolKind::function_definition) {
 
         // 函数定义
 
@@ -271,14 +357,14 @@ void tcir::IrGenerator::processFunctionDeclaration(AstNode* node) {
 
         // 过滤不支持的类型，同时获取参数表。
         if (directDeclarator->children.size() == 3
-            && directDeclarator->children[1]->symbolType == grammar::SymbolType::TERMINAL
-            && directDeclarator->children[1]->tokenKind == TokenKind::l_paren
+            && directDeclarator->children[1]->symbolType() == grammar::SymbolType::TERMINAL
+            && directDeclarator->children[1]->tokenKind() == TokenKind::l_paren
         ) {
             
             // do nothing
         
         } else if (directDeclarator->children.size() == 4
-            && directDeclarator->children[2]->symbolKind == SymbolKind::parameter_type_list
+            && directDeclarator->children[2]->symbolKind() == SymbolKind::parameter_type_list
         ) do { // 采用 do while(0) 结构，更好中途跳出。
 
             AstNode* parameterTypeList = directDeclarator->children[2];
@@ -332,7 +418,7 @@ void tcir::IrGenerator::processFunctionDeclaration(AstNode* node) {
                 }
 
 
-                if (paramDecl->children[1]->symbolKind == SymbolKind::abstract_declarator) {
+                if (paramDecl->children[1]->symbolKind() == SymbolKind::abstract_declarator) {
                     this->addUnsupportedGrammarError(paramDecl->children[1]);
                     continue;
                 }
@@ -353,7 +439,7 @@ void tcir::IrGenerator::processFunctionDeclaration(AstNode* node) {
                     continue;
                 }
 
-                string& name = dirDecl->children[0]->token.content;
+                const string& name = dirDecl->children[0]->token().content;
                 
                 auto& param = functionParams.emplace_back();
                 
@@ -380,12 +466,12 @@ void tcir::IrGenerator::processFunctionDeclaration(AstNode* node) {
 
         AstNode* identifierDirectDecl = directDeclarator->children[0];
 
-        if (identifierDirectDecl->children[0]->symbolType != grammar::SymbolType::TERMINAL) {
+        if (identifierDirectDecl->children[0]->symbolType() != grammar::SymbolType::TERMINAL) {
             this->addUnsupportedGrammarError(identifierDirectDecl);
             return;
         }
 
-        string& functionName = identifierDirectDecl->children[0]->token.content;
+        const string& functionName = identifierDirectDecl->children[0]->token().content;
 
         // 生成函数信息。
 
@@ -404,13 +490,14 @@ void tcir::IrGenerator::processFunctionDeclaration(AstNode* node) {
         funcSymbol->visibility = SymbolVisibility::global;
 
         this->currentFunction = funcSymbol;
+        this->nextTemporaryId = 2;
 
         // 生成标签。
-        instructionList.emplace_back();
-        auto& irInstructionCode = instructionList.back();
-        irInstructionCode.push_back("fun-label");
-        irInstructionCode.push_back(functionName);
-        irInstructionCode.push_back(to_string(this->nextBlockSymTabId));
+        instructionList.emplace_back(
+            IrOpcode::funLabel,
+            IrOperand::function(irNames.intern(functionName)),
+            IrOperand::number(this->nextBlockSymTabId)
+        );
 
         // 处理 compound statement
 
@@ -418,8 +505,7 @@ void tcir::IrGenerator::processFunctionDeclaration(AstNode* node) {
 
         // 生成 ret 语句。
         // 这样做可能会导致重复生成 ret。后续删去多余的 ret 即可。
-        instructionList.emplace_back();
-        instructionList.back().push_back("ret");
+        instructionList.emplace_back(IrOpcode::ret);
 
         this->currentFunction = nullptr; // 不再绑定当前函数。
 
@@ -467,8 +553,16 @@ void tcir::IrGenerator::processCompoundStatement(AstNode* node) {
         currentBlockSymbolTable = symbolTab->parent;
     }
 
-    symbolTab->dump(this->blockSymbolTableIrDumps);
-    delete symbolTab;
+    this->retainBlockSymbolTable(symbolTab);
+}
+
+void tcir::IrGenerator::retainBlockSymbolTable(BlockSymbolTable* symbolTab) {
+
+    if (symbolTab->parent != symbolTab) {
+        symbolTab->parent->children.push_back(symbolTab);
+    }
+
+    this->blockSymbolTables.push_back(symbolTab);
 }
 
 void tcir::IrGenerator::processBlockItemList(AstNode* node) {
@@ -485,7 +579,7 @@ void tcir::IrGenerator::processBlockItem(AstNode* node) {
 
 
 
-    if (node->children[0]->symbolKind == SymbolKind::statement) {
+    if (node->children[0]->symbolKind() == SymbolKind::statement) {
         
         this->processStatement(node->children[0]);
         
@@ -512,7 +606,7 @@ void tcir::IrGenerator::processStatement(AstNode* node) {
     
     */
 
-    switch (node->children[0]->symbolKind) {
+    switch (node->children[0]->symbolKind()) {
 
         case SymbolKind::labeled_statement: {
             this->addUnsupportedGrammarError(node->children[0]);
@@ -578,32 +672,29 @@ void tcir::IrGenerator::processStatement(AstNode* node) {
 
 void tcir::IrGenerator::processSelectionStatement(AstNode* node) {
 
-    if (node->children[0]->tokenKind == TokenKind::kw_switch) {
+    if (node->children[0]->tokenKind() == TokenKind::kw_switch) {
         this->addUnsupportedGrammarError(node->children[0]);
         return; // 暂不支持 switch case 语句。
     }
 
-    string endLabel = ".if_end_" + to_string(nextLabelId++);
+    auto endLabel = IrOperand::label(IrLabelKind::ifEnd, nextLabelId++);
 
-    processExpression(node->children[2], false);
+    processExpressionNode(node->children[2], false);
+    this->moveResultToVreg0();
 
     bool hasElseStmt = node->children.size() == 7;
 
-    string elseLabel;
+    IrOperand elseLabel;
 
     if (hasElseStmt) {
 
-        elseLabel = ".if_else_" + to_string(nextLabelId++);
+        elseLabel = IrOperand::label(IrLabelKind::ifElse, nextLabelId++);
 
-        instructionList.push_back(__tcMakeIrInstruction(
-            "je " + elseLabel
-        ));
+        instructionList.emplace_back(IrOpcode::je, elseLabel);
 
     } else {
 
-        instructionList.push_back(__tcMakeIrInstruction(
-            "je " + endLabel
-        ));
+        instructionList.emplace_back(IrOpcode::je, endLabel);
     
     }
 
@@ -611,21 +702,15 @@ void tcir::IrGenerator::processSelectionStatement(AstNode* node) {
 
     if (hasElseStmt) {
 
-        instructionList.push_back(__tcMakeIrInstruction(
-            "jmp " + endLabel
-        ));
+        instructionList.emplace_back(IrOpcode::jmp, endLabel);
 
-        instructionList.push_back(__tcMakeIrInstruction(
-            "label " + elseLabel
-        ));
+        instructionList.emplace_back(IrOpcode::label, elseLabel);
 
         processStatement(node->children[6]);
         
     } 
 
-    instructionList.push_back(__tcMakeIrInstruction(
-        "label " + endLabel
-    ));
+    instructionList.emplace_back(IrOpcode::label, endLabel);
     
 
 }
@@ -634,13 +719,13 @@ void tcir::IrGenerator::processIterationStatement(AstNode* node) {
 
     // iteration_statement ->
 
-    if (node->children[0]->tokenKind == TokenKind::kw_while) {
+    if (node->children[0]->tokenKind() == TokenKind::kw_while) {
 
         // WHILE '(' expression ')' statement
 
         processIterationStatementWhileLoop(node->children[2], node->children[4]);
         
-    } else if (node->children[0]->tokenKind == TokenKind::kw_do) {
+    } else if (node->children[0]->tokenKind() == TokenKind::kw_do) {
 
         // DO statement WHILE '(' expression ')' ';'
 
@@ -701,26 +786,27 @@ void tcir::IrGenerator::processIterationStatementDoWhile(
 
     */
 
-    string&& labelIdStr = to_string(nextLabelId++);
+    int labelId = nextLabelId++;
 
-    string&& stmtLabel = ".do_while_stmt_" + labelIdStr;
-    string&& expLabel = ".do_while_exp_" + labelIdStr;
-    string&& endLabel = ".do_while_end_" + labelIdStr;
+    auto stmtLabel = IrOperand::label(IrLabelKind::doWhileStmt, labelId);
+    auto expLabel = IrOperand::label(IrLabelKind::doWhileExp, labelId);
+    auto endLabel = IrOperand::label(IrLabelKind::doWhileEnd, labelId);
 
     this->continueStmtTargets.push_back(expLabel);
     this->breakStmtTargets.push_back(endLabel);
 
-    instructionList.push_back(__tcMakeIrInstruction("label " + stmtLabel));
+    instructionList.emplace_back(IrOpcode::label, stmtLabel);
 
     processStatement(statement);
     
-    instructionList.push_back(__tcMakeIrInstruction("label " + expLabel));
+    instructionList.emplace_back(IrOpcode::label, expLabel);
     
-    processExpression(expression, false);
-    instructionList.push_back(__tcMakeIrInstruction("je " + endLabel));
-    instructionList.push_back(__tcMakeIrInstruction("j " + stmtLabel));
+    processExpressionNode(expression, false);
+    this->moveResultToVreg0();
+    instructionList.emplace_back(IrOpcode::je, endLabel);
+    instructionList.emplace_back(IrOpcode::j, stmtLabel);
 
-    instructionList.push_back(__tcMakeIrInstruction("label " + endLabel));
+    instructionList.emplace_back(IrOpcode::label, endLabel);
 
 
     this->continueStmtTargets.pop_back();
@@ -756,22 +842,23 @@ void tcir::IrGenerator::processIterationStatementWhileLoop(
 
     */
 
-    string&& labelIdStr = to_string(nextLabelId++);
+    int labelId = nextLabelId++;
 
-    string&& stmtLabel = ".while_loop_stmt_" + labelIdStr;
-    string&& expLabel = ".while_loop_exp_" + labelIdStr;
-    string&& endLabel = ".while_loop_end_" + labelIdStr;
+    auto stmtLabel = IrOperand::label(IrLabelKind::whileLoopStmt, labelId);
+    auto expLabel = IrOperand::label(IrLabelKind::whileLoopExp, labelId);
+    auto endLabel = IrOperand::label(IrLabelKind::whileLoopEnd, labelId);
 
     this->continueStmtTargets.push_back(expLabel);
     this->breakStmtTargets.push_back(endLabel);
 
-    instructionList.push_back(__tcMakeIrInstruction("label " + expLabel));
-    processExpression(expression, false);
-    instructionList.push_back(__tcMakeIrInstruction("je " + endLabel));
-    instructionList.push_back(__tcMakeIrInstruction("label " + stmtLabel));
+    instructionList.emplace_back(IrOpcode::label, expLabel);
+    processExpressionNode(expression, false);
+    this->moveResultToVreg0();
+    instructionList.emplace_back(IrOpcode::je, endLabel);
+    instructionList.emplace_back(IrOpcode::label, stmtLabel);
     processStatement(statement);
-    instructionList.push_back(__tcMakeIrInstruction("jmp " + expLabel));
-    instructionList.push_back(__tcMakeIrInstruction("label " + endLabel));
+    instructionList.emplace_back(IrOpcode::jmp, expLabel);
+    instructionList.emplace_back(IrOpcode::label, endLabel);
     
 
     this->continueStmtTargets.pop_back();
@@ -787,7 +874,7 @@ void tcir::IrGenerator::processIterationStatementForLoop(
     AstNode* statement 
 ) {
 
-    if (expStmtOrDeclaration->symbolKind == SymbolKind::declaration) {
+    if (expStmtOrDeclaration->symbolKind() == SymbolKind::declaration) {
         this->addUnsupportedGrammarError(expStmtOrDeclaration);
         // 暂不支持 for (int x = 0; ; ) {} 这种形式。循环变量要求在外部定义。
         return;
@@ -818,20 +905,20 @@ void tcir::IrGenerator::processIterationStatementForLoop(
     
     */
 
-    auto pushIr = [this] (const string& ir) {
-        this->instructionList.push_back(__tcMakeIrInstruction(ir));
+    auto pushIr = [this] (IrOpcode opcode, const IrOperand& label) {
+        this->instructionList.emplace_back(opcode, label);
     };
 
-    string&& labelIdStr = to_string(nextLabelId++);
-    string&& estmtLabel = ".for_loop_estmt_" + labelIdStr;
-    string&& expLabel = ".for_loop_exp_" + labelIdStr;
-    string&& endLabel = ".for_loop_end_" + labelIdStr;
+    int labelId = nextLabelId++;
+    auto estmtLabel = IrOperand::label(IrLabelKind::forLoopEstmt, labelId);
+    auto expLabel = IrOperand::label(IrLabelKind::forLoopExp, labelId);
+    auto endLabel = IrOperand::label(IrLabelKind::forLoopEnd, labelId);
 
     this->continueStmtTargets.push_back(expLabel);
     this->breakStmtTargets.push_back(endLabel);
 
     // expStmtOrDecl
-    if (expStmtOrDeclaration->symbolKind == SymbolKind::declaration) {
+    if (expStmtOrDeclaration->symbolKind() == SymbolKind::declaration) {
         this->addUnsupportedGrammarError(expStmtOrDeclaration);
         // 暂不支持 for (int x = 0; ; ) {} 这种形式。循环变量要求在外部定义。
         return;
@@ -841,16 +928,17 @@ void tcir::IrGenerator::processIterationStatementForLoop(
 
     }
 
-    pushIr("label " + estmtLabel);
+    pushIr(IrOpcode::label, estmtLabel);
     this->processExpressionStatement(expStmt);
-    pushIr("je " + endLabel);
+    this->moveResultToVreg0();
+    pushIr(IrOpcode::je, endLabel);
 
     processStatement(statement);
 
-    pushIr("label " + expLabel);
-    processExpression(expression, false);
-    pushIr("jmp " + estmtLabel);
-    pushIr("label " + endLabel);
+    pushIr(IrOpcode::label, expLabel);
+    processExpressionNode(expression, false);
+    pushIr(IrOpcode::jmp, estmtLabel);
+    pushIr(IrOpcode::label, endLabel);
 
     this->continueStmtTargets.pop_back();
     this->breakStmtTargets.pop_back();
@@ -859,7 +947,7 @@ void tcir::IrGenerator::processIterationStatementForLoop(
 
 void tcir::IrGenerator::processJumpStatement(AstNode* node) {
 
-    switch (node->children[0]->tokenKind) {
+    switch (node->children[0]->tokenKind()) {
 
         case TokenKind::kw_goto: {
             
@@ -879,9 +967,7 @@ void tcir::IrGenerator::processJumpStatement(AstNode* node) {
                
             } else {
 
-                instructionList.push_back(__tcMakeIrInstruction(
-                    "jmp " + continueStmtTargets.back()
-                ));
+                instructionList.emplace_back(IrOpcode::jmp, continueStmtTargets.back());
             }
 
             break;
@@ -896,9 +982,7 @@ void tcir::IrGenerator::processJumpStatement(AstNode* node) {
                 
             } else {
 
-                instructionList.push_back(__tcMakeIrInstruction(
-                    "jmp " + breakStmtTargets.back()
-                ));
+                instructionList.emplace_back(IrOpcode::jmp, breakStmtTargets.back());
             }
 
             break;
@@ -907,10 +991,11 @@ void tcir::IrGenerator::processJumpStatement(AstNode* node) {
         case TokenKind::kw_return: {
 
             if (node->children.size() == 3) {
-                processExpression(node->children[1], false);
+                processExpressionNode(node->children[1], false);
+                this->moveResultToVreg0();
             }
 
-            instructionList.push_back(__tcMakeIrInstruction("ret"));
+            instructionList.emplace_back(IrOpcode::ret);
 
             break;
         }
@@ -996,7 +1081,7 @@ void tcir::IrGenerator::processVariableInitDeclarator(
     }
 
 
-    string& idName = dirDecl->children[0]->token.content;
+    const string& idName = dirDecl->children[0]->token().content;
 
 
     VariableSymbol* symbol = new VariableSymbol;
@@ -1106,7 +1191,7 @@ void tcir::IrGenerator::processVariableInitDeclarator(
     AstNode* assignmentExp = initializer->children[0];
 
     int prevErrCount = this->errorList.size();
-    string expRes = this->processAssignmentExpression(assignmentExp, isInGlobalScope);
+    string expRes = this->processExpressionNode(assignmentExp, isInGlobalScope);
 
     if (errorList.size() - prevErrCount > 0) {
         return; // 遇到错误，不继续。
@@ -1127,20 +1212,63 @@ void tcir::IrGenerator::processVariableInitDeclarator(
 
     } else {
 
-        auto& inst = this->instructionList.emplace_back();
-
         int varId = symbol->id;
 
         // 因为只考虑 int，这里直接等号就行。
 
-        inst.push_back("mov");
+        this->instructionList.emplace_back(
+            IrOpcode::mov, IrOperand::local(varId), resultOperand
+        );
+
+    }
+}
 
-        inst.push_back("val");
-        inst.push_back(to_string(varId));
+string tcir::IrGenerator::processExpressionNode(AstNode* node, bool isInGlobalScope) {
 
-        inst.push_back("vreg");
-        inst.push_back("0");
+    /*
+        语法分析器可能折叠了单产生式，例如 expression 的位置上
+        直接出现 primary_expression。因此按节点的实际类型分派。
+    */
 
+    switch (node->symbolKind()) {
+        case SymbolKind::expression:
+            return processExpression(node, isInGlobalScope);
+        case SymbolKind::assignment_expression:
+            return processAssignmentExpression(node, isInGlobalScope);
+        case SymbolKind::conditional_expression:
+            return processConditionalExpression(node, isInGlobalScope);
+        case SymbolKind::logical_or_expression:
+            return processLogicalOrExpression(node, isInGlobalScope);
+        case SymbolKind::logical_and_expression:
+            return processLogicalAndExpression(node, isInGlobalScope);
+        case SymbolKind::inclusive_or_expression:
+            return processInclusiveOrExpression(node, isInGlobalScope);
+        case SymbolKind::exclusive_or_expression:
+            return processExclusiveOrExpression(node, isInGlobalScope);
+        case SymbolKind::and_expression:
+            return processAndExpression(node, isInGlobalScope);
+        case SymbolKind::equality_expression:
+            return processEqualityExpression(node, isInGlobalScope);
+        case SymbolKind::relational_expression:
+            return processRelationalExpression(node, isInGlobalScope);
+        case SymbolKind::shift_expression:
+            return processShiftExpression(node, isInGlobalScope);
+        case SymbolKind::additive_expression:
+            return processAdditiveExpression(node, isInGlobalScope);
+        case SymbolKind::multiplicative_expression:
+            return processMultiplicativeExpression(node, isInGlobalScope);
+        case SymbolKind::cast_expression:
+            return processCastExpression(node, isInGlobalScope);
+        case SymbolKind::unary_expression:
+            return processUnaryExpression(node, isInGlobalScope);
+        case SymbolKind::postfix_expression:
+            return processPostfixExpression(node, isInGlobalScope);
+        case SymbolKind::primary_expression:
+            return processPrimaryExpression(node, isInGlobalScope);
+
+        default:
+            this->addUnsupportedGrammarError(node);
+            return "";
     }
 }
 
@@ -1161,7 +1289,7 @@ string tcir::IrGenerator::processAssignmentExpression(
 
     if (node->children.size() == 1) {
 
-        return processConditionalExpression(node->children[0], isInGlobalScope);
+        return processExpressionNode(node->children[0], isInGlobalScope);
     }
    
     
@@ -1174,7 +1302,7 @@ string tcir::IrGenerator::processAssignmentExpression(
 
     int errCount = errorList.size();
 
-    this->processUnaryExpression(node->children[0], isInGlobalScope);
+    this->processExpressionNode(node->children[0], isInGlobalScope);
     // 执行完上方语句，directSymbol 会被设置。
 
     if (errorList.size() - errCount) {
@@ -1191,11 +1319,11 @@ string tcir::IrGenerator::processAssignmentExpression(
     }
 
     auto dirSymbol = directResultSymbol;
-    string valueName = this->symbolToIrValueCode(dirSymbol);
+    IrOperand valueOperand = this->symbolToIrOperand(dirSymbol);
 
-    TokenKind op = node->children[1]->children[0]->tokenKind;
+    TokenKind op = node->children[1]->children[0]->tokenKind();
 
-    this->processAssignmentExpression(node->children[2], isInGlobalScope);
+    this->processExpressionNode(node->children[2], isInGlobalScope);
     if (errCount - errorList.size()) {
         return "";
     }
@@ -1203,22 +1331,27 @@ string tcir::IrGenerator::processAssignmentExpression(
     switch (op) {
         case TokenKind::equal: {
 
-            instructionList.push_back(__tcMakeIrInstruction(
-                "mov " + valueName + " vreg 0"
-            ));
+            // x = x 不产生指令。
+            if (resultOperand != valueOperand) {
+                instructionList.emplace_back(IrOpcode::mov, valueOperand, resultOperand);
+            }
+
+            resultOperand = valueOperand;
 
             break;
         }
 
-        case TokenKind::plusequal: {
-            this->addUnsupportedGrammarError(node->children[1]->children[0]);
-            // 暂不支持 +=
-            break;
-        }
-        
-        case TokenKind::minusequal: {
-            this->addUnsupportedGrammarError(node->children[1]->children[0]);
-            // 暂不支持 -=
+        case TokenKind::plusequal:
+        case TokenKind::minusequal:
+        case TokenKind::starequal: {
+
+            // 直接在变量上运算。
+            IrOpcode opcode = op == TokenKind::plusequal ? IrOpcode::add
+                : op == TokenKind::minusequal ? IrOpcode::sub : IrOpcode::mul;
+
+            instructionList.emplace_back(opcode, valueOperand, resultOperand);
+            resultOperand = valueOperand;
+
             break;
         }
 
@@ -1248,7 +1381,7 @@ string tcir::IrGenerator::processConditionalExpression(
    
 
     int errCount = errorList.size();
-    auto logiOrRes = processLogicalOrExpression(node->children[0], isInGlobalScope);
+    auto logiOrRes = processExpressionNode(node->children[0], isInGlobalScope);
 
     if (errorList.size() - errCount) {
         return "";
@@ -1264,13 +1397,13 @@ string tcir::IrGenerator::processConditionalExpression(
 
             // expression
 
-            return processExpression(node->children[2], isInGlobalScope);
+            return processExpressionNode(node->children[2], isInGlobalScope);
 
         } else {
 
             // conditional expression
 
-            return processConditionalExpression(node->children[4], isInGlobalScope);
+            return processExpressionNode(node->children[4], isInGlobalScope);
         }
 
     } else {
@@ -1288,28 +1421,23 @@ string tcir::IrGenerator::processConditionalExpression(
         */
 
         auto labelId = this->nextLabelId++;
-        auto&& exitLabel = ".con_exit_" + to_string(labelId);
-        auto&& falseLabel = ".con_false_" + to_string(labelId);
+        auto exitLabel = IrOperand::label(IrLabelKind::conExit, labelId);
+        auto falseLabel = IrOperand::label(IrLabelKind::conFalse, labelId);
 
-        this->instructionList.push_back(__tcMakeIrInstruction(
-            "je " + falseLabel
-        ));
+        this->moveResultToVreg0();
+        this->instructionList.emplace_back(IrOpcode::je, falseLabel);
 
-        this->processExpression(node->children[2], isInGlobalScope);
+        this->processExpressionNode(node->children[2], isInGlobalScope);
+        this->moveResultToVreg0();
 
-        this->instructionList.push_back(__tcMakeIrInstruction(
-            "jmp " + exitLabel
-        ));
+        this->instructionList.emplace_back(IrOpcode::jmp, exitLabel);
 
-        this->instructionList.push_back(__tcMakeIrInstruction(
-            "label " + falseLabel
-        ));
+        this->instructionList.emplace_back(IrOpcode::label, falseLabel);
 
-        this->processConditionalExpression(node->children[4], isInGlobalScope);
+        this->processExpressionNode(node->children[4], isInGlobalScope);
+        this->moveResultToVreg0();
 
-        this->instructionList.push_back(__tcMakeIrInstruction(
-            "label " + exitLabel
-        ));
+        this->instructionList.emplace_back(IrOpcode::label, exitLabel);
 
         return "";
 
@@ -1332,12 +1460,12 @@ string tcir::IrGenerator::processLogicalOrExpression(
     */
     
     if (node->children.size() == 1) {
-        return processLogicalAndExpression(node->children[0], isInGlobalScope);
+        return processExpressionNode(node->children[0], isInGlobalScope);
     }
 
 
     int errCount = this->errorList.size();
-    auto logiOrRes = processLogicalOrExpression(node->children[0], isInGlobalScope);
+    auto logiOrRes = processExpressionNode(node->children[0], isInGlobalScope);
     if (errorList.size() - errCount) {
         return "";
     }
@@ -1349,21 +1477,20 @@ string tcir::IrGenerator::processLogicalOrExpression(
             return "1";
         }
 
-        return processLogicalAndExpression(node->children[2], isInGlobalScope);
+        return processExpressionNode(node->children[2], isInGlobalScope);
 
     } else {
 
-        string resultLabel = ".logical_or_out_" + to_string(nextLabelId++);
+        auto resultLabel = IrOperand::label(IrLabelKind::logicalOrOut, nextLabelId++);
 
         // 短路跳转。
-        instructionList.push_back(__tcMakeIrInstruction("jne " + resultLabel));
+        this->moveResultToVreg0();
+        instructionList.emplace_back(IrOpcode::jne, resultLabel);
 
-        processLogicalAndExpression(node->children[2], isInGlobalScope);
+        processExpressionNode(node->children[2], isInGlobalScope);
+        this->moveResultToVreg0();
 
-        IrInstructionCode labelCode;
-        labelCode.push_back("label");
-        labelCode.push_back(resultLabel);
-        instructionList.push_back(labelCode);
+        instructionList.emplace_back(IrOpcode::label, resultLabel);
 
         return "";
 
@@ -1387,11 +1514,11 @@ string tcir::IrGenerator::processLogicalAndExpression(
     */
     
     if (node->children.size() == 1) {
-        return processInclusiveOrExpression(node->children[0], isInGlobalScope);
+        return processExpressionNode(node->children[0], isInGlobalScope);
     }
 
     int errCount = this->errorList.size();
-    auto logiAndRes = processLogicalAndExpression(node->children[0], isInGlobalScope);
+    auto logiAndRes = processExpressionNode(node->children[0], isInGlobalScope);
 
     if (errorList.size() - errCount) {
         return "";
@@ -1403,21 +1530,20 @@ string tcir::IrGenerator::processLogicalAndExpression(
             return "0";
         }
 
-        return processInclusiveOrExpression(node->children[2], isInGlobalScope);
+        return processExpressionNode(node->children[2], isInGlobalScope);
 
     } else {
 
-        string resultLabel = ".logical_and_out_" + to_string(nextLabelId++);
+        auto resultLabel = IrOperand::label(IrLabelKind::logicalAndOut, nextLabelId++);
 
         // 短路跳转。
-        instructionList.push_back(__tcMakeIrInstruction("je " + resultLabel));
+        this->moveResultToVreg0();
+        instructionList.emplace_back(IrOpcode::je, resultLabel);
 
-        processInclusiveOrExpression(node->children[2], isInGlobalScope);
+        processExpressionNode(node->children[2], isInGlobalScope);
+        this->moveResultToVreg0();
 
-        IrInstructionCode labelCode;
-        labelCode.push_back("label");
-        labelCode.push_back(resultLabel);
-        instructionList.push_back(labelCode);
+        instructionList.emplace_back(IrOpcode::label, resultLabel);
 
         return "";
 
@@ -1440,13 +1566,13 @@ string tcir::IrGenerator::processInclusiveOrExpression(
     */
     
     if (node->children.size() == 1) {
-        return processExclusiveOrExpression(node->children[0], isInGlobalScope);
+        return processExpressionNode(node->children[0], isInGlobalScope);
     } 
     
     if (isInGlobalScope) {
 
-        auto res1 = processInclusiveOrExpression(node->children[0], isInGlobalScope);
-        auto res2 = processExclusiveOrExpression(node->children[2], isInGlobalScope);
+        auto res1 = processExpressionNode(node->children[0], isInGlobalScope);
+        auto res2 = processExpressionNode(node->children[2], isInGlobalScope);
 
         return to_string(stoll(res1) | stoll(res2));
 
@@ -1472,13 +1598,13 @@ string tcir::IrGenerator::processExclusiveOrExpression(
     */
 
     if (node->children.size() == 1) {
-        return processAndExpression(node->children[0], isInGlobalScope);
+        return processExpressionNode(node->children[0], isInGlobalScope);
     } 
     
     if (isInGlobalScope) {
 
-        auto&& res1 = processExclusiveOrExpression(node->children[0], isInGlobalScope);
-        auto&& res2 = processAndExpression(node->children[2], isInGlobalScope);
+        auto&& res1 = processExpressionNode(node->children[0], isInGlobalScope);
+        auto&& res2 = processExpressionNode(node->children[2], isInGlobalScope);
 
         return to_string(stoll(res1) ^ stoll(res2));
 
@@ -1505,13 +1631,13 @@ string tcir::IrGenerator::processAndExpression(
     */
     
     if (node->children.size() == 1) {
-        return processEqualityExpression(node->children[0], isInGlobalScope);
+        return processExpressionNode(node->children[0], isInGlobalScope);
     } 
     
     if (isInGlobalScope) {
 
-        auto&& res1 = processAndExpression(node->children[0], isInGlobalScope);
-        auto&& res2 = processEqualityExpression(node->children[2], isInGlobalScope);
+        auto&& res1 = processExpressionNode(node->children[0], isInGlobalScope);
+        auto&& res2 = processExpressionNode(node->children[2], isInGlobalScope);
 
         return to_string(stoll(res1) & stoll(res2));
 
@@ -1540,21 +1666,21 @@ string tcir::IrGenerator::processEqualityExpression(AstNode* node, bool isInGlob
    
 
     if (node->children.size() == 1) {
-        return this->processRelationalExpression(node->children[0], isInGlobalScope);
+        return this->processExpressionNode(node->children[0], isInGlobalScope);
     }
 
     int errCount = this->errorList.size();
 
-    auto eqExpResult = processEqualityExpression(node->children[0], isInGlobalScope);
+    auto eqExpResult = processExpressionNode(node->children[0], isInGlobalScope);
 
-    auto opToken = node->children[1]->tokenKind;
+    auto opToken = node->children[1]->tokenKind();
 
     if (errorList.size() - errCount) {
         return "";
     }
 
     if (isInGlobalScope) {
-        auto relationExpRes = processRelationalExpression(
+        auto relationExpRes = processExpressionNode(
             node->children[2], isInGlobalScope
         );
 
@@ -1573,30 +1699,34 @@ string tcir::IrGenerator::processEqualityExpression(AstNode* node, bool isInGlob
 
     } else {
 
-        this->instructionList.push_back(__tcMakeIrInstruction("push 4 vreg 0"));
+        // cmp 的左操作数不能是立即数。vreg 0 可能被右侧改写，也先复制出来。
+        if (resultOperand.kind == IrOperandKind::imm || resultOperand.isVreg(0)) {
+            this->moveResultToTemporary();
+        }
 
-        auto relationExpRes = processRelationalExpression(
-            node->children[2], isInGlobalScope
-        );
+        auto lhs = resultOperand;
+
+        processExpressionNode(node->children[2], isInGlobalScope);
 
         if (errorList.size() - errCount) {
             return "";
         }
 
-        this->instructionList.push_back(__tcMakeIrInstruction("pop 4 vreg 1"));
-
-        auto ins = __tcMakeIrInstruction("cmp vreg 1 vreg 0");
-        
+        IrCondition cond;
 
         if (opToken == TokenKind::equalequal) {
 
-            ins.push_back("eq");
+            cond = IrCondition::eq;
 
         } else {
-            ins.push_back("ne");
+            cond = IrCondition::ne;
         }
 
-        this->instructionList.push_back(ins);
+        this->instructionList.emplace_back(
+            IrOpcode::cmp, lhs, resultOperand, IrOperand::condition(cond)
+        );
+
+        resultOperand = __tcVreg0;
 
         return "";
 
@@ -1622,13 +1752,13 @@ string tcir::IrGenerator::processRelationalExpression(AstNode* node, bool isInGl
 
 
     if (node->children.size() == 1) {
-        return this->processShiftExpression(node->children[0], isInGlobalScope);
+        return this->processExpressionNode(node->children[0], isInGlobalScope);
     }
 
     int errCount = errorList.size();
 
 
-    auto relationalExpResult = processRelationalExpression(
+    auto relationalExpResult = processExpressionNode(
         node->children[0], isInGlobalScope
     );
 
@@ -1637,10 +1767,10 @@ string tcir::IrGenerator::processRelationalExpression(AstNode* node, bool isInGl
     }
 
 
-    auto opToken = node->children[1]->tokenKind;
+    auto opToken = node->children[1]->tokenKind();
 
     if (isInGlobalScope) {
-        auto shiftExpRes = this->processShiftExpression(node->children[2], isInGlobalScope);
+        auto shiftExpRes = this->processExpressionNode(node->children[2], isInGlobalScope);
         
         if (errorList.size() - errCount) {
             return "";
@@ -1663,35 +1793,35 @@ string tcir::IrGenerator::processRelationalExpression(AstNode* node, bool isInGl
 
     } else {
 
-        this->instructionList.push_back(__tcMakeIrInstruction("push 4 vreg 0"));
+        if (resultOperand.kind == IrOperandKind::imm || resultOperand.isVreg(0)) {
+            this->moveResultToTemporary();
+        }
+
+        auto lhs = resultOperand;
 
-        auto shiftExpRes = this->processShiftExpression(node->children[2], isInGlobalScope);
+        this->processExpressionNode(node->children[2], isInGlobalScope);
 
         if (errorList.size() - errCount) {
             return "";
         }
 
-        this->instructionList.push_back(__tcMakeIrInstruction("pop 4 vreg 1"));
-
-        IrInstructionCode ins;
-
-        ins.push_back("cmp");
-        ins.push_back("vreg");
-        ins.push_back("1");
-        ins.push_back("vreg");
-        ins.push_back("0");
+        IrCondition cond;
         
         if (opToken == TokenKind::less) {
-            ins.push_back("l");
+            cond = IrCondition::l;
         } else if (opToken == TokenKind::greater) {
-            ins.push_back("g");
+            cond = IrCondition::g;
         } else if (opToken == TokenKind::lessequal) {
-            ins.push_back("le");
+            cond = IrCondition::le;
         } else {
-            ins.push_back("ge");
+            cond = IrCondition::ge;
         }
 
-        this->instructionList.push_back(ins);
+        this->instructionList.emplace_back(
+            IrOpcode::cmp, lhs, resultOperand, IrOperand::condition(cond)
+        );
+
+        resultOperand = __tcVreg0;
 
         return "";
 
@@ -1717,7 +1847,7 @@ string tcir::IrGenerator::processShiftExpression(AstNode* node, bool isInGlobalS
         return "";
     }
 
-    return this->processAdditiveExpression(node->children[0], isInGlobalScope);
+    return this->processExpressionNode(node->children[0], isInGlobalScope);
 
 }
 
@@ -1736,10 +1866,10 @@ string tcir::IrGenerator::processAdditiveExpression(AstNode* node, bool isInGlob
     int errCount = errorList.size();
 
     if (node->children.size() == 1) {
-        return processMultiplicativeExpression(node->children[0], isInGlobalScope);
+        return processExpressionNode(node->children[0], isInGlobalScope);
     }
 
-    auto addResult = processAdditiveExpression(
+    auto addResult = processExpressionNode(
         node->children[0], isInGlobalScope
     );
 
@@ -1748,11 +1878,11 @@ string tcir::IrGenerator::processAdditiveExpression(AstNode* node, bool isInGlob
         return "";
     }
 
-    auto opToken = node->children[1]->tokenKind;
+    auto opToken = node->children[1]->tokenKind();
     if (isInGlobalScope) {
 
         
-        auto multiplicationResult = processMultiplicativeExpression(
+        auto multiplicationResult = processExpressionNode(
             node->children[2], isInGlobalScope
         );
 
@@ -1772,34 +1902,23 @@ string tcir::IrGenerator::processAdditiveExpression(AstNode* node, bool isInGlob
     
     } else {
 
-        this->instructionList.push_back(__tcMakeIrInstruction("push 4 vreg 0"));
+        // 计算结果写在左操作数的临时值上。
+        this->moveResultToTemporary();
+        auto lhs = resultOperand;
 
-        auto multiplicationResult = processMultiplicativeExpression(
-            node->children[2], isInGlobalScope
-        );
+        processExpressionNode(node->children[2], isInGlobalScope);
 
         if (errorList.size() - errCount) {
             return "";
         }
 
-        this->instructionList.push_back(__tcMakeIrInstruction("pop 4 vreg 1"));
-
-        // add/sub vreg 0 vreg 1
-        IrInstructionCode ins;
-        if (opToken == TokenKind::plus) {
-            ins.push_back("add");
-        } else {
-            ins.push_back("sub");
-        }
-
-        ins.push_back("vreg");
-        ins.push_back("1");
-        ins.push_back("vreg");
-        ins.push_back("0");
-        this->instructionList.push_back(ins);
+        // add/sub lhs rhs
+        this->instructionList.emplace_back(
+            opToken == TokenKind::plus ? IrOpcode::add : IrOpcode::sub,
+            lhs, resultOperand
+        );
 
-        // 计算结果位于 vreg 1. 我们希望把它存到 vreg 0 内。
-        this->instructionList.push_back(__tcMakeIrInstruction("xchg vreg 0 vreg 1"));
+        resultOperand = lhs;
 
         return "";
 
@@ -1821,19 +1940,19 @@ string tcir::IrGenerator::processMultiplicativeExpression(AstNode* node, bool is
     */
 
     if (node->children.size() == 1) {
-        return processCastExpression(node->children[0], isInGlobalScope);
+        return processExpressionNode(node->children[0], isInGlobalScope);
     }
 
     // 下方代码执行时，children size 一定是 3.
 
-    auto&& res1 = processMultiplicativeExpression(node->children[0], isInGlobalScope);
+    auto&& res1 = processExpressionNode(node->children[0], isInGlobalScope);
 
     if (isInGlobalScope) {
 
         
-        auto&& res2 = processCastExpression(node->children[2], isInGlobalScope);
+        auto&& res2 = processExpressionNode(node->children[2], isInGlobalScope);
 
-        switch (node->children[1]->tokenKind) {
+        switch (node->children[1]->tokenKind()) {
             case TokenKind::star: {
                 return to_string(stoll(res1) * stoll(res2));
             }
@@ -1858,28 +1977,26 @@ string tcir::IrGenerator::processMultiplicativeExpression(AstNode* node, bool is
     // 执行到这里时，处理的代码不在全局。
     // 即：isInGlobalScope = false
 
-    this->instructionList.push_back(__tcMakeIrInstruction("push 4 vreg 0"));
-
-    auto&& mulResult = res1;
+    this->moveResultToTemporary();
+    auto lhs = resultOperand;
 
     auto errCount = errorList.size();
 
-    auto&& castResult = processCastExpression(node->children[2], isInGlobalScope);
+    processExpressionNode(node->children[2], isInGlobalScope);
 
     if (errorList.size() - errCount) {
         return "";
     }
-
-    this->instructionList.push_back(__tcMakeIrInstruction("pop 4 vreg 1"));
     
-    if (node->children[1]->tokenKind == TokenKind::star) {
+    if (node->children[1]->tokenKind() == TokenKind::star) {
 
         
         // 乘法
-        this->instructionList.push_back(__tcMakeIrInstruction("mul vreg 0 vreg 1"));
+        this->instructionList.emplace_back(IrOpcode::mul, lhs, resultOperand);
+        resultOperand = lhs;
 
         
-    } else if (node->children[1]->tokenKind == TokenKind::slash) {
+    } else if (node->children[1]->tokenKind() == TokenKind::slash) {
 
         // 除法
         this->addUnsupportedGrammarError(node->children[1]); // 不支持除法。
@@ -1907,17 +2024,20 @@ string tcir::IrGenerator::processCastExpression(AstNode* node, bool isInGlobalSc
 
     // 暂不支持真的转换。
     if (node->children.size() > 1) {
-        return processCastExpression(node->children[3], isInGlobalScope);
+        return processExpressionNode(node->children[3], isInGlobalScope);
     }
 
-    return processUnaryExpression(node->children[0], isInGlobalScope);
+    return processExpressionNode(node->children[0], isInGlobalScope);
 
 }
 
 void tcir::IrGenerator::processExpressionStatement(AstNode* node) {
 
+    // 空语句没有值。
+    resultOperand = __tcVreg0;
+
     if (node->children.size() > 1) {
-        processExpression(node->children[0], false);
+        processExpressionNode(node->children[0], false);
     }
 
     
@@ -1938,17 +2058,17 @@ string tcir::IrGenerator::processExpression(AstNode* node, bool isInGlobalScope)
 
 
     if (node->children.size() == 1) {
-        return processAssignmentExpression(node->children[0], isInGlobalScope);
+        return processExpressionNode(node->children[0], isInGlobalScope);
     }
 
     int errCount = errorList.size();
-    processExpression(node->children[0], isInGlobalScope);
+    processExpressionNode(node->children[0], isInGlobalScope);
 
     if (errorList.size() - errCount) {
         return "";
     }
 
-    auto assignmentExpRes = processAssignmentExpression(node->children[2], isInGlobalScope);
+    auto assignmentExpRes = processExpressionNode(node->children[2], isInGlobalScope);
 
     return assignmentExpRes;
 
@@ -1971,11 +2091,11 @@ string tcir::IrGenerator::processUnaryExpression(AstNode* node, bool isInGlobalS
     */
 
     if (node->children.size() == 1) {
-        return processPostfixExpression(node->children[0], isInGlobalScope);
+        return processExpressionNode(node->children[0], isInGlobalScope);
     }
 
-    if (node->children[0]->symbolType == grammar::SymbolType::TERMINAL) {
-        if (node->children[0]->tokenKind == TokenKind::kw_sizeof) {
+    if (node->children[0]->symbolType() == grammar::SymbolType::TERMINAL) {
+        if (node->children[0]->tokenKind() == TokenKind::kw_sizeof) {
             // 不支持 sizeof
             this->addUnsupportedGrammarError(node->children[0]);
             return "";
@@ -1998,27 +2118,25 @@ string tcir::IrGenerator::processUnaryExpression(AstNode* node, bool isInGlobalS
             return "";
         }
 
-        string valueCode = this->symbolToIrValueCode(directResultSymbol);
+        IrOperand valueOperand = this->symbolToIrOperand(directResultSymbol);
 
-        if (node->children[0]->tokenKind == TokenKind::plusplus) {
+        if (node->children[0]->tokenKind() == TokenKind::plusplus) {
             
             // ++i
-            this->instructionList.push_back(__tcMakeIrInstruction(
-                "add " + valueCode + " imm 1"
-            ));
+            this->instructionList.emplace_back(
+                IrOpcode::add, valueOperand, IrOperand::imm(1)
+            );
 
         } else {
         
             // --i
-            this->instructionList.push_back(__tcMakeIrInstruction(
-                "sub " + valueCode + " imm 1"
-            ));
+            this->instructionList.emplace_back(
+                IrOpcode::sub, valueOperand, IrOperand::imm(1)
+            );
         
         }
 
-        this->instructionList.push_back(__tcMakeIrInstruction(
-            "mov vreg 0 " + valueCode
-        ));
+        resultOperand = valueOperand;
 
     }
 
@@ -2062,13 +2180,13 @@ string tcir::IrGenerator::processPostfixExpression(AstNode* node, bool isInGloba
 
     if (node->children.size() == 1) {
         
-        return processPrimaryExpression(node->children[0], isInGlobalScope);
+        return processExpressionNode(node->children[0], isInGlobalScope);
 
     } else if (node->children.size() == 2) {
 
-        TokenKind op = node->children[1]->tokenKind;
+        TokenKind op = node->children[1]->tokenKind();
 
-        auto postfixExpRes = processPostfixExpression(node->children[0], isInGlobalScope);
+        auto postfixExpRes = processExpressionNode(node->children[0], isInGlobalScope);
 
         if (resultValueType != ValueType::s32) {
 
@@ -2094,41 +2212,37 @@ string tcir::IrGenerator::processPostfixExpression(AstNode* node, bool isInGloba
             return "";
         }
 
-        string symbolCode = this->symbolToIrValueCode(directResultSymbol);
+        IrOperand symbolOperand = this->symbolToIrOperand(directResultSymbol);
 
-        instructionList.push_back(__tcMakeIrInstruction(
-            "mov vreg 0 " + symbolCode
-        ));
+        // 表达式的值是自增前的值，先复制出来。
+        resultOperand = this->newTemporary();
+        instructionList.emplace_back(IrOpcode::mov, resultOperand, symbolOperand);
 
         if (op == TokenKind::plusplus) {
             // postfix_exp INC_OP
 
-            instructionList.push_back(__tcMakeIrInstruction(
-                "add " + symbolCode + " imm 1"
-            ));
+            instructionList.emplace_back(IrOpcode::add, symbolOperand, IrOperand::imm(1));
 
         } else {
             // postfix_exp DEC_OP
 
-            instructionList.push_back(__tcMakeIrInstruction(
-                "sub " + symbolCode + " imm 1"
-            ));
+            instructionList.emplace_back(IrOpcode::sub, symbolOperand, IrOperand::imm(1));
         }
 
         return "";
 
     }
 
-    if (node->children[0]->symbolType == grammar::SymbolType::TERMINAL) {
+    if (node->children[0]->symbolType() == grammar::SymbolType::TERMINAL) {
         this->addUnsupportedGrammarError(node);
         // 不支持 '(' type_name ')' '{' initializer_list ',' '}'
 
         return "";
     }
 
-    if (node->children[1]->tokenKind == TokenKind::l_square // []
-        || node->children[1]->tokenKind == TokenKind::period // x . y
-        || node->children[1]->tokenKind == TokenKind::arrow // x -> y
+    if (node->children[1]->tokenKind() == TokenKind::l_square // []
+        || node->children[1]->tokenKind() == TokenKind::period // x . y
+        || node->children[1]->tokenKind() == TokenKind::arrow // x -> y
     ) {
         this->addUnsupportedGrammarError(node->children[1]);
         return "";
@@ -2156,12 +2270,15 @@ string tcir::IrGenerator::processPostfixExpression(AstNode* node, bool isInGloba
         
     }
 
-    IrInstructionCode code;
-    code.push_back("call");
-
     // 假设只有最简单的名称，如 func()
     //   而不存在如 (func)() 这种麻烦的。
-    auto&& funcName = node->children[0]->children[0]->children[0]->token.content;
+    // 单产生式可能被折叠，因此不能假设层数，直接找第一个终结符。
+    AstNode* funcNameNode = node->children[0];
+    while (funcNameNode->symbolType() == grammar::SymbolType::NON_TERMINAL) {
+        funcNameNode = funcNameNode->children[0];
+    }
+
+    auto&& funcName = funcNameNode->token().content;
 
     auto funcPtr = this->globalSymbolTable.getFunction(funcName);
     if ( !funcPtr ) {
@@ -2172,8 +2289,10 @@ string tcir::IrGenerator::processPostfixExpression(AstNode* node, bool isInGloba
         return "";
     }
 
-    code.push_back(funcName);
-    instructionList.push_back(code);
+    instructionList.emplace_back(IrOpcode::call, IrOperand::function(irNames.intern(funcName)));
+
+    // 返回值位于 vreg 0。
+    resultOperand = __tcVreg0;
 
     return "";
 
@@ -2193,8 +2312,8 @@ void tcir::IrGenerator::processArgumentExpressionList(AstNode* node) {
         this->processArgumentExpressionList(node->children[0]);
     }
 
-    processAssignmentExpression(node->children.back(), false);
-    instructionList.push_back(__tcMakeIrInstruction("pushfc 4 vreg 0"));
+    processExpressionNode(node->children.back(), false);
+    instructionList.emplace_back(IrOpcode::pushfc, __tcWordSize, resultOperand);
 
 }
 
@@ -2216,11 +2335,11 @@ string tcir::IrGenerator::processPrimaryExpression(AstNode* node, bool isInGloba
 
     if (node->children.size() == 3) {
 
-        return processExpression(node->children[1], isInGlobalScope);
+        return processExpressionNode(node->children[1], isInGlobalScope);
     }
 
-    auto tokenKind = node->children[0]->tokenKind;
-    auto& content = node->children[0]->token.content;
+    auto tokenKind = node->children[0]->tokenKind();
+    auto& content = node->children[0]->token().content;
 
     if (tokenKind == TokenKind::string_literal) {
         // 暂不支持字符串。后续应该考虑支持。
@@ -2239,11 +2358,6 @@ string tcir::IrGenerator::processPrimaryExpression(AstNode* node, bool isInGloba
 
         } else {
             
-            IrInstructionCode ir;
-            ir.push_back("mov");
-            ir.push_back("vreg");
-            ir.push_back("0");
-
             // 寻找这个符号的含义。
 
             // 先从块符号表找。
@@ -2258,9 +2372,7 @@ string tcir::IrGenerator::processPrimaryExpression(AstNode* node, bool isInGloba
             }
 
             if (symbolFromTable) {
-                ir.push_back("val");
-                ir.push_back(to_string(symbolFromTable->id));
-                instructionList.push_back(ir);
+                resultOperand = IrOperand::local(symbolFromTable->id);
                 resultValueType = symbolFromTable->valueType;
 
                 directResultSymbol = symbolFromTable;
@@ -2282,9 +2394,9 @@ string tcir::IrGenerator::processPrimaryExpression(AstNode* node, bool isInGloba
 
             if (symFromFuncParams) {
 
-                ir.push_back("fval");
-                ir.push_back(content);
-                instructionList.push_back(ir);
+                resultOperand = IrOperand::param(
+                    currentFunction->findParamSymbolIndex(content)
+                );
                 resultValueType = symFromFuncParams->valueType;
 
                 directResultSymbol = symFromFuncParams;
@@ -2304,9 +2416,7 @@ string tcir::IrGenerator::processPrimaryExpression(AstNode* node, bool isInGloba
             }
 
             if (symFromGlobalVar) {
-                ir.push_back("val");
-                ir.push_back(content);
-                instructionList.push_back(ir);
+                resultOperand = IrOperand::global(irNames.intern(content));
                 resultValueType = symFromGlobalVar->valueType;
 
                 directResultSymbol = symFromGlobalVar;
@@ -2335,9 +2445,8 @@ string tcir::IrGenerator::processPrimaryExpression(AstNode* node, bool isInGloba
         if (isInGlobalScope) {
             return content;
         } else {
-            instructionList.push_back(__tcMakeIrInstruction(
-                "mov vreg 0 imm " + content
-            ));
+            // 按 C 的写法解析进制。
+            resultOperand = IrOperand::imm(strtoll(content.c_str(), nullptr, 0));
 
             return "";
         }
@@ -2359,7 +2468,7 @@ int tcir::IrGenerator::processDeclarationSpecifiers(
         return 1;  
     }
 
-    if (node->children[0]->symbolKind != SymbolKind::type_specifier) {
+    if (node->children[0]->symbolKind() != SymbolKind::type_specifier) {
         this->addUnsupportedGrammarError(node);
 
         return 1;
@@ -2392,9 +2501,9 @@ int tcir::IrGenerator::processDeclarationSpecifiers(
         return 1;
     }
 
-    if (returnTypeSpecifier->tokenKind == TokenKind::kw_int) {
+    if (returnTypeSpecifier->tokenKind() == TokenKind::kw_int) {
         tokenListContainer.push_back(TokenKind::kw_int);
-    } else if (returnTypeSpecifier->tokenKind == TokenKind::kw_void) {
+    } else if (returnTypeSpecifier->tokenKind() == TokenKind::kw_void) {
         tokenListContainer.push_back(TokenKind::kw_void);
     } else {
         this->addUnsupportedGrammarError(returnTypeSpecifier);
@@ -2407,17 +2516,42 @@ int tcir::IrGenerator::processDeclarationSpecifiers(
 }
 
 
-string tcir::IrGenerator::symbolToIrValueCode(SymbolBase* symbol) {
+tcir::IrOperand tcir::IrGenerator::symbolToIrOperand(SymbolBase* symbol) {
 
     VariableSymbol* varSymbol = (VariableSymbol*) symbol;
 
     if (varSymbol->visibility == SymbolVisibility::global) {
-        return "val " + varSymbol->name;
+        return IrOperand::global(irNames.intern(varSymbol->name));
     } else if (varSymbol->symbolType == SymbolType::variableDefine) {
-        return "val " + to_string(varSymbol->id);
+        return IrOperand::local(varSymbol->id);
     } else {
         // func param
-        return "fval " + varSymbol->name;
+        return IrOperand::param(currentFunction->findParamSymbolIndex(varSymbol->name));
+    }
+
+}
+
+tcir::IrOperand tcir::IrGenerator::newTemporary() {
+    return IrOperand::vreg(nextTemporaryId++);
+}
+
+void tcir::IrGenerator::moveResultToTemporary() {
+
+    if (isTemporary(resultOperand)) {
+        return;
+    }
+
+    auto temporary = this->newTemporary();
+    instructionList.emplace_back(IrOpcode::mov, temporary, resultOperand);
+    resultOperand = temporary;
+
+}
+
+void tcir::IrGenerator::moveResultToVreg0() {
+
+    if (!resultOperand.isVreg(0)) {
+        instructionList.emplace_back(IrOpcode::mov, __tcVreg0, resultOperand);
+        resultOperand = __tcVreg0;
     }
 
 }
@@ -27,6 +27,11 @@ namespace tc::tcir {
     struct IrGeneratorError {
         std::string msg;
         AstNode* astNode = nullptr;
+
+        /**
+         * 错误相关 token。没有语法树（语法制导生成）时使用，此时 astNode 为空。
+         */
+        Token token {};
     };
 
     /**
@@ -36,6 +41,7 @@ namespace tc::tcir {
     class IrGenerator {
     public:
         IrGenerator() {}
+        ~IrGenerator();
 
     public:
 
@@ -47,6 +53,24 @@ namespace tc::tcir {
          */
         int process(AstNode* root);
 
+        /**
+         * 增量处理一个 external_declaration 节点。用于边分析边生成 IR。
+         * 首次调用前需要调用 clear。节点需要按源码顺序依次传入。
+         * 
+         * @param node external_declaration 节点。
+         * @return 到目前为止遇到的错误数量。
+         */
+        int processExternalDeclarationIncrementally(AstNode* node);
+
+        /**
+         * 获取单产生式折叠时需要保留的节点类型。
+         * 生成器依赖这些节点的结构；其余类型（表达式层级）会按节点的实际类型分派，
+         * 可以由语法分析器折叠。
+         * 
+         * 用法见 Parser::setUnitReductionCollapse。
+         */
+        static std::vector<SymbolKind> getUnitReductionKeepList();
+
         /**
          * 导出 IR。
          * 
@@ -55,6 +79,14 @@ namespace tc::tcir {
          */
         void dump(std::ostream& out, bool withColor = false);
 
+        /**
+         * 以二进制格式导出 IR。格式见 IrBinaryModule.h。
+         * 
+         * @param out 输出流。需要以二进制模式打开。
+         * @return 0 表示成功。
+         */
+        int dumpBinary(std::ostream& out);
+
         std::vector<IrGeneratorError>& getErrorList() {
             return this->errorList;
         }
@@ -63,10 +95,23 @@ namespace tc::tcir {
             return this->warningList;
         }
 
-        std::vector< IrInstructionCode >& getInstructionCodeList() {
+        std::vector< IrInstruction >& getInstructionList() {
             return this->instructionList;
         }
 
+        /**
+         * 指令内全局变量名、函数名等名称的 id 表。
+         */
+        IrNameTable& getNameTable() {
+            return this->irNames;
+        }
+
+        /**
+         * 获取生成结果，直接交给后端。不经过文本形式。
+         * 结果引用生成器内部的数据，在生成器被清空前有效。
+         */
+        IrModule getModule();
+
         /**
          * 清空已经生成的 IR。同时清空内部记录结构。
          */
@@ -103,6 +148,18 @@ namespace tc::tcir {
          */
         SymbolBase* directResultSymbol = nullptr;
 
+        /**
+         * 上一个表达式的计算结果所在的操作数。
+         * 可能是变量、立即数、临时值，或 vreg 0（比较、逻辑运算、三目运算与函数返回值）。
+         */
+        IrOperand resultOperand = IrOperand::vreg(0);
+
+        /**
+         * 下一个临时值的编号。临时值为 2 号及以后的 vreg，由后端分配寄存器。
+         * 每个函数从 2 开始。
+         */
+        int nextTemporaryId = 2;
+
         /**
          * 当前正在处理的函数。指向 globalSymbolTable 内的成员。
          * 只负责指向，不负责管理内存。
@@ -116,29 +173,39 @@ namespace tc::tcir {
         std::vector<IrGeneratorError> errorList;
         std::vector<IrGeneratorError> warningList;
 
-        std::vector< IrInstructionCode > instructionList;
+        std::vector< IrInstruction > instructionList;
+
+        /**
+         * 指令使用的名称表。
+         */
+        IrNameTable irNames;
 
         /**
          * 跳出目标。用于登记循环和 switch 内 break 的跳出目标。
          */
-        std::vector< std::string > breakStmtTargets;
+        std::vector< IrOperand > breakStmtTargets;
 
         
         /**
          * 跳出目标。用于登记循环内 continue 的跳出目标。
          */
-        std::vector< std::string > continueStmtTargets;
+        std::vector< IrOperand > continueStmtTargets;
 
         /**
-         * 块符号表生成的 ir。每张表在离开其负责的代码块前，
-         * 将结果存到本流对象内，然后被释放。
+         * 已离开作用域的块符号表，按离开顺序排列。
+         * 子表已登记到上级表的 children 内。由生成器释放。
          */
-        std::stringstream blockSymbolTableIrDumps;
+        std::vector< BlockSymbolTable* > blockSymbolTables;
 
     protected:
 
         void addUnsupportedGrammarError(AstNode* node);
 
+        /**
+         * 块符号表离开作用域。登记到上级表，并保留到生成器被清空。
+         */
+        void retainBlockSymbolTable(BlockSymbolTable* symbolTab);
+
     protected: /* 模块处理函数。 */
 
         void processTranslationUnit(AstNode* node);
@@ -183,6 +250,12 @@ namespace tc::tcir {
             bool isInGlobalScope
         );
 
+        /**
+         * 按节点实际类型分派到对应的表达式处理函数。
+         * 单产生式被折叠后，子节点的类型可能比文法规定的“更深”。
+         */
+        std::string processExpressionNode(AstNode* node, bool isInGlobalScope);
+
         std::string processAssignmentExpression(AstNode* node, bool isInGlobalScope);
         std::string processConditionalExpression(AstNode* node, bool isInGlobalScope);
         std::string processLogicalOrExpression(AstNode* node, bool isInGlobalScope);
@@ -220,7 +293,30 @@ namespace tc::tcir {
         );
 
 
-        std::string symbolToIrValueCode(SymbolBase* symbol);
+        /**
+         * 把变量或参数符号转换为指令操作数。
+         */
+        IrOperand symbolToIrOperand(SymbolBase* symbol);
+
+        /**
+         * 申请一个临时值。
+         */
+        IrOperand newTemporary();
+
+        static bool isTemporary(const IrOperand& operand) {
+            return operand.kind == IrOperandKind::vreg && operand.value >= 2;
+        }
+
+        /**
+         * 把 resultOperand 复制到一个新的临时值内。已经是临时值时不复制。
+         * 用于二元运算的左操作数：计算结果写在它上面。
+         */
+        void moveResultToTemporary();
+
+        /**
+         * 把 resultOperand 放入 vreg 0。用于条件跳转、return 与逻辑运算。
+         */
+        void moveResultToVreg0();
 
 
     private:
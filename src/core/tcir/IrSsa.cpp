@@ -0,0 +1,747 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    TCIR 的 SSA 形式。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+#include <core/tcir/IrSsa.h>
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+using namespace std;
+
+namespace tc::tcir {
+
+static bool __tcIsVariable(const IrOperand& operand) {
+    return operand.kind == IrOperandKind::local || operand.kind == IrOperandKind::param;
+}
+
+/**
+ * 指令是否只定义第 0 个操作数，且没有其他作用。这样的定义没有使用时可以删除。
+ * div 与 mod 可能触发除零异常，不在此列。
+ */
+static bool __tcIsPureDefinition(const IrInstruction& ins) {
+    switch (ins.opcode) {
+        case IrOpcode::mov:
+        case IrOpcode::add:
+        case IrOpcode::sub:
+        case IrOpcode::mul:
+        case IrOpcode::neg:
+        case IrOpcode::bitAnd:
+        case IrOpcode::bitOr:
+        case IrOpcode::bitXor:
+        case IrOpcode::bitNot: {
+            return true;
+        }
+
+        default: {
+            return false;
+        }
+    }
+}
+
+/**
+ * 第 1 个操作数能否换成立即数。需要保证后端能输出对应的 x86 指令。
+ */
+static bool __tcAcceptsImmediate(const IrInstruction& ins) {
+    switch (ins.opcode) {
+        case IrOpcode::mov:
+        case IrOpcode::push:
+        case IrOpcode::pushfc: {
+            return true;
+        }
+
+        case IrOpcode::add:
+        case IrOpcode::sub:
+        case IrOpcode::cmp: {
+            return ins.operands[0].kind != IrOperandKind::imm;
+        }
+
+        case IrOpcode::mul: {
+            // imul 的目标必须是寄存器。
+            return ins.operands[0].kind == IrOperandKind::vreg;
+        }
+
+        default: {
+            return false;
+        }
+    }
+}
+
+static void __tcWriteVariable(ostream& out, const IrOperand& variable) {
+    if (variable.kind == IrOperandKind::local) {
+        out << "val " << variable.value;
+    } else {
+        out << "fval #" << variable.value;
+    }
+}
+
+
+void IrSsaUtils::getOperandRoles(
+    const IrInstruction& ins,
+    bool uses[IrInstruction::MAX_OPERANDS],
+    bool defs[IrInstruction::MAX_OPERANDS]
+) {
+
+    fill(uses, uses + IrInstruction::MAX_OPERANDS, false);
+    fill(defs, defs + IrInstruction::MAX_OPERANDS, false);
+
+    switch (ins.opcode) {
+        case IrOpcode::funLabel:
+        case IrOpcode::label:
+        case IrOpcode::call:
+        case IrOpcode::ret:
+        case IrOpcode::jmp:
+        case IrOpcode::je:
+        case IrOpcode::jne:
+        case IrOpcode::jg:
+        case IrOpcode::jge:
+        case IrOpcode::jl:
+        case IrOpcode::jle:
+        case IrOpcode::j: {
+            break;
+        }
+
+        case IrOpcode::push:
+        case IrOpcode::pushfc: {
+            uses[1] = true;
+            break;
+        }
+
+        case IrOpcode::pop: {
+            defs[1] = true;
+            break;
+        }
+
+        case IrOpcode::mov: {
+            defs[0] = true;
+            uses[1] = true;
+            break;
+        }
+
+        case IrOpcode::xchg: {
+            uses[0] = defs[0] = true;
+            uses[1] = defs[1] = true;
+            break;
+        }
+
+        case IrOpcode::add:
+        case IrOpcode::sub:
+        case IrOpcode::mul:
+        case IrOpcode::div:
+        case IrOpcode::mod:
+        case IrOpcode::bitAnd:
+        case IrOpcode::bitOr:
+        case IrOpcode::bitXor: {
+            uses[0] = defs[0] = true;
+            uses[1] = true;
+            break;
+        }
+
+        case IrOpcode::neg:
+        case IrOpcode::bitNot: {
+            uses[0] = defs[0] = true;
+            break;
+        }
+
+        case IrOpcode::cmp: {
+            uses[0] = true;
+            uses[1] = true;
+            break;
+        }
+
+        default: {
+            fill(uses, uses + IrInstruction::MAX_OPERANDS, true);
+            fill(defs, defs + IrInstruction::MAX_OPERANDS, true);
+            break;
+        }
+    }
+}
+
+
+void IrSsaFunction::build(const vector<IrInstruction>& instructions) {
+
+    code = instructions;
+    removed.assign(code.size(), false);
+    values.clear();
+
+    cfg.build(code);
+    auto& blocks = cfg.getBlocks();
+    int blockCount = blocks.size();
+    phis.assign(blockCount, {});
+
+    bool uses[IrInstruction::MAX_OPERANDS];
+    bool defs[IrInstruction::MAX_OPERANDS];
+
+    /* 收集变量与定义它们的块。 */
+
+    map< pair<int, int64_t>, int > variableIds;
+    vector<IrOperand> variables;
+    vector< vector<int> > defBlocks;
+
+    auto findVariable = [&] (const IrOperand& operand) {
+        auto key = make_pair(int(operand.kind), operand.value);
+        auto it = variableIds.find(key);
+        if (it != variableIds.end()) {
+            return it->second;
+        }
+
+        int varIdx = variables.size();
+        variableIds[key] = varIdx;
+        variables.push_back(operand);
+        defBlocks.push_back({ 0 }); // 入口块视为定义了初值。
+        return varIdx;
+    };
+
+    for (int blockIdx = 0; blockIdx < blockCount; blockIdx++) {
+        for (int idx = blocks[blockIdx].begin; idx < blocks[blockIdx].end; idx++) {
+            auto& ins = code[idx];
+            IrSsaUtils::getOperandRoles(ins, uses, defs);
+
+            for (int opIdx = 0; opIdx < ins.operandCount; opIdx++) {
+                if (!__tcIsVariable(ins.operands[opIdx])) {
+                    continue;
+                }
+
+                int varIdx = findVariable(ins.operands[opIdx]);
+                if (defs[opIdx] && defBlocks[varIdx].back() != blockIdx) {
+                    defBlocks[varIdx].push_back(blockIdx);
+                }
+            }
+        }
+    }
+
+    int varCount = variables.size();
+
+    /* 初值。 */
+
+    vector<int> varOfValue;
+    vector< vector<int> > currentValues(varCount);
+
+    for (int varIdx = 0; varIdx < varCount; varIdx++) {
+        IrSsaValue value;
+        value.variable = variables[varIdx];
+        currentValues[varIdx].push_back(values.size());
+        values.push_back(value);
+        varOfValue.push_back(varIdx);
+    }
+
+    /* 在支配边界的迭代闭包上放置 phi。 */
+
+    vector<int> hasPhi(blockCount, -1);
+    vector<int> inWorklist(blockCount, -1);
+
+    for (int varIdx = 0; varIdx < varCount; varIdx++) {
+        vector<int> worklist = defBlocks[varIdx];
+        for (int blockIdx : worklist) {
+            inWorklist[blockIdx] = varIdx;
+        }
+
+        while (!worklist.empty()) {
+            int blockIdx = worklist.back();
+            worklist.pop_back();
+
+            for (int frontierIdx : blocks[blockIdx].frontier) {
+                if (hasPhi[frontierIdx] == varIdx) {
+                    continue;
+                }
+
+                hasPhi[frontierIdx] = varIdx;
+
+                IrSsaValue value;
+                value.variable = variables[varIdx];
+                value.block = frontierIdx;
+                value.instruction = -1;
+
+                IrSsaPhi phi;
+                phi.value = values.size();
+                phi.args.assign(blocks[frontierIdx].preds.size(), -1);
+                phis[frontierIdx].push_back(move(phi));
+
+                values.push_back(value);
+                varOfValue.push_back(varIdx);
+
+                if (inWorklist[frontierIdx] != varIdx) {
+                    inWorklist[frontierIdx] = varIdx;
+                    worklist.push_back(frontierIdx);
+                }
+            }
+        }
+    }
+
+    /*
+     * 沿支配树重命名。用显式栈深度优先遍历。
+     * 栈内 mark 为 -1 表示进入块；否则表示离开块，需要把变量栈恢复到 mark 记录的长度。
+     */
+
+    vector<int> pushedVars;
+    vector< pair<int, int> > stack = { { 0, -1 } };
+
+    auto define = [&] (int varIdx, int blockIdx, int insIdx, int tiedFrom) {
+        IrSsaValue value;
+        value.variable = variables[varIdx];
+        value.block = blockIdx;
+        value.instruction = insIdx;
+        value.tiedFrom = tiedFrom;
+
+        int valueId = values.size();
+        values.push_back(value);
+        varOfValue.push_back(varIdx);
+
+        currentValues[varIdx].push_back(valueId);
+        pushedVars.push_back(varIdx);
+        return valueId;
+    };
+
+    while (!stack.empty()) {
+        auto [blockIdx, mark] = stack.back();
+        stack.pop_back();
+
+        if (mark >= 0) {
+            while (int(pushedVars.size()) > mark) {
+                currentValues[pushedVars.back()].pop_back();
+                pushedVars.pop_back();
+            }
+
+            continue;
+        }
+
+        stack.emplace_back(blockIdx, int(pushedVars.size()));
+        auto& block = blocks[blockIdx];
+
+        for (auto& phi : phis[blockIdx]) {
+            int varIdx = varOfValue[phi.value];
+            currentValues[varIdx].push_back(phi.value);
+            pushedVars.push_back(varIdx);
+        }
+
+        for (int idx = block.begin; idx < block.end; idx++) {
+            auto& ins = code[idx];
+            IrSsaUtils::getOperandRoles(ins, uses, defs);
+
+            int opVars[IrInstruction::MAX_OPERANDS];
+            for (int opIdx = 0; opIdx < ins.operandCount; opIdx++) {
+                auto& operand = ins.operands[opIdx];
+                opVars[opIdx] = __tcIsVariable(operand)
+                    ? variableIds[{ int(operand.kind), operand.value }] : -1;
+            }
+
+            // 先处理使用，再处理定义。
+            for (int opIdx = 0; opIdx < ins.operandCount; opIdx++) {
+                if (opVars[opIdx] >= 0 && uses[opIdx] && !defs[opIdx]) {
+                    ins.operands[opIdx] = IrOperand::ssa(currentValues[opVars[opIdx]].back());
+                }
+            }
+
+            for (int opIdx = 0; opIdx < ins.operandCount; opIdx++) {
+                int varIdx = opVars[opIdx];
+                if (varIdx < 0 || !defs[opIdx]) {
+                    continue;
+                }
+
+                int tiedFrom = uses[opIdx] ? currentValues[varIdx].back() : -1;
+                ins.operands[opIdx] = IrOperand::ssa(define(varIdx, blockIdx, idx, tiedFrom));
+            }
+        }
+
+        for (int succ : block.succs) {
+            auto& preds = blocks[succ].preds;
+            int predIdx = find(preds.begin(), preds.end(), blockIdx) - preds.begin();
+
+            for (auto& phi : phis[succ]) {
+                phi.args[predIdx] = currentValues[varOfValue[phi.value]].back();
+            }
+        }
+
+        for (int child : block.domChildren) {
+            stack.emplace_back(child, -1);
+        }
+    }
+}
+
+
+vector<int> IrSsaFunction::countUses() const {
+
+    vector<int> counts(values.size(), 0);
+
+    bool uses[IrInstruction::MAX_OPERANDS];
+    bool defs[IrInstruction::MAX_OPERANDS];
+
+    for (size_t idx = 0; idx < code.size(); idx++) {
+        if (removed[idx]) {
+            continue;
+        }
+
+        auto& ins = code[idx];
+        IrSsaUtils::getOperandRoles(ins, uses, defs);
+
+        for (int opIdx = 0; opIdx < ins.operandCount; opIdx++) {
+            auto& operand = ins.operands[opIdx];
+            if (operand.kind != IrOperandKind::ssa) {
+                continue;
+            }
+
+            if (!defs[opIdx]) {
+                counts[operand.value]++;
+            } else if (values[operand.value].tiedFrom >= 0) {
+                counts[values[operand.value].tiedFrom]++;
+            }
+        }
+    }
+
+    for (auto& blockPhis : phis) {
+        for (auto& phi : blockPhis) {
+            for (int arg : phi.args) {
+                if (arg >= 0) {
+                    counts[arg]++;
+                }
+            }
+        }
+    }
+
+    return counts;
+}
+
+
+int IrSsaFunction::propagateConstants() {
+
+    int valueCount = values.size();
+    vector<bool> known(valueCount, false);
+    vector<int64_t> constants(valueCount, 0);
+
+    auto& blocks = cfg.getBlocks();
+
+    /**
+     * 由定义推断值。值为常量时返回 true。
+     */
+    auto evaluate = [&] (int valueId, int64_t& result) {
+        auto& value = values[valueId];
+
+        if (value.isPhi()) {
+            bool found = false;
+
+            for (auto& phi : phis[value.block]) {
+                if (phi.value != valueId) {
+                    continue;
+                }
+
+                for (int arg : phi.args) {
+                    if (arg < 0 || arg == valueId) {
+                        continue; // 来自不可达块，或回到自身。
+                    }
+
+                    if (!known[arg] || (found && constants[arg] != result)) {
+                        return false;
+                    }
+
+                    found = true;
+                    result = constants[arg];
+                }
+            }
+
+            return found;
+        }
+
+        if (value.isEntry() || removed[value.instruction]) {
+            return false;
+        }
+
+        auto& ins = code[value.instruction];
+        if (!ins.isMov() || ins.operands[0] != IrOperand::ssa(valueId)) {
+            return false;
+        }
+
+        auto& src = ins.operands[1];
+
+        if (src.kind == IrOperandKind::imm) {
+            result = src.value;
+            return true;
+        }
+
+        if (src.kind == IrOperandKind::ssa) {
+            result = constants[src.value];
+            return bool(known[src.value]);
+        }
+
+        if (src.kind == IrOperandKind::vreg) {
+            // 前端把表达式的值放在寄存器内再存入变量。向前找最近的一条指令。
+            int idx = value.instruction - 1;
+            while (idx >= blocks[value.block].begin && removed[idx]) {
+                idx--;
+            }
+
+            if (idx < blocks[value.block].begin) {
+                return false;
+            }
+
+            auto& prev = code[idx];
+            if (prev.isMov() && prev.operands[0] == src
+                && prev.operands[1].kind == IrOperandKind::imm
+            ) {
+                result = prev.operands[1].value;
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (int valueId = 0; valueId < valueCount; valueId++) {
+            if (!known[valueId] && evaluate(valueId, constants[valueId])) {
+                known[valueId] = true;
+                changed = true;
+            }
+        }
+    }
+
+    /* 替换使用。 */
+
+    int replaced = 0;
+
+    for (size_t idx = 0; idx < code.size(); idx++) {
+        auto& ins = code[idx];
+        if (removed[idx] || ins.operandCount < 2 || !__tcAcceptsImmediate(ins)) {
+            continue;
+        }
+
+        auto& operand = ins.operands[1];
+        if (operand.kind == IrOperandKind::ssa && known[operand.value]) {
+            operand = IrOperand::imm(constants[operand.value]);
+            replaced++;
+        }
+    }
+
+    return replaced;
+}
+
+
+int IrSsaFunction::removeDeadDefinitions() {
+
+    auto useCounts = countUses();
+
+    vector<int> worklist;
+    for (int valueId = 0; valueId < int(values.size()); valueId++) {
+        if (useCounts[valueId] == 0) {
+            worklist.push_back(valueId);
+        }
+    }
+
+    vector<bool> deadPhis(values.size(), false);
+    int removedCount = 0;
+
+    bool uses[IrInstruction::MAX_OPERANDS];
+    bool defs[IrInstruction::MAX_OPERANDS];
+
+    auto release = [&] (int valueId) {
+        if (valueId >= 0 && --useCounts[valueId] == 0) {
+            worklist.push_back(valueId);
+        }
+    };
+
+    while (!worklist.empty()) {
+        int valueId = worklist.back();
+        worklist.pop_back();
+
+        auto& value = values[valueId];
+
+        if (value.isPhi()) {
+            if (deadPhis[valueId]) {
+                continue;
+            }
+
+            // 之前的轮次删除过的 phi 不在块内。
+            auto& blockPhis = phis[value.block];
+            auto it = find_if(
+                blockPhis.begin(), blockPhis.end(),
+                [valueId] (const IrSsaPhi& phi) { return phi.value == valueId; }
+            );
+
+            if (it == blockPhis.end()) {
+                continue;
+            }
+
+            deadPhis[valueId] = true;
+            removedCount++;
+
+            for (int arg : it->args) {
+                release(arg);
+            }
+
+            continue;
+        }
+
+        if (value.isEntry() || removed[value.instruction]) {
+            continue;
+        }
+
+        auto& ins = code[value.instruction];
+        if (!__tcIsPureDefinition(ins) || ins.operands[0] != IrOperand::ssa(valueId)) {
+            continue;
+        }
+
+        removed[value.instruction] = true;
+        removedCount++;
+
+        release(value.tiedFrom);
+
+        IrSsaUtils::getOperandRoles(ins, uses, defs);
+        for (int opIdx = 0; opIdx < ins.operandCount; opIdx++) {
+            if (ins.operands[opIdx].kind == IrOperandKind::ssa && !defs[opIdx]) {
+                release(ins.operands[opIdx].value);
+            }
+        }
+    }
+
+    for (auto& blockPhis : phis) {
+        blockPhis.erase(
+            remove_if(
+                blockPhis.begin(), blockPhis.end(),
+                [&deadPhis] (const IrSsaPhi& phi) { return deadPhis[phi.value]; }
+            ),
+            blockPhis.end()
+        );
+    }
+
+    return removedCount;
+}
+
+
+void IrSsaFunction::destruct(vector<IrInstruction>& out) const {
+
+    for (size_t idx = 0; idx < code.size(); idx++) {
+        if (removed[idx]) {
+            continue;
+        }
+
+        auto& ins = out.emplace_back(code[idx]);
+        for (int opIdx = 0; opIdx < ins.operandCount; opIdx++) {
+            auto& operand = ins.operands[opIdx];
+            if (operand.kind == IrOperandKind::ssa) {
+                operand = values[operand.value].variable;
+            }
+        }
+    }
+}
+
+
+void IrSsaFunction::dump(ostream& out, const IrNameTable& names) const {
+
+    auto& blocks = cfg.getBlocks();
+
+    for (int blockIdx = 0; blockIdx < int(blocks.size()); blockIdx++) {
+        auto& block = blocks[blockIdx];
+
+        out << "// block " << blockIdx << " preds";
+        for (int pred : block.preds) {
+            out << " " << pred;
+        }
+
+        if (cfg.isReachable(blockIdx)) {
+            out << " idom " << block.idom << endl;
+        } else {
+            out << " unreachable" << endl;
+        }
+
+        for (auto& phi : phis[blockIdx]) {
+            out << "phi ssa " << phi.value << " ";
+            for (int arg : phi.args) {
+                if (arg >= 0) {
+                    out << "ssa " << arg << " ";
+                } else {
+                    out << "undef ";
+                }
+            }
+
+            out << "// ";
+            __tcWriteVariable(out, values[phi.value].variable);
+            out << endl;
+        }
+
+        for (int idx = block.begin; idx < block.end; idx++) {
+            if (removed[idx]) {
+                continue;
+            }
+
+            auto& ins = code[idx];
+            ins.write(out, names, nullptr);
+
+            // 注明定义的值对应的变量。
+            bool first = true;
+            for (int opIdx = 0; opIdx < ins.operandCount; opIdx++) {
+                auto& operand = ins.operands[opIdx];
+                if (operand.kind != IrOperandKind::ssa
+                    || values[operand.value].instruction != idx
+                ) {
+                    continue;
+                }
+
+                out << (first ? "// " : ", ") << "ssa " << operand.value << " = ";
+                __tcWriteVariable(out, values[operand.value].variable);
+                first = false;
+            }
+
+            out << endl;
+        }
+    }
+}
+
+
+void IrSsaUtils::optimize(
+    vector<IrInstruction>& instructions,
+    const IrNameTable& names,
+    ostream* dumpOut
+) {
+
+    vector<IrInstruction> result;
+    result.reserve(instructions.size());
+
+    size_t idx = 0;
+
+    // 第一个函数之前的指令原样保留。
+    while (idx < instructions.size() && !instructions[idx].isFunLabel()) {
+        result.push_back(instructions[idx++]);
+    }
+
+    IrSsaFunction function;
+    vector<IrInstruction> functionCode;
+
+    while (idx < instructions.size()) {
+        size_t end = idx + 1;
+        while (end < instructions.size() && !instructions[end].isFunLabel()) {
+            end++;
+        }
+
+        functionCode.assign(instructions.begin() + idx, instructions.begin() + end);
+        function.build(functionCode);
+
+        while (true) {
+            int changes = function.propagateConstants();
+            changes += function.removeDeadDefinitions();
+            if (changes == 0) {
+                break;
+            }
+        }
+
+        if (dumpOut) {
+            function.dump(*dumpOut, names);
+        }
+
+        function.destruct(result);
+        idx = end;
+    }
+
+    instructions.swap(result);
+}
+
+}
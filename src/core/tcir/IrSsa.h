@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    TCIR 的 SSA 形式。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+/*
+
+  提升的变量
+
+    局部变量（val <id>）与函数参数（fval x）都存放在栈上，且 TCIR 内没有取地址的指令，
+    因此它们都可以提升为 SSA 值。全局变量可能被其他函数修改，不提升。
+
+  读改写
+
+    add val 3 imm 1 这样的指令同时使用并定义变量。构造后，操作数记为新定义的值，
+    被使用的旧值记在新值的 tiedFrom 内。两者在析构后回到同一个栈位置。
+
+  析构
+
+    SSA 值的每个版本都回到原变量的栈位置，phi 直接删去。
+    这要求 SSA 保持 conventional 形式：同一变量的各版本的活跃区间互不重叠。
+    构造的结果满足这一点；本文件内的优化只删除无用的定义、把使用换成常量，不会破坏它。
+    今后如果加入复制传播等会使活跃区间重叠的优化，需要在析构时插入复制。
+
+*/
+
+#pragma once
+
+#include <core/tcir/IrCfg.h>
+
+#include <iostream>
+#include <vector>
+
+namespace tc::tcir {
+
+    struct IrSsaValue {
+
+        /** 原变量。local 或 param 操作数。 */
+        IrOperand variable;
+
+        /** 定义所在的块。 */
+        int block = 0;
+
+        /**
+         * 定义的指令下标。phi 定义为 -1，进入函数时的初值为 -2。
+         * 局部变量的初值未定义；参数的初值为调用者传入的实参。
+         */
+        int instruction = -2;
+
+        /** 读改写指令定义的值所使用的旧值。没有则为 -1。 */
+        int tiedFrom = -1;
+
+        bool isPhi() const { return instruction == -1; }
+        bool isEntry() const { return instruction == -2; }
+    };
+
+    struct IrSsaPhi {
+        int value;
+
+        /** 参数。与所在块的 preds 一一对应。 */
+        std::vector<int> args;
+    };
+
+
+    /**
+     * SSA 形式的函数。
+     */
+    class IrSsaFunction {
+
+    public:
+
+        /**
+         * 构造 SSA。使用 Cytron 等人的方法：在支配边界的迭代闭包上放置 phi，
+         * 再沿支配树重命名。
+         *
+         * @param instructions 函数的指令。以 fun-label 开头。
+         */
+        void build(const std::vector<IrInstruction>& instructions);
+
+        /**
+         * 常量传播。把值为常量的 SSA 值的使用换成立即数。
+         *
+         * @return 替换的操作数个数。
+         */
+        int propagateConstants();
+
+        /**
+         * 删除没有使用的定义：phi、mov 与纯运算指令。删除可能使其他定义变得无用，一并删除。
+         *
+         * @return 删除的指令与 phi 个数。
+         */
+        int removeDeadDefinitions();
+
+        /**
+         * 析构 SSA，把函数的指令追加到 out 末尾。
+         */
+        void destruct(std::vector<IrInstruction>& out) const;
+
+        /**
+         * 输出 SSA 形式。用于调试。
+         */
+        void dump(std::ostream& out, const IrNameTable& names) const;
+
+        const IrCfg& getCfg() const { return cfg; }
+        const std::vector<IrSsaValue>& getValues() const { return values; }
+
+    protected:
+
+        /**
+         * 计算每个 SSA 值被使用的次数。包括 phi 参数与读改写的旧值。
+         */
+        std::vector<int> countUses() const;
+
+    protected:
+        IrCfg cfg;
+
+        std::vector<IrInstruction> code;
+
+        /** 被删除的指令。析构时跳过。 */
+        std::vector<bool> removed;
+
+        std::vector<IrSsaValue> values;
+
+        /** 各块的 phi。 */
+        std::vector< std::vector<IrSsaPhi> > phis;
+
+    };
+
+
+    class IrSsaUtils {
+    public:
+
+        /**
+         * 逐个函数构造 SSA，做常量传播与无用定义删除，再析构回普通的指令。
+         *
+         * @param instructions 模块的全部指令。原地修改。
+         * @param names 名称表。输出 SSA 形式时使用。
+         * @param dumpOut 非空时，输出各函数优化后的 SSA 形式。
+         */
+        static void optimize(
+            std::vector<IrInstruction>& instructions,
+            const IrNameTable& names,
+            std::ostream* dumpOut = nullptr
+        );
+
+        /**
+         * 获取指令各操作数是否被使用、是否被定义。
+         * 对不认识的指令，所有操作数都视为既被使用又被定义。
+         */
+        static void getOperandRoles(
+            const IrInstruction& ins,
+            bool uses[IrInstruction::MAX_OPERANDS],
+            bool defs[IrInstruction::MAX_OPERANDS]
+        );
+    };
+
+}
@@ -0,0 +1,506 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    文本 TCIR 读取器。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+#include <core/tcir/IrTextReader.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using namespace std;
+
+namespace tc::tcir {
+
+/**
+ * 每段指令至少的字节数。小文件不必开线程。
+ */
+static const size_t __tcMinChunkBytes = 1 << 16;
+
+static bool __tcIsBlank(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\v' || ch == '\f';
+}
+
+/**
+ * 取出一行。pos 移到下一行开头。
+ */
+static string_view __tcNextLine(const char*& pos, const char* end) {
+    auto lineEnd = static_cast<const char*>(memchr(pos, '\n', end - pos));
+    if (lineEnd == nullptr) {
+        lineEnd = end;
+    }
+
+    string_view line(pos, lineEnd - pos);
+    pos = lineEnd == end ? end : lineEnd + 1;
+    return line;
+}
+
+/**
+ * 按空白切分一行。遇到 // 时，其后的内容作为注释忽略。
+ */
+static void __tcSplitLine(string_view line, vector<string_view>& segments) {
+    segments.clear();
+
+    const char* pos = line.data();
+    const char* end = pos + line.size();
+
+    while (pos < end) {
+        if (__tcIsBlank(*pos)) {
+            pos++;
+            continue;
+        }
+
+        const char* begin = pos;
+        while (pos < end && !__tcIsBlank(*pos)) {
+            if (*pos == '/' && pos + 1 < end && pos[1] == '/') {
+                end = pos;
+                break;
+            }
+
+            pos++;
+        }
+
+        if (pos > begin) {
+            segments.emplace_back(begin, pos - begin);
+        }
+    }
+}
+
+static ValueType __tcToValueType(string_view name) {
+    ValueType type = ValueType::s32;
+    ValueTypeUtils::findType(name, type);
+    return type;
+}
+
+
+int IrTextReader::read(const char* data, size_t size, ostream& err, int threadCount) {
+
+    this->clear();
+
+    if (data == nullptr || size == 0) {
+        return 1;
+    }
+
+    enum class Section {
+        none, extlink, staticData, globalSymtab, blockSymtab
+    };
+
+    Section section = Section::none;
+    const char* pos = data;
+    const char* end = data + size;
+
+    vector<string_view> segments;
+    int resCode = 0;
+
+    // 全局数据区段在全文符号表之前。先记下，最后填入变量符号。
+    vector< pair<string, int64_t> > initValues;
+    vector<string> imports;
+
+    FunctionSymbol* function = nullptr;
+    int pendingParamCount = 0;
+
+    BlockSymbolTable* blockTab = nullptr;
+    map<BlockSymbolTable*, int> parentIdMap;
+
+    auto badLine = [&err] (const char* what, string_view line) {
+        err << "[err] bad " << what << " line: " << line << endl;
+        return 2;
+    };
+
+    while (pos < end) {
+        string_view line = __tcNextLine(pos, end);
+        __tcSplitLine(line, segments);
+
+        if (segments.empty()) {
+            continue;
+        }
+
+        /* 区段边界。 @ begin of xxx, @ end of xxx */
+
+        if (segments[0] == "@") {
+            if (segments.size() != 4 || (segments[1] != "begin" && segments[1] != "end")) {
+                return badLine("section", line);
+            }
+
+            section = Section::none;
+
+            if (segments[1] == "end") {
+                continue;
+            }
+
+            auto& name = segments[3];
+
+            if (name == "extlink") {
+                section = Section::extlink;
+            } else if (name == "static-data") {
+                section = Section::staticData;
+            } else if (name == "global-symtab") {
+                section = Section::globalSymtab;
+            } else if (name == "block-symtab") {
+                section = Section::blockSymtab;
+            } else if (name == "instructions") {
+
+                // 指令区段整体交给 readInstructions。结尾行留给下一轮循环。
+                string_view rest(pos, end - pos);
+                size_t endPos = rest.find("@ end of instructions");
+
+                if (endPos == string_view::npos) {
+                    return badLine("section", line);
+                }
+
+                if (readInstructions(pos, pos + endPos, err, threadCount)) {
+                    resCode = 3;
+                }
+
+                pos += endPos;
+            }
+
+            continue;
+        }
+
+        switch (section) {
+            case Section::none: {
+                break;
+            }
+
+            case Section::extlink: {
+                // export ${symbol} ${"fun" | "var"}
+                // import ${symbol}
+                if (segments[0] == "import" && segments.size() >= 2) {
+                    imports.emplace_back(segments[1]);
+                }
+
+                break;
+            }
+
+            case Section::staticData: {
+                // int var ${name} ${type} ${value}
+                if (segments[0] == "int") {
+                    if (segments.size() != 5) {
+                        return badLine("static-data", line);
+                    }
+
+                    initValues.emplace_back(string(segments[2]), IrCodeUtils::toInt(segments[4]));
+                }
+
+                break;
+            }
+
+            case Section::globalSymtab: {
+
+                if (pendingParamCount > 0) {
+                    // ${type} ${"ptr" | "value"} ${name}
+                    pendingParamCount--;
+
+                    if (segments[0] == "void") {
+                        break;
+                    }
+
+                    if (segments.size() != 3) {
+                        return badLine("global-symtab", line);
+                    }
+
+                    auto& param = function->params.emplace_back();
+                    param.symbolType = SymbolType::functionParam;
+                    param.visibility = SymbolVisibility::internal;
+                    param.name = segments[2];
+                    param.valueType = __tcToValueType(segments[0]);
+                    param.isPointer = segments[1] == "ptr";
+                    param.isVaList = false;
+
+                } else if (segments[0] == "fun") {
+                    // fun ${visibility} ${name} ${argc} ${return type} ${root symtab id}
+                    if (segments.size() != 6) {
+                        return badLine("global-symtab", line);
+                    }
+
+                    function = new FunctionSymbol;
+                    function->symbolType = SymbolType::functionDefine;
+                    function->visibility = segments[1] == "visible"
+                        ? SymbolVisibility::global : SymbolVisibility::internal;
+                    function->name = segments[2];
+                    function->returnType = __tcToValueType(segments[4]);
+                    function->isImported = false;
+                    function->rootSymTabId = int(IrCodeUtils::toInt(segments[5]));
+                    globalSymbolTable.put(function);
+
+                    pendingParamCount = int(IrCodeUtils::toInt(segments[3]));
+
+                } else if (segments[0] == "var") {
+                    // var ${name} ${type} ${bytes}
+                    if (segments.size() != 4) {
+                        return badLine("global-symtab", line);
+                    }
+
+                    auto var = new VariableSymbol;
+                    var->symbolType = SymbolType::variableDefine;
+                    var->visibility = SymbolVisibility::global;
+                    var->name = segments[1];
+                    var->id = -1;
+                    var->valueType = __tcToValueType(segments[2]);
+                    var->bytes = int(IrCodeUtils::toInt(segments[3]));
+                    globalSymbolTable.put(var);
+                }
+
+                break;
+            }
+
+            case Section::blockSymtab: {
+
+                if (segments[0] == "%") {
+                    // % begin, % end
+                    if (segments.size() == 2 && segments[1] == "begin") {
+                        blockTab = new BlockSymbolTable;
+                        blockTab->descTable = &varDescTable;
+                        blockSymbolTables.push_back(blockTab);
+                    } else {
+                        blockTab = nullptr;
+                    }
+
+                    break;
+                }
+
+                if (blockTab == nullptr || segments.size() < 2) {
+                    return badLine("block-symtab", line);
+                }
+
+                if (segments[0] == "tab-id") {
+                    blockTab->id = int(IrCodeUtils::toInt(segments[1]));
+                } else if (segments[0] == "parent-tab-id") {
+                    parentIdMap[blockTab] = int(IrCodeUtils::toInt(segments[1]));
+                } else if (segments[0] == "var") {
+                    // var ${id} ${name} ${type} ${bytes}
+                    if (segments.size() != 5) {
+                        return badLine("block-symtab", line);
+                    }
+
+                    auto sym = new VariableSymbol;
+                    sym->symbolType = SymbolType::variableDefine;
+                    sym->visibility = SymbolVisibility::internal;
+                    sym->id = int(IrCodeUtils::toInt(segments[1]));
+                    sym->name = segments[2];
+                    sym->valueType = __tcToValueType(segments[3]);
+                    sym->bytes = int(IrCodeUtils::toInt(segments[4]));
+                    blockTab->put(sym);
+                }
+
+                break;
+            }
+        }
+    }
+
+    /* 收尾。 */
+
+    for (auto& it : initValues) {
+        auto var = globalSymbolTable.getVariable(it.first);
+        if (var) {
+            var->initValue = it.second;
+        }
+    }
+
+    for (auto& name : imports) {
+        if (globalSymbolTable.getFunction(name)) {
+            continue;
+        }
+
+        auto fun = new FunctionSymbol;
+        fun->symbolType = SymbolType::functionDefine;
+        fun->visibility = SymbolVisibility::global;
+        fun->name = name;
+        fun->isImported = true;
+        globalSymbolTable.put(fun);
+    }
+
+    // 母子关系绑定。
+    map<int, BlockSymbolTable*> tabIdMap;
+    for (auto symbolTab : blockSymbolTables) {
+        tabIdMap[symbolTab->id] = symbolTab;
+    }
+
+    for (auto symbolTab : blockSymbolTables) {
+        auto it = tabIdMap.find(parentIdMap[symbolTab]);
+        if (it != tabIdMap.end() && it->second != symbolTab) {
+            it->second->children.push_back(symbolTab);
+            symbolTab->parent = it->second;
+        }
+    }
+
+    return resCode;
+}
+
+int IrTextReader::readInstructions(
+    const char* begin, const char* end, ostream& err, int threadCount
+) {
+
+    if (threadCount <= 0) {
+        threadCount = max(1u, thread::hardware_concurrency());
+    }
+
+    // 切分。只在 fun-label 所在行切开，使每段开头的所在函数确定。
+    // 每个线程大约分到 4 段，使各线程的工作量较为均衡。
+
+    string_view body(begin, end - begin);
+    size_t chunkSize = max(__tcMinChunkBytes, body.size() / (threadCount * 4) + 1);
+
+    vector< pair<size_t, size_t> > chunks;
+    size_t chunkBegin = 0;
+
+    while (chunkBegin < body.size()) {
+        size_t chunkEnd = body.size();
+
+        if (chunkBegin + chunkSize < body.size()) {
+            size_t found = body.find("\nfun-label", chunkBegin + chunkSize);
+            if (found != string_view::npos) {
+                chunkEnd = found + 1;
+            }
+        }
+
+        chunks.emplace_back(chunkBegin, chunkEnd);
+        chunkBegin = chunkEnd;
+    }
+
+    // 各段使用自己的名称表，合并时重新编号。
+    struct ChunkResult {
+        IrNameTable names;
+        vector<IrInstruction> instructions;
+        vector<string> errors;
+    };
+
+    int chunkCount = chunks.size();
+    vector<ChunkResult> results(chunkCount);
+    atomic<int> nextChunkIdx { 0 };
+
+    auto worker = [&] () {
+        vector<string_view> segments;
+
+        while (true) {
+            int chunkIdx = nextChunkIdx.fetch_add(1, memory_order_relaxed);
+            if (chunkIdx >= chunkCount) {
+                return;
+            }
+
+            auto& result = results[chunkIdx];
+            const char* pos = begin + chunks[chunkIdx].first;
+            const char* chunkEnd = begin + chunks[chunkIdx].second;
+
+            // 参数在指令内记录为下标，解析时需要所在的函数。
+            FunctionSymbol* function = nullptr;
+
+            // 按每行约 16 字节预留。
+            result.instructions.reserve((chunkEnd - pos) / 16);
+
+            while (pos < chunkEnd) {
+                __tcSplitLine(__tcNextLine(pos, chunkEnd), segments);
+
+                if (segments.empty()) {
+                    continue;
+                }
+
+                auto& ins = result.instructions.emplace_back();
+
+                if (!ins.parse(segments, result.names, function)) {
+                    result.errors.emplace_back(segments[0]);
+                    result.instructions.pop_back();
+                } else if (ins.isFunLabel()) {
+                    // 只读查找。多个线程同时访问全局符号表是安全的。
+                    auto& functions = globalSymbolTable.functions;
+                    auto it = functions.find(result.names.getName(ins.operands[0].value));
+                    function = it == functions.end() ? nullptr : it->second;
+                }
+            }
+        }
+    };
+
+    vector<thread> threads;
+    for (int threadIdx = 1; threadIdx < min(threadCount, chunkCount); threadIdx++) {
+        threads.emplace_back(worker);
+    }
+
+    worker();
+
+    for (auto& it : threads) {
+        it.join();
+    }
+
+    /* 按顺序合并。名称按首次出现的顺序登记，与顺序解析相同。 */
+
+    if (chunkCount > 1) {
+        size_t instructionCount = 0;
+        for (auto& result : results) {
+            instructionCount += result.instructions.size();
+        }
+
+        instructions.reserve(instructions.size() + instructionCount);
+    }
+
+    int errorCount = 0;
+    vector<int> nameIdMap;
+
+    for (auto& result : results) {
+        for (auto& it : result.errors) {
+            err << "[err] bad instruction: " << it << endl;
+        }
+
+        errorCount += result.errors.size();
+
+        nameIdMap.resize(result.names.getNameCount());
+        for (int nameId = 0; nameId < result.names.getNameCount(); nameId++) {
+            nameIdMap[nameId] = names.intern(result.names.getName(nameId));
+        }
+
+        for (auto& ins : result.instructions) {
+            for (int idx = 0; idx < ins.operandCount; idx++) {
+                if (ins.operands[idx].isName()) {
+                    ins.operands[idx].value = nameIdMap[ins.operands[idx].value];
+                }
+            }
+        }
+
+        // 只有一段时直接接管，不必复制。
+        if (chunkCount == 1 && instructions.empty()) {
+            instructions.swap(result.instructions);
+        } else {
+            instructions.insert(
+                instructions.end(), result.instructions.begin(), result.instructions.end()
+            );
+        }
+    }
+
+    return errorCount;
+}
+
+IrModule IrTextReader::getModule() {
+    IrModule module;
+    module.instructions = &this->instructions;
+    module.names = &this->names;
+    module.globalSymbolTable = &this->globalSymbolTable;
+    module.blockSymbolTables = &this->blockSymbolTables;
+    return module;
+}
+
+void IrTextReader::clear() {
+    for (auto it : blockSymbolTables) {
+        delete it;
+    }
+
+    blockSymbolTables.clear();
+
+    // 块符号表内的符号由变量描述表管理。
+    varDescTable.clear();
+    globalSymbolTable.clear();
+    names.clear();
+    instructions.clear();
+}
+
+}
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    文本 TCIR 读取器。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+#pragma once
+
+#include <core/tcir/IrContainer.h>
+#include <core/tcir/SymbolTable.h>
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+namespace tc::tcir {
+
+    /**
+     * 文本 TCIR 读取器。
+     *
+     * 直接在整块内存（通常为 mmap 映射的文件）上按行切分，各段使用 string_view，
+     * 不经过 istream 逐词读取。instructions 区段在 fun-label 处切开，由多个线程分别解析，
+     * 之后按顺序合并，结果与顺序解析相同。
+     *
+     * 读取结果通过 getModule 交给后端。
+     */
+    class IrTextReader {
+
+    public:
+        IrTextReader() {}
+        ~IrTextReader() { clear(); }
+
+        IrTextReader(const IrTextReader&) = delete;
+        IrTextReader& operator = (const IrTextReader&) = delete;
+
+        /**
+         * 读取文本 TCIR。读取期间，传入的内存需要保持有效；读取完成后不再引用。
+         *
+         * @param data 文本起始地址。
+         * @param size 文本字节数。
+         * @param err 错误信息输出流。
+         * @param threadCount 解析指令的线程数。不大于 0 时使用硬件线程数。
+         * @return 0 表示成功。1 表示没有输入。2 表示区段格式错误。3 表示存在无法解析的指令。
+         */
+        int read(const char* data, size_t size, std::ostream& err, int threadCount = 0);
+
+        /**
+         * 获取读取结果。在读取器被清空前有效。
+         */
+        IrModule getModule();
+
+        void clear();
+
+    protected:
+
+        int readInstructions(
+            const char* begin, const char* end, std::ostream& err, int threadCount
+        );
+
+    protected:
+        VariableDescriptionTable varDescTable;
+        GlobalSymbolTable globalSymbolTable;
+        std::vector<BlockSymbolTable*> blockSymbolTables;
+
+        IrNameTable names;
+        std::vector<IrInstruction> instructions;
+
+    };
+
+}
@@ -0,0 +1,1969 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+    语法制导的 TCIR 生成器。
+
+    created on 2026.10.18
+*/
+
+#include <core/tcir/SyntaxDirectedIrGenerator.h>
+
+#include <cstdlib>
+
+using namespace std;
+using namespace tc;
+
+using SdtGenerator = tcir::SyntaxDirectedIrGenerator;
+
+using tcir::IrInstruction;
+using tcir::IrOpcode;
+using tcir::IrOperand;
+using tcir::IrOperandKind;
+using tcir::IrLabelKind;
+using tcir::IrCondition;
+
+static const IrOperand __tcVreg0 = IrOperand::vreg(0);
+
+/** push 与 pop 的字节数。 */
+static const IrOperand __tcWordSize = IrOperand::number(4);
+
+/**
+ * 读取全局常量表达式的值。与遍历方式使用 stoll 不同，非数字不会抛出异常。
+ */
+static long long __tcParseConstant(const string& value) {
+    return strtoll(value.c_str(), nullptr, 10);
+}
+
+SdtGenerator::SyntaxDirectedIrGenerator() {
+    this->registerActions();
+}
+
+/* ------------ 语义值管理。 ------------ */
+
+tcir::SyntaxDirectedIrGenerator::SdtValue* SdtGenerator::newValue(
+    SdtValueKind kind, int firstTokenIdx
+) {
+
+    SdtValue* value;
+
+    if (freeValues.empty()) {
+        value = &valuePool.emplace_back();
+    } else {
+        value = freeValues.back();
+        freeValues.pop_back();
+
+        value->failed = false;
+        value->code.clear();
+        value->labelSlots.clear();
+        value->breakJumps.clear();
+        value->continueJumps.clear();
+        value->result.clear();
+        value->operand = __tcVreg0;
+        value->directSymbol = nullptr;
+        value->valid = true;
+        value->typeKind = TokenKind::unknown;
+        value->unsupportedTokenIdx = -1;
+        value->unsupportedName.clear();
+        value->form = DeclaratorForm::other;
+        value->nameTokenIdx = -1;
+        value->pointerTokenIdx = -1;
+        value->ellipsis = false;
+        value->isDeclaration = false;
+        value->parts.clear();
+    }
+
+    value->kind = kind;
+    value->firstTokenIdx = firstTokenIdx;
+
+    return value;
+}
+
+tcir::SyntaxDirectedIrGenerator::SdtValue* SdtGenerator::newCodeValue(ParserValue* values) {
+    return newValue(SdtValueKind::code, firstTokenIdxOf(values[0]));
+}
+
+void SdtGenerator::releaseValue(SdtValue* value) {
+    freeValues.push_back(value);
+}
+
+int SdtGenerator::firstTokenIdxOf(ParserValue value) {
+    return isToken(value) ? tokenIdxOf(value) : valueOf(value)->firstTokenIdx;
+}
+
+tcir::SyntaxDirectedIrGenerator::SdtValue* SdtGenerator::codeOf(ParserValue value) {
+
+    SdtValue* sdtValue = valueOf(value);
+    if (sdtValue && sdtValue->kind == SdtValueKind::code) {
+        return sdtValue;
+    }
+
+    return newValue(SdtValueKind::code, firstTokenIdxOf(value));
+}
+
+void SdtGenerator::append(SdtValue* dest, SdtValue* src) {
+
+    // splice 之后，指向 src 内指令的迭代器仍然有效，并改为指向 dest 内。
+    dest->code.splice(dest->code.end(), src->code);
+
+    dest->labelSlots.insert(
+        dest->labelSlots.end(), src->labelSlots.begin(), src->labelSlots.end()
+    );
+
+    dest->breakJumps.insert(
+        dest->breakJumps.end(), src->breakJumps.begin(), src->breakJumps.end()
+    );
+
+    dest->continueJumps.insert(
+        dest->continueJumps.end(), src->continueJumps.begin(), src->continueJumps.end()
+    );
+
+    dest->failed |= src->failed;
+
+    releaseValue(src);
+}
+
+void SdtGenerator::emit(SdtValue* dest, const IrInstruction& ins) {
+    dest->code.push_back(ins);
+}
+
+int SdtGenerator::newLabelSlot(SdtValue* dest) {
+    dest->labelSlots.push_back(labelSlotCount);
+    return labelSlotCount++;
+}
+
+IrOperand SdtGenerator::makeLabel(IrLabelKind kind, int slot) {
+    // 函数结束时换成标签 id。
+    return IrOperand::labelSlot(kind, slot);
+}
+
+void SdtGenerator::moveToTemporary(SdtValue* value) {
+
+    if (isTemporary(value->operand)) {
+        return;
+    }
+
+    auto temporary = this->newTemporary();
+    emit(value, { IrOpcode::mov, temporary, value->operand });
+    value->operand = temporary;
+}
+
+void SdtGenerator::moveToVreg0(SdtValue* value) {
+
+    if (!value->operand.isVreg(0)) {
+        emit(value, { IrOpcode::mov, __tcVreg0, value->operand });
+        value->operand = __tcVreg0;
+    }
+}
+
+/* ------------ 报错。 ------------ */
+
+void SdtGenerator::addError(int tokenIdx, const string& msg) {
+    auto& err = errorList.emplace_back();
+    err.msg = msg;
+    err.token = tokenOf(tokenIdx);
+}
+
+void SdtGenerator::addUnsupportedError(int tokenIdx, const string& symbolName) {
+
+    auto& token = tokenOf(tokenIdx);
+
+    auto& err = errorList.emplace_back();
+    err.token = token;
+
+    err.msg = "not supported: (";
+    err.msg += to_string(token.row);
+    err.msg += ", ";
+    err.msg += to_string(token.col);
+    err.msg += ") ";
+    err.msg += token.content;
+    err.msg += " as ";
+    err.msg += symbolName;
+}
+
+void SdtGenerator::addUnsupportedTerminalError(int tokenIdx) {
+
+    // 报错时使用文法内的终结符名称，与遍历方式一致。
+    auto table = actions.getTable();
+    int symbolId = table->getSymbolIdByTokenKind(tokenOf(tokenIdx).kind);
+
+    this->addUnsupportedError(tokenIdx, symbolId >= 0 ? table->symbolList[symbolId].name : "");
+}
+
+bool SdtGenerator::checkSpecifiers(SdtValue* specifiers) {
+
+    if (specifiers == nullptr || specifiers->kind != SdtValueKind::declarationSpecifiers) {
+        return false;
+    }
+
+    if (!specifiers->valid) {
+        this->addUnsupportedError(specifiers->unsupportedTokenIdx, specifiers->unsupportedName);
+        return false;
+    }
+
+    return true;
+}
+
+/* ------------ 回调注册。 ------------ */
+
+void SdtGenerator::registerActions() {
+
+    using Handler = ParserValue (SdtGenerator::*)(ParserValue*, int);
+
+    auto on = [this] (const char* production, Handler handler) {
+        actions.onReduce(production, [this, handler] (ParserValue* values, int count) {
+            return (this->*handler)(values, count);
+        });
+    };
+
+    auto onLambda = [this] (const char* production, ParserActions::ReduceAction action) {
+        actions.onReduce(production, move(action));
+    };
+
+    // 不支持的结构，归约时立即报错。
+    auto unsupportedNow = [this] (const char* symbolName) {
+        return [this, symbolName] (ParserValue* values, int) {
+            SdtValue* value = newCodeValue(values);
+            value->failed = true;
+            this->addUnsupportedError(value->firstTokenIdx, symbolName);
+            return toParserValue(value);
+        };
+    };
+
+    // 不支持的结构，用到时才报错。
+    auto unsupportedLater = [this] (const char* symbolName) {
+        return [this, symbolName] (ParserValue* values, int) {
+            SdtValue* value = newValue(SdtValueKind::unsupported, firstTokenIdxOf(values[0]));
+            value->unsupportedTokenIdx = value->firstTokenIdx;
+            value->unsupportedName = symbolName;
+            return toParserValue(value);
+        };
+    };
+
+    // 不支持的运算符。
+    auto unsupportedOperator = [this] (ParserValue* values, int) {
+        SdtValue* value = newCodeValue(values);
+        value->failed = true;
+        this->addUnsupportedTerminalError(tokenIdxOf(values[1]));
+        return toParserValue(value);
+    };
+
+    // $1 与 $n 的 IR 依次拼接。
+    auto appendLast = [this] (ParserValue* values, int count) {
+        SdtValue* value = codeOf(values[0]);
+        append(value, codeOf(values[count - 1]));
+        return toParserValue(value);
+    };
+
+    actions.onBegin([this] (const vector<Token>& tokens) { this->begin(tokens); });
+    actions.onShift([this] (int tokenIdx) { return this->shift(tokenIdx); });
+
+    /* 表达式。 */
+
+    on("primary_expression : IDENTIFIER", &SdtGenerator::reducePrimaryExpression);
+    on("primary_expression : CONSTANT", &SdtGenerator::reducePrimaryExpression);
+    on("primary_expression : STRING_LITERAL", &SdtGenerator::reducePrimaryExpression);
+    on("primary_expression : '(' expression ')'", &SdtGenerator::reducePrimaryExpression);
+
+    onLambda("postfix_expression : postfix_expression '[' expression ']'", unsupportedOperator);
+    on("postfix_expression : postfix_expression '(' ')'", &SdtGenerator::reduceFunctionCall);
+    on(
+        "postfix_expression : postfix_expression '(' argument_expression_list ')'",
+        &SdtGenerator::reduceFunctionCall
+    );
+    onLambda("postfix_expression : postfix_expression '.' IDENTIFIER", unsupportedOperator);
+    onLambda("postfix_expression : postfix_expression PTR_OP IDENTIFIER", unsupportedOperator);
+    on("postfix_expression : postfix_expression INC_OP", &SdtGenerator::reducePostfixIncDec);
+    on("postfix_expression : postfix_expression DEC_OP", &SdtGenerator::reducePostfixIncDec);
+    onLambda(
+        "postfix_expression : '(' type_name ')' '{' initializer_list '}'",
+        unsupportedNow("postfix_expression")
+    );
+    onLambda(
+        "postfix_expression : '(' type_name ')' '{' initializer_list ',' '}'",
+        unsupportedNow("postfix_expression")
+    );
+
+    on("argument_expression_list : assignment_expression", &SdtGenerator::reduceArgument);
+    on(
+        "argument_expression_list : argument_expression_list ',' assignment_expression",
+        &SdtGenerator::reduceArgument
+    );
+
+    on("unary_expression : INC_OP unary_expression", &SdtGenerator::reduceUnaryExpression);
+    on("unary_expression : DEC_OP unary_expression", &SdtGenerator::reduceUnaryExpression);
+    on("unary_expression : unary_operator cast_expression", &SdtGenerator::reduceUnaryExpression);
+    on("unary_expression : SIZEOF unary_expression", &SdtGenerator::reduceUnaryExpression);
+    on("unary_expression : SIZEOF '(' type_name ')'", &SdtGenerator::reduceUnaryExpression);
+
+    // 暂不支持真的转换。
+    onLambda("cast_expression : '(' type_name ')' cast_expression", [] (ParserValue* values, int) {
+        return values[3];
+    });
+
+    on(
+        "multiplicative_expression : multiplicative_expression '*' cast_expression",
+        &SdtGenerator::reduceMultiplicative
+    );
+    on(
+        "multiplicative_expression : multiplicative_expression '/' cast_expression",
+        &SdtGenerator::reduceMultiplicative
+    );
+    on(
+        "multiplicative_expression : multiplicative_expression '%' cast_expression",
+        &SdtGenerator::reduceMultiplicative
+    );
+
+    static const char* const binaryProductions[] = {
+        "additive_expression : additive_expression '+' multiplicative_expression",
+        "additive_expression : additive_expression '-' multiplicative_expression",
+        "shift_expression : shift_expression LEFT_OP additive_expression",
+        "shift_expression : shift_expression RIGHT_OP additive_expression",
+        "relational_expression : relational_expression '<' shift_expression",
+        "relational_expression : relational_expression '>' shift_expression",
+        "relational_expression : relational_expression LE_OP shift_expression",
+        "relational_expression : relational_expression GE_OP shift_expression",
+        "equality_expression : equality_expression EQ_OP relational_expression",
+        "equality_expression : equality_expression NE_OP relational_expression"
+    };
+
+    for (auto production : binaryProductions) {
+        on(production, &SdtGenerator::reduceBinaryCompute);
+    }
+
+    on("and_expression : and_expression '&' equality_expression", &SdtGenerator::reduceBitwise);
+    on(
+        "exclusive_or_expression : exclusive_or_expression '^' and_expression",
+        &SdtGenerator::reduceBitwise
+    );
+    on(
+        "inclusive_or_expression : inclusive_or_expression '|' exclusive_or_expression",
+        &SdtGenerator::reduceBitwise
+    );
+
+    on(
+        "logical_and_expression : logical_and_expression AND_OP inclusive_or_expression",
+        &SdtGenerator::reduceLogical
+    );
+    on(
+        "logical_or_expression : logical_or_expression OR_OP logical_and_expression",
+        &SdtGenerator::reduceLogical
+    );
+
+    on(
+        "conditional_expression : logical_or_expression '?' expression ':' conditional_expression",
+        &SdtGenerator::reduceConditional
+    );
+
+    on(
+        "assignment_expression : unary_expression assignment_operator assignment_expression",
+        &SdtGenerator::reduceAssignment
+    );
+
+    // 赋值运算符归约时，左值刚刚处理完毕，记下它指向的符号。
+    static const char* const assignmentOperators[] = {
+        "'='", "MUL_ASSIGN", "DIV_ASSIGN", "MOD_ASSIGN", "ADD_ASSIGN", "SUB_ASSIGN",
+        "LEFT_ASSIGN", "RIGHT_ASSIGN", "AND_ASSIGN", "XOR_ASSIGN", "OR_ASSIGN"
+    };
+
+    for (auto op : assignmentOperators) {
+        actions.onReduce(string("assignment_operator : ") + op, [this] (ParserValue* values, int) {
+            SdtValue* value = newValue(SdtValueKind::assignmentOperator, tokenIdxOf(values[0]));
+            value->directSymbol = directResultSymbol;
+            return toParserValue(value);
+        });
+    }
+
+    on("expression : expression ',' assignment_expression", &SdtGenerator::reduceCommaExpression);
+
+    /* 声明。 */
+
+    on("declaration : declaration_specifiers ';'", &SdtGenerator::reduceDeclaration);
+    on(
+        "declaration : declaration_specifiers init_declarator_list ';'",
+        &SdtGenerator::reduceDeclaration
+    );
+
+    on("declaration_specifiers : type_specifier", &SdtGenerator::reduceDeclarationSpecifiers);
+
+    static const char* const otherSpecifiers[] = {
+        "declaration_specifiers : storage_class_specifier",
+        "declaration_specifiers : storage_class_specifier declaration_specifiers",
+        "declaration_specifiers : type_specifier declaration_specifiers",
+        "declaration_specifiers : type_qualifier",
+        "declaration_specifiers : type_qualifier declaration_specifiers"
+    };
+
+    for (auto production : otherSpecifiers) {
+        actions.onReduce(production, [this] (ParserValue* values, int) {
+            SdtValue* value = newValue(
+                SdtValueKind::declarationSpecifiers, firstTokenIdxOf(values[0])
+            );
+
+            value->valid = false;
+            value->unsupportedTokenIdx = value->firstTokenIdx;
+            value->unsupportedName = "declaration_specifiers";
+            return toParserValue(value);
+        });
+    }
+
+    onLambda("init_declarator_list : init_declarator_list ',' init_declarator", appendLast);
+    on("init_declarator : declarator", &SdtGenerator::reduceInitDeclarator);
+    on("init_declarator : declarator '=' initializer", &SdtGenerator::reduceInitDeclarator);
+
+    onLambda(
+        "type_specifier : struct_or_union_specifier",
+        unsupportedLater("struct_or_union_specifier")
+    );
+    onLambda("type_specifier : enum_specifier", unsupportedLater("enum_specifier"));
+
+    on("declarator : pointer direct_declarator", &SdtGenerator::reduceDeclarator);
+    on("declarator : direct_declarator", &SdtGenerator::reduceDeclarator);
+
+    static const char* const directDeclarators[] = {
+        "direct_declarator : IDENTIFIER",
+        "direct_declarator : '(' declarator ')'",
+        "direct_declarator : direct_declarator '[' type_qualifier_list assignment_expression ']'",
+        "direct_declarator : direct_declarator '[' type_qualifier_list ']'",
+        "direct_declarator : direct_declarator '[' assignment_expression ']'",
+        "direct_declarator : direct_declarator '[' STATIC type_qualifier_list assignment_expression ']'",
+        "direct_declarator : direct_declarator '[' type_qualifier_list STATIC assignment_expression ']'",
+        "direct_declarator : direct_declarator '[' type_qualifier_list '*' ']'",
+        "direct_declarator : direct_declarator '[' '*' ']'",
+        "direct_declarator : direct_declarator '[' ']'",
+        "direct_declarator : direct_declarator '(' parameter_type_list ')'",
+        "direct_declarator : direct_declarator '(' identifier_list ')'",
+        "direct_declarator : direct_declarator '(' ')'"
+    };
+
+    for (auto production : directDeclarators) {
+        on(production, &SdtGenerator::reduceDirectDeclarator);
+    }
+
+    onLambda("parameter_type_list : parameter_list ',' ELLIPSIS", [this] (ParserValue* values, int) {
+        valueOf(values[0])->ellipsis = true;
+        return values[0];
+    });
+
+    onLambda("parameter_list : parameter_declaration", [this] (ParserValue* values, int) {
+        SdtValue* value = newValue(SdtValueKind::parameterList, firstTokenIdxOf(values[0]));
+        value->parts.push_back(valueOf(values[0]));
+        return toParserValue(value);
+    });
+
+    onLambda(
+        "parameter_list : parameter_list ',' parameter_declaration",
+        [this] (ParserValue* values, int) {
+            valueOf(values[0])->parts.push_back(valueOf(values[2]));
+            return values[0];
+        }
+    );
+
+    on("parameter_declaration : declaration_specifiers declarator", &SdtGenerator::reduceParameter);
+    on(
+        "parameter_declaration : declaration_specifiers abstract_declarator",
+        &SdtGenerator::reduceParameter
+    );
+    on("parameter_declaration : declaration_specifiers", &SdtGenerator::reduceParameter);
+
+    onLambda("abstract_declarator : pointer", unsupportedLater("abstract_declarator"));
+    onLambda(
+        "abstract_declarator : direct_abstract_declarator",
+        unsupportedLater("abstract_declarator")
+    );
+    onLambda(
+        "abstract_declarator : pointer direct_abstract_declarator",
+        unsupportedLater("abstract_declarator")
+    );
+
+    onLambda("initializer : '{' initializer_list '}'", unsupportedLater("initializer"));
+    onLambda("initializer : '{' initializer_list ',' '}'", unsupportedLater("initializer"));
+
+    /* 语句。 */
+
+    onLambda("labeled_statement : IDENTIFIER ':' statement", unsupportedNow("labeled_statement"));
+    onLambda(
+        "labeled_statement : CASE constant_expression ':' statement",
+        unsupportedNow("labeled_statement")
+    );
+    onLambda("labeled_statement : DEFAULT ':' statement", unsupportedNow("labeled_statement"));
+
+    onLambda("compound_statement : '{' '}'", [this] (ParserValue* values, int) {
+        return toParserValue(newCodeValue(values));
+    });
+
+    onLambda("compound_statement : '{' block_item_list '}'", [] (ParserValue* values, int) {
+        return values[1];
+    });
+
+    onLambda("block_item_list : block_item_list block_item", appendLast);
+
+    onLambda("expression_statement : ';'", [this] (ParserValue* values, int) {
+        directResultSymbol = nullptr;
+        return toParserValue(newCodeValue(values));
+    });
+
+    onLambda("expression_statement : expression ';'", [this] (ParserValue* values, int) {
+        directResultSymbol = nullptr; // 防止该值被设置。
+        return toParserValue(codeOf(values[0]));
+    });
+
+    on("selection_statement : IF '(' expression ')' statement", &SdtGenerator::reduceIfStatement);
+    on(
+        "selection_statement : IF '(' expression ')' statement ELSE statement",
+        &SdtGenerator::reduceIfStatement
+    );
+    on(
+        "selection_statement : SWITCH '(' expression ')' statement",
+        &SdtGenerator::reduceIfStatement
+    );
+
+    on("iteration_statement : WHILE '(' expression ')' statement", &SdtGenerator::reduceWhileLoop);
+    on(
+        "iteration_statement : DO statement WHILE '(' expression ')' ';'",
+        &SdtGenerator::reduceDoWhileLoop
+    );
+
+    static const char* const forLoops[] = {
+        "iteration_statement : FOR '(' expression_statement expression_statement ')' statement",
+        "iteration_statement : FOR '(' expression_statement expression_statement expression ')' statement",
+        "iteration_statement : FOR '(' declaration expression_statement ')' statement",
+        "iteration_statement : FOR '(' declaration expression_statement expression ')' statement"
+    };
+
+    for (auto production : forLoops) {
+        on(production, &SdtGenerator::reduceForLoop);
+    }
+
+    static const char* const jumpStatements[] = {
+        "jump_statement : GOTO IDENTIFIER ';'",
+        "jump_statement : CONTINUE ';'",
+        "jump_statement : BREAK ';'",
+        "jump_statement : RETURN ';'",
+        "jump_statement : RETURN expression ';'"
+    };
+
+    for (auto production : jumpStatements) {
+        on(production, &SdtGenerator::reduceJumpStatement);
+    }
+
+    /* 函数。 */
+
+    on(
+        "function_definition : declaration_specifiers declarator declaration_list compound_statement",
+        &SdtGenerator::finishFunction
+    );
+    on(
+        "function_definition : declaration_specifiers declarator compound_statement",
+        &SdtGenerator::finishFunction
+    );
+
+}
+
+/* ------------ 移进与作用域。 ------------ */
+
+void SdtGenerator::begin(const vector<Token>& tokens) {
+
+    this->tokens = &tokens;
+
+    this->clear();
+
+    currentFunction = nullptr;
+    directResultSymbol = nullptr;
+    resultValueType = ValueType::type_void;
+
+    // 上一次分析的语义值全部回收。
+    freeValues.clear();
+    for (auto& value : valuePool) {
+        freeValues.push_back(&value);
+    }
+
+    labelSlotCount = 0;
+    braceIsBlock.clear();
+    blockOpenPending = false;
+    prevTokenKind = TokenKind::unknown;
+    functionHeaderReady = false;
+}
+
+ParserValue SdtGenerator::shift(int tokenIdx) {
+
+    auto kind = tokenOf(tokenIdx).kind;
+
+    if (kind == TokenKind::r_brace) {
+
+        if (!braceIsBlock.empty()) {
+            if (braceIsBlock.back()) {
+                if (blockOpenPending) {
+                    blockOpenPending = false; // 空的代码块不建立符号表。
+                } else {
+                    this->closeBlockSymbolTable();
+                }
+            }
+
+            braceIsBlock.pop_back();
+        }
+
+    } else {
+
+        // 代码块内出现了第一个 token。
+        if (blockOpenPending) {
+            blockOpenPending = false;
+            this->openBlockSymbolTable();
+        }
+
+        if (kind == TokenKind::l_brace) {
+
+            bool isBlock;
+
+            if (braceIsBlock.empty()) {
+
+                // 文件作用域内，只有函数体是代码块。
+                isBlock = functionHeaderReady;
+                functionHeaderReady = false;
+
+            } else {
+
+                // 语句位置上的 '{' 是代码块。初始化列表、struct 与 enum 的不是。
+                switch (prevTokenKind) {
+                    case TokenKind::r_paren:
+                    case TokenKind::semi:
+                    case TokenKind::l_brace:
+                    case TokenKind::r_brace:
+                    case TokenKind::colon:
+                    case TokenKind::kw_else:
+                    case TokenKind::kw_do:
+                        isBlock = braceIsBlock.back();
+                        break;
+
+                    default:
+                        isBlock = false;
+                        break;
+                }
+            }
+
+            braceIsBlock.push_back(isBlock);
+            blockOpenPending = isBlock;
+        }
+
+    }
+
+    prevTokenKind = kind;
+
+    // 终结符的语义值为 token 下标。最低位置 1，以区别于非终结符的语义值（对象地址）。
+    return ParserValue(tokenIdx) * 2 + 1;
+}
+
+void SdtGenerator::openBlockSymbolTable() {
+
+    BlockSymbolTable* symbolTab = new BlockSymbolTable;
+    symbolTab->id = nextBlockSymTabId++;
+    symbolTab->parent = currentBlockSymbolTable ? currentBlockSymbolTable : symbolTab;
+    currentBlockSymbolTable = symbolTab;
+    symbolTab->descTable = &varDescTable;
+
+    if (this->currentFunction->rootSymTabId == -1) {
+        this->currentFunction->rootSymTabId = symbolTab->id;
+    }
+}
+
+void SdtGenerator::closeBlockSymbolTable() {
+
+    BlockSymbolTable* symbolTab = currentBlockSymbolTable;
+
+    if (symbolTab->parent == symbolTab) {
+        currentBlockSymbolTable = nullptr;
+    } else {
+        currentBlockSymbolTable = symbolTab->parent;
+    }
+
+    this->retainBlockSymbolTable(symbolTab);
+}
+
+/* ------------ 函数。 ------------ */
+
+void SdtGenerator::beginFunction(SdtValue* specifiers, SdtValue* declarator) {
+
+    functionHeaderReady = true;
+    functionLabelTabId = nextBlockSymTabId;
+
+    // 声明不受支持时，函数体照常分析，但结果会被丢弃。
+    discardedFunction.params.clear();
+    discardedFunction.rootSymTabId = -1;
+    currentFunction = &discardedFunction;
+
+    if (!this->checkSpecifiers(specifiers)) {
+        return;
+    }
+
+    if (declarator->pointerTokenIdx >= 0) {
+        this->addUnsupportedError(declarator->pointerTokenIdx, "pointer");
+        return;
+    }
+
+    if (declarator->form != DeclaratorForm::function) {
+        this->addUnsupportedError(declarator->firstTokenIdx, "declarator");
+        return;
+    }
+
+    vector<FunctionParamSymbol> functionParams;
+
+    if (declarator->ellipsis) {
+
+        // 带变长参数的，不支持。
+        this->addUnsupportedError(declarator->unsupportedTokenIdx, "parameter_type_list");
+
+    } else for (auto paramDecl : declarator->parts) {
+
+        SdtValue* paramSpecifiers = paramDecl->parts[0];
+        SdtValue* paramDeclarator = paramDecl->parts.size() > 1 ? paramDecl->parts[1] : nullptr;
+
+        if (!this->checkSpecifiers(paramSpecifiers)) {
+            continue;
+        }
+
+        auto valueType = paramSpecifiers->typeKind == TokenKind::kw_int
+            ? ValueType::s32 : ValueType::type_void;
+
+        if (paramDeclarator == nullptr) {
+            // parameter_declaration -> declaration_specifiers
+
+            auto& param = functionParams.emplace_back();
+            param.symbolType = SymbolType::functionParam;
+            param.isPointer = false;
+            param.isVaList = false;
+            param.name = "";
+            param.valueType = valueType;
+
+            continue;
+        }
+
+        if (paramDeclarator->kind == SdtValueKind::unsupported) {
+            this->addUnsupportedError(
+                paramDeclarator->unsupportedTokenIdx, paramDeclarator->unsupportedName
+            );
+
+            continue;
+        }
+
+        if (paramDeclarator->pointerTokenIdx >= 0) {
+            // 不支持指针。
+            this->addUnsupportedError(paramDeclarator->pointerTokenIdx, "pointer");
+            continue;
+        }
+
+        if (paramDeclarator->form != DeclaratorForm::identifier) {
+            this->addUnsupportedError(paramDecl->firstTokenIdx, "parameter_declaration");
+            continue;
+        }
+
+        auto& param = functionParams.emplace_back();
+        param.symbolType = SymbolType::functionParam;
+        param.isPointer = false;
+        param.isVaList = false;
+        param.name = tokenOf(paramDeclarator->nameTokenIdx).content;
+        param.valueType = valueType;
+    }
+
+    if (declarator->nameTokenIdx < 0) {
+        this->addUnsupportedError(declarator->firstTokenIdx, "direct_declarator");
+        return;
+    }
+
+    const string& functionName = tokenOf(declarator->nameTokenIdx).content;
+
+    // 生成函数信息。
+
+    FunctionSymbol* funcSymbol = new FunctionSymbol;
+    globalSymbolTable.functions[functionName] = funcSymbol;
+    funcSymbol->params = functionParams;
+
+    if (specifiers->typeKind == TokenKind::kw_int) {
+        funcSymbol->returnType = ValueType::s32;
+    } else {
+        funcSymbol->returnType = ValueType::type_void;
+    }
+
+    funcSymbol->name = functionName;
+    funcSymbol->isImported = false;
+    funcSymbol->symbolType = SymbolType::functionDefine;
+    funcSymbol->visibility = SymbolVisibility::global;
+
+    this->currentFunction = funcSymbol;
+}
+
+ParserValue SdtGenerator::finishFunction(ParserValue* values, int count) {
+
+    SdtValue* value = newCodeValue(values);
+
+    if (count == 4) {
+
+        /*
+            function_definition ->
+                declaration_specifiers declarator
+                declaration_list compound_statement
+        */
+
+        this->addUnsupportedError(value->firstTokenIdx, "function_definition");
+        value->failed = true;
+    }
+
+    FunctionSymbol* funcSymbol = currentFunction;
+    SdtValue* body = codeOf(values[count - 1]);
+
+    currentFunction = nullptr; // 不再绑定当前函数。
+    functionHeaderReady = false;
+
+    int slotCount = labelSlotCount;
+    labelSlotCount = 0;
+
+    int temporaryCount = nextTemporaryId;
+    nextTemporaryId = 2;
+
+    if (count == 4 || funcSymbol == nullptr || funcSymbol == &discardedFunction) {
+        releaseValue(body);
+        return toParserValue(value);
+    }
+
+    // 按遍历顺序为标签分配 id。
+    vector<int> labelIds(slotCount);
+    for (auto slot : body->labelSlots) {
+        labelIds[slot] = nextLabelId++;
+    }
+
+    for (auto& jump : body->breakJumps) {
+        this->addError(jump.second, "nowhere to skip for \"break\".");
+    }
+
+    for (auto& jump : body->continueJumps) {
+        this->addError(jump.second, "nowhere to skip for \"continue\".");
+    }
+
+    // 临时值按出现的顺序重新编号，与遍历方式的申请顺序一致。
+    vector<int64_t> temporaryIds(temporaryCount, -1);
+    int64_t nextId = 2;
+
+    // 生成标签。
+    instructionList.emplace_back(
+        IrOpcode::funLabel,
+        IrOperand::function(irNames.intern(funcSymbol->name)),
+        IrOperand::number(functionLabelTabId)
+    );
+
+    for (auto& ins : body->code) {
+
+        for (int idx = 0; idx < ins.operandCount; idx++) {
+            auto& operand = ins.operands[idx];
+            if (operand.kind == IrOperandKind::labelSlot) {
+                operand.kind = IrOperandKind::label;
+                operand.value = labelIds[operand.value];
+            } else if (isTemporary(operand)) {
+                auto& id = temporaryIds[operand.value];
+                if (id < 0) {
+                    id = nextId++;
+                }
+
+                operand.value = id;
+            }
+        }
+
+        instructionList.push_back(ins);
+    }
+
+    // 生成 ret 语句。
+    // 这样做可能会导致重复生成 ret。后续删去多余的 ret 即可。
+    instructionList.emplace_back(IrOpcode::ret);
+
+    releaseValue(body);
+
+    return toParserValue(value);
+}
+
+/* ------------ 表达式。 ------------ */
+
+ParserValue SdtGenerator::reducePrimaryExpression(ParserValue* values, int count) {
+
+    /*
+
+        primary_expression
+            : IDENTIFIER
+            | CONSTANT
+            | STRING_LITERAL
+            | '(' expression ')'
+            ;
+
+    */
+
+    if (count == 3) {
+        return values[1];
+    }
+
+    int tokenIdx = tokenIdxOf(values[0]);
+    auto& token = tokenOf(tokenIdx);
+
+    if (token.kind == TokenKind::identifier) {
+
+        // 被调用的函数名。遍历方式不会访问它，directResultSymbol 也保持不变。
+        int lookaheadIdx = actions.getLookaheadTokenIdx();
+        if (lookaheadIdx >= 0 && size_t(lookaheadIdx) < tokens->size()
+            && tokenOf(lookaheadIdx).kind == TokenKind::l_paren
+        ) {
+            return toParserValue(newValue(SdtValueKind::functionName, tokenIdx));
+        }
+    }
+
+    directResultSymbol = nullptr;
+
+    SdtValue* value = newValue(SdtValueKind::code, tokenIdx);
+    auto& content = token.content;
+
+    if (token.kind == TokenKind::string_literal) {
+
+        // 暂不支持字符串。
+        this->addUnsupportedTerminalError(tokenIdx);
+        value->failed = true;
+
+    } else if (token.kind == TokenKind::identifier) {
+
+        if (isInGlobalScope()) {
+
+            this->addError(
+                tokenIdx, "cannot use variable to init value in global scope. (" + content + ")"
+            );
+
+            value->failed = true;
+            return toParserValue(value);
+        }
+
+        // 寻找这个符号的含义。依次查找块符号表、函数参数表与全局变量。
+
+        auto symbolFromTable = currentBlockSymbolTable
+            ? currentBlockSymbolTable->get(content, true) : nullptr;
+
+        if (symbolFromTable && symbolFromTable->valueType != ValueType::s32) {
+            this->addError(tokenIdx, "only support int32.");
+            value->failed = true;
+            return toParserValue(value);
+        }
+
+        if (symbolFromTable) {
+            value->operand = IrOperand::local(symbolFromTable->id);
+            resultValueType = symbolFromTable->valueType;
+            directResultSymbol = symbolFromTable;
+            return toParserValue(value);
+        }
+
+        auto symFromFuncParams = currentFunction->findParamSymbol(content);
+
+        if (symFromFuncParams && symFromFuncParams->valueType != ValueType::s32) {
+            this->addError(tokenIdx, "only support int32.");
+            value->failed = true;
+            return toParserValue(value);
+        }
+
+        if (symFromFuncParams) {
+            value->operand = IrOperand::param(currentFunction->findParamSymbolIndex(content));
+            resultValueType = symFromFuncParams->valueType;
+            directResultSymbol = symFromFuncParams;
+            return toParserValue(value);
+        }
+
+        auto symFromGlobalVar = globalSymbolTable.getVariable(content);
+
+        if (symFromGlobalVar && symFromGlobalVar->valueType != ValueType::s32) {
+            this->addError(tokenIdx, "only support int32.");
+            value->failed = true;
+            return toParserValue(value);
+        }
+
+        if (symFromGlobalVar) {
+            value->operand = IrOperand::global(irNames.intern(content));
+            resultValueType = symFromGlobalVar->valueType;
+            directResultSymbol = symFromGlobalVar;
+            return toParserValue(value);
+        }
+
+        this->addError(tokenIdx, "symbol not found: " + content);
+        value->failed = true;
+
+    } else {
+
+        // constant
+        resultValueType = ValueType::s32;
+
+        if (isInGlobalScope()) {
+            value->result = content;
+        } else {
+            // 按 C 的写法解析进制。
+            value->operand = IrOperand::imm(strtoll(content.c_str(), nullptr, 0));
+        }
+    }
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reducePostfixIncDec(ParserValue* values, int) {
+
+    SdtValue* value = codeOf(values[0]);
+    auto op = tokenOf(tokenIdxOf(values[1])).kind;
+
+    if (resultValueType != ValueType::s32) {
+        this->addError(value->firstTokenIdx, "cannot assign ++/-- on non int32 value.");
+        value->failed = true;
+        return toParserValue(value);
+    }
+
+    if (isInGlobalScope()) {
+        this->addError(value->firstTokenIdx, "cannot assign ++/-- in global scope.");
+        value->failed = true;
+        return toParserValue(value);
+    }
+
+    if (!directResultSymbol) {
+        this->addError(value->firstTokenIdx, "cannot assign ++/-- to constants.");
+        value->failed = true;
+        return toParserValue(value);
+    }
+
+    IrOperand symbolOperand = this->symbolToIrOperand(directResultSymbol);
+
+    // 表达式的值是自增前的值，先复制出来。
+    value->operand = this->newTemporary();
+    emit(value, { IrOpcode::mov, value->operand, symbolOperand });
+    emit(value, {
+        op == TokenKind::plusplus ? IrOpcode::add : IrOpcode::sub,
+        symbolOperand, IrOperand::imm(1)
+    });
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceFunctionCall(ParserValue* values, int count) {
+
+    /*
+        postfix_expression
+            | postfix_expression '(' ')'
+            | postfix_expression '(' argument_expression_list ')'
+            ;
+
+        只考虑最简单的名称，如 func()。
+    */
+
+    int nameTokenIdx = firstTokenIdxOf(values[0]);
+
+    if (!isToken(values[0])) {
+        releaseValue(valueOf(values[0]));
+    }
+
+    SdtValue* value = count == 4 ? codeOf(values[2]) : newCodeValue(values);
+    value->firstTokenIdx = nameTokenIdx;
+
+    auto& funcName = tokenOf(nameTokenIdx).content;
+
+    if (!this->globalSymbolTable.getFunction(funcName)) {
+        this->addError(nameTokenIdx, "this function is undefined: " + funcName);
+        value->failed = true;
+        return toParserValue(value);
+    }
+
+    emit(value, { IrOpcode::call, IrOperand::function(irNames.intern(funcName)) });
+
+    // 返回值位于 vreg 0。
+    value->operand = __tcVreg0;
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceArgument(ParserValue* values, int count) {
+
+    /*
+
+        argument_expression_list
+            : assignment_expression
+            | argument_expression_list ',' assignment_expression
+            ;
+
+    */
+
+    SdtValue* value = codeOf(values[0]);
+
+    if (count > 1) {
+        SdtValue* argument = codeOf(values[2]);
+        value->operand = argument->operand;
+        append(value, argument);
+    }
+
+    emit(value, { IrOpcode::pushfc, __tcWordSize, value->operand });
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceUnaryExpression(ParserValue* values, int) {
+
+    /*
+        unary_expression
+            | INC_OP unary_expression
+            | DEC_OP unary_expression
+            | unary_operator cast_expression
+            | SIZEOF unary_expression
+            | SIZEOF '(' type_name ')'
+            ;
+    */
+
+    SdtValue* value = newCodeValue(values);
+    value->failed = true;
+
+    int opTokenIdx = tokenIdxOf(values[0]);
+    auto op = tokenOf(opTokenIdx).kind;
+
+    if (op == TokenKind::kw_sizeof) {
+        // 不支持 sizeof
+        this->addUnsupportedTerminalError(opTokenIdx);
+    } else if (op != TokenKind::plusplus && op != TokenKind::minusminus) {
+        // unary_operator 的语义值即为运算符 token。
+        this->addUnsupportedError(opTokenIdx, "unary_operator");
+    } else if (isInGlobalScope()) {
+        this->addError(opTokenIdx, "cannot use ++/-- in global scope.");
+    } else {
+        this->addUnsupportedTerminalError(opTokenIdx);
+    }
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceMultiplicative(ParserValue* values, int) {
+
+    SdtValue* value = codeOf(values[0]);
+    int opTokenIdx = tokenIdxOf(values[1]);
+    SdtValue* rhs = codeOf(values[2]);
+
+    auto op = tokenOf(opTokenIdx).kind;
+
+    if (isInGlobalScope()) {
+
+        long long lhsRes = __tcParseConstant(value->result);
+        long long rhsRes = __tcParseConstant(rhs->result);
+        bool failed = value->failed || rhs->failed;
+
+        append(value, rhs);
+
+        if (failed) {
+            return toParserValue(value);
+        }
+
+        if (op != TokenKind::star && rhsRes == 0) {
+            this->addError(opTokenIdx, "division by zero.");
+            value->failed = true;
+        } else if (op == TokenKind::star) {
+            value->result = to_string(lhsRes * rhsRes);
+        } else if (op == TokenKind::slash) {
+            value->result = to_string(lhsRes / rhsRes);
+        } else {
+            value->result = to_string(lhsRes % rhsRes);
+        }
+
+        return toParserValue(value);
+    }
+
+    // 计算结果写在左操作数的临时值上。
+    moveToTemporary(value);
+
+    bool rhsFailed = rhs->failed;
+    IrOperand rhsOperand = rhs->operand;
+    append(value, rhs);
+
+    if (rhsFailed) {
+        return toParserValue(value);
+    }
+
+    if (op == TokenKind::star) {
+        emit(value, { IrOpcode::mul, value->operand, rhsOperand });
+    } else {
+        // 不支持除法与取模。
+        this->addUnsupportedTerminalError(opTokenIdx);
+        value->failed = true;
+    }
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceBinaryCompute(ParserValue* values, int) {
+
+    /*
+        additive_expression '+' | '-' multiplicative_expression
+        relational_expression '<' | '>' | LE_OP | GE_OP shift_expression
+        equality_expression EQ_OP | NE_OP relational_expression
+    */
+
+    SdtValue* value = codeOf(values[0]);
+    int opTokenIdx = tokenIdxOf(values[1]);
+    SdtValue* rhs = codeOf(values[2]);
+
+    auto op = tokenOf(opTokenIdx).kind;
+
+    if (op == TokenKind::lessless || op == TokenKind::greatergreater) {
+        // 不支持移位。
+        this->addUnsupportedTerminalError(opTokenIdx);
+        append(value, rhs);
+        value->failed = true;
+        return toParserValue(value);
+    }
+
+    if (value->failed || rhs->failed) {
+        append(value, rhs);
+        return toParserValue(value);
+    }
+
+    if (isInGlobalScope()) {
+
+        long long lhsRes = __tcParseConstant(value->result);
+        long long rhsRes = __tcParseConstant(rhs->result);
+        long long result;
+
+        switch (op) {
+            case TokenKind::plus: result = lhsRes + rhsRes; break;
+            case TokenKind::minus: result = lhsRes - rhsRes; break;
+            case TokenKind::less: result = lhsRes < rhsRes; break;
+            case TokenKind::greater: result = lhsRes > rhsRes; break;
+            case TokenKind::lessequal: result = lhsRes <= rhsRes; break;
+            case TokenKind::greaterequal: result = lhsRes >= rhsRes; break;
+            case TokenKind::equalequal: result = lhsRes == rhsRes; break;
+            default: result = lhsRes != rhsRes; break;
+        }
+
+        releaseValue(rhs);
+        value->result = to_string(result);
+
+        return toParserValue(value);
+    }
+
+    IrOperand rhsOperand = rhs->operand;
+
+    switch (op) {
+        case TokenKind::plus:
+        case TokenKind::minus:
+            // 计算结果写在左操作数的临时值上。
+            moveToTemporary(value);
+            append(value, rhs);
+            emit(value, {
+                op == TokenKind::plus ? IrOpcode::add : IrOpcode::sub, value->operand, rhsOperand
+            });
+            break;
+
+        default: {
+            // cmp 的左操作数不能是立即数。vreg 0 可能被右侧改写，也先复制出来。
+            if (value->operand.kind == IrOperandKind::imm || value->operand.isVreg(0)) {
+                moveToTemporary(value);
+            }
+
+            append(value, rhs);
+
+            IrCondition cond;
+            switch (op) {
+                case TokenKind::less: cond = IrCondition::l; break;
+                case TokenKind::greater: cond = IrCondition::g; break;
+                case TokenKind::lessequal: cond = IrCondition::le; break;
+                case TokenKind::greaterequal: cond = IrCondition::ge; break;
+                case TokenKind::equalequal: cond = IrCondition::eq; break;
+                default: cond = IrCondition::ne; break;
+            }
+
+            emit(value, { IrOpcode::cmp, value->operand, rhsOperand, IrOperand::condition(cond) });
+            value->operand = __tcVreg0;
+            break;
+        }
+    }
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceBitwise(ParserValue* values, int) {
+
+    SdtValue* value = codeOf(values[0]);
+    SdtValue* rhs = codeOf(values[2]);
+
+    auto op = tokenOf(tokenIdxOf(values[1])).kind;
+
+    if (isInGlobalScope()) {
+
+        long long lhsRes = __tcParseConstant(value->result);
+        long long rhsRes = __tcParseConstant(rhs->result);
+
+        if (op == TokenKind::amp) {
+            value->result = to_string(lhsRes & rhsRes);
+        } else if (op == TokenKind::caret) {
+            value->result = to_string(lhsRes ^ rhsRes);
+        } else {
+            value->result = to_string(lhsRes | rhsRes);
+        }
+
+        append(value, rhs);
+        return toParserValue(value);
+    }
+
+    this->addUnsupportedError(
+        value->firstTokenIdx,
+        op == TokenKind::amp ? "and_expression"
+            : op == TokenKind::caret ? "exclusive_or_expression" : "inclusive_or_expression"
+    );
+
+    append(value, rhs);
+    value->failed = true;
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceLogical(ParserValue* values, int) {
+
+    SdtValue* value = codeOf(values[0]);
+    SdtValue* rhs = codeOf(values[2]);
+
+    bool isAnd = tokenOf(tokenIdxOf(values[1])).kind == TokenKind::ampamp;
+
+    if (value->failed) {
+        append(value, rhs);
+        return toParserValue(value);
+    }
+
+    if (isInGlobalScope()) {
+
+        long long lhsRes = __tcParseConstant(value->result);
+
+        // 短路：不需要右侧的值。
+        if (isAnd && !lhsRes) {
+            value->result = "0";
+            releaseValue(rhs);
+        } else if (!isAnd && lhsRes) {
+            value->result = "1";
+            releaseValue(rhs);
+        } else {
+            value->result = move(rhs->result);
+            append(value, rhs);
+        }
+
+        return toParserValue(value);
+    }
+
+    IrOperand resultLabel = makeLabel(
+        isAnd ? IrLabelKind::logicalAndOut : IrLabelKind::logicalOrOut, newLabelSlot(value)
+    );
+
+    // 短路跳转。
+    moveToVreg0(value);
+    emit(value, { isAnd ? IrOpcode::je : IrOpcode::jne, resultLabel });
+    moveToVreg0(rhs);
+    append(value, rhs);
+    emit(value, { IrOpcode::label, resultLabel });
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceConditional(ParserValue* values, int) {
+
+    /*
+
+            logocal_or_exp
+            je .false
+            expression
+            jmp .exit
+        .false:
+            conditional_exp
+        .exit:
+
+    */
+
+    SdtValue* value = codeOf(values[0]);
+    SdtValue* trueExp = codeOf(values[2]);
+    SdtValue* falseExp = codeOf(values[4]);
+
+    if (value->failed) {
+        append(value, trueExp);
+        append(value, falseExp);
+        return toParserValue(value);
+    }
+
+    if (isInGlobalScope()) {
+
+        bool cond = __tcParseConstant(value->result);
+
+        SdtValue* chosen = cond ? trueExp : falseExp;
+        releaseValue(cond ? falseExp : trueExp);
+
+        value->result = move(chosen->result);
+        append(value, chosen);
+
+        return toParserValue(value);
+    }
+
+    int slot = newLabelSlot(value);
+    IrOperand exitLabel = makeLabel(IrLabelKind::conExit, slot);
+    IrOperand falseLabel = makeLabel(IrLabelKind::conFalse, slot);
+
+    moveToVreg0(value);
+    emit(value, { IrOpcode::je, falseLabel });
+    moveToVreg0(trueExp);
+    append(value, trueExp);
+    emit(value, { IrOpcode::jmp, exitLabel });
+    emit(value, { IrOpcode::label, falseLabel });
+    moveToVreg0(falseExp);
+    append(value, falseExp);
+    emit(value, { IrOpcode::label, exitLabel });
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceAssignment(ParserValue* values, int) {
+
+    SdtValue* value = codeOf(values[0]);
+    SdtValue* op = valueOf(values[1]);
+    SdtValue* rhs = codeOf(values[2]);
+
+    if (isInGlobalScope()) {
+        this->addUnsupportedError(value->firstTokenIdx, "assignment_expression");
+        append(value, rhs);
+        value->failed = true;
+        return toParserValue(value);
+    }
+
+    if (value->failed) {
+        append(value, rhs);
+        return toParserValue(value);
+    }
+
+    if (!op->directSymbol) {
+        this->addError(value->firstTokenIdx, "cannot find symbol.");
+        append(value, rhs);
+        value->failed = true;
+        return toParserValue(value);
+    }
+
+    IrOperand valueOperand = this->symbolToIrOperand(op->directSymbol);
+    IrOperand rhsOperand = rhs->operand;
+
+    append(value, rhs);
+
+    if (value->failed) {
+        return toParserValue(value);
+    }
+
+    TokenKind opKind = tokenOf(op->firstTokenIdx).kind;
+
+    if (opKind == TokenKind::equal) {
+        // x = x 不产生指令。
+        if (rhsOperand != valueOperand) {
+            emit(value, { IrOpcode::mov, valueOperand, rhsOperand });
+        }
+
+        value->operand = valueOperand;
+    } else if (opKind == TokenKind::plusequal || opKind == TokenKind::minusequal
+        || opKind == TokenKind::starequal
+    ) {
+        // 直接在变量上运算。
+        IrOpcode opcode = opKind == TokenKind::plusequal ? IrOpcode::add
+            : opKind == TokenKind::minusequal ? IrOpcode::sub : IrOpcode::mul;
+
+        emit(value, { opcode, valueOperand, rhsOperand });
+        value->operand = valueOperand;
+    } else {
+        // 暂不支持 /= 等。
+        this->addUnsupportedTerminalError(op->firstTokenIdx);
+        value->failed = true;
+    }
+
+    releaseValue(op);
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceCommaExpression(ParserValue* values, int) {
+
+    SdtValue* value = codeOf(values[0]);
+    SdtValue* rhs = codeOf(values[2]);
+
+    value->result = move(rhs->result);
+    value->operand = rhs->operand;
+    append(value, rhs);
+
+    return toParserValue(value);
+}
+
+/* ------------ 语句。 ------------ */
+
+void SdtGenerator::resolveJumps(
+    SdtValue* body, const IrOperand& breakTarget, const IrOperand& continueTarget
+) {
+
+    for (auto& jump : body->breakJumps) {
+        jump.first->operands[0] = breakTarget;
+    }
+
+    for (auto& jump : body->continueJumps) {
+        jump.first->operands[0] = continueTarget;
+    }
+
+    body->breakJumps.clear();
+    body->continueJumps.clear();
+}
+
+ParserValue SdtGenerator::reduceIfStatement(ParserValue* values, int count) {
+
+    SdtValue* value = newCodeValue(values);
+
+    if (tokenOf(value->firstTokenIdx).kind == TokenKind::kw_switch) {
+        this->addUnsupportedTerminalError(value->firstTokenIdx);
+        value->failed = true;
+        return toParserValue(value); // 暂不支持 switch case 语句。
+    }
+
+    bool hasElseStmt = count == 7;
+
+    IrOperand endLabel = makeLabel(IrLabelKind::ifEnd, newLabelSlot(value));
+
+    SdtValue* condition = codeOf(values[2]);
+    moveToVreg0(condition);
+    append(value, condition);
+
+    IrOperand elseLabel;
+
+    if (hasElseStmt) {
+        elseLabel = makeLabel(IrLabelKind::ifElse, newLabelSlot(value));
+        emit(value, { IrOpcode::je, elseLabel });
+    } else {
+        emit(value, { IrOpcode::je, endLabel });
+    }
+
+    append(value, codeOf(values[4]));
+
+    if (hasElseStmt) {
+        emit(value, { IrOpcode::jmp, endLabel });
+        emit(value, { IrOpcode::label, elseLabel });
+        append(value, codeOf(values[6]));
+    }
+
+    emit(value, { IrOpcode::label, endLabel });
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceWhileLoop(ParserValue* values, int) {
+
+    /*
+            exp:  <- continue target
+                expression
+                je end
+
+            stmt:
+                statement
+                jmp exp
+
+            end:  <- break target
+    */
+
+    SdtValue* value = newCodeValue(values);
+
+    int slot = newLabelSlot(value);
+    IrOperand stmtLabel = makeLabel(IrLabelKind::whileLoopStmt, slot);
+    IrOperand expLabel = makeLabel(IrLabelKind::whileLoopExp, slot);
+    IrOperand endLabel = makeLabel(IrLabelKind::whileLoopEnd, slot);
+
+    SdtValue* statement = codeOf(values[4]);
+    this->resolveJumps(statement, endLabel, expLabel);
+
+    SdtValue* condition = codeOf(values[2]);
+    moveToVreg0(condition);
+
+    emit(value, { IrOpcode::label, expLabel });
+    append(value, condition);
+    emit(value, { IrOpcode::je, endLabel });
+    emit(value, { IrOpcode::label, stmtLabel });
+    append(value, statement);
+    emit(value, { IrOpcode::jmp, expLabel });
+    emit(value, { IrOpcode::label, endLabel });
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceDoWhileLoop(ParserValue* values, int) {
+
+    /*
+            stmt:
+                statement
+
+            exp:  <- continue target
+                expression
+
+                je end
+                j stmt
+
+            end:  <- break target
+    */
+
+    SdtValue* value = newCodeValue(values);
+
+    int slot = newLabelSlot(value);
+    IrOperand stmtLabel = makeLabel(IrLabelKind::doWhileStmt, slot);
+    IrOperand expLabel = makeLabel(IrLabelKind::doWhileExp, slot);
+    IrOperand endLabel = makeLabel(IrLabelKind::doWhileEnd, slot);
+
+    SdtValue* statement = codeOf(values[1]);
+    this->resolveJumps(statement, endLabel, expLabel);
+
+    emit(value, { IrOpcode::label, stmtLabel });
+    append(value, statement);
+    SdtValue* condition = codeOf(values[4]);
+    moveToVreg0(condition);
+
+    emit(value, { IrOpcode::label, expLabel });
+    append(value, condition);
+    emit(value, { IrOpcode::je, endLabel });
+    emit(value, { IrOpcode::j, stmtLabel });
+    emit(value, { IrOpcode::label, endLabel });
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceForLoop(ParserValue* values, int count) {
+
+    /*
+                expStmtOrDecl
+
+            estmt:
+                expStmt
+                je end
+
+                statement
+
+            exp:  <- continue target
+                expression
+                jmp estmt
+
+            end:  <- break target
+    */
+
+    SdtValue* value = newCodeValue(values);
+
+    SdtValue* init = codeOf(values[2]);
+
+    if (init->isDeclaration) {
+        // 暂不支持 for (int x = 0; ; ) {} 这种形式。循环变量要求在外部定义。
+        this->addUnsupportedError(init->firstTokenIdx, "declaration");
+        append(value, init);
+        value->failed = true;
+        return toParserValue(value);
+    }
+
+    int slot = newLabelSlot(value);
+    IrOperand estmtLabel = makeLabel(IrLabelKind::forLoopEstmt, slot);
+    IrOperand expLabel = makeLabel(IrLabelKind::forLoopExp, slot);
+    IrOperand endLabel = makeLabel(IrLabelKind::forLoopEnd, slot);
+
+    SdtValue* statement = codeOf(values[count - 1]);
+    this->resolveJumps(statement, endLabel, expLabel);
+
+    SdtValue* condition = codeOf(values[3]);
+    moveToVreg0(condition);
+
+    append(value, init);
+    emit(value, { IrOpcode::label, estmtLabel });
+    append(value, condition);
+    emit(value, { IrOpcode::je, endLabel });
+    append(value, statement);
+    emit(value, { IrOpcode::label, expLabel });
+
+    if (count == 7) {
+        append(value, codeOf(values[4]));
+    }
+
+    emit(value, { IrOpcode::jmp, estmtLabel });
+    emit(value, { IrOpcode::label, endLabel });
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceJumpStatement(ParserValue* values, int count) {
+
+    SdtValue* value = newCodeValue(values);
+    int tokenIdx = value->firstTokenIdx;
+
+    switch (tokenOf(tokenIdx).kind) {
+
+        case TokenKind::kw_goto: {
+            this->addError(tokenIdx, "\"goto\" is not currently supported.");
+            value->failed = true;
+            break;
+        }
+
+        case TokenKind::kw_continue:
+        case TokenKind::kw_break: {
+
+            // 目标在外层循环归约时回填。
+            emit(value, { IrOpcode::jmp, IrOperand() });
+
+            auto& jumps = tokenOf(tokenIdx).kind == TokenKind::kw_break
+                ? value->breakJumps : value->continueJumps;
+
+            jumps.emplace_back(prev(value->code.end()), tokenIdx);
+
+            break;
+        }
+
+        default: {
+
+            // return
+            if (count == 3) {
+                SdtValue* result = codeOf(values[1]);
+                moveToVreg0(result);
+                append(value, result);
+            }
+
+            emit(value, IrInstruction(IrOpcode::ret));
+            break;
+        }
+    }
+
+    return toParserValue(value);
+}
+
+/* ------------ 声明。 ------------ */
+
+ParserValue SdtGenerator::reduceDeclarationSpecifiers(ParserValue* values, int) {
+
+    // declaration_specifiers : type_specifier
+
+    SdtValue* value = newValue(SdtValueKind::declarationSpecifiers, firstTokenIdxOf(values[0]));
+
+    if (isToken(values[0])) {
+
+        auto kind = tokenOf(value->firstTokenIdx).kind;
+
+        if (kind == TokenKind::kw_int || kind == TokenKind::kw_void) {
+            value->typeKind = kind;
+        } else {
+            auto table = actions.getTable();
+            int symbolId = table->getSymbolIdByTokenKind(kind);
+
+            value->valid = false;
+            value->unsupportedTokenIdx = value->firstTokenIdx;
+            value->unsupportedName = table->symbolList[symbolId].name;
+        }
+
+    } else {
+
+        // struct_or_union_specifier 与 enum_specifier
+        SdtValue* typeSpecifier = valueOf(values[0]);
+
+        value->valid = false;
+        value->unsupportedTokenIdx = typeSpecifier->unsupportedTokenIdx;
+        value->unsupportedName = typeSpecifier->unsupportedName;
+    }
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceDirectDeclarator(ParserValue* values, int count) {
+
+    SdtValue* value = newValue(SdtValueKind::declarator, firstTokenIdxOf(values[0]));
+
+    if (count == 1) {
+
+        // direct_declarator : IDENTIFIER
+        value->form = DeclaratorForm::identifier;
+        value->nameTokenIdx = value->firstTokenIdx;
+        return toParserValue(value);
+
+    }
+
+    SdtValue* inner = valueOf(values[0]);
+    bool isFunction = inner != nullptr
+        && tokenOf(tokenIdxOf(values[1])).kind == TokenKind::l_paren
+        && (count == 3 || valueOf(values[2])->kind == SdtValueKind::parameterList);
+
+    if (!isFunction) {
+        return toParserValue(value);
+    }
+
+    // direct_declarator '(' ')' 与 direct_declarator '(' parameter_type_list ')'
+    value->form = DeclaratorForm::function;
+
+    if (inner->form == DeclaratorForm::identifier && inner->pointerTokenIdx < 0) {
+        value->nameTokenIdx = inner->nameTokenIdx;
+    }
+
+    if (count == 4) {
+        SdtValue* params = valueOf(values[2]);
+        value->parts = params->parts;
+        value->ellipsis = params->ellipsis;
+        value->unsupportedTokenIdx = params->firstTokenIdx;
+    }
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceDeclarator(ParserValue* values, int count) {
+
+    SdtValue* value = valueOf(values[count - 1]);
+
+    if (count == 2) {
+        // 指针。
+        value->pointerTokenIdx = firstTokenIdxOf(values[0]);
+        value->firstTokenIdx = value->pointerTokenIdx;
+    }
+
+    // 文件作用域内的声明符后面紧跟 '{'：这是函数定义，声明说明符在它之前。
+    int lookaheadIdx = actions.getLookaheadTokenIdx();
+    if (braceIsBlock.empty() && lookaheadIdx >= 0 && size_t(lookaheadIdx) < tokens->size()
+        && tokenOf(lookaheadIdx).kind == TokenKind::l_brace
+    ) {
+        this->beginFunction(valueOf(values[-1]), value);
+    }
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceParameter(ParserValue* values, int count) {
+
+    SdtValue* value = newValue(SdtValueKind::parameter, firstTokenIdxOf(values[0]));
+
+    for (int idx = 0; idx < count; idx++) {
+        value->parts.push_back(valueOf(values[idx]));
+    }
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceInitDeclarator(ParserValue* values, int count) {
+
+    // 声明说明符位于 init_declarator_list 之前：
+    //   declaration_specifiers init_declarator
+    //   declaration_specifiers init_declarator_list ',' init_declarator
+    SdtValue* specifiers = valueOf(isToken(values[-1]) ? values[-3] : values[-1]);
+
+    SdtValue* declarator = valueOf(values[0]);
+    SdtValue* value = newCodeValue(values);
+
+    // 声明说明符不受支持时，整条声明在 declaration 归约时报错。
+    if (specifiers == nullptr || specifiers->kind != SdtValueKind::declarationSpecifiers
+        || !specifiers->valid
+    ) {
+        return toParserValue(value);
+    }
+
+    bool isInGlobalScope = this->isInGlobalScope();
+
+    // 目前仅支持 int
+    if (specifiers->typeKind != TokenKind::kw_int) {
+        this->addError(value->firstTokenIdx, "unsupported value type. only int supported.");
+        value->failed = true;
+        return toParserValue(value);
+    }
+
+    if (declarator->pointerTokenIdx >= 0) {
+        // 指针。不支持。
+        this->addUnsupportedError(declarator->pointerTokenIdx, "pointer");
+        value->failed = true;
+        return toParserValue(value);
+    }
+
+    if (declarator->form != DeclaratorForm::identifier) {
+        // 仅支持 direct_decl -> IDENTIFIER
+        this->addUnsupportedError(declarator->firstTokenIdx, "direct_declarator");
+        value->failed = true;
+        return toParserValue(value);
+    }
+
+    const string& idName = tokenOf(declarator->nameTokenIdx).content;
+
+    VariableSymbol* symbol = new VariableSymbol;
+    symbol->name = idName;
+    symbol->bytes = ValueTypeUtils::getBytes(ValueType::s32);
+    symbol->valueType = ValueType::s32;
+    symbol->symbolType = SymbolType::variableDefine;
+    symbol->visibility = isInGlobalScope ? SymbolVisibility::global : SymbolVisibility::internal;
+
+    if (isInGlobalScope) {
+
+        if (this->globalSymbolTable.variables.count(idName)) {
+            auto& warning = this->warningList.emplace_back();
+            warning.token = tokenOf(value->firstTokenIdx);
+            warning.msg = "symbol redefined: ";
+            warning.msg += idName;
+        }
+
+        if (this->globalSymbolTable.functions.count(idName)) {
+            this->addError(value->firstTokenIdx, "symbol defined as function: " + idName);
+            value->failed = true;
+            delete symbol;
+            return toParserValue(value);
+        }
+
+    } else {
+
+        if (this->currentBlockSymbolTable->get(idName, false)) {
+            this->addError(value->firstTokenIdx, "already defined: " + idName);
+            value->failed = true;
+            delete symbol;
+            return toParserValue(value);
+        }
+
+        symbol->id = this->nextVarId++;
+    }
+
+    SdtValue* initializer = count == 3 ? valueOf(values[2]) : nullptr;
+
+    if (initializer && initializer->kind != SdtValueKind::code) {
+        // { xxx }
+        this->addUnsupportedError(initializer->unsupportedTokenIdx, initializer->unsupportedName);
+        value->failed = true;
+        delete symbol;
+        return toParserValue(value);
+    }
+
+    if (initializer && initializer->failed) {
+        releaseValue(initializer);
+        value->failed = true;
+        delete symbol;
+        return toParserValue(value); // 遇到错误，不继续。
+    }
+
+    // 注册到符号表。在初始化表达式之后注册，防止表达式内直接调用自己。
+    if (isInGlobalScope) {
+        this->globalSymbolTable.variables[idName] = symbol;
+    } else {
+        this->currentBlockSymbolTable->put(symbol);
+    }
+
+    if (initializer == nullptr) {
+        return toParserValue(value);
+    }
+
+    if (isInGlobalScope) {
+        symbol->initValue = __tcParseConstant(initializer->result);
+        releaseValue(initializer);
+    } else {
+        IrOperand initOperand = initializer->operand;
+        append(value, initializer);
+        emit(value, { IrOpcode::mov, IrOperand::local(symbol->id), initOperand });
+    }
+
+    return toParserValue(value);
+}
+
+ParserValue SdtGenerator::reduceDeclaration(ParserValue* values, int count) {
+
+    SdtValue* value;
+
+    if (count == 2) {
+        // declaration -> declaration_specifiers ';'
+        value = newCodeValue(values);
+    } else {
+        value = codeOf(values[1]);
+        value->firstTokenIdx = firstTokenIdxOf(values[0]);
+
+        if (!this->checkSpecifiers(valueOf(values[0]))) {
+            this->addUnsupportedError(value->firstTokenIdx, "declaration");
+            value->failed = true;
+        }
+    }
+
+    value->isDeclaration = true;
+
+    return toParserValue(value);
+}
@@ -0,0 +1,319 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+    语法制导的 TCIR 生成器。
+
+    created on 2026.10.18
+*/
+
+/*
+
+  工作方式
+
+    IrGenerator 在语法分析结束后遍历整棵语法树生成 IR。
+    本生成器则把生成过程写成 Parser 的归约回调（见 tc/core/ParserActions.h），
+    边分析边生成，不需要语法树。生成结果与 IrGenerator 相同。
+
+    每个非终结符的语义值是一段尚未放入指令列表的 IR（以及相关信息）。
+    归约时，按 IrGenerator 遍历子树的顺序，把各孩子的 IR 片段拼接起来。
+    片段使用链表，拼接不需要复制指令。
+
+  与遍历方式的差异
+
+    标签：遍历方式按访问顺序分配标签 id。自底向上归约时，外层语句的标签
+      晚于内层分配，因此片段内的标签先用槽位占位，并按遍历顺序记录槽位。
+      函数归约完成后，依次为槽位分配 id 并回填。
+
+    break / continue：先生成目标待定的跳转，归约到外层循环时回填。
+
+    临时值：二元运算的左操作数要等到归约时才复制到临时值内，晚于右侧子树的临时值申请。
+      函数归约完成后，按出现的顺序重新编号。
+
+    作用域：块符号表在移进 '{' 与 '}' 时建立与销毁。函数信息在函数声明符
+      归约、且待进入 token 为 '{' 时登记，此时函数体尚未开始分析。
+
+    函数调用：被调用的函数名不是变量。归约 primary_expression 时，
+      若待进入 token 为 '('，则不查找变量。
+
+    对于不支持的写法，报错的内容与顺序可能与遍历方式不同。
+
+*/
+
+#pragma once
+
+#include <core/tcir/IrGenerator.h>
+#include <core/ParserActions.h>
+
+#include <deque>
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tc::tcir {
+
+    /**
+     * 语法制导的 TCIR 生成器。
+     *
+     * 用法：将 getActions() 交给 Parser::setActions，然后调用 Parser::parse。
+     * 分析成功后，结果与错误的获取方式与 IrGenerator 相同。
+     * 每次分析开始时会自动清空上一次的结果。
+     */
+    class SyntaxDirectedIrGenerator : public IrGenerator {
+    public:
+
+        SyntaxDirectedIrGenerator();
+
+        /**
+         * 生成 IR 的回调集合。
+         */
+        ParserActions& getActions() { return actions; }
+
+    protected:
+
+        using InstructionList = std::list< IrInstruction >;
+
+        /**
+         * 目标待定的跳转指令，以及对应的 break / continue 的 token 下标。
+         */
+        using PendingJump = std::pair< InstructionList::iterator, int >;
+
+        enum class SdtValueKind {
+
+            /** 表达式、语句或声明。持有一段 IR。 */
+            code,
+
+            /** 后面紧跟 '(' 的标识符，即被调用的函数名。 */
+            functionName,
+
+            /** 赋值运算符。记录左值。 */
+            assignmentOperator,
+
+            declarationSpecifiers,
+            declarator,
+            parameter,
+            parameterList,
+
+            /** 不支持的结构。用到时报错。 */
+            unsupported
+        };
+
+        enum class DeclaratorForm {
+            /** IDENTIFIER */
+            identifier,
+
+            /** direct_declarator '(' ... ')' */
+            function,
+
+            other
+        };
+
+        /**
+         * 非终结符的语义值。
+         */
+        struct SdtValue {
+
+            SdtValueKind kind = SdtValueKind::code;
+
+            /** 子树内第一个 token 的下标。用于报错。 */
+            int firstTokenIdx = -1;
+
+            /** 子树内是否报过错。 */
+            bool failed = false;
+
+            /** 生成的 IR。 */
+            InstructionList code;
+
+            /** 片段内的标签槽位，按遍历方式分配标签 id 的顺序排列。 */
+            std::vector< int > labelSlots;
+
+            std::vector< PendingJump > breakJumps;
+            std::vector< PendingJump > continueJumps;
+
+            /** 全局作用域内常量表达式的值。 */
+            std::string result;
+
+            /** 表达式：计算结果所在的操作数。 */
+            IrOperand operand = IrOperand::vreg(0);
+
+            /** 赋值运算符：左值符号。 */
+            SymbolBase* directSymbol = nullptr;
+
+            /** 声明说明符：是否受支持，以及类型（int 或 void）。 */
+            bool valid = true;
+            TokenKind typeKind = TokenKind::unknown;
+
+            /** 不支持的结构：报错位置与结构名称。 */
+            int unsupportedTokenIdx = -1;
+            std::string unsupportedName;
+
+            /** 声明符。 */
+            DeclaratorForm form = DeclaratorForm::other;
+            int nameTokenIdx = -1;
+            int pointerTokenIdx = -1;
+            bool ellipsis = false;
+
+            /** 是否为 declaration。for 循环的初始化部分不支持声明。 */
+            bool isDeclaration = false;
+
+            /**
+             * 组成部分。
+             * 函数声明符与参数列表：各参数。参数：声明说明符与声明符。
+             */
+            std::vector< SdtValue* > parts;
+        };
+
+    protected: /* 语义值管理。 */
+
+        SdtValue* newValue(SdtValueKind kind, int firstTokenIdx);
+        SdtValue* newCodeValue(ParserValue* values);
+        void releaseValue(SdtValue* value);
+
+        static bool isToken(ParserValue value) { return value & 1; }
+        static int tokenIdxOf(ParserValue value) { return int(value >> 1); }
+        static SdtValue* valueOf(ParserValue value) {
+            return isToken(value) ? nullptr : reinterpret_cast<SdtValue*>(value);
+        }
+
+        static ParserValue toParserValue(SdtValue* value) {
+            return reinterpret_cast<ParserValue>(value);
+        }
+
+        const Token& tokenOf(int tokenIdx) { return (*tokens)[tokenIdx]; }
+        int firstTokenIdxOf(ParserValue value);
+
+        /**
+         * 取表达式或语句的语义值。不是 code 类型时，换成一个空片段。
+         */
+        SdtValue* codeOf(ParserValue value);
+
+        /**
+         * 把 src 的 IR、标签槽位与待定跳转接到 dest 后面，然后回收 src。
+         */
+        void append(SdtValue* dest, SdtValue* src);
+
+        void emit(SdtValue* dest, const IrInstruction& ins);
+
+        /**
+         * 申请一个标签槽位，并记录到 dest 的槽位序列尾部。
+         */
+        int newLabelSlot(SdtValue* dest);
+
+        /**
+         * 生成以槽位占位的标签。
+         */
+        static IrOperand makeLabel(IrLabelKind kind, int slot);
+
+        /**
+         * 把表达式的结果复制到新的临时值内。已经是临时值时不复制。
+         */
+        void moveToTemporary(SdtValue* value);
+
+        /**
+         * 把表达式的结果放入 vreg 0。
+         */
+        void moveToVreg0(SdtValue* value);
+
+    protected: /* 报错。 */
+
+        void addError(int tokenIdx, const std::string& msg);
+        void addUnsupportedError(int tokenIdx, const std::string& symbolName);
+        void addUnsupportedTerminalError(int tokenIdx);
+
+        /**
+         * 检查声明说明符。不受支持时报错。
+         *
+         * @return 是否受支持。
+         */
+        bool checkSpecifiers(SdtValue* specifiers);
+
+        bool isInGlobalScope() { return currentFunction == nullptr; }
+
+    protected: /* 回调。 */
+
+        void registerActions();
+
+        void begin(const std::vector< Token >& tokens);
+        ParserValue shift(int tokenIdx);
+
+        void openBlockSymbolTable();
+        void closeBlockSymbolTable();
+
+        /**
+         * 函数声明符归约完毕，且其后是函数体。登记函数。
+         */
+        void beginFunction(SdtValue* specifiers, SdtValue* declarator);
+        ParserValue finishFunction(ParserValue* values, int count);
+
+        ParserValue reducePrimaryExpression(ParserValue* values, int count);
+        ParserValue reducePostfixIncDec(ParserValue* values, int count);
+        ParserValue reduceFunctionCall(ParserValue* values, int count);
+        ParserValue reduceArgument(ParserValue* values, int count);
+        ParserValue reduceUnaryExpression(ParserValue* values, int count);
+        ParserValue reduceMultiplicative(ParserValue* values, int count);
+        ParserValue reduceBinaryCompute(ParserValue* values, int count);
+        ParserValue reduceBitwise(ParserValue* values, int count);
+        ParserValue reduceLogical(ParserValue* values, int count);
+        ParserValue reduceConditional(ParserValue* values, int count);
+        ParserValue reduceAssignment(ParserValue* values, int count);
+        ParserValue reduceCommaExpression(ParserValue* values, int count);
+
+        ParserValue reduceIfStatement(ParserValue* values, int count);
+        ParserValue reduceWhileLoop(ParserValue* values, int count);
+        ParserValue reduceDoWhileLoop(ParserValue* values, int count);
+        ParserValue reduceForLoop(ParserValue* values, int count);
+        ParserValue reduceJumpStatement(ParserValue* values, int count);
+
+        ParserValue reduceDeclarationSpecifiers(ParserValue* values, int count);
+        ParserValue reduceDirectDeclarator(ParserValue* values, int count);
+        ParserValue reduceDeclarator(ParserValue* values, int count);
+        ParserValue reduceParameter(ParserValue* values, int count);
+        ParserValue reduceInitDeclarator(ParserValue* values, int count);
+        ParserValue reduceDeclaration(ParserValue* values, int count);
+
+        /**
+         * 回填循环体内的 break 与 continue。
+         */
+        void resolveJumps(
+            SdtValue* body, const IrOperand& breakTarget, const IrOperand& continueTarget
+        );
+
+    protected:
+
+        ParserActions actions;
+
+        const std::vector< Token >* tokens = nullptr;
+
+        /** 语义值池。deque 保证已分配的值地址不变。 */
+        std::deque< SdtValue > valuePool;
+        std::vector< SdtValue* > freeValues;
+
+        /** 当前函数内已申请的标签槽位数量。 */
+        int labelSlotCount = 0;
+
+        /**
+         * 已打开的花括号是否为代码块。
+         * 初始化列表、struct 与 enum 的花括号不是代码块。
+         */
+        std::vector< bool > braceIsBlock;
+
+        /** 刚移进一个代码块的 '{'，块符号表尚未建立。 */
+        bool blockOpenPending = false;
+
+        TokenKind prevTokenKind = TokenKind::unknown;
+
+        /** 已登记函数信息，等待函数体的 '{'。 */
+        bool functionHeaderReady = false;
+
+        /** 函数标签内记录的块符号表 id。 */
+        int functionLabelTabId = 0;
+
+        /**
+         * 当前函数的声明不受支持时，函数体使用这个不登记的函数符号，
+         * 生成的 IR 会被丢弃。
+         */
+        FunctionSymbol discardedFunction;
+
+    };
+
+}
@@ -90,3 +90,14 @@ const char* ValueTypeUtils::getName(const ValueType& type) {
 
     exit(0xabc);
 }
+
+bool ValueTypeUtils::findType(std::string_view name, ValueType& result) {
+    for (int idx = 0; idx <= int(ValueType::type_void); idx++) {
+        if (name == getName(ValueType(idx))) {
+            result = ValueType(idx);
+            return true;
+        }
+    }
+
+    return false;
+}
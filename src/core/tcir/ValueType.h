@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include <string_view>
+
 namespace tc::tcir {
 
     /**
@@ -34,5 +36,10 @@ namespace tc::tcir {
         static bool isSigned(const ValueType& type);
         static const char* getName(const ValueType& type);
 
+        /**
+         * 根据 getName 给出的名称查找类型。找不到时返回 false。
+         */
+        static bool findType(std::string_view name, ValueType& result);
+
     };
 }
@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+ * 内置分析表。
+ * 创建：2026.10.18
+ */
+
+#include <main/BuiltinParserTable.h>
+
+#ifdef TC_BUILTIN_PARSER_TABLE
+    #include <generated/BuiltinParserTableData.h>
+    #include <generated/BuiltinDirectParser.h>
+#endif
+
+const tc::LrParserTableImage* tcGetBuiltinParserTable() {
+#ifdef TC_BUILTIN_PARSER_TABLE
+    return &tc::builtintable::image;
+#else
+    return nullptr;
+#endif
+}
+
+tc::DirectParseFunction tcGetBuiltinDirectParser() {
+#ifdef TC_BUILTIN_PARSER_TABLE
+    return &tc::builtintable::directParse;
+#else
+    return nullptr;
+#endif
+}
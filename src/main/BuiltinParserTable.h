@@ -0,0 +1,26 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+ * 内置分析表。
+ * 创建：2026.10.18
+ */
+
+#pragma once
+
+#include <core/LrParserTable.h>
+#include <core/Parser.h>
+
+/**
+ * 获取编译进程序的默认文法（TC_CORE_CFG_PARSER_C_TCEY_PATH）分析表。
+ * 
+ * @return 构建时未生成内置表（TC_BUILTIN_PARSER_TABLE 为 OFF）时，返回 nullptr。
+ */
+const tc::LrParserTableImage* tcGetBuiltinParserTable();
+
+/**
+ * 获取针对内置分析表生成的直接编码分析器。
+ * 只能与 tcGetBuiltinParserTable 得到的表一起使用。
+ * 
+ * @return 构建时未生成内置表时，返回 nullptr。
+ */
+tc::DirectParseFunction tcGetBuiltinDirectParser();
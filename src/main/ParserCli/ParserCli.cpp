@@ -15,8 +15,11 @@
 #include <core/Lexer.h>
 #include <core/Parser.h>
 
+#include <main/BuiltinParserTable.h>
+
 #include <fstream>
 #include <iostream>
+#include <memory>
 
 #include <utils/ConsoleColorPad.h>
 
@@ -36,8 +39,8 @@ void ParserCli::printUsage(std::ostream &out) {
     out << "  fname:[x]      : specify input file 'x'." << endl;
     out << "  help           : get help." << endl;
     out << "  rebuild-table  : reload parser table from tcey file." << endl;
-    out << "                   if not set, parser would try to load cache" << endl;
-    out << "                   to improve performance." << endl;
+    out << "                   if not set, parser would use the built-in table" << endl;
+    out << "                   or try to load cache to improve performance." << endl;
     out << "  no-store-table : don't store built table to file." << endl;
     out << "  cache-table:[x]: specify cache table file." << endl;
     out << "  tcey:[x]       : set tcey file 'x'." << endl;
@@ -59,11 +62,11 @@ static void __tcDumpNodeName(const AstNode* node, ostream& out) {
     out << "\"";
 
     out << node << "\\n";
-    out << node->symbol.name;
+    out << node->symbol().name;
 
-    if (node->symbolType == grammar::SymbolType::TERMINAL) {
-        out << "\\n" << node->token.content;
-        out << "\\n(" << node->token.row << ", " << node->token.col << ")";
+    if (node->symbolType() == grammar::SymbolType::TERMINAL) {
+        out << "\\n" << node->token().content;
+        out << "\\n(" << node->token().row << ", " << node->token().col << ")";
     }
     
     out << "\"";
@@ -167,9 +170,19 @@ int ParserCli::run(
 
     // 首先尝试加载缓存。
 
-    LrParserTable table;
+    auto tablePtr = make_shared<LrParserTable>();
+    auto& table = *tablePtr;
     bool tableLoadedFromCache = false; // 是否成功从缓存加载。
 
+    // 默认文法优先使用编译进程序的分析表。
+    auto builtinTable = tcGetBuiltinParserTable();
+    bool useBuiltinTable = builtinTable != nullptr && !rebuildTable && !paramMap.count("tcey");
+
+    if (useBuiltinTable) {
+        table.load(*builtinTable);
+        tableLoadedFromCache = true;
+    }
+
     if (!rebuildTable && !tableLoadedFromCache) {
         ifstream fin(cacheTableFilePath, ios::binary);
         int loadResult;
@@ -190,6 +203,12 @@ int ParserCli::run(
         }
     }
 
+    // 懒构建产生的不完整表不能直接使用。
+    if (tableLoadedFromCache && table.partial) {
+        out << "[warn] cached table is partial. rebuilding." << endl;
+        tableLoadedFromCache = false;
+    }
+
     // 从语法定义文件加载 action goto 表。
     if (!tableLoadedFromCache) {
         YaccTcey yacc(tceyFilePath);
@@ -206,7 +225,7 @@ int ParserCli::run(
         lr1.buildParserTable(table); // 构建 action goto 表。
     }
 
-    if (!noStoreTable) {
+    if (!noStoreTable && !useBuiltinTable) {
         // 保存表到文件。
 
         ofstream fout(cacheTableFilePath, ios::binary);
@@ -220,7 +239,7 @@ int ParserCli::run(
 
     /* -------- 语法识别。 -------- */
 
-    Parser parser(table);
+    Parser parser(tablePtr);
 
     vector<ParserParseError> parserErrors;
     parser.parse(tokens, parserErrors);
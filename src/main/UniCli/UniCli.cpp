@@ -9,19 +9,36 @@
 */
 
 #include <iostream>
+#include <algorithm>
 #include <fstream>
 #include <map>
 #include <vector>
+#include <memory>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <iterator>
+#include <filesystem>
 
 #include <main/UniCli/UniCli.h>
 #include <utils/ConsoleColorPad.h>
+#include <utils/Fnv1a.h>
+#include <utils/MappedFile.h>
 
 #include <core/Lexer.h>
 #include <core/Parser.h>
+#include <core/AstExporter.h>
 #include <core/YaccTcey.h>
 #include <core/Lr1Grammar.h>
 #include <core/tcir/IrGenerator.h>
+#include <core/tcir/SyntaxDirectedIrGenerator.h>
+#include <core/tcir/IrBinaryModule.h>
+#include <core/tcir/IrSsa.h>
 #include <core/Intel386AssemblyGenerator.h>
+#include <core/FrontendPipeline.h>
+
+#include <main/BuiltinParserTable.h>
 
 using namespace std;
 using namespace tc;
@@ -31,11 +48,11 @@ static void __tcDumpAstNodeName(const AstNode* node, ostream& out) {
     out << "\"";
 
     out << node << "\\n";
-    out << node->symbol.name;
+    out << node->symbol().name;
 
-    if (node->symbolType == grammar::SymbolType::TERMINAL) {
-        out << "\\n" << node->token.content;
-        out << "\\n(" << node->token.row << ", " << node->token.col << ")";
+    if (node->symbolType() == grammar::SymbolType::TERMINAL) {
+        out << "\\n" << node->token().content;
+        out << "\\n(" << node->token().row << ", " << node->token().col << ")";
     }
     
     out << "\"";
@@ -62,6 +79,56 @@ static void __tcDumpAstToDot(const AstNode* root, ostream& out) {
     out << "}" << endl;
 }
 
+static string __tcGetTceyFilePath(map<string, string>& paramMap) {
+    if (paramMap.count("tcey")) {
+        return paramMap["tcey"];
+    } else {
+        return TC_CORE_CFG_PARSER_C_TCEY_PATH;
+    }
+}
+
+static string __tcGetCacheTableFilePath(map<string, string>& paramMap) {
+    if (paramMap.count("cache-table")) {
+        return paramMap["cache-table"];
+    } else {
+        return __tcGetTceyFilePath(paramMap) + ".tcpt";
+    }
+}
+
+static string __tcGetAstCacheDirPath(map<string, string>& paramMap) {
+    if (paramMap.count("ast-cache")) {
+        return paramMap["ast-cache"];
+    } else {
+        return "ast-cache";
+    }
+}
+
+static string __tcGetAstCacheFilePath(const string& dirPath, uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.tcast", (unsigned long long) key);
+    return dirPath + "/" + name;
+}
+
+/**
+ * 语法树缓存的键。源码、分析表、词法自动机，或者影响语法树形状的参数
+ * 有任何不同，键就不同。
+ */
+static uint64_t __tcGetAstCacheKey(
+    const string& source, 
+    const LrParserTable& table, 
+    set<string>& paramSet
+) {
+    ifstream dfaIn(TC_CORE_CFG_LEXER_DFA_TCDF_PATH, ios::binary);
+    string dfa((istreambuf_iterator<char>(dfaIn)), istreambuf_iterator<char>());
+
+    return Fnv1a()
+        .update(source)
+        .update(table.fingerprint())
+        .update(dfa)
+        .update(paramSet.count("collapse-unit") > 0)
+        .digest();
+}
+
 void UniCli::printUsage(std::ostream& out) {
 
     setOutputColor(0x2f, 0x90, 0xb9);
@@ -80,16 +147,51 @@ void UniCli::printUsage(std::ostream& out) {
     out << "  dump-tokens    : dump tokens." << endl;
     out << endl;
     out << "  rebuild-table  : reload parser table from tcey file." << endl;
-    out << "                   if not set, parser would try to load cache" << endl;
-    out << "                   to improve performance." << endl;
+    out << "                   if not set, parser would use the built-in table" << endl;
+    out << "                   or try to load cache to improve performance." << endl;
     out << "  no-store-table : don't store built table to file." << endl;
+    out << "  lazy-table     : build parser table rows on demand." << endl;
+    out << "                   built rows are kept in cache table." << endl;
     out << "  cache-table:[x]: specify cache table file." << endl;
+    out << "  direct-parser  : use the direct-coded parser generated for" << endl;
+    out << "                   the built-in table." << endl;
+    out << "  collapse-unit  : don't build ast nodes for unit productions" << endl;
+    out << "                   the ir generator doesn't depend on." << endl;
+    out << "  parallel-parse : parse external declarations on multiple threads." << endl;
+    out << "  parallel-parse:[n]" << endl;
+    out << "                 : same as above, using 'n' threads." << endl;
     out << "  tcey:[x]       : set tcey file 'x'." << endl;
     out << "  dump-ast       : dump parser result." << endl;
     out << "  dot-file:[x]   : store parser result to file 'x'." << endl;
+    out << "  ast-jsonl:[x]  : export ast to file 'x' as json lines." << endl;
+    out << "  ast-bin:[x]    : export ast to file 'x' in compact binary format." << endl;
+    out << endl;
+    out << "  ast-cache      : cache tokens and ast in directory 'ast-cache'." << endl;
+    out << "                   on a hit, lexer and parser are skipped." << endl;
+    out << "  ast-cache:[x]  : same as above, using directory 'x'." << endl;
+    out << endl;
+    out << "  pipeline       : run lexer, parser and ir generator" << endl;
+    out << "                   concurrently." << endl;
+    out << endl;
+    out << "  one-pass       : generate ir during parsing, without building ast." << endl;
+    out << "                   pipeline and ast-cache are ignored." << endl;
+    out << endl;
+    out << "  profile        : count lexer dfa states and parser shifts," << endl;
+    out << "                   reductions and goto lookups. dump top 10." << endl;
+    out << "  profile:[n]    : same as above, dumping top 'n'." << endl;
     out << endl;
     out << "  dump-ir        : dump toycompile ir code." << endl;
     out << "  ir-to-file:[x] : store ir code to file." << endl;
+    out << "  ir-binary      : store ir code in binary format." << endl;
+    out << "                   works with dump-ir and ir-to-file." << endl;
+    out << "  ir-from-file:[x]" << endl;
+    out << "                 : load ir code (text or binary) from file 'x' and" << endl;
+    out << "                   generate asm directly. front-end is skipped." << endl;
+    out << "  ssa            : run constant propagation and dead store" << endl;
+    out << "                   elimination on ssa form before generating asm." << endl;
+    out << "  dump-ssa       : dump optimized ssa form of each function." << endl;
+    out << "  no-regalloc    : keep all variables on stack instead of" << endl;
+    out << "                   allocating registers." << endl;
     out << "  disable-color  : disable color to log output stream." << endl;
     out << endl;
     out << "  -o-std         : put asm to stdout." << endl;
@@ -99,7 +201,7 @@ void UniCli::printUsage(std::ostream& out) {
     out << endl;
     out << "must have:" << endl;
     setOutputColor();
-    out << "  fname:[x]" << endl;
+    out << "  fname:[x]      (or ir-from-file:[x])" << endl;
 
     setOutputColor(0xfb, 0x99, 0x68);
     out << endl;
@@ -170,6 +272,18 @@ int UniCli::lexicalAnalysis(
         return -2;
     }
 
+    return this->analyzeTokens(srcIn, paramSet, logOutput, tokenContainer);
+}
+
+int UniCli::analyzeTokens(
+    istream& srcIn,
+    set<string>& paramSet,
+    ostream& logOutput,
+    vector<Token>& tokenContainer
+) {
+
+    auto& out = logOutput;
+
     Lexer lexer;
 
     vector<LexerAnalyzeError> lexerErrors;
@@ -183,22 +297,21 @@ int UniCli::lexicalAnalysis(
         return -4;
     }
 
+    DfaProfile dfaProfile;
+    if (profileTopN) {
+        lexer.setProfile(&dfaProfile);
+    }
+
     lexer.analyze(srcIn, tokenContainer, lexerErrors); // 词法分析。
-    if (!lexerErrors.empty()) {
-        for (auto& err : lexerErrors) {
-            setOutputColor(0xee, 0x3f, 0x4d);
-            out << "lexer error: ";
-            setOutputColor();
-            out << "(" << err.row
-                << ", " << err.col << ") "
-                << err.msg << ". token: "
-                << err.token.content << "." << endl;
-        }
 
-        return -5;
+    if (profileTopN) {
+        dfaProfile.report(out, profileTopN);
     }
 
-    srcIn.close();
+    if (!lexerErrors.empty()) {
+        this->printLexerErrors(lexerErrors, out);
+        return -5;
+    }
 
     if (paramSet.count("dump-tokens")) {
         this->dumpTokens(tokenContainer, out);
@@ -216,37 +329,187 @@ int UniCli::syntaxAnalysis(
     Parser& parser
 ) {
 
-    bool rebuildTable = paramSet.count("rebuild-table");
-    bool noStoreTable = paramSet.count("no-store-table");
+    /* -------- 准备语法识别器。 -------- */
 
-    auto& out = logOutput;
+    unique_ptr<lr1grammar::Lr1Grammar> lazyGrammar;
+    int resCode = this->prepareParser(paramMap, paramSet, logOutput, parser, lazyGrammar);
+    if (resCode) {
+        return resCode;
+    }
 
-    /* -------- 准备语法识别器。 -------- */
+    /* -------- 语法识别。 -------- */
 
-    // 尝试加载语法分析缓存。 
-    
-    string tceyFilePath;
-    if (paramMap.count("tcey")) {
-        tceyFilePath = paramMap["tcey"];
-    } else {
-        tceyFilePath = TC_CORE_CFG_PARSER_C_TCEY_PATH;
+    vector<ParserParseError> parserErrors;
+
+    ParserProfile parserProfile;
+    if (profileTopN) {
+        parser.setProfile(&parserProfile);
     }
 
-    string cacheTableFilePath;
-    if (paramMap.count("cache-table")) {
-        cacheTableFilePath = paramMap["cache-table"];
+    this->runParser(paramMap, paramSet, tokens, parser, parserErrors);
+
+    if (profileTopN) {
+        parser.setProfile(nullptr);
+        parserProfile.report(logOutput, *parser.getParserTable(), profileTopN);
+    }
+
+    if (lazyGrammar) {
+        this->storeLazyTable(paramMap, paramSet, logOutput, parser, *lazyGrammar);
+    }
+
+    return this->finishSyntaxAnalysis(paramMap, paramSet, logOutput, parserErrors, parser);
+}
+
+void UniCli::runParser(
+    map<string, string>& paramMap,
+    set<string>& paramSet,
+    vector<Token>& tokens,
+    Parser& parser,
+    vector<ParserParseError>& parserErrors
+) {
+
+    if (paramSet.count("parallel-parse") || paramMap.count("parallel-parse")) {
+        // 按外部声明切分，多线程分析。未指定线程数时使用硬件并发数。
+        int threadCount = paramMap.count("parallel-parse") 
+            ? atoi(paramMap["parallel-parse"].c_str()) : 0;
+        
+        parser.parseParallel(tokens, parserErrors, threadCount);
     } else {
-        cacheTableFilePath = tceyFilePath;
-        cacheTableFilePath += ".tcpt";
+        parser.parse(tokens, parserErrors);
     }
+}
+
+int UniCli::cachedAnalysis(
+    map<string, string>& paramMap,
+    set<string>& paramSet,
+    vector<string>& additionalValues,
+    ostream& logOutput,
+    vector<Token>& tokens,
+    Parser& parser
+) {
+
+    auto& out = logOutput;
+
+    // 懒构建的表不完整，无法得到可靠的指纹。
+    if (paramSet.count("lazy-table") || !paramMap.count("fname")) {
+        if (paramSet.count("lazy-table")) {
+            out << "[warn] ast cache is not available with lazy table." << endl;
+        }
+
+        int resCode = this->lexicalAnalysis(
+            paramMap, paramSet, additionalValues, logOutput, tokens
+        );
+
+        if (resCode) {
+            return resCode;
+        }
+
+        return this->syntaxAnalysis(
+            paramMap, paramSet, additionalValues, logOutput, tokens, parser
+        );
+    }
+
+    // 一次读入整个源文件。计算键与未命中时的词法分析都使用这份内容。
+    ifstream srcIn(paramMap["fname"], ios::binary);
+    if (!srcIn.is_open()) {
+        setOutputColor(0xee, 0x3f, 0x4d);
+        out << "[Error] ";
+        setOutputColor();
+        out << "UniCli: failed to open source file." << endl;
+        return -2;
+    }
+
+    string source((istreambuf_iterator<char>(srcIn)), istreambuf_iterator<char>());
+    srcIn.close();
+
+    unique_ptr<lr1grammar::Lr1Grammar> lazyGrammar;
+    int resCode = this->prepareParser(paramMap, paramSet, logOutput, parser, lazyGrammar);
+    if (resCode) {
+        return resCode;
+    }
+
+    uint64_t key = __tcGetAstCacheKey(source, *parser.getParserTable(), paramSet);
+    string cacheDirPath = __tcGetAstCacheDirPath(paramMap);
+    string cacheFilePath = __tcGetAstCacheFilePath(cacheDirPath, key);
+
+    vector<ParserParseError> parserErrors;
+
+    ifstream cacheIn(cacheFilePath, ios::binary | ios::ate);
+    if (cacheIn.is_open()) {
+        string data(size_t(cacheIn.tellg()), '\0');
+        cacheIn.seekg(0);
+        cacheIn.read(data.data(), data.size());
+
+        if (cacheIn && parser.loadAst(data.data(), data.size(), key, tokens) == 0) {
+            
+            if (paramSet.count("dump-tokens")) {
+                this->dumpTokens(tokens, out);
+            }
+
+            return this->finishSyntaxAnalysis(paramMap, paramSet, logOutput, parserErrors, parser);
+        }
+    }
+
+    // 未命中。正常分析，成功后写入缓存。
+
+    istringstream sourceIn(source);
+    resCode = this->analyzeTokens(sourceIn, paramSet, logOutput, tokens);
+    if (resCode) {
+        return resCode;
+    }
+
+    this->runParser(paramMap, paramSet, tokens, parser, parserErrors);
+
+    if (parserErrors.empty()) {
+        error_code ec;
+        filesystem::create_directories(cacheDirPath, ec);
+
+        ofstream cacheOut(cacheFilePath, ios::binary);
+        if (!cacheOut.is_open() || parser.dumpAst(cacheOut, key, tokens) != 0) {
+            out << "[warn] failed to store ast cache." << endl;
+        }
+    }
+
+    return this->finishSyntaxAnalysis(paramMap, paramSet, logOutput, parserErrors, parser);
+}
+
+int UniCli::prepareParser(
+    map<string, string>& paramMap,
+    set<string>& paramSet,
+    ostream& logOutput,
+    Parser& parser,
+    unique_ptr<lr1grammar::Lr1Grammar>& lazyGrammar
+) {
+
+    bool rebuildTable = paramSet.count("rebuild-table");
+    bool noStoreTable = paramSet.count("no-store-table");
+    bool lazyTable = paramSet.count("lazy-table");
+
+    auto& out = logOutput;
+
+    // 尝试加载语法分析缓存。 
+    
+    string tceyFilePath = __tcGetTceyFilePath(paramMap);
+    string cacheTableFilePath = __tcGetCacheTableFilePath(paramMap);
 
     // 准备 action goto 表。
 
     // 首先尝试加载缓存。
 
-    LrParserTable table;
+    auto tablePtr = make_shared<LrParserTable>();
+    auto& table = *tablePtr;
     bool tableLoadedFromCache = false; // 是否成功从缓存加载。
 
+    // 默认文法优先使用编译进程序的分析表。不访问文件系统。
+    auto builtinTable = tcGetBuiltinParserTable();
+    bool useBuiltinTable = builtinTable != nullptr 
+        && !rebuildTable && !lazyTable && !paramMap.count("tcey");
+
+    if (useBuiltinTable) {
+        table.load(*builtinTable);
+        tableLoadedFromCache = true;
+    }
+
     if (!rebuildTable && !tableLoadedFromCache) {
         ifstream fin(cacheTableFilePath, ios::binary);
         int loadResult;
@@ -267,8 +530,14 @@ int UniCli::syntaxAnalysis(
         }
     }
 
+    // 懒构建产生的不完整表不能直接使用。
+    bool partialTableLoaded = tableLoadedFromCache && table.partial;
+    if (partialTableLoaded && !lazyTable) {
+        out << "[warn] cached table is partial. rebuilding." << endl;
+    }
+
     // 从语法定义文件加载 action goto 表。
-    if (!tableLoadedFromCache) {
+    if (!tableLoadedFromCache || partialTableLoaded) {
         YaccTcey yacc(tceyFilePath);
         if (yacc.errcode != YaccTceyError::TCEY_OK) {
             out << "[error] ";
@@ -278,12 +547,23 @@ int UniCli::syntaxAnalysis(
 
         auto& grammar = yacc.grammar;
 
-        lr1grammar::Lr1Grammar lr1(grammar);
+        if (lazyTable) {
+
+            // 懒构建模式下，文法需要在分析期间一直存在。
+            lazyGrammar = make_unique<lr1grammar::Lr1Grammar>(
+                grammar, lr1grammar::Lr1BuildMode::LAZY, 
+                partialTableLoaded ? &table : nullptr
+            );
+
+        } else {
+
+            lr1grammar::Lr1Grammar lr1(grammar);
 
-        lr1.buildParserTable(table); // 构建 action goto 表。
+            lr1.buildParserTable(table); // 构建 action goto 表。
+        }
     }
 
-    if (!noStoreTable) {
+    if (!noStoreTable && !lazyGrammar && !useBuiltinTable) {
         // 保存表到文件。
 
         ofstream fout(cacheTableFilePath, ios::binary);
@@ -295,12 +575,69 @@ int UniCli::syntaxAnalysis(
         }
     }
 
-    /* -------- 语法识别。 -------- */
+    if (lazyGrammar) {
+        parser.loadLazyGrammar(lazyGrammar.get());
+    } else {
+        parser.loadParserTable(tablePtr);
+    }
 
-    parser.loadParserTable(table);
+    if (paramSet.count("direct-parser")) {
+        // 直接编码的分析器是针对内置表生成的。
+        if (useBuiltinTable) {
+            parser.setDirectParser(tcGetBuiltinDirectParser());
+        } else {
+            out << "[warn] direct parser requires the built-in table. using table-driven parser." << endl;
+        }
+    }
 
-    vector<ParserParseError> parserErrors;
-    parser.parse(tokens, parserErrors);
+    if (paramSet.count("collapse-unit")) {
+        // 只保留 IR 生成器依赖结构的节点。
+        parser.setUnitReductionCollapse(true, tcir::IrGenerator::getUnitReductionKeepList());
+    }
+
+    return 0;
+}
+
+void UniCli::storeLazyTable(
+    map<string, string>& paramMap,
+    set<string>& paramSet,
+    ostream& logOutput,
+    Parser& parser,
+    lr1grammar::Lr1Grammar& lazyGrammar
+) {
+
+    auto& out = logOutput;
+
+    // 懒构建的文法不再使用，从 parser 中撤下。
+    parser.loadLazyGrammar(nullptr);
+
+    if (paramSet.count("no-store-table")) {
+        return;
+    }
+
+    // 保存已经构建的行，供下次继续构建。
+
+    LrParserTable table;
+    lazyGrammar.exportLazyTable(table);
+
+    ofstream fout(__tcGetCacheTableFilePath(paramMap), ios::binary);
+    if (fout.is_open()) {
+        table.dump(fout);
+        
+    } else {
+        out << "[warn] failed to store parser table." << endl;
+    }
+}
+
+int UniCli::finishSyntaxAnalysis(
+    map<string, string>& paramMap,
+    set<string>& paramSet,
+    ostream& logOutput,
+    vector<ParserParseError>& parserErrors,
+    Parser& parser
+) {
+
+    auto& out = logOutput;
 
     if (!parserErrors.empty()) {
         for (auto& err : parserErrors) {
@@ -328,8 +665,11 @@ int UniCli::syntaxAnalysis(
 
     AstNode* astRoot = parser.getAstRoot();
 
-    // 输出结果。按照 graphviz dot 格式输出。
-    if (paramSet.count("dump-ast")) {
+    // 语法制导翻译时不建立语法树。
+    if (paramSet.count("dump-ast") && astRoot == nullptr) {
+        out << "[warn] no ast to dump in one-pass mode." << endl;
+    
+    } else if (paramSet.count("dump-ast")) { // 输出结果。按照 graphviz dot 格式输出。
         bool storeResToFile = paramMap.count("dot-file");
         bool dumpedToFile = false;
 
@@ -346,6 +686,28 @@ int UniCli::syntaxAnalysis(
         }
     }
 
+    // 供外部工具读取的导出。格式见 tc/core/AstExporter.h
+    pair<const char*, AstExportFormat> exportOptions[] = {
+        { "ast-jsonl", AstExportFormat::jsonLines },
+        { "ast-bin", AstExportFormat::binary }
+    };
+
+    for (auto& option : exportOptions) {
+        if (!paramMap.count(option.first)) {
+            continue;
+        }
+
+        if (astRoot == nullptr) {
+            out << "[warn] no ast to export in one-pass mode." << endl;
+            continue;
+        }
+
+        ofstream fout(paramMap[option.first], ios::binary);
+        if (!fout.is_open() || exportAst(fout, astRoot, option.second) != 0) {
+            out << "[warn] failed to export ast to: " << paramMap[option.first] << endl;
+        }
+    }
+
     return 0;
 }
 
@@ -364,6 +726,19 @@ int UniCli::generateTcIr(
     // 输入语法树，内部产生中间代码（及错误分析）。
     irGen.process(astRoot); 
 
+    return this->finishTcIr(paramMap, paramSet, logOutput, irGen);
+}
+
+int UniCli::finishTcIr(
+    map<string, string>& paramMap,
+    set<string>& paramSet,
+    ostream& logOutput,
+    tcir::IrGenerator& irGenerator
+) {
+
+    auto& irGen = irGenerator;
+    auto& out = logOutput;
+
     auto& irErrors = irGen.getErrorList();
     auto& irWarnings = irGen.getWarningList();
 
@@ -372,20 +747,27 @@ int UniCli::generateTcIr(
      */
     auto printErrTokenDetail = [this, &out] (tcir::IrGeneratorError& err) {
 
-        AstNode* tk = err.astNode;
-        while (tk->symbolType != grammar::SymbolType::TERMINAL) {
-            tk = tk->children[0];
+        // 语法制导生成时没有语法树，直接记录 token。
+        const Token* token = &err.token;
+
+        if (err.astNode) {
+            AstNode* tk = err.astNode;
+            while (tk->symbolType() != grammar::SymbolType::TERMINAL) {
+                tk = tk->children[0];
+            }
+
+            token = &tk->token();
         }
 
         this->setOutputColor(0xbc, 0x84, 0xa8);
         out << "  token: ";
         this->setOutputColor();
-        out << tk->token.content << endl;
+        out << token->content << endl;
 
         this->setOutputColor(0x80, 0x6d, 0x9e);
         out << "  loc  : ";
         this->setOutputColor();
-        out << "(" << tk->token.row << ", " << tk->token.col << ")" << endl;
+        out << "(" << token->row << ", " << token->col << ")" << endl;
         this->setOutputColor();
     };
 
@@ -425,7 +807,12 @@ int UniCli::generateTcIr(
                 return -9;
             }
 
-            irGen.dump(fout, false);
+            if (paramSet.count("ir-binary")) {
+                irGen.dumpBinary(fout);
+            } else {
+                irGen.dump(fout, false);
+            }
+
             fout.close();
 
         } else {
@@ -436,9 +823,100 @@ int UniCli::generateTcIr(
 
     }
 
+    /* 输出 SSA 形式。只用于观察，不影响交给后端的 IR。 */
+    if (paramSet.count("dump-ssa")) {
+        auto module = irGen.getModule();
+        vector<tcir::IrInstruction> instructions = *module.instructions;
+        tcir::IrSsaUtils::optimize(instructions, *module.names, &out);
+    }
+
     return 0;
 }
 
+int UniCli::pipelinedAnalysis(
+    map<string, string>& paramMap,
+    set<string>& paramSet,
+    vector<string>& additionalValues,
+    ostream& logOutput,
+    vector<Token>& tokens,
+    Parser& parser,
+    tcir::IrGenerator& irGenerator
+) {
+
+    auto& out = logOutput;
+
+    if (!paramMap.count("fname")) {
+
+        setOutputColor(0xee, 0x3f, 0x4d);
+        out << "[Error]";
+        setOutputColor();
+        out << " fname required." << endl;
+        this->printUsage(out);
+        return -1;
+    }
+
+    ifstream srcIn(paramMap["fname"], ios::binary); // 打开源文件。
+    if (!srcIn.is_open()) {
+        setOutputColor(0xee, 0x3f, 0x4d);
+        out << "[Error] ";
+        setOutputColor();
+        out << "UniCli: failed to open source file." << endl;
+        return -2;
+    }
+
+    Lexer lexer;
+
+    if (!lexer.dfaIsReady()) {
+        
+        setOutputColor(0xee, 0x3f, 0x4d);
+        out << "[Error] ";
+        out << "UniCli: failed to init lexer dfa." << endl;
+        setOutputColor();
+        return -4;
+    }
+
+    unique_ptr<lr1grammar::Lr1Grammar> lazyGrammar;
+    int resCode = this->prepareParser(paramMap, paramSet, logOutput, parser, lazyGrammar);
+    if (resCode) {
+        return resCode;
+    }
+
+    /* -------- 词法、语法、IR 并行处理。 -------- */
+
+    vector<LexerAnalyzeError> lexerErrors;
+    vector<ParserParseError> parserErrors;
+
+    FrontendPipeline pipeline(lexer, parser, irGenerator);
+    pipeline.run(srcIn, tokens, lexerErrors, parserErrors);
+
+    srcIn.close();
+
+    if (lazyGrammar) {
+        this->storeLazyTable(paramMap, paramSet, logOutput, parser, *lazyGrammar);
+    }
+
+    // 按照顺序执行时的规则报告结果：词法错误优先。
+
+    if (!lexerErrors.empty()) {
+        this->printLexerErrors(lexerErrors, out);
+        return -5;
+    }
+
+    if (paramSet.count("dump-tokens")) {
+        this->dumpTokens(tokens, out);
+    }
+
+    resCode = this->finishSyntaxAnalysis(
+        paramMap, paramSet, logOutput, parserErrors, parser
+    );
+
+    if (resCode) {
+        return resCode;
+    }
+
+    return this->finishTcIr(paramMap, paramSet, logOutput, irGenerator);
+}
+
 int UniCli::run(
     map<string, string>& paramMap,
     set<string>& paramSet,
@@ -453,51 +931,162 @@ int UniCli::run(
         this->enableOutputColor = false;
     }
 
+    if (paramMap.count("profile")) { // 热点统计。
+        this->profileTopN = max(1, atoi(paramMap["profile"].c_str()));
+    } else if (paramSet.count("profile")) {
+        this->profileTopN = 10;
+    }
+
     
     if (paramSet.count("help")) { // 打印程序使用说明。
         this->printUsage(out);
         return 0;
     }
 
-    /* -------- 词法识别。 -------- */
-
-    
     vector<Token> tokens;
-    int resCode = lexicalAnalysis(
-        paramMap, paramSet, additionalValues, out, tokens
-    );
+    Parser parser;
+    int resCode;
 
-    if (resCode) {
-        return resCode;
-    }
-    
+    // 一遍生成：IR 在语法分析的归约回调中生成，不建立语法树。
+    bool onePass = paramSet.count("one-pass");
+    tcir::IrGenerator treeIrGen;
+    tcir::SyntaxDirectedIrGenerator syntaxDirectedIrGen;
+    tcir::IrGenerator& irGen = onePass ? syntaxDirectedIrGen : treeIrGen;
 
-    /* -------- 语法识别。 -------- */
+    // 从文件读入 IR：映射文件后直接交给后端，跳过前端。
+    // 以 TCIB 开头的是二进制 IR，否则按文本 TCIR 读取。
+    bool fromIrFile = paramMap.count("ir-from-file");
+    bool binaryIrInput = false;
+    MappedFile irFile;
+    tcir::IrBinaryModule binaryIr;
 
-    Parser parser;
-    resCode = syntaxAnalysis(
-        paramMap, paramSet, additionalValues, out, tokens, parser
-    );
+    if (fromIrFile) {
 
-    if (resCode) {
-        return resCode;
-    }
+        if (!irFile.open(paramMap["ir-from-file"])) {
+            setOutputColor(0xee, 0x3f, 0x4d);
+            out << "[Error] ";
+            setOutputColor();
+            out << "failed to open ir input file." << endl;
+            return -10;
+        }
 
-    /* -------- 语义分析。 -------- */
+        binaryIrInput = irFile.getSize() >= 4 && memcmp(irFile.getData(), "TCIB", 4) == 0;
 
-    tcir::IrGenerator irGen;
-    resCode = generateTcIr(
-        paramMap, paramSet, additionalValues, out, parser.getAstRoot(), irGen
-    );
+        resCode = binaryIrInput ? binaryIr.bind(irFile.getData(), irFile.getSize()) : 0;
+
+        if (resCode) {
+            setOutputColor(0xee, 0x3f, 0x4d);
+            out << "[Error] ";
+            setOutputColor();
+            out << "bad binary ir file. code: " << resCode << endl;
+            return -10;
+        }
+
+    } else if (onePass) {
+
+        if (paramSet.count("pipeline") || paramSet.count("ast-cache") || paramMap.count("ast-cache")) {
+            out << "[warn] pipeline and ast-cache are ignored in one-pass mode." << endl;
+        }
+
+        /* -------- 词法识别。 -------- */
+
+        resCode = lexicalAnalysis(
+            paramMap, paramSet, additionalValues, out, tokens
+        );
+
+        if (resCode) {
+            return resCode;
+        }
+
+        /* -------- 语法识别，同时生成中间代码。 -------- */
+
+        parser.setActions(&syntaxDirectedIrGen.getActions());
+
+        resCode = syntaxAnalysis(
+            paramMap, paramSet, additionalValues, out, tokens, parser
+        );
+
+        if (resCode) {
+            return resCode;
+        }
+
+        resCode = finishTcIr(paramMap, paramSet, out, irGen);
+
+        if (resCode) {
+            return resCode;
+        }
+
+    } else if (paramSet.count("pipeline")) {
+
+        if (profileTopN) {
+            out << "[warn] profile is ignored in pipeline mode." << endl;
+        }
+
+        /* -------- 词法识别、语法识别、语义分析并行进行。 -------- */
+
+        resCode = pipelinedAnalysis(
+            paramMap, paramSet, additionalValues, out, tokens, parser, irGen
+        );
+
+        if (resCode) {
+            return resCode;
+        }
+
+    } else {
+
+        if (paramSet.count("ast-cache") || paramMap.count("ast-cache")) {
+
+            /* -------- 词法识别、语法识别。命中缓存时跳过。 -------- */
+
+            resCode = cachedAnalysis(
+                paramMap, paramSet, additionalValues, out, tokens, parser
+            );
+
+            if (resCode) {
+                return resCode;
+            }
+
+        } else {
+
+            /* -------- 词法识别。 -------- */
+
+            resCode = lexicalAnalysis(
+                paramMap, paramSet, additionalValues, out, tokens
+            );
+
+            if (resCode) {
+                return resCode;
+            }
+            
+
+            /* -------- 语法识别。 -------- */
+
+            resCode = syntaxAnalysis(
+                paramMap, paramSet, additionalValues, out, tokens, parser
+            );
+
+            if (resCode) {
+                return resCode;
+            }
+        }
+
+        /* -------- 语义分析。 -------- */
+
+        resCode = generateTcIr(
+            paramMap, paramSet, additionalValues, out, parser.getAstRoot(), irGen
+        );
+
+        if (resCode) {
+            return resCode;
+        }
 
-    if (resCode) {
-        return resCode;
     }
 
     /* -------- 生成 i386 汇编。 -------- */
-    stringstream tcirStream;
+    // IR 直接交给后端，不经过文本。
     i386::Intel386AssemblyGenerator i386asmGen;
-    irGen.dump(tcirStream, false);
+    i386asmGen.setSsaEnabled(paramSet.count("ssa"));
+    i386asmGen.setRegisterAllocationEnabled(!paramSet.count("no-regalloc"));
 
     ostream* asmOut = nullptr;
     bool asmOutIsFile = false;
@@ -513,7 +1102,13 @@ int UniCli::run(
     }
 
     if (asmOut) {
-        i386asmGen.generate(tcirStream, *asmOut, cerr);
+        if (binaryIrInput) {
+            i386asmGen.generate(binaryIr, *asmOut, cerr);
+        } else if (fromIrFile) {
+            i386asmGen.generate(irFile.getData(), irFile.getSize(), *asmOut, cerr);
+        } else {
+            i386asmGen.generate(irGen.getModule(), *asmOut, cerr);
+        }
     }
 
     if (asmOutIsFile) {
@@ -525,6 +1120,21 @@ int UniCli::run(
 
 }
 
+void UniCli::printLexerErrors(
+    vector<LexerAnalyzeError>& lexerErrors, 
+    ostream& out
+) {
+    for (auto& err : lexerErrors) {
+        setOutputColor(0xee, 0x3f, 0x4d);
+        out << "lexer error: ";
+        setOutputColor();
+        out << "(" << err.row
+            << ", " << err.col << ") "
+            << err.msg << ". token: "
+            << err.token.content << "." << endl;
+    }
+}
+
 void UniCli::setOutputColor(int red, int green, int blue) {
     if (enableOutputColor) {
         ConsoleColorPad::setColor(red, green, blue);
@@ -14,9 +14,12 @@
 #include <main/TcSubProgram.h>
 
 #include <vector>
+#include <memory>
 
 #include <core/Token.h>
 #include <core/Parser.h>
+#include <core/Lexer.h>
+#include <core/Lr1Grammar.h>
 #include <core/tcir/IrGenerator.h>
 
 /**
@@ -53,6 +56,21 @@ public:
         tc::Parser& parser
     );
 
+    /**
+     * 带缓存的词法分析与语法分析。结果与依次调用 lexicalAnalysis、syntaxAnalysis 相同。
+     * 
+     * 缓存以源码、分析表、词法自动机与影响语法树形状的参数的哈希为键。
+     * 命中时直接加载 token 列表与语法树，不再进行词法分析和语法分析。
+     */
+    int cachedAnalysis(
+        std::map<std::string, std::string>& paramMap,
+        std::set<std::string>& paramSet,
+        std::vector<std::string>& additionalValues,
+        std::ostream& logOutput,
+        std::vector<tc::Token>& tokens,
+        tc::Parser& parser
+    );
+
     int generateTcIr(
         std::map<std::string, std::string>& paramMap,
         std::set<std::string>& paramSet,
@@ -62,6 +80,20 @@ public:
         tc::tcir::IrGenerator& irGenerator
     );
 
+    /**
+     * 流水线模式：词法分析、语法分析、IR 生成并行进行。
+     * 结果与依次调用 lexicalAnalysis、syntaxAnalysis、generateTcIr 相同。
+     */
+    int pipelinedAnalysis(
+        std::map<std::string, std::string>& paramMap,
+        std::set<std::string>& paramSet,
+        std::vector<std::string>& additionalValues,
+        std::ostream& logOutput,
+        std::vector<tc::Token>& tokens,
+        tc::Parser& parser,
+        tc::tcir::IrGenerator& irGenerator
+    );
+
     int run(
         std::map<std::string, std::string>& paramMap,
         std::set<std::string>& paramSet,
@@ -74,10 +106,84 @@ public:
 protected:
     /** 是否启用控制台颜色输出。 */
     bool enableOutputColor = true;
+
+    /** 热点统计输出的项数。为 0 表示不统计。 */
+    int profileTopN = 0;
     
     void setOutputColor(int red, int green, int blue);
     void setOutputColor();
 
+    void printLexerErrors(
+        std::vector<tc::LexerAnalyzeError>& lexerErrors, 
+        std::ostream& out
+    );
+
+    /**
+     * 对已打开的源码进行词法分析，按需输出 token。
+     */
+    int analyzeTokens(
+        std::istream& srcIn,
+        std::set<std::string>& paramSet,
+        std::ostream& logOutput,
+        std::vector<tc::Token>& tokenContainer
+    );
+
+    /**
+     * 按参数选择顺序或并行分析。
+     */
+    void runParser(
+        std::map<std::string, std::string>& paramMap,
+        std::set<std::string>& paramSet,
+        std::vector<tc::Token>& tokens,
+        tc::Parser& parser,
+        std::vector<tc::ParserParseError>& parserErrors
+    );
+
+    /**
+     * 准备语法分析器：加载或构建分析表，并交给 parser。
+     * 
+     * @param lazyGrammar 懒构建模式下，存放懒构建的文法。分析期间需保持存活。
+     */
+    int prepareParser(
+        std::map<std::string, std::string>& paramMap,
+        std::set<std::string>& paramSet,
+        std::ostream& logOutput,
+        tc::Parser& parser,
+        std::unique_ptr<tc::lr1grammar::Lr1Grammar>& lazyGrammar
+    );
+
+    /**
+     * 懒构建模式下，分析结束后保存已经构建的行。
+     */
+    void storeLazyTable(
+        std::map<std::string, std::string>& paramMap,
+        std::set<std::string>& paramSet,
+        std::ostream& logOutput,
+        tc::Parser& parser,
+        tc::lr1grammar::Lr1Grammar& lazyGrammar
+    );
+
+    /**
+     * 报告语法分析结果，按需输出语法树。
+     */
+    int finishSyntaxAnalysis(
+        std::map<std::string, std::string>& paramMap,
+        std::set<std::string>& paramSet,
+        std::ostream& logOutput,
+        std::vector<tc::ParserParseError>& parserErrors,
+        tc::Parser& parser
+    );
+
+    /**
+     * 报告 IR 生成结果，按需输出 IR。
+     */
+    int finishTcIr(
+        std::map<std::string, std::string>& paramMap,
+        std::set<std::string>& paramSet,
+        std::ostream& logOutput,
+        tc::tcir::IrGenerator& irGenerator
+    );
+
 protected:
 
 };
@@ -65,11 +65,11 @@ static void dumpNodeName(const AstNode *node, ostream &out) {
     out << "\"";
 
     out << node << "\\n";
-    out << node->symbol.name;
+    out << node->symbol().name;
 
-    if (node->symbolType == grammar::SymbolType::TERMINAL) {
-        out << "\\n" << node->token.content;
-        out << "\\n(" << node->token.row << ", " << node->token.col << ")";
+    if (node->symbolType() == grammar::SymbolType::TERMINAL) {
+        out << "\\n" << node->token().content;
+        out << "\\n(" << node->token().row << ", " << node->token().col << ")";
     }
 
     out << "\"";
@@ -0,0 +1,395 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    分析表生成器。构建期工具。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+/*
+
+    用法：
+        TableGen [tcey file] [table header] (optional: [direct parser header])
+
+    读取文法，构建 LR(1) 分析表，输出为 C++ 头文件。
+    表头文件内以 constexpr 数组描述分析表，并定义一个 LrParserTableImage：
+        tc::builtintable::image
+
+    若指定了第三个文件，还会输出该表的直接编码分析器：
+        tc::builtintable::directParse
+    每个状态对应一个标号，按待进入符号 switch。移进与 goto 直接跳转，不查表。
+
+    由 CMake 在构建时调用。
+
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <map>
+#include <set>
+
+#include <core/YaccTcey.h>
+#include <core/Lr1Grammar.h>
+#include <core/LrParserTable.h>
+
+using namespace std;
+using namespace tc;
+
+static const char* __tcTokenKindNames[] = {
+#define TOK(X) #X,
+    #include "core/TokenKinds.def"
+#undef TOK
+};
+
+static const char* __tcSymbolKindNames[] = {
+#define SYM(X) #X,
+    #include "core/SymbolKinds.def"
+#undef SYM
+};
+
+static const char* __tcCommandTypeName(LrParserCommandType type) {
+    switch (type) {
+        case LrParserCommandType::ACCEPT: return "ACCEPT";
+        case LrParserCommandType::GOTO: return "GOTO";
+        case LrParserCommandType::SHIFT: return "SHIFT";
+        case LrParserCommandType::REDUCE: return "REDUCE";
+        default: return "ERROR";
+    }
+}
+
+/**
+ * 转为 C++ 字符串字面量。
+ */
+static string __tcQuote(const string& s) {
+    string res = "\"";
+    for (char ch : s) {
+        if (ch == '"' || ch == '\\') {
+            res += '\\';
+        }
+        res += ch;
+    }
+
+    res += '"';
+    return res;
+}
+
+/**
+ * 输出一组单元格，并记录每行的起始位置。
+ * 
+ * @param isGoto 输出 GOTO 部分（非终结符）或 ACTION 部分（终结符）。
+ */
+static void __tcEmitCells(
+    ostream& out,
+    const LrParserTable& table,
+    int stateCount,
+    bool isGoto,
+    const char* cellsName,
+    const char* rowBeginsName
+) {
+
+    vector<int> rowBegins;
+    int cellCount = 0;
+
+    stringstream cellsOut;
+
+    for (int stateId = 0; stateId < stateCount; stateId++) {
+        rowBegins.push_back(cellCount);
+
+        auto rowIt = table.table.find(stateId);
+        if (rowIt == table.table.end()) {
+            continue;
+        }
+
+        // 按符号排序，保证输出稳定。
+        vector< pair<int, LrParserCommand> > cells;
+        for (auto& it : rowIt->second) {
+            bool cellIsGoto = table.symbolList[it.first].type == grammar::SymbolType::NON_TERMINAL;
+            if (cellIsGoto == isGoto) {
+                cells.emplace_back(it.first, it.second);
+            }
+        }
+
+        sort(cells.begin(), cells.end(), [] (auto& a, auto& b) {
+            return a.first < b.first;
+        });
+
+        for (auto& cell : cells) {
+            cellsOut << "        { " << cell.first 
+                << ", LrParserCommandType::" << __tcCommandTypeName(cell.second.type)
+                << ", " << cell.second.target << " },\n";
+            cellCount++;
+        }
+    }
+
+    rowBegins.push_back(cellCount);
+
+    // 空数组不合法。补一个不会被访问到的元素。
+    if (cellCount == 0) {
+        cellsOut << "        { 0, LrParserCommandType::ERROR, 0 },\n";
+    }
+
+    out << "    constexpr LrParserTableImage::CellEntry " << cellsName << "[] = {\n";
+    out << cellsOut.str();
+    out << "    };\n\n";
+
+    out << "    constexpr int " << rowBeginsName << "[] = {";
+    for (size_t i = 0; i < rowBegins.size(); i++) {
+        out << (i % 16 == 0 ? "\n        " : " ") << rowBegins[i] << ",";
+    }
+    out << "\n    };\n\n";
+}
+
+static void __tcEmitHeader(ostream& out, const LrParserTable& table, const string& tceyPath) {
+
+    int stateCount = 0;
+    for (auto& it : table.table) {
+        stateCount = max(stateCount, it.first + 1);
+    }
+
+    out << "// SPDX-License-Identifier: MulanPSL-2.0\n\n";
+    out << "/*\n";
+    out << "    内置分析表。由 TableGen 在构建时生成，请勿修改。\n";
+    out << "    文法：" << tceyPath.substr(tceyPath.find_last_of("/\\") + 1) << "\n";
+    out << "*/\n\n";
+    out << "#pragma once\n\n";
+    out << "#include <core/LrParserTable.h>\n\n";
+    out << "namespace tc::builtintable {\n\n";
+
+    // 符号表。
+    out << "    constexpr LrParserTableImage::SymbolEntry symbols[] = {\n";
+    for (auto& sym : table.symbolList) {
+        bool isTerminal = sym.type == grammar::SymbolType::TERMINAL;
+        out << "        { " << __tcQuote(sym.name) << ", grammar::SymbolType::"
+            << (isTerminal ? "TERMINAL" : "NON_TERMINAL") << ", ";
+        
+        if (isTerminal && size_t(sym.tokenKind) < size_t(TokenKind::NUM_TOKENS)) {
+            out << "TokenKind::" << __tcTokenKindNames[size_t(sym.tokenKind)];
+        } else {
+            out << "TokenKind::unknown";
+        }
+
+        out << ", ";
+
+        if (!isTerminal && size_t(sym.symbolKind) < size_t(SymbolKind::NUM_SYMBOLS)) {
+            out << "SymbolKind::" << __tcSymbolKindNames[size_t(sym.symbolKind)];
+        } else {
+            out << "SymbolKind(0)";
+        }
+
+        out << " },\n";
+    }
+    out << "    };\n\n";
+
+    // 产生式。
+    vector<int> ruleSymbols;
+    out << "    constexpr LrParserTableImage::ExpressionEntry expressions[] = {\n";
+    for (auto& exp : table.flatExpressions) {
+        out << "        { " << exp.targetSymbolId << ", " << ruleSymbols.size() 
+            << ", " << exp.rule.size() << " },\n";
+        ruleSymbols.insert(ruleSymbols.end(), exp.rule.begin(), exp.rule.end());
+    }
+    out << "    };\n\n";
+
+    out << "    constexpr int ruleSymbols[] = {";
+    for (size_t i = 0; i < ruleSymbols.size(); i++) {
+        out << (i % 16 == 0 ? "\n        " : " ") << ruleSymbols[i] << ",";
+    }
+    if (ruleSymbols.empty()) {
+        out << " 0,";
+    }
+    out << "\n    };\n\n";
+
+    // ACTION 与 GOTO。
+    __tcEmitCells(out, table, stateCount, false, "actionCells", "actionRowBegins");
+    __tcEmitCells(out, table, stateCount, true, "gotoCells", "gotoRowBegins");
+
+    out << "    constexpr LrParserTableImage image = {\n";
+    out << "        " << table.primaryStateId << ",\n";
+    out << "        symbols, " << table.symbolList.size() << ",\n";
+    out << "        expressions, " << table.flatExpressions.size() << ",\n";
+    out << "        ruleSymbols,\n";
+    out << "        " << stateCount << ",\n";
+    out << "        actionRowBegins, actionCells,\n";
+    out << "        gotoRowBegins, gotoCells\n";
+    out << "    };\n\n";
+
+    out << "}\n";
+}
+
+/**
+ * 输出直接编码的分析器。
+ * 
+ * 状态 s 的代码形如：
+ *   s17:
+ *       states.push_back(17);
+ *       switch (session.lookahead()) {
+ *           case 3: case 5: session.shift(symbolId, 17); goto s23;
+ *           case 7: session.reduce(12); states.resize(...); goto g34;
+ *           ...
+ *       }
+ * 
+ * 归约后按 goto 转移：
+ *   g34:
+ *       switch (states.back()) { case 3: goto s40; ... }
+ */
+static void __tcEmitDirectParser(ostream& out, const LrParserTable& table, const string& tceyPath) {
+
+    int stateCount = 0;
+    for (auto& it : table.table) {
+        stateCount = max(stateCount, it.first + 1);
+    }
+
+    // 非终结符 id -> (状态 id -> 目标状态 id)。
+    map< int, map<int, int> > gotoColumns;
+
+    out << "// SPDX-License-Identifier: MulanPSL-2.0\n\n";
+    out << "/*\n";
+    out << "    内置直接编码分析器。由 TableGen 在构建时生成，请勿修改。\n";
+    out << "    文法：" << tceyPath.substr(tceyPath.find_last_of("/\\") + 1) << "\n";
+    out << "    只能与同时生成的 BuiltinParserTableData.h 一起使用。\n";
+    out << "*/\n\n";
+    out << "#pragma once\n\n";
+    out << "#include <vector>\n";
+    out << "#include <core/Parser.h>\n\n";
+    out << "namespace tc::builtintable {\n\n";
+    out << "    inline int directParse(ParserSession& session) {\n\n";
+    out << "        std::vector<int> states;\n";
+    out << "        states.reserve(256);\n\n";
+    out << "        int symbolId;\n\n";
+    out << "        goto s" << table.primaryStateId << ";\n\n";
+
+    for (int stateId = 0; stateId < stateCount; stateId++) {
+
+        // 指令 -> 符号列表。相同指令的 case 合并。
+        map< pair<int, int>, vector<int> > actions;
+
+        auto rowIt = table.table.find(stateId);
+        if (rowIt != table.table.end()) {
+            for (auto& it : rowIt->second) {
+                auto& command = it.second;
+                if (command.type == LrParserCommandType::GOTO) {
+                    gotoColumns[it.first][stateId] = command.target;
+                } else if (command.type != LrParserCommandType::ERROR) {
+                    actions[{ int(command.type), command.target }].push_back(it.first);
+                }
+            }
+        }
+
+        out << "    s" << stateId << ":\n";
+        out << "        states.push_back(" << stateId << ");\n";
+        out << "        symbolId = session.lookahead();\n";
+        out << "        switch (symbolId) {\n";
+
+        for (auto& it : actions) {
+            auto type = LrParserCommandType(it.first.first);
+            int target = it.first.second;
+            auto& symbolIds = it.second;
+            
+            sort(symbolIds.begin(), symbolIds.end());
+
+            out << "           ";
+            for (size_t i = 0; i < symbolIds.size(); i++) {
+                out << (i > 0 && i % 8 == 0 ? "\n           " : "") << " case " << symbolIds[i] << ":";
+            }
+            out << "\n";
+
+            if (type == LrParserCommandType::ACCEPT) {
+                
+                out << "                return session.accept();\n";
+            
+            } else if (type == LrParserCommandType::SHIFT) {
+            
+                out << "                session.shift(symbolId, " << stateId << ");\n";
+                out << "                goto s" << target << ";\n";
+            
+            } else {
+                
+                auto& expression = table.flatExpressions[target];
+                out << "                session.reduce(" << target << ");\n";
+                if (!expression.rule.empty()) {
+                    out << "                states.resize(states.size() - " << expression.rule.size() << ");\n";
+                }
+                out << "                goto g" << expression.targetSymbolId << ";\n";
+                
+                // 保证 goto 标号存在。
+                gotoColumns[expression.targetSymbolId];
+            }
+        }
+
+        out << "            case ParserSession::END_OF_TOKENS:\n";
+        out << "                return session.unexpectedEnd();\n";
+        out << "            default:\n";
+        out << "                return session.unexpectedToken();\n";
+        out << "        }\n\n";
+    }
+
+    for (auto& column : gotoColumns) {
+        out << "    g" << column.first << ":\n";
+        out << "        switch (states.back()) {\n";
+        for (auto& it : column.second) {
+            out << "            case " << it.first << ": goto s" << it.second << ";\n";
+        }
+        out << "            default: return session.unexpectedToken();\n";
+        out << "        }\n\n";
+    }
+
+    out << "    }\n\n";
+    out << "}\n";
+}
+
+int main(int argc, const char** argv) {
+
+    if (argc != 3 && argc != 4) {
+        cerr << "usage: " << argv[0] 
+            << " [tcey file] [table header] (optional: [direct parser header])" << endl;
+        return -1;
+    }
+
+    string tceyPath = argv[1];
+    string outputPath = argv[2];
+
+    YaccTcey yacc(tceyPath);
+    if (yacc.errcode != YaccTceyError::TCEY_OK) {
+        cerr << "[error] " << yacc.errmsg << endl;
+        return -2;
+    }
+
+    LrParserTable table;
+    lr1grammar::Lr1Grammar lr1(yacc.grammar);
+    lr1.buildParserTable(table);
+
+    // 先写到字符串，避免构建中断时留下不完整的头文件。
+    stringstream headerOut;
+    __tcEmitHeader(headerOut, table, tceyPath);
+
+    ofstream fout(outputPath, ios::binary);
+    if (!fout.is_open()) {
+        cerr << "[error] failed to open: " << outputPath << endl;
+        return -3;
+    }
+
+    fout << headerOut.str();
+    fout.close();
+
+    if (argc == 4) {
+        stringstream parserOut;
+        __tcEmitDirectParser(parserOut, table, tceyPath);
+
+        ofstream parserFout(argv[3], ios::binary);
+        if (!parserFout.is_open()) {
+            cerr << "[error] failed to open: " << argv[3] << endl;
+            return -3;
+        }
+
+        parserFout << parserOut.str();
+    }
+
+    return 0;
+}
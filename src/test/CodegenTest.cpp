@@ -0,0 +1,623 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    代码生成测试。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+/*
+
+    把示例程序编译为 i386 汇编，再解释执行，检查 main 的返回值。
+    每个程序在以下模式下各编译一次：
+      默认、ssa、no-regalloc、one-pass、one-pass + ssa。
+
+    解释器只支持生成器会输出的指令与操作数形式：
+      mov add sub imul cmp xchg push pop call ret leave jmp jcc，
+      寄存器、立即数、[ebp +/- n] 与 [全局变量]。
+
+    实参的传递方式按生成器的约定：从左到右压栈，第 i 个形参位于 [ebp + 8 + 4i]。
+    下面的程序不依赖多个实参的顺序。
+
+    需要在构建目录下运行，以找到 resources 目录。
+
+*/
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <core/Lexer.h>
+#include <core/Parser.h>
+#include <core/YaccTcey.h>
+#include <core/Lr1Grammar.h>
+#include <core/LrParserTable.h>
+#include <core/Intel386AssemblyGenerator.h>
+#include <core/tcir/IrGenerator.h>
+#include <core/tcir/SyntaxDirectedIrGenerator.h>
+#include <core/config.h>
+
+using namespace std;
+using namespace tc;
+
+static int failures = 0;
+
+static void __tcCheck(bool condition, const string& what) {
+    if (!condition) {
+        cerr << "[failed] " << what << endl;
+        failures++;
+    }
+}
+
+struct CodegenCase {
+    const char* name;
+    const char* source;
+    int32_t expected;
+};
+
+static const CodegenCase cases[] = {
+    {
+        "self assignment",
+        "int main() { int x = 3; x = 40; x = x; return x; }",
+        40
+    },
+    {
+        "chained self assignment",
+        "int main() { int x = 3; int y = 7; x = 40; x = x = y; x = x; y = x = x; "
+        "return x + y * 10; }",
+        77
+    },
+    {
+        "chained assignment",
+        "int main() { int a; int b; int c; a = b = c = 5; b = a + (c = 2); "
+        "return a * 100 + b * 10 + c; }",
+        572
+    },
+    {
+        "compound assignment",
+        "int main() { int x = 3; int y = 4; x += 10; x -= y; y *= x + 1; x += x; x -= x - 1; "
+        "return x * 1000 + y; }",
+        1040
+    },
+    {
+        "compound assignment on parameter",
+        "int sq(int p) { p *= p; p += 1; return p; } "
+        "int main() { return sq(6) + sq(2); }",
+        42
+    },
+    {
+        "increment statements",
+        "int main() { int i = 0; int s = 0; while (i < 10) { s += i; i++; } "
+        "for (i = 0; i < 5; i++) s += 100; i--; i--; return s * 10 + i; }",
+        5453
+    },
+    {
+        "increment value",
+        "int main() { int i = 5; int a = i++; int c = i--; return a * 100 + c * 10 + i; }",
+        565
+    },
+    {
+        "parameter reassignment",
+        "int f(int p) { int t = p - 1; p = p * 3; p = p + t; return p; } "
+        "int main() { return f(5); }",
+        19
+    },
+    {
+        "parameter read only by dead temporary",
+        "int f(int p) { int x = p - 1; p = 7; return p; } "
+        "int main() { return f(2); }",
+        7
+    },
+    {
+        "parameter reassigned in loop",
+        "int f(int n) { int s = 0; while (n > 0) { s += n; n -= 1; } return s; } "
+        "int main() { return f(10); }",
+        55
+    },
+    {
+        "values across calls",
+        "int id(int v) { return v; } "
+        "int main() { int a = 1; int b = 2; int c = 3; int d = id(4); "
+        "return a * 1000 + b * 100 + c * 10 + d; }",
+        1234
+    },
+};
+
+struct CodegenMode {
+    const char* name;
+    bool onePass;
+    bool ssa;
+    bool registerAllocation;
+};
+
+static const CodegenMode modes[] = {
+    { "default", false, false, true },
+    { "ssa", false, true, true },
+    { "no-regalloc", false, false, false },
+    { "one-pass", true, false, true },
+    { "one-pass ssa", true, true, true },
+};
+
+
+/**
+ * 生成的汇编的解释器。
+ */
+class AsmMachine {
+public:
+
+    /**
+     * 加载汇编文本。
+     *
+     * @return 是否成功。失败时 error 记录原因。
+     */
+    bool load(const string& text, string& error);
+
+    /**
+     * 从 entry 开始执行，直到它返回。
+     *
+     * @param result eax 的值。
+     * @return 是否成功。失败时 error 记录原因。
+     */
+    bool run(const string& entry, int32_t& result, string& error);
+
+protected:
+
+    struct Instruction {
+        string mnemonic;
+        vector<string> operands;
+    };
+
+    enum Register { EAX, ECX, EDX, EBX, ESI, EDI, EBP, ESP, NUM_REGISTERS };
+
+    vector<Instruction> instructions;
+    map<string, int> codeLabels;
+    map<string, uint32_t> dataLabels;
+
+    map<uint32_t, uint8_t> memory;
+    uint32_t registers[NUM_REGISTERS] = {};
+
+    int32_t cmpLeft = 0;
+    int32_t cmpRight = 0;
+
+    string error;
+
+    static int findRegister(const string& name);
+
+    uint32_t readMemory(uint32_t address);
+    void writeMemory(uint32_t address, uint32_t value);
+
+    /**
+     * 求 [...] 内的地址。
+     */
+    bool address(const string& operand, uint32_t& result);
+
+    bool read(const string& operand, uint32_t& result);
+    bool write(const string& operand, uint32_t value);
+
+    void push(uint32_t value);
+    uint32_t pop();
+};
+
+static string __tcTrim(const string& s) {
+    size_t begin = s.find_first_not_of(" \t\r");
+    if (begin == string::npos) {
+        return "";
+    }
+
+    size_t end = s.find_last_not_of(" \t\r");
+    return s.substr(begin, end - begin + 1);
+}
+
+/**
+ * 去掉操作数前的 dword、ptr 修饰。
+ */
+static string __tcStripSize(string operand) {
+    for (const string prefix : { "dword ", "ptr " }) {
+        if (operand.compare(0, prefix.size(), prefix) == 0) {
+            operand = __tcTrim(operand.substr(prefix.size()));
+        }
+    }
+
+    return operand;
+}
+
+bool AsmMachine::load(const string& text, string& error) {
+
+    istringstream in(text);
+    string line;
+    string scope;
+    string pendingDataLabel;
+    uint32_t nextDataAddress = 0x1000;
+
+    while (getline(in, line)) {
+        line = __tcTrim(line.substr(0, line.find(';')));
+        if (line.empty() || line[0] == '[') {
+            continue;
+        }
+
+        size_t space = line.find(' ');
+        string head = line.substr(0, space);
+        string rest = space == string::npos ? "" : __tcTrim(line.substr(space + 1));
+
+        if (head == "section" || head == "global" || head == "extern" || head == "align") {
+            continue;
+        }
+
+        if (rest.empty() && head.back() == ':') {
+            string name = head.substr(0, head.size() - 1);
+            if (name[0] == '.') {
+                name = scope + name;
+            } else {
+                scope = name;
+            }
+
+            codeLabels[name] = instructions.size();
+            pendingDataLabel = name;
+            continue;
+        }
+
+        if (head == "db") {
+            if (!pendingDataLabel.empty()) {
+                dataLabels[pendingDataLabel] = nextDataAddress;
+                pendingDataLabel.clear();
+            }
+
+            istringstream bytes(rest);
+            string byte;
+            while (getline(bytes, byte, ',')) {
+                memory[nextDataAddress++] = uint8_t(stoi(__tcTrim(byte)));
+            }
+
+            continue;
+        }
+
+        pendingDataLabel.clear();
+
+        auto& ins = instructions.emplace_back();
+        ins.mnemonic = head;
+
+        // 操作数内没有逗号。
+        istringstream operands(rest);
+        string operand;
+        while (getline(operands, operand, ',')) {
+            operand = __tcStripSize(__tcTrim(operand));
+            if (operand.empty()) {
+                continue;
+            }
+
+            if (operand[0] == '.') {
+                operand = scope + operand;
+            }
+
+            ins.operands.push_back(operand);
+        }
+    }
+
+    return true;
+}
+
+int AsmMachine::findRegister(const string& name) {
+    static const char* names[] = { "eax", "ecx", "edx", "ebx", "esi", "edi", "ebp", "esp" };
+    for (int idx = 0; idx < NUM_REGISTERS; idx++) {
+        if (name == names[idx]) {
+            return idx;
+        }
+    }
+
+    return -1;
+}
+
+uint32_t AsmMachine::readMemory(uint32_t address) {
+    uint32_t value = 0;
+    for (int idx = 3; idx >= 0; idx--) {
+        value = (value << 8) | memory[address + idx];
+    }
+
+    return value;
+}
+
+void AsmMachine::writeMemory(uint32_t address, uint32_t value) {
+    for (int idx = 0; idx < 4; idx++) {
+        memory[address + idx] = uint8_t(value >> (8 * idx));
+    }
+}
+
+bool AsmMachine::address(const string& operand, uint32_t& result) {
+    string inner = __tcTrim(operand.substr(1, operand.size() - 2));
+
+    if (inner.compare(0, 3, "ebp") == 0) {
+        string offset = __tcTrim(inner.substr(3));
+        if (offset.empty()) {
+            result = registers[EBP];
+            return true;
+        }
+
+        int32_t value = stoi(__tcTrim(offset.substr(1)));
+        result = registers[EBP] + uint32_t(offset[0] == '-' ? -value : value);
+        return true;
+    }
+
+    auto it = dataLabels.find(inner);
+    if (it == dataLabels.end()) {
+        error = "unknown memory operand: " + operand;
+        return false;
+    }
+
+    result = it->second;
+    return true;
+}
+
+bool AsmMachine::read(const string& operand, uint32_t& result) {
+    int reg = findRegister(operand);
+    if (reg >= 0) {
+        result = registers[reg];
+        return true;
+    }
+
+    if (operand[0] == '[') {
+        uint32_t addr;
+        if (!address(operand, addr)) {
+            return false;
+        }
+
+        result = readMemory(addr);
+        return true;
+    }
+
+    if (isdigit(operand[0]) || operand[0] == '-') {
+        result = uint32_t(stoll(operand));
+        return true;
+    }
+
+    error = "unknown operand: " + operand;
+    return false;
+}
+
+bool AsmMachine::write(const string& operand, uint32_t value) {
+    int reg = findRegister(operand);
+    if (reg >= 0) {
+        registers[reg] = value;
+        return true;
+    }
+
+    if (operand[0] == '[') {
+        uint32_t addr;
+        if (!address(operand, addr)) {
+            return false;
+        }
+
+        writeMemory(addr, value);
+        return true;
+    }
+
+    error = "cannot write to operand: " + operand;
+    return false;
+}
+
+void AsmMachine::push(uint32_t value) {
+    registers[ESP] -= 4;
+    writeMemory(registers[ESP], value);
+}
+
+uint32_t AsmMachine::pop() {
+    uint32_t value = readMemory(registers[ESP]);
+    registers[ESP] += 4;
+    return value;
+}
+
+bool AsmMachine::run(const string& entry, int32_t& result, string& error) {
+
+    /** 返回到这里表示 entry 已经返回。 */
+    const uint32_t EXIT_ADDRESS = 0xffffffff;
+
+    const long long STEP_LIMIT = 10000000;
+
+    if (!codeLabels.count(entry)) {
+        error = "entry not found: " + entry;
+        return false;
+    }
+
+    registers[ESP] = 0x100000;
+    push(EXIT_ADDRESS);
+    uint32_t pc = codeLabels[entry];
+
+    auto jumpTo = [this, &pc] (const string& label) {
+        auto it = codeLabels.find(label);
+        if (it == codeLabels.end()) {
+            this->error = "unknown label: " + label;
+            return false;
+        }
+
+        pc = it->second;
+        return true;
+    };
+
+    for (long long step = 0; step < STEP_LIMIT; step++) {
+
+        if (pc >= instructions.size()) {
+            error = "pc out of range.";
+            return false;
+        }
+
+        auto& ins = instructions[pc++];
+        auto& op = ins.operands;
+        auto& m = ins.mnemonic;
+
+        bool ok = true;
+        uint32_t a = 0;
+        uint32_t b = 0;
+
+        if (m == "mov") {
+            ok = read(op[1], b) && write(op[0], b);
+        } else if (m == "add" || m == "sub" || m == "imul") {
+            ok = read(op[0], a) && read(op[1], b);
+            uint32_t value = m == "add" ? a + b : m == "sub" ? a - b : a * b;
+            ok = ok && write(op[0], value);
+        } else if (m == "cmp") {
+            ok = read(op[0], a) && read(op[1], b);
+            cmpLeft = int32_t(a);
+            cmpRight = int32_t(b);
+        } else if (m == "xchg") {
+            ok = read(op[0], a) && read(op[1], b) && write(op[0], b) && write(op[1], a);
+        } else if (m == "push") {
+            ok = read(op[0], a);
+            push(a);
+        } else if (m == "pop") {
+            a = pop();
+            ok = op.empty() || write(op[0], a);
+        } else if (m == "leave") {
+            registers[ESP] = registers[EBP];
+            registers[EBP] = pop();
+        } else if (m == "call") {
+            push(pc);
+            ok = jumpTo(op[0]);
+        } else if (m == "ret") {
+            pc = pop();
+            if (pc == EXIT_ADDRESS) {
+                result = int32_t(registers[EAX]);
+                return true;
+            }
+        } else if (m == "jmp") {
+            ok = jumpTo(op[0]);
+        } else if (m[0] == 'j') {
+            bool taken = m == "je" ? cmpLeft == cmpRight
+                : m == "jne" ? cmpLeft != cmpRight
+                : m == "jg" ? cmpLeft > cmpRight
+                : m == "jge" ? cmpLeft >= cmpRight
+                : m == "jl" ? cmpLeft < cmpRight
+                : m == "jle" ? cmpLeft <= cmpRight
+                : (error = "unknown jump: " + m, ok = false);
+
+            if (ok && taken) {
+                ok = jumpTo(op[0]);
+            }
+        } else {
+            this->error = "unknown instruction: " + m;
+            ok = false;
+        }
+
+        if (!ok) {
+            error = this->error;
+            return false;
+        }
+    }
+
+    error = "step limit exceeded.";
+    return false;
+}
+
+
+/**
+ * 编译源码为汇编。
+ *
+ * @return 是否成功。
+ */
+static bool __tcCompile(
+    const string& source,
+    const CodegenMode& mode,
+    Lexer& lexer,
+    const shared_ptr<LrParserTable>& table,
+    string& asmText
+) {
+    istringstream in(source);
+    vector< Token > tokens;
+    vector< LexerAnalyzeError > lexerErrors;
+    lexer.analyze(in, tokens, lexerErrors);
+
+    if (!lexerErrors.empty()) {
+        return false;
+    }
+
+    Parser parser(table);
+    vector< ParserParseError > parserErrors;
+
+    tcir::IrGenerator treeIrGen;
+    tcir::SyntaxDirectedIrGenerator syntaxDirectedIrGen;
+    tcir::IrGenerator& irGen = mode.onePass ? syntaxDirectedIrGen : treeIrGen;
+
+    if (mode.onePass) {
+        parser.setActions(&syntaxDirectedIrGen.getActions());
+    }
+
+    if (parser.parse(tokens, parserErrors) != 0) {
+        return false;
+    }
+
+    if (!mode.onePass) {
+        treeIrGen.process(parser.getAstRoot());
+    }
+
+    if (!irGen.getErrorList().empty()) {
+        return false;
+    }
+
+    i386::Intel386AssemblyGenerator asmGen;
+    asmGen.setSsaEnabled(mode.ssa);
+    asmGen.setRegisterAllocationEnabled(mode.registerAllocation);
+
+    stringstream out;
+    asmGen.generate(irGen.getModule(), out, cerr);
+    asmText = out.str();
+
+    return true;
+}
+
+int main() {
+
+    YaccTcey yacc(TC_CORE_CFG_PARSER_C_TCEY_PATH);
+    if (yacc.errcode != YaccTceyError::TCEY_OK) {
+        cerr << "failed to load grammar." << endl;
+        return 1;
+    }
+
+    auto table = make_shared<LrParserTable>();
+    lr1grammar::Lr1Grammar lr1(yacc.grammar);
+    lr1.buildParserTable(*table);
+
+    Lexer lexer;
+    if (!lexer.dfaIsReady()) {
+        cerr << "failed to init lexer dfa." << endl;
+        return 1;
+    }
+
+    for (auto& test : cases) {
+        for (auto& mode : modes) {
+
+            string where = string(test.name) + " (" + mode.name + ")";
+
+            string asmText;
+            if (!__tcCompile(test.source, mode, lexer, table, asmText)) {
+                __tcCheck(false, where + ": compiles");
+                continue;
+            }
+
+            AsmMachine machine;
+            string error;
+            int32_t result = 0;
+
+            if (!machine.load(asmText, error) || !machine.run("main", result, error)) {
+                __tcCheck(false, where + ": runs. " + error);
+                continue;
+            }
+
+            __tcCheck(
+                result == test.expected,
+                where + ": returns " + to_string(test.expected) + ", got " + to_string(result)
+            );
+        }
+    }
+
+    if (failures) {
+        return 1;
+    }
+
+    cout << "ok" << endl;
+    return 0;
+}
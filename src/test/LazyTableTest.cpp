@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    懒构建分析表的恢复测试。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+/*
+
+    用默认文法懒构建一部分行并导出，经 tcpt 格式保存再读回后：
+      文法不变时，应当恢复已构建的行；
+      改动一条产生式（符号与产生式的数量都不变）后，应当丢弃整张表。
+
+    需要在构建目录下运行，以找到 resources 目录。
+
+*/
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include <core/YaccTcey.h>
+#include <core/Lr1Grammar.h>
+#include <core/LrParserTable.h>
+#include <core/config.h>
+
+using namespace std;
+using namespace tc;
+
+static int failures = 0;
+
+static void __tcCheck(bool condition, const char* what) {
+    if (!condition) {
+        cerr << "[failed] " << what << endl;
+        failures++;
+    }
+}
+
+/**
+ * 懒构建，查询 0 号状态及其移进目标的所有列，然后导出。
+ */
+static void __tcBuildPartialTable(const grammar::Grammar& grammar, LrParserTable& out) {
+
+    lr1grammar::Lr1Grammar lr1(grammar, lr1grammar::Lr1BuildMode::LAZY);
+    int symbolCount = lr1.getSymbolList().size();
+
+    for (int symbolId = 0; symbolId < symbolCount; symbolId++) {
+        auto cmd = lr1.getCommand(0, symbolId);
+        if (cmd.type != LrParserCommandType::SHIFT && cmd.type != LrParserCommandType::GOTO) {
+            continue;
+        }
+
+        for (int nextSymbolId = 0; nextSymbolId < symbolCount; nextSymbolId++) {
+            lr1.getCommand(cmd.target, nextSymbolId);
+        }
+    }
+
+    LrParserTable table;
+    lr1.exportLazyTable(table);
+
+    // 经 tcpt 格式保存再读回。
+    stringstream tcpt;
+    table.dump(tcpt);
+    out.load(tcpt, cerr);
+}
+
+int main() {
+
+    ifstream fin(TC_CORE_CFG_PARSER_C_TCEY_PATH, ios::binary);
+    if (!fin.is_open()) {
+        cerr << "failed to open " << TC_CORE_CFG_PARSER_C_TCEY_PATH << endl;
+        return 1;
+    }
+
+    string text((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+
+    const string production = "| relational_expression '<' shift_expression\n";
+    auto pos = text.find(production);
+    if (pos == string::npos) {
+        cerr << "production not found in grammar." << endl;
+        return 1;
+    }
+
+    string editedText = text;
+    editedText.replace(
+        pos, production.size(), "| relational_expression '<' shift_expression shift_expression\n"
+    );
+
+    istringstream in(text);
+    YaccTcey yacc(in);
+
+    istringstream editedIn(editedText);
+    YaccTcey editedYacc(editedIn);
+
+    if (yacc.errcode != YaccTceyError::TCEY_OK || editedYacc.errcode != YaccTceyError::TCEY_OK) {
+        cerr << "failed to load grammar." << endl;
+        return 1;
+    }
+
+    LrParserTable partialTable;
+    __tcBuildPartialTable(yacc.grammar, partialTable);
+
+    __tcCheck(partialTable.partial, "exported table is partial");
+    __tcCheck(partialTable.table.size() > 1, "exported table has rows");
+
+    // 文法不变：恢复。
+    lr1grammar::Lr1Grammar same(yacc.grammar, lr1grammar::Lr1BuildMode::LAZY);
+    __tcCheck(same.loadLazily(yacc.grammar, &partialTable), "same grammar restores the table");
+
+    // 改动一条产生式：数量不变，但表必须作废。
+    lr1grammar::Lr1Grammar edited(editedYacc.grammar, lr1grammar::Lr1BuildMode::LAZY);
+
+    __tcCheck(
+        edited.getSymbolList().size() == same.getSymbolList().size()
+            && edited.getFlatExpressions().size() == same.getFlatExpressions().size(),
+        "edited grammar keeps symbol and production counts"
+    );
+
+    __tcCheck(
+        !edited.loadLazily(editedYacc.grammar, &partialTable),
+        "edited grammar rejects the table"
+    );
+
+    // 旧版本保存的表没有指纹，也不能恢复。
+    partialTable.grammarFingerprint = 0;
+    __tcCheck(
+        !same.loadLazily(yacc.grammar, &partialTable),
+        "table without fingerprint is rejected"
+    );
+
+    if (failures) {
+        return 1;
+    }
+
+    cout << "ok" << endl;
+    return 0;
+}
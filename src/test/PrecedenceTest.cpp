@@ -0,0 +1,247 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    优先级与结合性测试。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+/*
+
+    用一个带 %left、%right、%nonassoc 与 %prec 的小文法构建分析表，检查：
+      分析结果符合优先级与结合性；
+      %nonassoc 的格子为错误；
+      冲突统计按格子计数。期望值由状态内的项目直接数出。
+
+    需要在构建目录下运行。
+
+*/
+
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <core/Lexer.h>
+#include <core/Parser.h>
+#include <core/YaccTcey.h>
+#include <core/Lr1Grammar.h>
+#include <core/LrParserTable.h>
+
+using namespace std;
+using namespace tc;
+
+static const char* grammarText = R"(
+/*_tcey_
+
+token-key CONSTANT --_numeric_constant_
+token-key '+' +
+token-key '*' *
+token-key '-' -
+token-key '<' <
+
+*/
+
+%token CONSTANT
+
+%nonassoc '<'
+%left '+'
+%left '*'
+%right UMINUS
+
+%start expression
+
+%%
+
+expression
+    : expression '<' expression
+    | expression '+' expression
+    | expression '*' expression
+    | '-' expression %prec UMINUS
+    | CONSTANT
+    ;
+
+%%
+)";
+
+static int failures = 0;
+
+static void __tcCheck(bool condition, const string& what) {
+    if (!condition) {
+        cerr << "[failed] " << what << endl;
+        failures++;
+    }
+}
+
+/**
+ * 把语法树写成带括号的形式，如 (1 + (2 * 3))。只有一个子节点的非终结符不加括号。
+ */
+static string __tcTreeText(const AstNode* node) {
+    if (node->symbolType() == grammar::SymbolType::TERMINAL) {
+        return node->token().content;
+    }
+
+    if (node->children.size() == 1) {
+        return __tcTreeText(node->children[0]);
+    }
+
+    string res = "(";
+    for (size_t idx = 0; idx < node->children.size(); idx++) {
+        res += (idx ? " " : "") + __tcTreeText(node->children[idx]);
+    }
+
+    return res + ")";
+}
+
+/**
+ * 分析源码。
+ *
+ * @return 树的文本。分析失败时返回空串。
+ */
+static string __tcParse(
+    const string& source, Lexer& lexer, const shared_ptr<LrParserTable>& table
+) {
+    istringstream in(source);
+    vector< Token > tokens;
+    vector< LexerAnalyzeError > lexerErrors;
+    lexer.analyze(in, tokens, lexerErrors);
+
+    Parser parser(table);
+    vector< ParserParseError > errors;
+    parser.parse(tokens, errors);
+
+    if (!lexerErrors.empty() || !errors.empty() || !parser.getAstRoot()) {
+        return "";
+    }
+
+    return __tcTreeText(parser.getAstRoot());
+}
+
+int main() {
+
+    istringstream grammarIn(grammarText);
+    YaccTcey yacc(grammarIn);
+    if (yacc.errcode != YaccTceyError::TCEY_OK) {
+        cerr << "failed to load grammar: " << yacc.errmsg << endl;
+        return 1;
+    }
+
+    auto table = make_shared<LrParserTable>();
+    lr1grammar::Lr1Grammar lr1(yacc.grammar);
+    lr1.buildParserTable(*table);
+
+    Lexer lexer;
+    if (!lexer.dfaIsReady()) {
+        cerr << "failed to init lexer dfa." << endl;
+        return 1;
+    }
+
+    // 分析结果。
+
+    struct {
+        const char* source;
+        const char* tree;
+    } parseCases[] = {
+        { "1 + 2 * 3", "(1 + (2 * 3))" },
+        { "1 * 2 + 3", "((1 * 2) + 3)" },
+        { "1 + 2 + 3", "((1 + 2) + 3)" },
+        { "1 * 2 * 3", "((1 * 2) * 3)" },
+        { "- 1 + 2", "((- 1) + 2)" },
+        { "- 1 * 2", "((- 1) * 2)" },
+        { "- - 1", "(- (- 1))" },
+        { "1 + 2 < 3 * 4", "((1 + 2) < (3 * 4))" },
+        { "1 < 2 < 3", "" },
+    };
+
+    for (auto& test : parseCases) {
+        string tree = __tcParse(test.source, lexer, table);
+        __tcCheck(
+            tree == test.tree,
+            string(test.source) + ": expected \"" + test.tree + "\", got \"" + tree + "\""
+        );
+    }
+
+    // 逐个格子数出移进-归约冲突。
+
+    auto& compiled = *lr1.getCompiledGrammar();
+    int lessSymbolId = -1;
+    for (int id = 0; id < compiled.getSymbolCount(); id++) {
+        if (compiled.getSymbolName(id) == "'<'") {
+            lessSymbolId = id;
+        }
+    }
+
+    __tcCheck(lessSymbolId >= 0, "grammar has '<'");
+
+    int expectedResolved = 0;
+    int expectedNonassoc = 0;
+
+    for (auto& state : lr1.getStates()) {
+
+        unordered_set<int> shiftSymbolIds;
+        unordered_map<int, unordered_set<int>> reduceExpressions; // 展望符 -> 产生式。
+
+        for (auto& item : state.expressions) {
+            int rhsLength = compiled.getRhsLength(item.expressionId);
+            if (item.dotPos < rhsLength) {
+                shiftSymbolIds.insert(compiled.getRhs(item.expressionId)[item.dotPos]);
+            } else if (compiled.getLhs(item.expressionId) != lr1.getEntrySymbolId()) {
+                reduceExpressions[item.paimonId].insert(item.expressionId);
+            }
+        }
+
+        for (auto& [symbolId, expressionIds] : reduceExpressions) {
+            if (!shiftSymbolIds.count(symbolId)) {
+                continue;
+            }
+
+            // 只有 E '<' E 在展望 '<' 时优先级相同且不结合。
+            bool nonassoc = false;
+            for (int expressionId : expressionIds) {
+                auto rhs = compiled.getRhs(expressionId);
+                nonassoc |= symbolId == lessSymbolId
+                    && compiled.getRhsLength(expressionId) == 3 && rhs[1] == lessSymbolId;
+            }
+
+            if (nonassoc) {
+                expectedNonassoc++;
+                __tcCheck(
+                    table->getCommand(state.id, symbolId).type == LrParserCommandType::ERROR,
+                    "state " + to_string(state.id) + ": nonassoc cell is an error"
+                );
+            } else {
+                expectedResolved++;
+            }
+        }
+    }
+
+    auto& stats = lr1.getStats();
+
+    __tcCheck(expectedNonassoc > 0, "grammar has nonassoc cells");
+    __tcCheck(
+        stats.shiftReduceResolved == expectedResolved,
+        "shiftReduceResolved is " + to_string(expectedResolved)
+            + ", got " + to_string(stats.shiftReduceResolved)
+    );
+    __tcCheck(
+        stats.nonassocErrors == expectedNonassoc,
+        "nonassocErrors is " + to_string(expectedNonassoc)
+            + ", got " + to_string(stats.nonassocErrors)
+    );
+    __tcCheck(stats.shiftReduceUnresolved == 0, "no unresolved shift-reduce conflicts");
+    __tcCheck(stats.reduceReduce == 0, "no reduce-reduce conflicts");
+
+    if (failures) {
+        return 1;
+    }
+
+    cout << "ok. " << stats.shiftReduceResolved << " resolved, "
+        << stats.nonassocErrors << " nonassoc." << endl;
+    return 0;
+}
@@ -0,0 +1,167 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    寄存器分配测试。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+/*
+
+    直接构造函数的 TCIR，检查分配结果：
+      入口读入寄存器的参数，其区间必须从入口开始；
+      区间重叠的值不能分到同一个寄存器。
+
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <core/Intel386RegisterAllocator.h>
+
+using namespace std;
+using namespace tc;
+using namespace tc::tcir;
+using namespace tc::i386;
+
+static int failures = 0;
+
+static void __tcCheck(bool condition, const string& what) {
+    if (!condition) {
+        cerr << "[failed] " << what << endl;
+        failures++;
+    }
+}
+
+/**
+ * 检查分配结果的一致性。
+ */
+static void __tcCheckAllocation(
+    const Intel386RegisterAllocator& allocator, const string& name
+) {
+    auto& intervals = allocator.getIntervals();
+
+    for (size_t a = 0; a < intervals.size(); a++) {
+        auto& ia = intervals[a];
+        if (!ia.location.isRegister() || ia.end < 0) {
+            continue;
+        }
+
+        for (size_t b = a + 1; b < intervals.size(); b++) {
+            auto& ib = intervals[b];
+            if (!ib.location.isRegister() || ib.end < 0) {
+                continue;
+            }
+
+            bool overlap = ia.start <= ib.end && ib.start <= ia.end;
+            __tcCheck(
+                !overlap || ia.location.reg != ib.location.reg,
+                name + ": overlapping intervals share "
+                    + Intel386RegisterAllocator::getName(ia.location.reg)
+            );
+        }
+    }
+
+    for (auto& [reg, offset] : allocator.getParamLoads()) {
+        for (auto& interval : intervals) {
+            if (interval.value.kind != IrOperandKind::param
+                || 8 + 4 * int(interval.value.value) != offset
+            ) {
+                continue;
+            }
+
+            __tcCheck(
+                interval.location.reg == reg && interval.start == 0,
+                name + ": loaded parameter " + to_string(interval.value.value)
+                    + " is live from the entry"
+            );
+        }
+    }
+}
+
+/**
+ * 参数只被死的临时值读取，之后被重新赋值。
+ *
+ *   int f(int p0, int p1) { int x = p1 - p0; p0 = p1 * 3; return p0; }
+ *
+ * SSA 优化删掉 x 后，剩下的指令如下。p0 在入口处不活跃，不应读入寄存器。
+ * 它的区间从重新赋值处开始，寄存器可能与 p1 相同，入口读入 p0 会覆盖 p1。
+ */
+static void __tcTestParamReadOnlyByDeadTemporary() {
+    vector<IrInstruction> instructions = {
+        { IrOpcode::funLabel, IrOperand::function(0), IrOperand::number(1) },
+        { IrOpcode::mov, IrOperand::vreg(2), IrOperand::param(1) },
+        { IrOpcode::sub, IrOperand::vreg(2), IrOperand::param(0) },
+        { IrOpcode::mov, IrOperand::vreg(3), IrOperand::param(1) },
+        { IrOpcode::mul, IrOperand::vreg(3), IrOperand::imm(3) },
+        { IrOpcode::mov, IrOperand::param(0), IrOperand::vreg(3) },
+        { IrOpcode::mov, IrOperand::vreg(0), IrOperand::param(0) },
+        IrInstruction(IrOpcode::ret),
+    };
+
+    Intel386RegisterAllocator allocator;
+    allocator.allocate(instructions, true);
+
+    const string name = "param read only by dead temporary";
+
+    __tcCheck(
+        allocator.isDeadInstruction(1) && allocator.isDeadInstruction(2),
+        name + ": dead temporary is removed"
+    );
+
+    for (auto& [reg, offset] : allocator.getParamLoads()) {
+        __tcCheck(offset != 8, name + ": reassigned parameter is not loaded at entry");
+    }
+
+    __tcCheckAllocation(allocator, name);
+}
+
+/**
+ * 两个参数都在入口活跃，中间有 call。
+ *
+ *   int f(int p0, int p1) { g(); return p0 + p1; }
+ */
+static void __tcTestParamsAcrossCall() {
+    vector<IrInstruction> instructions = {
+        { IrOpcode::funLabel, IrOperand::function(0), IrOperand::number(1) },
+        { IrOpcode::call, IrOperand::function(1) },
+        { IrOpcode::mov, IrOperand::vreg(2), IrOperand::param(0) },
+        { IrOpcode::add, IrOperand::vreg(2), IrOperand::param(1) },
+        { IrOpcode::mov, IrOperand::vreg(0), IrOperand::vreg(2) },
+        IrInstruction(IrOpcode::ret),
+    };
+
+    Intel386RegisterAllocator allocator;
+    allocator.allocate(instructions, true);
+
+    const string name = "params across call";
+
+    for (int idx = 0; idx < 2; idx++) {
+        auto location = allocator.getLocation(IrOperand::param(idx));
+        __tcCheck(
+            !location.isRegister() || Intel386RegisterAllocator::isCalleeSaved(location.reg),
+            name + ": parameter " + to_string(idx) + " survives the call"
+        );
+    }
+
+    __tcCheck(allocator.getParamLoads().size() <= 2, name + ": at most two loads");
+
+    __tcCheckAllocation(allocator, name);
+}
+
+int main() {
+
+    __tcTestParamReadOnlyByDeadTemporary();
+    __tcTestParamsAcrossCall();
+
+    if (failures) {
+        return 1;
+    }
+
+    cout << "ok" << endl;
+    return 0;
+}
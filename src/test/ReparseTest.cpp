@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+
+    增量分析测试。
+    part of the ToyCompile project.
+
+    created on 2026.10.18
+
+*/
+
+/*
+
+    对 resources/test 内的示例文件做随机编辑（改标识符、删除、插入），
+    每次编辑后分别用 reparse 和完整分析处理编辑后的 token 列表，
+    两者得到的语法树与错误应当完全相同。
+
+    编辑后仍能通过分析时，下一次编辑在此基础上继续，reparse 也基于上一次 reparse 的结果；
+    否则退回上一个能通过分析的版本重新分析，使每次 reparse 都有可复用的旧树。
+    随机数种子固定，失败可以复现。
+
+    需要在构建目录下运行，以找到 resources 目录。
+
+*/
+
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <core/Lexer.h>
+#include <core/Parser.h>
+#include <core/YaccTcey.h>
+#include <core/Lr1Grammar.h>
+#include <core/LrParserTable.h>
+#include <core/config.h>
+
+using namespace std;
+using namespace tc;
+
+static const char* sampleFiles[] = {
+    "resources/test/easy.c.txt",
+    "resources/test/tj-demo1.c.txt",
+    "resources/test/tj-demo2.c.txt",
+};
+
+/**
+ * 每个文件的编辑次数。
+ */
+static const int ROUNDS_PER_FILE = 300;
+
+static int failures = 0;
+
+static void __tcCheck(bool condition, const string& what) {
+    if (!condition) {
+        cerr << "[failed] " << what << endl;
+        failures++;
+    }
+}
+
+/**
+ * 比较两棵语法树。终结符比较 token 的类型与内容。
+ */
+static bool __tcSameTree(const AstNode* a, const AstNode* b) {
+    if (a == nullptr || b == nullptr) {
+        return a == b;
+    }
+
+    if (a->symbolId != b->symbolId || a->children.size() != b->children.size()) {
+        return false;
+    }
+
+    if (a->symbolType() == grammar::SymbolType::TERMINAL) {
+        auto& ta = a->token();
+        auto& tb = b->token();
+        return ta.kind == tb.kind && ta.content == tb.content;
+    }
+
+    for (size_t idx = 0; idx < a->children.size(); idx++) {
+        if (!__tcSameTree(a->children[idx], b->children[idx])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool __tcSameErrors(
+    const vector< ParserParseError >& a,
+    const vector< ParserParseError >& b
+) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+
+    for (size_t idx = 0; idx < a.size(); idx++) {
+        if (a[idx].tokenRelated != b[idx].tokenRelated || a[idx].msg != b[idx].msg) {
+            return false;
+        }
+
+        if (a[idx].tokenRelated
+            && (a[idx].token.row != b[idx].token.row || a[idx].token.col != b[idx].token.col)
+        ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * 随机编辑 token 列表。结尾的 eof 不参与编辑。
+ *
+ * @return 编辑范围。
+ */
+static TokenEdit __tcRandomEdit(vector< Token >& tokens, mt19937& rng) {
+    int bodySize = tokens.size() - 1;
+    auto randomInt = [&rng] (int lo, int hi) {
+        return uniform_int_distribution<int>(lo, hi)(rng);
+    };
+
+    TokenEdit edit;
+
+    switch (bodySize > 0 ? randomInt(0, 2) : 2) {
+        case 0: { // 改名：找一个标识符，换成另一个名字。
+            int idx = randomInt(0, bodySize - 1);
+            for (int step = 0; step < bodySize && tokens[idx].kind != TokenKind::identifier; step++) {
+                idx = (idx + 1) % bodySize;
+            }
+
+            if (tokens[idx].kind == TokenKind::identifier) {
+                tokens[idx].content = "v" + to_string(randomInt(0, 9));
+            }
+
+            edit = { idx, idx + 1, idx + 1 };
+            break;
+        }
+
+        case 1: { // 删除 1 ~ 8 个 token。
+            int begin = randomInt(0, bodySize - 1);
+            int end = min(bodySize, begin + randomInt(1, 8));
+            tokens.erase(tokens.begin() + begin, tokens.begin() + end);
+            edit = { begin, end, begin };
+            break;
+        }
+
+        default: { // 插入 1 ~ 8 个 token，复制自文件内另一处。
+            int pos = randomInt(0, bodySize);
+            int srcBegin = bodySize > 0 ? randomInt(0, bodySize - 1) : 0;
+            int srcEnd = min(bodySize, srcBegin + randomInt(1, 8));
+
+            vector< Token > inserted(tokens.begin() + srcBegin, tokens.begin() + srcEnd);
+            tokens.insert(tokens.begin() + pos, inserted.begin(), inserted.end());
+            edit = { pos, pos, pos + int(inserted.size()) };
+            break;
+        }
+    }
+
+    return edit;
+}
+
+int main() {
+
+    YaccTcey yacc(TC_CORE_CFG_PARSER_C_TCEY_PATH);
+    if (yacc.errcode != YaccTceyError::TCEY_OK) {
+        cerr << "failed to load grammar." << endl;
+        return 1;
+    }
+
+    auto table = make_shared<LrParserTable>();
+    lr1grammar::Lr1Grammar lr1(yacc.grammar);
+    lr1.buildParserTable(*table);
+
+    Lexer lexer;
+    if (!lexer.dfaIsReady()) {
+        cerr << "failed to init lexer dfa." << endl;
+        return 1;
+    }
+
+    mt19937 rng(20261018);
+
+    int reparseSuccessCount = 0;
+
+    for (auto filePath : sampleFiles) {
+
+        ifstream fin(filePath, ios::binary);
+        if (!fin.is_open()) {
+            cerr << "failed to open " << filePath << endl;
+            return 1;
+        }
+
+        vector< Token > tokens;
+        vector< LexerAnalyzeError > lexerErrors;
+        lexer.analyze(fin, tokens, lexerErrors);
+
+        if (!lexerErrors.empty()) {
+            cerr << "lexer error in " << filePath << endl;
+            return 1;
+        }
+
+        Parser reparser(table);
+        vector< ParserParseError > errors;
+        reparser.parse(tokens, errors);
+
+        __tcCheck(errors.empty(), string(filePath) + ": sample file parses");
+
+        vector< Token > validTokens = tokens;
+
+        for (int round = 0; round < ROUNDS_PER_FILE; round++) {
+
+            TokenEdit edit = __tcRandomEdit(tokens, rng);
+
+            vector< ParserParseError > reparseErrors;
+            reparser.reparse(tokens, edit, reparseErrors);
+
+            Parser fullParser(table);
+            vector< ParserParseError > fullErrors;
+            fullParser.parse(tokens, fullErrors);
+
+            string where = string(filePath) + ", round " + to_string(round);
+
+            __tcCheck(
+                __tcSameErrors(reparseErrors, fullErrors),
+                where + ": reparse reports the same errors as full parse"
+            );
+
+            __tcCheck(
+                __tcSameTree(reparser.getAstRoot(), fullParser.getAstRoot()),
+                where + ": reparse builds the same tree as full parse"
+            );
+
+            if (reparseErrors.empty()) {
+                reparseSuccessCount++;
+                validTokens = tokens;
+            } else {
+                tokens = validTokens;
+                reparseErrors.clear();
+                reparser.parse(tokens, reparseErrors);
+            }
+        }
+    }
+
+    // 大部分随机编辑会引入语法错误。至少要有一部分编辑后仍能通过分析，
+    // 否则比较的只是出错的情形。
+    __tcCheck(reparseSuccessCount > 0, "some edits keep the source valid");
+
+    if (failures) {
+        return 1;
+    }
+
+    cout << "ok. " << reparseSuccessCount << " of "
+        << ROUNDS_PER_FILE * sizeof(sampleFiles) / sizeof(sampleFiles[0]) << " edits kept the source valid." << endl;
+    return 0;
+}
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+ * 单写多读的只追加列表。
+ * 创建：2026.10.18
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+
+/**
+ * 单写多读的只追加列表。
+ *
+ * 元素分块存储，第 k 块容量为 FIRST_CHUNK_SIZE << k。块的目录是定长数组，
+ * 追加时既不移动已有元素，也不移动目录，已有元素的引用一直有效。
+ *
+ * 只允许一个线程调用 append。其他线程可以同时读取 size() 以内的元素：
+ * append 写好元素后才以 release 发布新的长度，读者以 acquire 读取长度。
+ */
+template <typename T>
+class AppendOnlyList {
+
+public:
+
+    AppendOnlyList() {}
+
+    ~AppendOnlyList() {
+        clear();
+    }
+
+    AppendOnlyList(const AppendOnlyList&) = delete;
+    AppendOnlyList& operator = (const AppendOnlyList&) = delete;
+
+    /**
+     * 已发布的元素数量。下标小于它的元素可以读取。
+     */
+    size_t size() const {
+        return count.load(std::memory_order_acquire);
+    }
+
+    const T& operator [] (size_t idx) const {
+        size_t pos = idx + FIRST_CHUNK_SIZE;
+        int bit = 63 - __builtin_clzll(pos);
+        return chunks[bit - FIRST_CHUNK_BITS][pos - (size_t(1) << bit)];
+    }
+
+    /**
+     * 把 [begin, end) 内的元素追加到尾部，再一次性发布。仅写线程调用。
+     * 迭代器解引用得到右值时移动元素，否则复制。
+     */
+    template <typename Iterator>
+    void append(Iterator begin, Iterator end) {
+        size_t n = count.load(std::memory_order_relaxed);
+
+        for (; begin != end; ++begin, ++n) {
+            size_t pos = n + FIRST_CHUNK_SIZE;
+            int bit = 63 - __builtin_clzll(pos);
+            int chunkIdx = bit - FIRST_CHUNK_BITS;
+
+            if (chunks[chunkIdx] == nullptr) {
+                chunks[chunkIdx] = static_cast<T*>(
+                    ::operator new(sizeof(T) << bit)
+                );
+            }
+
+            new (chunks[chunkIdx] + (pos - (size_t(1) << bit))) T(*begin);
+        }
+
+        count.store(n, std::memory_order_release);
+    }
+
+    /**
+     * 释放所有元素。调用时不能有其他线程在读取。
+     */
+    void clear() {
+        size_t n = count.load(std::memory_order_relaxed);
+
+        for (int chunkIdx = 0; chunkIdx < MAX_CHUNKS; chunkIdx++) {
+            if (chunks[chunkIdx] == nullptr) {
+                continue;
+            }
+
+            size_t chunkBegin = (FIRST_CHUNK_SIZE << chunkIdx) - FIRST_CHUNK_SIZE;
+            size_t chunkSize = FIRST_CHUNK_SIZE << chunkIdx;
+
+            for (size_t i = 0; i < chunkSize && chunkBegin + i < n; i++) {
+                chunks[chunkIdx][i].~T();
+            }
+
+            ::operator delete(chunks[chunkIdx]);
+            chunks[chunkIdx] = nullptr;
+        }
+
+        count.store(0, std::memory_order_relaxed);
+    }
+
+protected:
+
+    static constexpr int FIRST_CHUNK_BITS = 10;
+    static constexpr size_t FIRST_CHUNK_SIZE = size_t(1) << FIRST_CHUNK_BITS;
+
+    /** 块数上限。所有块的总容量覆盖整个 64 位下标范围。 */
+    static constexpr int MAX_CHUNKS = 64 - FIRST_CHUNK_BITS;
+
+    T* chunks[MAX_CHUNKS] = {};
+
+    std::atomic<size_t> count { 0 };
+
+};
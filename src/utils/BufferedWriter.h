@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+ * 带缓冲的输出。
+ * 创建：2026.10.18
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+
+/**
+ * 带缓冲的输出。
+ *
+ * 先写入自己的缓冲区，满了再整块交给输出流，避免逐项调用流的格式化与 endl 刷新。
+ * 析构时自动 flush。
+ */
+class BufferedWriter {
+
+public:
+
+    explicit BufferedWriter(std::ostream& out, size_t capacity = 1 << 16) 
+        : out(out), buffer(capacity) {}
+
+    ~BufferedWriter() { flush(); }
+
+    BufferedWriter(const BufferedWriter&) = delete;
+
+    /**
+     * 写入一段字节。
+     */
+    void write(const void* data, size_t size) {
+        if (used + size > buffer.size()) {
+            flush();
+
+            if (size > buffer.size()) {
+                out.write(static_cast<const char*>(data), size);
+                return;
+            }
+        }
+
+        memcpy(buffer.data() + used, data, size);
+        used += size;
+    }
+
+    void write(std::string_view str) { write(str.data(), str.size()); }
+
+    void put(char ch) {
+        if (used == buffer.size()) {
+            flush();
+        }
+
+        buffer[used++] = ch;
+    }
+
+    /**
+     * 以本机字节序写入一个整数。
+     */
+    template <typename T>
+    void writeBinary(T number) {
+        static_assert(std::is_integral_v<T>);
+        write(&number, sizeof(number));
+    }
+
+    /**
+     * 以十进制文本写入一个整数。
+     */
+    void writeDecimal(int64_t number) {
+        char digits[24];
+        int pos = sizeof(digits);
+
+        uint64_t value = number < 0 ? 0 - uint64_t(number) : uint64_t(number);
+        do {
+            digits[--pos] = char('0' + value % 10);
+            value /= 10;
+        } while (value);
+
+        if (number < 0) {
+            digits[--pos] = '-';
+        }
+
+        write(digits + pos, sizeof(digits) - pos);
+    }
+
+    /**
+     * 把缓冲区内容交给输出流。
+     */
+    void flush() {
+        if (used) {
+            out.write(buffer.data(), used);
+            used = 0;
+        }
+    }
+
+protected:
+
+    std::ostream& out;
+    std::vector<char> buffer;
+    size_t used = 0;
+
+};
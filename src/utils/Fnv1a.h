@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+ * 64 位 FNV-1a 哈希。
+ * 创建：2026.10.18
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+
+/**
+ * 64 位 FNV-1a 哈希。
+ *
+ * 用于缓存的键与指纹，不用于安全相关的场合。
+ * 逐字节处理，结果与机器字长无关；整数按本机字节序参与计算。
+ */
+class Fnv1a {
+
+public:
+
+    static constexpr uint64_t OFFSET_BASIS = 14695981039346656037ull;
+    static constexpr uint64_t PRIME = 1099511628211ull;
+
+    /**
+     * 加入一段字节。
+     */
+    Fnv1a& update(const void* data, size_t size) {
+        auto bytes = static_cast<const unsigned char*>(data);
+        for (size_t idx = 0; idx < size; idx++) {
+            value = (value ^ bytes[idx]) * PRIME;
+        }
+
+        return *this;
+    }
+
+    /**
+     * 加入一个整数或枚举值。
+     */
+    template <typename T>
+    Fnv1a& update(T number) {
+        static_assert(std::is_integral_v<T> || std::is_enum_v<T>);
+        return update(&number, sizeof(number));
+    }
+
+    /**
+     * 加入一个字符串。长度也参与计算，使 "ab" + "c" 与 "a" + "bc" 不同。
+     */
+    Fnv1a& update(const std::string& str) {
+        update(str.data(), str.size());
+        return update(uint64_t(str.size()));
+    }
+
+    uint64_t digest() const { return value; }
+
+protected:
+
+    uint64_t value = OFFSET_BASIS;
+
+};
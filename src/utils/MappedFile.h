@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+ * 只读映射的文件。
+ * 创建：2026.10.18
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#ifdef _WIN32
+    #include <fstream>
+    #include <iterator>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+/**
+ * 只读映射的文件。
+ *
+ * POSIX 系统上使用 mmap，内容按需换入，不复制到堆上。
+ * 其他系统退化为整体读入内存。两种情况下数据起始地址都按页或堆分配对齐。
+ */
+class MappedFile {
+
+public:
+
+    MappedFile() {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator = (const MappedFile&) = delete;
+
+    /**
+     * 打开并映射文件。
+     *
+     * @return 是否成功。
+     */
+    bool open(const std::string& filename) {
+        close();
+
+#ifdef _WIN32
+        std::ifstream fin(filename, std::ios::binary);
+        if (!fin.is_open()) {
+            return false;
+        }
+
+        buffer.assign(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+        data = buffer.data();
+        size = buffer.size();
+        return true;
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+
+        size = size_t(st.st_size);
+
+        // 空文件不能映射。保持 data 为空即可。
+        if (size > 0) {
+            void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                ::close(fd);
+                size = 0;
+                return false;
+            }
+
+            data = static_cast<const char*>(addr);
+        }
+
+        ::close(fd);
+        return true;
+#endif
+    }
+
+    void close() {
+#ifdef _WIN32
+        buffer.clear();
+#else
+        if (data) {
+            munmap(const_cast<char*>(data), size);
+        }
+#endif
+
+        data = nullptr;
+        size = 0;
+    }
+
+    const char* getData() const { return data; }
+    size_t getSize() const { return size; }
+
+protected:
+    const char* data = nullptr;
+    size_t size = 0;
+
+#ifdef _WIN32
+    std::string buffer;
+#endif
+
+};
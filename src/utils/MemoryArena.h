@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+ * 内存竞技场（bump allocator）。
+ * 创建：2026.10.18
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+/**
+ * 内存竞技场。
+ *
+ * 从大块内存中按顺序切出小块，分配只需移动游标。
+ * 切出的内存不能单独释放，只能通过 release 一次性归还。
+ *
+ * 本工具不负责调用对象的析构函数。
+ */
+class MemoryArena {
+
+public:
+
+    /**
+     * @param blockSize 每个内存块的默认大小（字节）。
+     */
+    explicit MemoryArena(size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+
+    MemoryArena(const MemoryArena&) = delete;
+    MemoryArena& operator = (const MemoryArena&) = delete;
+
+    /**
+     * 分配一块内存。
+     *
+     * @param size 字节数。
+     * @param align 对齐要求。需要是 2 的幂。
+     */
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+
+        uintptr_t pos = (uintptr_t(cursor) + align - 1) & ~uintptr_t(align - 1);
+        size_t padding = pos - uintptr_t(cursor);
+
+        if (cursor == nullptr || padding + size > remaining) {
+            // 当前块不够用，开新块。过大的请求单独占用一块。
+            size_t newBlockSize = size + align > blockSize ? size + align : blockSize;
+            blocks.emplace_back(new unsigned char[newBlockSize]);
+            cursor = blocks.back().get();
+            remaining = newBlockSize;
+
+            pos = (uintptr_t(cursor) + align - 1) & ~uintptr_t(align - 1);
+            padding = pos - uintptr_t(cursor);
+        }
+
+        cursor += padding + size;
+        remaining -= padding + size;
+        usedBytes += size;
+
+        return reinterpret_cast<void*>(pos);
+    }
+
+    /**
+     * 分配一个类型为 T 的数组。数组元素未初始化。
+     */
+    template <typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /**
+     * 归还所有内存。耗时只与内存块数量有关。
+     */
+    void release() {
+        blocks.clear();
+        cursor = nullptr;
+        remaining = 0;
+        usedBytes = 0;
+    }
+
+    /**
+     * 已分配出去的字节数。
+     */
+    size_t getUsedBytes() const { return usedBytes; }
+
+    /**
+     * 当前持有的内存块数量。
+     */
+    size_t getBlockCount() const { return blocks.size(); }
+
+protected:
+
+    std::vector< std::unique_ptr<unsigned char[]> > blocks;
+    unsigned char* cursor = nullptr;
+    size_t remaining = 0;
+    size_t blockSize;
+    size_t usedBytes = 0;
+
+};
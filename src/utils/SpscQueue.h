@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: MulanPSL-2.0
+
+/*
+ * 单生产者单消费者有界无锁队列。
+ * 创建：2026.10.18
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+/**
+ * 单生产者单消费者有界无锁队列（环形缓冲区）。
+ *
+ * 只允许一个线程调用 push 类方法，一个线程调用 pop 类方法。
+ * 生产者只写 tail，消费者只写 head，二者通过 acquire/release 同步，不需要锁。
+ */
+template <typename T>
+class SpscQueue {
+
+public:
+
+    /**
+     * @param capacity 队列容量。会向上取整到 2 的幂。
+     */
+    explicit SpscQueue(size_t capacity = 64) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator = (const SpscQueue&) = delete;
+
+    /**
+     * 尝试入队。仅生产者线程调用。
+     *
+     * @return 队列已满时返回 false，此时 value 不会被移走。
+     */
+    bool tryPush(T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) > mask) {
+            return false; // 满。
+        }
+
+        slots[t & mask] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * 入队。队列满时等待消费者腾出位置。仅生产者线程调用。
+     */
+    void push(T value) {
+        while (!tryPush(value)) {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * 尝试出队。仅消费者线程调用。
+     *
+     * @return 队列为空时返回 false。
+     */
+    bool tryPop(T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false; // 空。
+        }
+
+        value = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * 出队。队列为空时等待生产者放入元素。仅消费者线程调用。
+     */
+    T pop() {
+        T value;
+        while (!tryPop(value)) {
+            std::this_thread::yield();
+        }
+
+        return value;
+    }
+
+protected:
+
+    std::vector<T> slots;
+    size_t mask;
+
+    /** 消费者位置。与 tail 分处不同缓存行，避免伪共享。 */
+    alignas(64) std::atomic<size_t> head { 0 };
+
+    /** 生产者位置。 */
+    alignas(64) std::atomic<size_t> tail { 0 };
+
+};